@@ -2,37 +2,430 @@
 #include <QMap>
 #include <QHash>
 #include <QDebug>
+#include <QActionEvent>
+#include <QPointer>
+#include <algorithm>
 #include "SARibbonBar.h"
 
+/**
+ * @def 搜索索引的n-gram最大长度
+ *
+ * action的文本会把长度为1~SA_ACTIONS_SEARCH_GRAM的所有子串建立索引，
+ * 不超过此长度的关键词可直接通过索引得到结果，超过此长度的关键词通过其所有子串的交集得到候选再精确匹配
+ */
+#define SA_ACTIONS_SEARCH_GRAM 3
+
+/**
+ * @brief tag下的action列表，保持注册顺序，同一个action只记录一次
+ *
+ * 通过action到位置的索引，移除action只把对应位置置空，空位过多时再统一压缩，
+ * 因此逐个移除action的耗时和tag中action的数量无关
+ *
+ * 列表通过@ref SARibbonActionsManager::actions 以引用的方式对外暴露，暴露前会先压缩，
+ * 外部可能直接修改列表，因此暴露后位置索引标记为失效，下次使用时重建
+ */
+class _SARibbonTagActions
+{
+public:
+    // 添加action，已经存在返回false
+    bool append(QAction* act);
+    // 移除action，O(1)
+    void remove(QAction* act);
+    // 是否已经没有action
+    bool isEmpty();
+    // 压缩后的列表，列表可能被外部修改
+    QList< QAction* >& exposedList();
+    // 不含空位的列表
+    QList< QAction* > actions() const;
+
+private:
+    void compact();
+    void ensurePositions();
+
+private:
+    QList< QAction* > mActions;       ///< 注册顺序的action，移除的位置为nullptr
+    QHash< QAction*, int > mPosition;  ///< action在mActions中的位置
+    int mHoleCount { 0 };              ///< mActions中空位的数量
+    bool mIsPositionDirty { false };   ///< 列表对外暴露后位置索引需要重建
+};
+
+bool _SARibbonTagActions::append(QAction* act)
+{
+    ensurePositions();
+    if (mPosition.contains(act)) {
+        return false;
+    }
+    mPosition.insert(act, mActions.size());
+    mActions.append(act);
+    return true;
+}
+
+void _SARibbonTagActions::remove(QAction* act)
+{
+    ensurePositions();
+    auto i = mPosition.find(act);
+    if (i == mPosition.end()) {
+        return;
+    }
+    mActions[ i.value() ] = nullptr;
+    mPosition.erase(i);
+    ++mHoleCount;
+    // 空位超过一半再压缩，均摊后每次移除仍为O(1)
+    if (mHoleCount > 16 && mHoleCount * 2 > mActions.size()) {
+        compact();
+    }
+}
+
+bool _SARibbonTagActions::isEmpty()
+{
+    ensurePositions();
+    return mPosition.isEmpty();
+}
+
+QList< QAction* >& _SARibbonTagActions::exposedList()
+{
+    ensurePositions();
+    compact();
+    mIsPositionDirty = true;
+    return mActions;
+}
+
+QList< QAction* > _SARibbonTagActions::actions() const
+{
+    if (0 == mHoleCount) {
+        return mActions;
+    }
+    QList< QAction* > res;
+    res.reserve(mActions.size() - mHoleCount);
+    for (QAction* a : mActions) {
+        if (a) {
+            res.append(a);
+        }
+    }
+    return res;
+}
+
+void _SARibbonTagActions::compact()
+{
+    if (0 == mHoleCount) {
+        return;
+    }
+    mActions   = actions();
+    mHoleCount = 0;
+    mPosition.clear();
+    mPosition.reserve(mActions.size());
+    for (int i = 0; i < mActions.size(); ++i) {
+        mPosition.insert(mActions[ i ], i);
+    }
+}
+
+void _SARibbonTagActions::ensurePositions()
+{
+    if (!mIsPositionDirty) {
+        return;
+    }
+    mIsPositionDirty = false;
+    // 外部修改过的列表可能包含空指针和重复的action
+    QList< QAction* > acts;
+    acts.reserve(mActions.size());
+    mPosition.clear();
+    for (QAction* a : qAsConst(mActions)) {
+        if (a && !mPosition.contains(a)) {
+            mPosition.insert(a, acts.size());
+            acts.append(a);
+        }
+    }
+    mActions   = acts;
+    mHoleCount = 0;
+}
+
 class SARibbonActionsManager::PrivateData
 {
     SA_RIBBON_DECLARE_PUBLIC(SARibbonActionsManager)
 public:
     PrivateData(SARibbonActionsManager* p);
     void clear();
-
-    QMap< int, QList< QAction* > > mTagToActions;   ///< tag : QList<QAction*>
+    // 规范化文本，去除助记符并转为小写，用于搜索
+    static QString normalizeText(const QString& text);
+    // 建立/移除action的搜索索引
+    void indexAction(QAction* act);
+    void unindexAction(QAction* act);
+    void updateGrams(QAction* act, const QString& normText, bool add);
+    // 查找包含关键词的action，关键词需已经规范化
+    QSet< QAction* > searchKeyword(const QString& kw) const;
+
+    // 从tag中移除action，tag中没有action时移除tag，返回tag是否被移除
+    bool removeActionFromTag(QAction* act, int tag);
+    // 从总表中移除action
+    void removeFromTotal(QAction* act);
+    // 实时跟踪category和pannel
+    void trackCategory(SARibbonCategory* c, bool on);
+    void trackPannel(SARibbonPannel* p, bool on);
+    // category对应的tag，没有返回-1
+    int categoryTag(const QObject* c) const;
+    // 判断action是否还在category的其它pannel中
+    static bool isActionInCategory(QAction* act, SARibbonCategory* c, SARibbonPannel* exclude);
+
+    QMap< int, _SARibbonTagActions > mTagToActions;  ///< tag : action列表
+    QHash< QAction*, QSet< int > > mActionToTags;   ///< action对应的tag，是mTagToActions的反向索引
     QMap< int, QString > mTagToName;                ///< tag对应的名字
     QHash< QString, QAction* > mKeyToAction;        ///< key对应action
-    QMap< QAction*, QString > mActionToKey;         ///< action对应key
+    QHash< QAction*, QString > mActionToKey;        ///< action对应key
     QMap< int, SARibbonCategory* > mTagToCategory;  ///< 仅仅在autoRegisteActions函数会有用
     int mSale;  ///< 盐用于生成固定的id，在用户不主动设置key时，id基于msale生成，只要SARibbonActionsManager的调用registeAction顺序不变，生成的id都不变，因为它是基于自增实现的
+    QHash< QString, QSet< QAction* > > mGramToActions;         ///< 搜索索引，n-gram对应的action
+    QHash< QAction*, QString > mActionToIndexedText;           ///< action建立索引时的文本（已规范化）
+    QPointer< SARibbonBar > mBar;                              ///< autoRegisteActions的ribbonbar，实时跟踪用
+    bool mLiveTracking { false };                              ///< 是否实时跟踪
+    int mNextCategoryTag { AutoCategoryDistinguishBeginTag };  ///< 下一个新增category使用的tag
 };
 
 SARibbonActionsManager::PrivateData::PrivateData(SARibbonActionsManager* p) : q_ptr(p), mSale(0)
 {
 }
 
+void SARibbonActionsManager::PrivateData::trackCategory(SARibbonCategory* c, bool on)
+{
+    SARibbonActionsManager* q = q_ptr;
+    if (on) {
+        q->connect(c, &SARibbonCategory::pannelAdded, q, &SARibbonActionsManager::onPannelAdded, Qt::UniqueConnection);
+        q->connect(c,
+                   &SARibbonCategory::pannelRemoved,
+                   q,
+                   &SARibbonActionsManager::onPannelRemoved,
+                   Qt::UniqueConnection);
+        q->connect(c, &QObject::destroyed, q, &SARibbonActionsManager::onCategoryDestroyed, Qt::UniqueConnection);
+    } else {
+        q->disconnect(c, &SARibbonCategory::pannelAdded, q, &SARibbonActionsManager::onPannelAdded);
+        q->disconnect(c, &SARibbonCategory::pannelRemoved, q, &SARibbonActionsManager::onPannelRemoved);
+        q->disconnect(c, &QObject::destroyed, q, &SARibbonActionsManager::onCategoryDestroyed);
+    }
+    const QList< SARibbonPannel* > pannels = c->pannelList();
+    for (SARibbonPannel* p : pannels) {
+        trackPannel(p, on);
+    }
+}
+
+void SARibbonActionsManager::PrivateData::trackPannel(SARibbonPannel* p, bool on)
+{
+    if (on) {
+        // installEventFilter对同一个对象只会安装一次
+        p->installEventFilter(q_ptr);
+    } else {
+        p->removeEventFilter(q_ptr);
+    }
+}
+
+int SARibbonActionsManager::PrivateData::categoryTag(const QObject* c) const
+{
+    for (auto i = mTagToCategory.begin(); i != mTagToCategory.end(); ++i) {
+        if (static_cast< const QObject* >(i.value()) == c) {
+            return i.key();
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 判断action是否还在category中除exclude以外的pannel中
+ *
+ * 通过action关联的窗口判断，耗时只和action关联的窗口数相关
+ */
+bool SARibbonActionsManager::PrivateData::isActionInCategory(QAction* act,
+                                                             SARibbonCategory* c,
+                                                             SARibbonPannel* exclude)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const QList< QObject* > objs = act->associatedObjects();
+#else
+    const QList< QWidget* > objs = act->associatedWidgets();
+#endif
+    for (QObject* o : objs) {
+        for (QObject* w = o; w; w = w->parent()) {
+            if (SARibbonPannel* p = qobject_cast< SARibbonPannel* >(w)) {
+                if (p != exclude && p->category() == c) {
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+    return false;
+}
+
 void SARibbonActionsManager::PrivateData::clear()
 {
     mTagToActions.clear();
+    mActionToTags.clear();
     mTagToName.clear();
     mKeyToAction.clear();
     mActionToKey.clear();
     mTagToCategory.clear();
+    mGramToActions.clear();
+    mActionToIndexedText.clear();
     mSale = 0;
 }
 
+/**
+ * @brief 从tag中移除action
+ * @param act
+ * @param tag
+ * @return 如果tag中已经没有action，tag会被移除，此时返回true
+ */
+bool SARibbonActionsManager::PrivateData::removeActionFromTag(QAction* act, int tag)
+{
+    auto ite = mTagToActions.find(tag);
+    if (ite == mTagToActions.end()) {
+        return false;
+    }
+    ite.value().remove(act);
+    if (ite.value().isEmpty()) {
+        mTagToActions.erase(ite);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 从总表中移除action，包括key和搜索索引
+ * @param act
+ */
+void SARibbonActionsManager::PrivateData::removeFromTotal(QAction* act)
+{
+    auto i = mActionToKey.find(act);
+    if (i != mActionToKey.end()) {
+        mKeyToAction.remove(i.value());
+        mActionToKey.erase(i);
+    }
+    unindexAction(act);
+}
+
+/**
+ * @brief 规范化文本，去除助记符&（&&保留为&）并转为小写
+ * @param text
+ * @return
+ */
+QString SARibbonActionsManager::PrivateData::normalizeText(const QString& text)
+{
+    QString res;
+    res.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        if (text.at(i) == QLatin1Char('&')) {
+            if (i + 1 < text.size() && text.at(i + 1) == QLatin1Char('&')) {
+                res.append(QLatin1Char('&'));
+                ++i;
+            }
+            continue;
+        }
+        res.append(text.at(i));
+    }
+    return res.toCaseFolded();
+}
+
+/**
+ * @brief 建立action的搜索索引，已经建立过索引的action，如果文本没变化不做处理
+ * @param act
+ */
+void SARibbonActionsManager::PrivateData::indexAction(QAction* act)
+{
+    const QString normText = normalizeText(act->text());
+    auto ite               = mActionToIndexedText.find(act);
+    if (ite != mActionToIndexedText.end()) {
+        if (ite.value() == normText) {
+            return;
+        }
+        updateGrams(act, ite.value(), false);
+        ite.value() = normText;
+    } else {
+        mActionToIndexedText.insert(act, normText);
+    }
+    updateGrams(act, normText, true);
+}
+
+/**
+ * @brief 移除action的搜索索引
+ *
+ * 使用记录的文本移除，因此action在析构过程中也可以调用
+ * @param act
+ */
+void SARibbonActionsManager::PrivateData::unindexAction(QAction* act)
+{
+    auto ite = mActionToIndexedText.find(act);
+    if (ite == mActionToIndexedText.end()) {
+        return;
+    }
+    updateGrams(act, ite.value(), false);
+    mActionToIndexedText.erase(ite);
+}
+
+/**
+ * @brief 把文本的所有n-gram加入或移出索引，含空白的n-gram不会被查询到，不建立索引
+ * @param act
+ * @param normText 规范化后的文本
+ * @param add true为加入，false为移出
+ */
+void SARibbonActionsManager::PrivateData::updateGrams(QAction* act, const QString& normText, bool add)
+{
+    QSet< QString > grams;
+    const int len = normText.size();
+    for (int i = 0; i < len; ++i) {
+        for (int n = 1; n <= SA_ACTIONS_SEARCH_GRAM && i + n <= len; ++n) {
+            if (normText.at(i + n - 1).isSpace()) {
+                break;
+            }
+            grams.insert(normText.mid(i, n));
+        }
+    }
+    for (const QString& g : qAsConst(grams)) {
+        if (add) {
+            mGramToActions[ g ].insert(act);
+            continue;
+        }
+        auto ite = mGramToActions.find(g);
+        if (ite != mGramToActions.end()) {
+            ite.value().remove(act);
+            if (ite.value().isEmpty()) {
+                mGramToActions.erase(ite);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 查找文本包含关键词的action
+ * @param kw 规范化后的关键词，不含空白
+ * @return
+ */
+QSet< QAction* > SARibbonActionsManager::PrivateData::searchKeyword(const QString& kw) const
+{
+    if (kw.size() <= SA_ACTIONS_SEARCH_GRAM) {
+        return mGramToActions.value(kw);
+    }
+    // 长关键词取其所有n-gram索引的交集作为候选，再精确匹配
+    QSet< QAction* > candidates;
+    for (int i = 0; i + SA_ACTIONS_SEARCH_GRAM <= kw.size(); ++i) {
+        auto ite = mGramToActions.constFind(kw.mid(i, SA_ACTIONS_SEARCH_GRAM));
+        if (ite == mGramToActions.constEnd()) {
+            return QSet< QAction* >();
+        }
+        if (0 == i) {
+            candidates = ite.value();
+        } else {
+            candidates.intersect(ite.value());
+        }
+        if (candidates.isEmpty()) {
+            return candidates;
+        }
+    }
+    QSet< QAction* > res;
+    for (QAction* a : qAsConst(candidates)) {
+        if (mActionToIndexedText.value(a).contains(kw)) {
+            res.insert(a);
+        }
+    }
+    return res;
+}
+
 SARibbonActionsManager::SARibbonActionsManager(SARibbonBar* bar)
     : QObject(bar), d_ptr(new SARibbonActionsManager::PrivateData(this))
 {
@@ -66,35 +459,30 @@ QString SARibbonActionsManager::tagName(int tag) const
 
 /**
  * @brief 移除tag
- * @note 注意，这个函数非常耗时
+ *
+ * 不再属于任何tag的action会从管理器中移除，
+ * 通过action到tag的反向索引，耗时只和此tag下的action数量相关
  * @param tag
  */
 void SARibbonActionsManager::removeTag(int tag)
 {
-    QList< QAction* > oldacts = actions(tag);
+    const QList< QAction* > oldacts = d_ptr->mTagToActions.take(tag).actions();
 
-    // 开始移除
-    d_ptr->mTagToActions.remove(tag);
     d_ptr->mTagToName.remove(tag);
-    // 开始查找需要移出总表的action
-    QList< QAction* > needRemoveAct;
-    QList< QAction* > total;
-
-    for (auto i = d_ptr->mTagToActions.begin(); i != d_ptr->mTagToActions.end(); ++i) {
-        total += i.value();
-    }
-    for (QAction* a : qAsConst(oldacts)) {
-        if (!total.contains(a)) {
-            needRemoveAct.append(a);
+    for (QAction* a : oldacts) {
+        auto i = d_ptr->mActionToTags.find(a);
+        if (i == d_ptr->mActionToTags.end()) {
+            continue;
         }
-    }
-    // 从总表移除action
-    for (QAction* a : qAsConst(needRemoveAct)) {
-        auto i = d_ptr->mActionToKey.find(a);
-        if (i != d_ptr->mActionToKey.end()) {
-            d_ptr->mKeyToAction.remove(i.value());
-            d_ptr->mActionToKey.erase(i);
+        i.value().remove(tag);
+        if (!i.value().isEmpty()) {
+            continue;
         }
+        // action不再属于任何tag，从总表移除
+        d_ptr->mActionToTags.erase(i);
+        d_ptr->removeFromTotal(a);
+        disconnect(a, &QObject::destroyed, this, &SARibbonActionsManager::onActionDestroyed);
+        disconnect(a, &QAction::changed, this, &SARibbonActionsManager::onActionChanged);
     }
 }
 
@@ -130,8 +518,12 @@ bool SARibbonActionsManager::registeAction(QAction* act, int tag, const QString&
     bool isneedemit = !(d_ptr->mTagToActions.contains(tag));  // 记录是否需要发射信号
 
     d_ptr->mTagToActions[ tag ].append(act);
+    d_ptr->mActionToTags[ act ].insert(tag);
+    // 建立搜索索引
+    d_ptr->indexAction(act);
     // 绑定槽
-    connect(act, &QObject::destroyed, this, &SARibbonActionsManager::onActionDestroyed);
+    connect(act, &QObject::destroyed, this, &SARibbonActionsManager::onActionDestroyed, Qt::UniqueConnection);
+    connect(act, &QAction::changed, this, &SARibbonActionsManager::onActionChanged, Qt::UniqueConnection);
     if (isneedemit && enableEmit) {
         // 说明新增tag
         emit actionTagChanged(tag, false);
@@ -154,45 +546,29 @@ void SARibbonActionsManager::unregisteAction(QAction* act, bool enableEmit)
     }
     // 绑定槽
     disconnect(act, &QObject::destroyed, this, &SARibbonActionsManager::onActionDestroyed);
+    disconnect(act, &QAction::changed, this, &SARibbonActionsManager::onActionChanged);
     removeAction(act, enableEmit);
 }
 
 /**
  * @brief 移除action
  *
- * 仅移除内存内容
+ * 仅移除内存内容，通过action到tag的反向索引只处理action所在的tag
  * @param act
  * @param enableEmit
  */
 void SARibbonActionsManager::removeAction(QAction* act, bool enableEmit)
 {
-    QList< int > deletedTags;                     // 记录删除的tag，用于触发actionTagChanged
-    QMap< int, QList< QAction* > > tagToActions;  ///< tag : QList<QAction*>
-
-    for (auto i = d_ptr->mTagToActions.begin(); i != d_ptr->mTagToActions.end(); ++i) {
-        // 把不是act的内容转移到tagToActions和tagToActionKeys中，之后再和m_d里的替换
-        auto tmpi = tagToActions.insert(i.key(), QList< QAction* >());
-        int count = 0;
-        for (int j = 0; j < i.value().size(); ++j) {
-            if (i.value()[ j ] != act) {
-                tmpi.value().append(act);
-                ++count;
-            }
-        }
-        if (0 == count) {
+    QList< int > deletedTags;  // 记录删除的tag，用于触发actionTagChanged
+    const QSet< int > tags = d_ptr->mActionToTags.take(act);
+
+    for (int tag : tags) {
+        if (d_ptr->removeActionFromTag(act, tag)) {
             // 说明这个tag没有内容
-            tagToActions.erase(tmpi);
-            deletedTags.append(i.key());
+            deletedTags.append(tag);
         }
     }
-    // 删除mKeyToAction
-    QString key = d_ptr->mActionToKey.value(act);
-
-    d_ptr->mActionToKey.remove(act);
-    d_ptr->mKeyToAction.remove(key);
-
-    // 置换
-    d_ptr->mTagToActions.swap(tagToActions);
+    d_ptr->removeFromTotal(act);
     // 发射信号
     if (enableEmit) {
         for (int tagdelete : qAsConst(deletedTags)) {
@@ -215,15 +591,27 @@ QList< QAction* >& SARibbonActionsManager::filter(int tag)
  * @brief 根据tag得到actions
  * @param tag
  * @return
+ * @note 返回的是内部列表的引用，增删action请使用@ref registeAction 和@ref unregisteAction ，
+ * 直接修改此列表不会更新action到tag的反向索引；
+ * 对外暴露引用后，tag内部的位置索引会在下次增删时重建（O(n)），只读取时请使用const版本
+ * @note 同一个action在一个tag中只会出现一次，重复注册会被忽略，直接在列表中加入的重复action在重建索引时会被去除
  */
 QList< QAction* >& SARibbonActionsManager::actions(int tag)
 {
-    return (d_ptr->mTagToActions[ tag ]);
+    return (d_ptr->mTagToActions[ tag ].exposedList());
 }
 
+/**
+ * @brief 根据tag得到actions的快照
+ *
+ * 不会影响tag内部的位置索引，只读取时应使用此函数
+ * @param tag
+ * @return
+ */
 const QList< QAction* > SARibbonActionsManager::actions(int tag) const
 {
-    return (d_ptr->mTagToActions[ tag ]);
+    auto i = d_ptr->mTagToActions.constFind(tag);
+    return (i == d_ptr->mTagToActions.constEnd() ? QList< QAction* >() : i.value().actions());
 }
 
 /**
@@ -309,6 +697,9 @@ QMap< int, SARibbonCategory* > SARibbonActionsManager::autoRegisteActions(SARibb
         // 非ribbon模式，直接退出
         return (res);
     }
+    // 实时跟踪时先解除对原有category的跟踪，遍历完成后再重新跟踪
+    const bool liveTracking = d_ptr->mLiveTracking;
+    setLiveTrackingEnabled(false);
     QSet< QAction* > categoryActions;
     QList< SARibbonCategory* > categorys = bar->categoryPages();
     int tag                              = AutoCategoryDistinguishBeginTag;
@@ -336,7 +727,10 @@ QMap< int, SARibbonCategory* > SARibbonActionsManager::autoRegisteActions(SARibb
     for (auto i = res.begin(); i != res.end(); ++i) {
         connect(i.value(), &SARibbonCategory::categoryNameChanged, this, &SARibbonActionsManager::onCategoryTitleChanged);
     }
-    d_ptr->mTagToCategory = res;
+    d_ptr->mTagToCategory   = res;
+    d_ptr->mBar             = bar;
+    d_ptr->mNextCategoryTag = tag;
+    setLiveTrackingEnabled(liveTracking);
     return (res);
 }
 
@@ -367,36 +761,230 @@ QSet< QAction* > SARibbonActionsManager::autoRegisteWidgetActions(QWidget* w, in
 
 /**
  * @brief 根据标题查找action
+ *
+ * 查找基于注册时建立的n-gram索引，action文本变化时索引会自动更新。
+ * 多个关键词用空格分隔，返回文本同时包含所有关键词的action（不区分大小写，忽略助记符&），结果不会重复，
+ * 按匹配程度排序：关键词位于文本开头的优先，其次是位于单词开头的，最后是位于单词中间的，
+ * 匹配程度相同时文本短的优先
  * @param text
  * @return
  */
 QList< QAction* > SARibbonActionsManager::search(const QString& text)
 {
     QList< QAction* > res;
+    const QString normText = PrivateData::normalizeText(text).simplified();
 
-    if (text.isEmpty()) {
+    if (normText.isEmpty()) {
         return (res);
     }
-    QStringList kws = text.split(" ");
-
-    if (kws.isEmpty()) {
-        kws.append(text);
+    const QStringList kws = normText.split(QLatin1Char(' '));
+    // 先得到每个关键词的结果，从最小的集合开始求交集
+    QList< QSet< QAction* > > kwResults;
+    for (const QString& k : kws) {
+        QSet< QAction* > r = d_ptr->searchKeyword(k);
+        if (r.isEmpty()) {
+            return (res);
+        }
+        kwResults.append(r);
     }
-    QList< QAction* > acts = d_ptr->mActionToKey.keys();
-
-    for (const QString& k : qAsConst(kws)) {
-        for (auto i = d_ptr->mActionToKey.begin(); i != d_ptr->mActionToKey.end(); ++i) {
-            if (i.key()->text().contains(k, Qt::CaseInsensitive)) {
-                res.append(i.key());
+    std::sort(kwResults.begin(), kwResults.end(), [](const QSet< QAction* >& a, const QSet< QAction* >& b) {
+        return a.size() < b.size();
+    });
+    QSet< QAction* > matched = kwResults.first();
+    for (int i = 1; i < kwResults.size() && !matched.isEmpty(); ++i) {
+        matched.intersect(kwResults.at(i));
+    }
+    // 排序
+    struct RankedAction
+    {
+        int score;
+        QAction* action;
+        QString text;
+    };
+    QList< RankedAction > ranked;
+    for (QAction* a : qAsConst(matched)) {
+        RankedAction ra { 0, a, d_ptr->mActionToIndexedText.value(a) };
+        for (const QString& k : kws) {
+            const int pos = ra.text.indexOf(k);
+            if (pos > 0) {
+                ra.score += ra.text.at(pos - 1).isLetterOrNumber() ? 2 : 1;
             }
         }
+        ranked.append(ra);
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const RankedAction& a, const RankedAction& b) {
+        if (a.score != b.score) {
+            return a.score < b.score;
+        }
+        if (a.text.size() != b.text.size()) {
+            return a.text.size() < b.text.size();
+        }
+        return a.text < b.text;
+    });
+    res.reserve(ranked.size());
+    for (const RankedAction& ra : qAsConst(ranked)) {
+        res.append(ra.action);
     }
     return (res);
 }
 
 void SARibbonActionsManager::clear()
 {
+    const bool liveTracking = d_ptr->mLiveTracking;
+    setLiveTrackingEnabled(false);
     d_ptr->clear();
+    d_ptr->mNextCategoryTag = AutoCategoryDistinguishBeginTag;
+    setLiveTrackingEnabled(liveTracking);
+}
+
+/**
+ * @brief 设置是否实时跟踪ribbonbar的变化
+ *
+ * 开启后，SARibbonActionsManager会跟踪@ref autoRegisteActions 时的SARibbonBar：
+ * - 新增的category会分配一个新的tag，其pannel中的action注册到此tag下
+ * - 移除的category对应的tag也会移除
+ * - category中新增或移除pannel，pannel中新增或移除action，都会增量更新到category对应的tag中
+ *
+ * 这些变化都会触发@ref actionTagChanged 信号，无需再调用autoRegisteActions进行全量遍历
+ *
+ * 和autoRegisteActions一样，没有objectName的action不会被注册
+ * @param on
+ * @note 上下文标签中的category不会被跟踪
+ */
+void SARibbonActionsManager::setLiveTrackingEnabled(bool on)
+{
+    if (d_ptr->mLiveTracking == on) {
+        return;
+    }
+    d_ptr->mLiveTracking = on;
+    SARibbonBar* bar     = d_ptr->mBar.data();
+    if (nullptr == bar) {
+        return;
+    }
+    if (on) {
+        connect(bar, &SARibbonBar::categoryAdded, this, &SARibbonActionsManager::onCategoryAdded, Qt::UniqueConnection);
+        connect(bar,
+                &SARibbonBar::categoryRemoved,
+                this,
+                &SARibbonActionsManager::onCategoryRemoved,
+                Qt::UniqueConnection);
+    } else {
+        disconnect(bar, &SARibbonBar::categoryAdded, this, &SARibbonActionsManager::onCategoryAdded);
+        disconnect(bar, &SARibbonBar::categoryRemoved, this, &SARibbonActionsManager::onCategoryRemoved);
+    }
+    for (SARibbonCategory* c : qAsConst(d_ptr->mTagToCategory)) {
+        d_ptr->trackCategory(c, on);
+    }
+    if (on) {
+        // 补上在autoRegisteActions之后添加的category
+        const QList< SARibbonCategory* > categorys = bar->categoryPages();
+        for (SARibbonCategory* c : categorys) {
+            onCategoryAdded(c);
+        }
+    }
+}
+
+bool SARibbonActionsManager::isLiveTrackingEnabled() const
+{
+    return d_ptr->mLiveTracking;
+}
+
+/**
+ * @brief 实时跟踪时，处理pannel中action的增减
+ */
+bool SARibbonActionsManager::eventFilter(QObject* obj, QEvent* e)
+{
+    if (d_ptr->mLiveTracking && (e->type() == QEvent::ActionAdded || e->type() == QEvent::ActionRemoved)) {
+        SARibbonPannel* p = qobject_cast< SARibbonPannel* >(obj);
+        QActionEvent* ae  = static_cast< QActionEvent* >(e);
+        if (p && ae->action()) {
+            SARibbonCategory* c = p->category();
+            const int tag       = d_ptr->categoryTag(c);
+            if (tag >= 0) {
+                if (e->type() == QEvent::ActionAdded) {
+                    registePannelAction(ae->action(), tag);
+                } else {
+                    // 此时pannel中的按钮还没有移除，需要排除此pannel
+                    unregistePannelAction(ae->action(), c, p);
+                }
+            }
+        }
+    }
+    return QObject::eventFilter(obj, e);
+}
+
+/**
+ * @brief 实时跟踪时把pannel中的action注册到category对应的tag
+ *
+ * 已经作为不在功能区的action注册的，会转移到此tag下
+ * @param act
+ * @param tag
+ */
+void SARibbonActionsManager::registePannelAction(QAction* act, int tag)
+{
+    if (act->objectName().isEmpty()) {
+        return;
+    }
+    auto i = d_ptr->mActionToTags.find(act);
+    if (i == d_ptr->mActionToTags.end()) {
+        registeAction(act, tag, act->objectName(), true);
+        return;
+    }
+    if (!i.value().contains(NotInRibbonCategoryTag)) {
+        // 已经在某个category中
+        return;
+    }
+    i.value().remove(NotInRibbonCategoryTag);
+    i.value().insert(tag);
+    const bool isneedemit = !(d_ptr->mTagToActions.contains(tag));
+    d_ptr->mTagToActions[ tag ].append(act);
+    if (d_ptr->removeActionFromTag(act, NotInRibbonCategoryTag)) {
+        emit actionTagChanged(NotInRibbonCategoryTag, true);
+    }
+    if (isneedemit) {
+        emit actionTagChanged(tag, false);
+    }
+}
+
+/**
+ * @brief 实时跟踪时，action脱离了pannel，如果category中已经没有此action，从category对应的tag中移除
+ * @param act
+ * @param c action所在的category
+ * @param exclude 判断action是否还在category中时排除的pannel
+ */
+void SARibbonActionsManager::unregistePannelAction(QAction* act, SARibbonCategory* c, SARibbonPannel* exclude)
+{
+    const int tag = d_ptr->categoryTag(c);
+    auto i        = d_ptr->mActionToTags.find(act);
+    if (i == d_ptr->mActionToTags.end() || !i.value().contains(tag)) {
+        return;
+    }
+    if (PrivateData::isActionInCategory(act, c, exclude)) {
+        return;
+    }
+    if (i.value().size() == 1) {
+        // action只属于此tag，直接取消注册
+        unregisteAction(act, true);
+        return;
+    }
+    i.value().remove(tag);
+    if (d_ptr->removeActionFromTag(act, tag)) {
+        emit actionTagChanged(tag, true);
+    }
+}
+
+/**
+ * @brief 移除category对应的tag
+ * @param tag
+ */
+void SARibbonActionsManager::removeCategoryTag(int tag)
+{
+    d_ptr->mTagToCategory.remove(tag);
+    const bool isneedemit = d_ptr->mTagToActions.contains(tag);
+    removeTag(tag);
+    if (isneedemit) {
+        emit actionTagChanged(tag, true);
+    }
 }
 
 /**
@@ -411,6 +999,20 @@ void SARibbonActionsManager::onActionDestroyed(QObject* o)
     removeAction(act, false);
 }
 
+/**
+ * @brief action变化时更新搜索索引（文本没有变化时不更新），并转发actionChanged信号
+ */
+void SARibbonActionsManager::onActionChanged()
+{
+    QAction* act = qobject_cast< QAction* >(sender());
+
+    if (nullptr == act || !d_ptr->mActionToKey.contains(act)) {
+        return;
+    }
+    d_ptr->indexAction(act);
+    emit actionChanged(act);
+}
+
 /**
  * @brief autoRegisteActions函数会关联此槽，在标签内容改变时改变tag 对应 文本
  * @param title
@@ -430,6 +1032,101 @@ void SARibbonActionsManager::onCategoryTitleChanged(const QString& title)
     setTagName(tag, title);
 }
 
+/**
+ * @brief 实时跟踪时，ribbonbar新增了category
+ * @param c
+ */
+void SARibbonActionsManager::onCategoryAdded(SARibbonCategory* c)
+{
+    if (nullptr == c || c->isContextCategory() || d_ptr->categoryTag(c) >= 0) {
+        return;
+    }
+    if (d_ptr->mNextCategoryTag >= AutoCategoryDistinguishEndTag) {
+        qWarning() << "SARibbonActionsManager: too many categories to distinguish,category " << c->categoryName()
+                   << " will not be tracked";
+        return;
+    }
+    const int tag = d_ptr->mNextCategoryTag++;
+    // 先设置名字，保证actionTagChanged发射时名字已经有效
+    setTagName(tag, c->categoryName());
+    d_ptr->mTagToCategory[ tag ] = c;
+    connect(c,
+            &SARibbonCategory::categoryNameChanged,
+            this,
+            &SARibbonActionsManager::onCategoryTitleChanged,
+            Qt::UniqueConnection);
+    const QList< SARibbonPannel* > pannels = c->pannelList();
+    for (SARibbonPannel* p : pannels) {
+        const QList< QAction* > acts = p->actions();
+        for (QAction* a : acts) {
+            registePannelAction(a, tag);
+        }
+    }
+    d_ptr->trackCategory(c, true);
+}
+
+/**
+ * @brief 实时跟踪时，category从ribbonbar中移除
+ * @param c
+ */
+void SARibbonActionsManager::onCategoryRemoved(SARibbonCategory* c)
+{
+    const int tag = d_ptr->categoryTag(c);
+    if (tag < 0) {
+        return;
+    }
+    d_ptr->trackCategory(c, false);
+    disconnect(c, &SARibbonCategory::categoryNameChanged, this, &SARibbonActionsManager::onCategoryTitleChanged);
+    removeCategoryTag(tag);
+}
+
+/**
+ * @brief 实时跟踪时，category被直接delete
+ * @param o
+ */
+void SARibbonActionsManager::onCategoryDestroyed(QObject* o)
+{
+    const int tag = d_ptr->categoryTag(o);
+    if (tag < 0) {
+        return;
+    }
+    removeCategoryTag(tag);
+}
+
+/**
+ * @brief 实时跟踪时，category新增了pannel
+ * @param p
+ */
+void SARibbonActionsManager::onPannelAdded(SARibbonPannel* p)
+{
+    const int tag = d_ptr->categoryTag(sender());
+    if (tag < 0) {
+        return;
+    }
+    d_ptr->trackPannel(p, true);
+    const QList< QAction* > acts = p->actions();
+    for (QAction* a : acts) {
+        registePannelAction(a, tag);
+    }
+}
+
+/**
+ * @brief 实时跟踪时，pannel脱离了category
+ * @param p
+ */
+void SARibbonActionsManager::onPannelRemoved(SARibbonPannel* p)
+{
+    SARibbonCategory* c = qobject_cast< SARibbonCategory* >(sender());
+    if (nullptr == c || d_ptr->categoryTag(c) < 0) {
+        return;
+    }
+    d_ptr->trackPannel(p, false);
+    const QList< QAction* > acts = p->actions();
+    for (QAction* a : acts) {
+        unregistePannelAction(a, c, p);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// SARibbonActionsModel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -443,12 +1140,30 @@ public:
     int count() const;
     QAction* at(int index);
     bool isNull() const;
+    // 获取当前标签和查找条件下应该显示的actions
+    QList< QAction* > targetActions() const;
+    // 增量的把mActions更新为acts
+    void applyActions(const QList< QAction* >& acts);
+    // 按acts的顺序重排现有的行，acts必须和现有的行包含相同的action
+    void reorderActions(const QList< QAction* >& acts);
+    // action是否匹配当前的查找文本
+    bool isMatched(QAction* act) const;
+    // 更新匹配的action，只对变化的行发射dataChanged
+    void updateMatched();
+    // action所在的行，没有返回-1
+    int rowOf(QAction* act) const;
+    // 对行号排序后按连续区间发射dataChanged
+    void emitRowsChanged(QList< int >& rows, const QVector< int >& roles);
 
 public:
     SARibbonActionsManager* mMgr { nullptr };
     int mTag { SARibbonActionsManager::CommonlyUsedActionTag };
     QString mSeatchText;
     QList< QAction* > mActions;
+    bool mSearchFilter { true };                  ///< 查找时是否过滤行
+    QSet< QAction* > mMatched;                    ///< 不过滤行时，匹配查找的action
+    mutable QHash< QAction*, int > mActionToRow;  ///< action对应的行，延迟生成
+    mutable bool mActionToRowDirty { true };      ///< mActionToRow需要重新生成
 };
 
 SARibbonActionsManagerModel::PrivateData::PrivateData(SARibbonActionsManagerModel* p) : q_ptr(p)
@@ -458,13 +1173,11 @@ SARibbonActionsManagerModel::PrivateData::PrivateData(SARibbonActionsManagerMode
 void SARibbonActionsManagerModel::PrivateData::updateRef()
 {
     if (isNull()) {
+        applyActions(QList< QAction* >());
         return;
     }
-    if (!mSeatchText.isEmpty()) {
-        mActions = mMgr->search(mSeatchText);
-    } else {
-        mActions = mMgr->actions(mTag);
-    }
+    applyActions(targetActions());
+    updateMatched();
 }
 
 int SARibbonActionsManagerModel::PrivateData::count() const
@@ -491,6 +1204,201 @@ bool SARibbonActionsManagerModel::PrivateData::isNull() const
     return (mMgr == nullptr);
 }
 
+QList< QAction* > SARibbonActionsManagerModel::PrivateData::targetActions() const
+{
+    if (mSearchFilter && !mSeatchText.isEmpty()) {
+        return mMgr->search(mSeatchText);
+    }
+    // 使用const版本，非const版本会对外暴露内部列表，导致位置索引失效，之后的移除又退化为O(n)
+    return static_cast< const SARibbonActionsManager* >(mMgr)->actions(mTag);
+}
+
+/**
+ * @brief 增量的把mActions更新为acts
+ *
+ * 先按连续区间移除不在acts中的行，如果剩余的行在acts中的顺序发生了变化（例如查找结果的排序发生了变化），
+ * 通过layoutChanged重排剩余的行，最后按连续区间插入新增的行，持久索引在整个过程中都会保持指向原来的action
+ * @param acts
+ */
+void SARibbonActionsManagerModel::PrivateData::applyActions(const QList< QAction* >& acts)
+{
+    SARibbonActionsManagerModel* q = q_ptr;
+    QSet< QAction* > newSet;
+    newSet.reserve(acts.size());
+    for (QAction* a : acts) {
+        newSet.insert(a);
+    }
+    if (newSet.size() != acts.size()) {
+        // 有重复的action，无法按集合比较
+        q->beginResetModel();
+        mActions          = acts;
+        mActionToRowDirty = true;
+        q->endResetModel();
+        return;
+    }
+    // 从后往前按连续区间移除
+    for (int last = mActions.size() - 1; last >= 0;) {
+        if (newSet.contains(mActions.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !newSet.contains(mActions.at(first - 1))) {
+            --first;
+        }
+        q->beginRemoveRows(QModelIndex(), first, last);
+        mActions.erase(mActions.begin() + first, mActions.begin() + last + 1);
+        mActionToRowDirty = true;
+        q->endRemoveRows();
+        last = first - 1;
+    }
+    // 剩余的行必须是acts的子序列，否则按acts的顺序重排
+    int j = 0;
+    for (int i = 0; i < acts.size() && j < mActions.size(); ++i) {
+        if (acts.at(i) == mActions.at(j)) {
+            ++j;
+        }
+    }
+    if (j != mActions.size()) {
+        QSet< QAction* > remain;
+        remain.reserve(mActions.size());
+        for (QAction* a : qAsConst(mActions)) {
+            remain.insert(a);
+        }
+        QList< QAction* > ordered;
+        ordered.reserve(mActions.size());
+        for (QAction* a : acts) {
+            if (remain.contains(a)) {
+                ordered.append(a);
+            }
+        }
+        reorderActions(ordered);
+    }
+    // 按连续区间插入
+    for (int i = 0; i < acts.size();) {
+        if (i < mActions.size() && acts.at(i) == mActions.at(i)) {
+            ++i;
+            continue;
+        }
+        const bool atEnd = (i >= mActions.size());
+        int last         = i;
+        while (last + 1 < acts.size() && (atEnd || acts.at(last + 1) != mActions.at(i))) {
+            ++last;
+        }
+        q->beginInsertRows(QModelIndex(), i, last);
+        for (int k = i; k <= last; ++k) {
+            mActions.insert(k, acts.at(k));
+        }
+        mActionToRowDirty = true;
+        q->endInsertRows();
+        i = last + 1;
+    }
+}
+
+/**
+ * @brief 按acts的顺序重排现有的行
+ *
+ * 通过layoutAboutToBeChanged/layoutChanged通知视图，并把持久索引映射到新的行，
+ * 视图的选中和当前项不会丢失
+ * @param acts
+ */
+void SARibbonActionsManagerModel::PrivateData::reorderActions(const QList< QAction* >& acts)
+{
+    SARibbonActionsManagerModel* q = q_ptr;
+    emit q->layoutAboutToBeChanged(QList< QPersistentModelIndex >(), QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList oldIndexes = q->persistentIndexList();
+    QList< QAction* > oldActions;
+    oldActions.reserve(oldIndexes.size());
+    for (const QModelIndex& i : oldIndexes) {
+        oldActions.append(mActions.value(i.row(), nullptr));
+    }
+    mActions          = acts;
+    mActionToRowDirty = true;
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (int i = 0; i < oldIndexes.size(); ++i) {
+        const int r = rowOf(oldActions.at(i));
+        newIndexes.append(r >= 0 ? q->index(r, oldIndexes.at(i).column()) : QModelIndex());
+    }
+    q->changePersistentIndexList(oldIndexes, newIndexes);
+    emit q->layoutChanged(QList< QPersistentModelIndex >(), QAbstractItemModel::VerticalSortHint);
+}
+
+/**
+ * @brief 判断action是否匹配当前的查找文本，和@ref SARibbonActionsManager::search 的匹配规则一致
+ * @param act
+ * @return 查找文本为空时返回false
+ */
+bool SARibbonActionsManagerModel::PrivateData::isMatched(QAction* act) const
+{
+    const QString normText = SARibbonActionsManager::PrivateData::normalizeText(mSeatchText).simplified();
+    if (normText.isEmpty()) {
+        return false;
+    }
+    const QString actText = SARibbonActionsManager::PrivateData::normalizeText(act->text());
+    const QStringList kws = normText.split(QLatin1Char(' '));
+    for (const QString& k : kws) {
+        if (!actText.contains(k)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 不过滤行时，查找只更新匹配状态，对匹配状态变化的行发射dataChanged
+ */
+void SARibbonActionsManagerModel::PrivateData::updateMatched()
+{
+    QSet< QAction* > matched;
+    if (!mSearchFilter && !isNull() && !mSeatchText.isEmpty()) {
+        const QList< QAction* > res = mMgr->search(mSeatchText);
+        matched.reserve(res.size());
+        for (QAction* a : res) {
+            matched.insert(a);
+        }
+    }
+    QSet< QAction* > changed = matched;
+    changed.unite(mMatched);
+    changed.subtract(matched & mMatched);
+    mMatched = matched;
+    QList< int > rows;
+    for (QAction* a : qAsConst(changed)) {
+        const int r = rowOf(a);
+        if (r >= 0) {
+            rows.append(r);
+        }
+    }
+    emitRowsChanged(rows, QVector< int >() << ActionMatchedRole);
+}
+
+int SARibbonActionsManagerModel::PrivateData::rowOf(QAction* act) const
+{
+    if (mActionToRowDirty) {
+        mActionToRow.clear();
+        mActionToRow.reserve(mActions.size());
+        for (int i = 0; i < mActions.size(); ++i) {
+            mActionToRow.insert(mActions.at(i), i);
+        }
+        mActionToRowDirty = false;
+    }
+    return mActionToRow.value(act, -1);
+}
+
+void SARibbonActionsManagerModel::PrivateData::emitRowsChanged(QList< int >& rows, const QVector< int >& roles)
+{
+    SARibbonActionsManagerModel* q = q_ptr;
+    std::sort(rows.begin(), rows.end());
+    for (int i = 0; i < rows.size();) {
+        int last = i;
+        while (last + 1 < rows.size() && rows.at(last + 1) == rows.at(last) + 1) {
+            ++last;
+        }
+        emit q->dataChanged(q->index(rows.at(i)), q->index(rows.at(last)), roles);
+        i = last + 1;
+    }
+}
+
 //===================================================
 // SARibbonActionsManagerModel
 //===================================================
@@ -554,6 +1462,12 @@ QVariant SARibbonActionsManagerModel::data(const QModelIndex& index, int role) c
     case Qt::DecorationRole:
         return (act->icon());
 
+    case ActionMatchedRole:
+        if (d_ptr->mSearchFilter || d_ptr->mSeatchText.isEmpty()) {
+            return (true);
+        }
+        return (d_ptr->mMatched.contains(act));
+
     default:
         break;
     }
@@ -566,19 +1480,28 @@ void SARibbonActionsManagerModel::setFilter(int tag)
     update();
 }
 
+/**
+ * @brief 更新model
+ *
+ * 会和当前的行进行比较，只移除和插入变化的行
+ */
 void SARibbonActionsManagerModel::update()
 {
-    beginResetModel();
     d_ptr->updateRef();
-    endResetModel();
 }
 
 void SARibbonActionsManagerModel::setupActionsManager(SARibbonActionsManager* m)
 {
+    // 更换manager时原有的行没有意义，直接重置
+    beginResetModel();
     d_ptr->mMgr     = m;
     d_ptr->mTag     = SARibbonActionsManager::CommonlyUsedActionTag;
-    d_ptr->mActions = m->filter(d_ptr->mTag);
+    d_ptr->mActions = static_cast< const SARibbonActionsManager* >(m)->actions(d_ptr->mTag);
+    d_ptr->mMatched.clear();
+    d_ptr->mActionToRowDirty = true;
+    endResetModel();
     connect(m, &SARibbonActionsManager::actionTagChanged, this, &SARibbonActionsManagerModel::onActionTagChanged);
+    connect(m, &SARibbonActionsManager::actionChanged, this, &SARibbonActionsManagerModel::onActionChanged);
     update();
 }
 
@@ -586,10 +1509,18 @@ void SARibbonActionsManagerModel::uninstallActionsManager()
 {
     if (!d_ptr->isNull()) {
         disconnect(d_ptr->mMgr, &SARibbonActionsManager::actionTagChanged, this, &SARibbonActionsManagerModel::onActionTagChanged);
+        disconnect(d_ptr->mMgr,
+                   &SARibbonActionsManager::actionChanged,
+                   this,
+                   &SARibbonActionsManagerModel::onActionChanged);
         d_ptr->mMgr = nullptr;
         d_ptr->mTag = SARibbonActionsManager::CommonlyUsedActionTag;
     }
-    update();
+    beginResetModel();
+    d_ptr->mActions.clear();
+    d_ptr->mMatched.clear();
+    d_ptr->mActionToRowDirty = true;
+    endResetModel();
 }
 
 QAction* SARibbonActionsManagerModel::indexToAction(QModelIndex index) const
@@ -609,10 +1540,34 @@ QAction* SARibbonActionsManagerModel::indexToAction(QModelIndex index) const
  */
 void SARibbonActionsManagerModel::search(const QString& text)
 {
+    if (d_ptr->mSeatchText == text) {
+        return;
+    }
     d_ptr->mSeatchText = text;
     update();
 }
 
+/**
+ * @brief 设置查找时是否过滤行
+ *
+ * 默认为true，查找时只显示匹配的行；设置为false后，查找不会改变model的行，
+ * 只会更新@ref ActionMatchedRole 并对匹配状态变化的行发射dataChanged，适合配合QSortFilterProxyModel使用
+ * @param on
+ */
+void SARibbonActionsManagerModel::setSearchFilterEnabled(bool on)
+{
+    if (d_ptr->mSearchFilter == on) {
+        return;
+    }
+    d_ptr->mSearchFilter = on;
+    update();
+}
+
+bool SARibbonActionsManagerModel::isSearchFilterEnabled() const
+{
+    return d_ptr->mSearchFilter;
+}
+
 void SARibbonActionsManagerModel::onActionTagChanged(int tag, bool isdelete)
 {
     if (isdelete && (tag == d_ptr->mTag)) {
@@ -624,3 +1579,37 @@ void SARibbonActionsManagerModel::onActionTagChanged(int tag, bool isdelete)
         }
     }
 }
+
+/**
+ * @brief action变化时只刷新对应的行
+ *
+ * 有查找文本时会重新判断action是否匹配：过滤行时匹配状态变化会增删对应的行，
+ * 不过滤行时更新@ref ActionMatchedRole
+ * @param act
+ */
+void SARibbonActionsManagerModel::onActionChanged(QAction* act)
+{
+    if (d_ptr->isNull()) {
+        return;
+    }
+    int r = d_ptr->rowOf(act);
+    if (!d_ptr->mSeatchText.isEmpty()) {
+        const bool matched = d_ptr->isMatched(act);
+        if (d_ptr->mSearchFilter) {
+            if (matched != (r >= 0)) {
+                // 文本变化导致action进入或离开查找结果，增量更新行
+                update();
+                r = d_ptr->rowOf(act);
+            }
+        } else if (matched != d_ptr->mMatched.contains(act)) {
+            if (matched) {
+                d_ptr->mMatched.insert(act);
+            } else {
+                d_ptr->mMatched.remove(act);
+            }
+        }
+    }
+    if (r >= 0) {
+        emit dataChanged(index(r), index(r));
+    }
+}
@@ -9,6 +9,7 @@
 #include <QSet>
 class SARibbonBar;
 class SARibbonCategory;
+class SARibbonPannel;
 
 /**
  * @brief 用于管理SARibbon的所有Action
@@ -16,8 +17,8 @@ class SARibbonCategory;
  * SARibbonActionsManager维护着两个表，一个是tag（标签）对应的Action list，
  * 一个是所有接受SARibbonActionsManager管理的action list。
  *
- * SARibbonActionsManager的标签对应一组actions，每个标签对应的action可以重复出现，
- * 但SARibbonActionsManager维护的action list里只有一份action，不会重复出现。
+ * SARibbonActionsManager的标签对应一组actions，同一个action可以属于多个标签，但在一个标签中只会出现一次，
+ * 重复注册到同一个标签会被忽略，SARibbonActionsManager维护的action list里也只有一份action，不会重复出现。
  *
  * tag用于对action list分组，每个tag的实体名字通过@ref setTagName 进行设置，在语言变化时需要及时调用
  * setTagName设置新的标签对应的文本。
@@ -30,6 +31,10 @@ class SARibbonCategory;
  *
  * 通过@ref autoRegisteActions 函数可以快速的建立action的管理，此函数会遍历@ref SARibbonBar下所有@ref SARibbonPannel 添加的action,并给予Category建立tag，正常使用用户仅需关注此autoRegisteActions函数即可
  *
+ * autoRegisteActions只是一次性的遍历，如果ribbon在之后还会变化（例如插件加载后添加category和pannel），
+ * 可以通过@ref setLiveTrackingEnabled 开启实时跟踪，category的添加移除以及pannel中action的添加移除都会增量更新到标签中，
+ * 不需要重新调用autoRegisteActions
+ *
  *
  */
 class SA_RIBBON_EXPORT SARibbonActionsManager : public QObject
@@ -60,7 +65,7 @@ public:
     //获取tag对应的名字
     QString tagName(int tag) const;
 
-    //移除tag，注意，这个函数非常耗时
+    //移除tag
     void removeTag(int tag);
 
     //注册action
@@ -72,7 +77,7 @@ public:
     //过滤得到actions对应的引用，实际是一个迭代器
     QList< QAction* >& filter(int tag);
 
-    //通过tag筛选出系列action
+    //通过tag筛选出系列action，非const版本会使tag内部的位置索引失效，只读取时使用const版本
     QList< QAction* >& actions(int tag);
     const QList< QAction* > actions(int tag) const;
 
@@ -97,12 +102,16 @@ public:
     //自动加载widget下的actions函数返回的action,返回加载的数量，这些
     QSet< QAction* > autoRegisteWidgetActions(QWidget* w, int tag, bool enableEmit = false);
 
-    //根据标题查找action
+    //根据标题查找action，多个关键词用空格分隔，返回同时包含所有关键词的action，并按匹配程度排序
     QList< QAction* > search(const QString& text);
 
     //清除
     void clear();
 
+    //实时跟踪ribbonbar的变化，增量注册category和pannel中的action
+    void setLiveTrackingEnabled(bool on);
+    bool isLiveTrackingEnabled() const;
+
 signals:
 
     /**
@@ -110,21 +119,63 @@ signals:
      */
     void actionTagChanged(int tag, bool isdelete);
 
+    /**
+     * @brief 管理的action发生了变化（文本、图标、状态等），由QAction::changed转发
+     */
+    void actionChanged(QAction* act);
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* e) Q_DECL_OVERRIDE;
+
 private slots:
     void onActionDestroyed(QObject* o);
     void onCategoryTitleChanged(const QString& title);
+    void onActionChanged();
+    void onCategoryAdded(SARibbonCategory* c);
+    void onCategoryRemoved(SARibbonCategory* c);
+    void onCategoryDestroyed(QObject* o);
+    void onPannelAdded(SARibbonPannel* p);
+    void onPannelRemoved(SARibbonPannel* p);
 
 private:
     void removeAction(QAction* act, bool enableEmit = true);
+    // 实时跟踪时pannel中的action增减
+    void registePannelAction(QAction* act, int tag);
+    void unregistePannelAction(QAction* act, SARibbonCategory* c, SARibbonPannel* exclude);
+    // 移除category对应的tag
+    void removeCategoryTag(int tag);
 };
 
 /**
  * @brief SARibbonActionsManager 对应的model
+ *
+ * 切换标签、查找以及标签内容变化时，model会比较新旧两个action列表，
+ * 通过beginRemoveRows/beginInsertRows增量更新，action变化时只发射对应行的dataChanged，避免视图整体重建
+ *
+ * 默认情况下查找会过滤掉不匹配的行，如果希望配合QSortFilterProxyModel使用，
+ * 可以通过@ref setSearchFilterEnabled 关闭过滤，此时查找不会改变行，只会通过@ref ActionMatchedRole 标记行是否匹配
+ *
+ * @code
+ * model->setSearchFilterEnabled(false);
+ * QSortFilterProxyModel* proxy = new QSortFilterProxyModel(this);
+ * proxy->setSourceModel(model);
+ * proxy->setFilterRole(SARibbonActionsManagerModel::ActionMatchedRole);
+ * proxy->setFilterFixedString("true");
+ * @endcode
  */
 class SA_RIBBON_EXPORT SARibbonActionsManagerModel : public QAbstractListModel
 {
     Q_OBJECT
     SA_RIBBON_DECLARE_PRIVATE(SARibbonActionsManagerModel)
+public:
+    /**
+     * @brief 自定义的数据角色
+     */
+    enum ActionsManagerModelRole
+    {
+        ActionMatchedRole = Qt::UserRole + 1  ///< 行是否匹配当前的查找，值为bool
+    };
+
 public:
     explicit SARibbonActionsManagerModel(QObject* p = nullptr);
     explicit SARibbonActionsManagerModel(SARibbonActionsManager* m, QObject* p = nullptr);
@@ -139,9 +190,13 @@ public:
     void uninstallActionsManager();
     QAction* indexToAction(QModelIndex index) const;
     void search(const QString& text);
+    // 查找时是否过滤行，默认为true
+    void setSearchFilterEnabled(bool on);
+    bool isSearchFilterEnabled() const;
 
 private slots:
     void onActionTagChanged(int tag, bool isdelete);
+    void onActionChanged(QAction* act);
 };
 
 #endif  // SARIBBONACTIONSMANAGER_H
@@ -2,7 +2,11 @@
 #include <QPointer>
 #include <QAction>
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
+#include <QFile>
+#include <QHash>
 #include <QHoverEvent>
 #include <QLinearGradient>
 #include <QPainter>
@@ -11,12 +15,17 @@
 #include <QStyleOptionMenuItem>
 #include <QTimer>
 #include <QVariant>
+#include <algorithm>
 #include "SARibbonButtonGroupWidget.h"
 #include "SARibbonElementManager.h"
 #include "SARibbonQuickAccessBar.h"
 #include "SARibbonStackedWidget.h"
 #include "SARibbonTabBar.h"
 #include "SARibbonApplicationButton.h"
+#include "SARibbonGalleryGroup.h"
+#include "SARibbonPannelLayout.h"
+#include "SARibbonActionsManager.h"
+#include "SARibbonMainWindow.h"
 
 #define HELP_DRAW_RECT(p, rect)                                                                                        \
     do {                                                                                                               \
@@ -34,6 +43,7 @@ class _SAContextCategoryManagerData
 public:
     SARibbonContextCategory* contextCategory;
     QList< int > tabPageIndex;
+    QRect contextTitleRect;  ///< 上下文标签标题的绘制区域（SARibbonBar坐标），由updateContextCategoryTitleRect计算
     bool operator==(const SARibbonContextCategory* contextPage)
     {
         return (this->contextCategory == contextPage);
@@ -41,7 +51,7 @@ public:
 };
 
 /**
- * @todo 此处要修改，此方式容易异常
+ * @brief 记录隐藏的category和隐藏前所在的tab位置
  */
 class _SARibbonTabData
 {
@@ -52,7 +62,19 @@ public:
     {
     }
 };
-Q_DECLARE_METATYPE(_SARibbonTabData)
+
+/**
+ * @brief category在名字索引中记录的信息
+ *
+ * 记录建立索引时的名字，改名时才能找到旧的索引项
+ */
+class _SARibbonCategoryIndexInfo
+{
+public:
+    int position { -1 };  ///< 在stacked中的位置
+    QString name;         ///< 索引中的categoryName
+    QString objectName;   ///< 索引中的objectName
+};
 
 class SARibbonBar::PrivateData
 {
@@ -67,6 +89,7 @@ public:
     QList< _SAContextCategoryManagerData > mCurrentShowingContextCategory;
     QList< SARibbonContextCategory* > mContextCategoryList;  ///< 存放所有的上下文标签
     QList< _SARibbonTabData > mHidedCategory;
+    QPoint mContextCategoryRegion { -1, -1 };  ///< 上下文标签占据的水平范围，x为左边界，y为右边界，y<0说明没有上下文标签
     int mIconRightBorderPosition { 1 };  ///< 标题栏x值得最小值，在有图标和快捷启动按钮，此值都需要变化
     SARibbonBar::RibbonStyles mRibbonStyle { SARibbonBar::RibbonStyleLooseThreeRow };  ///< ribbon的风格
     SARibbonBar::RibbonMode mCurrentRibbonMode { SARibbonBar::NormalRibbonMode };      ///< 记录当前模式
@@ -89,6 +112,24 @@ public:
     std::unique_ptr< int > mUserDefTitleBarHeight;  ///< 用户定义的标题栏高度，正常不使用用户设定的高度，而是使用自动计算的高度
     std::unique_ptr< int > mUserDefTabBarHeight;  ///< 用户定义的tabbar高度，正常不使用用户设定的高度，而是使用自动计算的高度
     std::unique_ptr< int > mUserDefCategoryHeight;  ///< 用户定义的Category的高度，正常不使用用户设定的高度，而是使用自动计算的高度
+    qreal mDisplayDevicePixelRatio { 0 };  ///< 最近一次刷新尺寸时的dpr，用于判断显示环境是否变化
+    int mDisplayLogicalDpi { 0 };          ///< 最近一次刷新尺寸时的逻辑dpi
+    QList< QPointer< SARibbonCategory > > mPendingWarmUpCategories;  ///< 显示环境变化后，等待空闲时刷新的category
+    QTimer* mWarmUpTimer { nullptr };                                ///< 空闲时逐个刷新category的定时器
+    int mActionStateUpdateDepth { 0 };                               ///< beginActionStateUpdate的嵌套层数
+    /// 批量更新action状态期间需要重新布局的pannel，以指针为键去重，值用于判断pannel是否已经销毁（地址可能被复用）
+    QHash< SARibbonPannel*, QPointer< SARibbonPannel > > mActionChangedPannels;
+    QByteArray mLayoutSnapshotFingerprint;                           ///< 已恢复的布局快照的指纹，为空说明没有使用布局快照
+    QHash< QString, SARibbonCategory* > mCategoryNameIndex;        ///< categoryName到category的索引，重名时记录第一个
+    QHash< QString, SARibbonCategory* > mCategoryObjectNameIndex;  ///< objectName到category的索引，重名时记录第一个
+    QHash< const SARibbonCategory*, _SARibbonCategoryIndexInfo > mCategoryIndexInfo;  ///< category到stacked位置和名字
+    /// 和stacked顺序一致的category，widgetRemoved只给出位置，窗口已经不在stacked中，通过它按位置找到被移除的category
+    QList< const SARibbonCategory* > mStackedCategories;
+    QHash< const SARibbonCategory*, int > mCategoryTabIndex;       ///< category到tab索引的索引
+    QList< SARibbonCategory* > mTabCategories;                     ///< 每个tab对应的category，和tabbar的顺序一致
+    bool mIsCategoryTabIndexDirty { false };                       ///< tab索引需要重建
+    QSet< SARibbonContextCategory* > mPendingVisibleContextCategories;  ///< 等待应用的需要显示的上下文标签
+    QTimer* mContextCategoryVisibleTimer { nullptr };  ///< 合并同一轮事件循环内的setVisibleContextCategories
 public:
     PrivateData(SARibbonBar* par) : q_ptr(par)
     {
@@ -128,7 +169,55 @@ public:
 
     QColor getContextCategoryColor();
 
-    void updateTabData();
+    // 插入category对应的tab
+    int insertCategoryTab(int index, SARibbonCategory* category);
+    // 移除tab
+    void removeCategoryTab(int index);
+    // tab移动后更新对应关系
+    void moveCategoryTab(int from, int to);
+    // 插入上下文标签的tab，不刷新区域和尺寸，返回是否有改变
+    bool showContextCategoryTabs(SARibbonContextCategory* context);
+    // 移除上下文标签的tab，不刷新区域和尺寸，返回是否有改变
+    bool hideContextCategoryTabs(SARibbonContextCategory* context);
+    // 应用mPendingVisibleContextCategories
+    void applyPendingVisibleContextCategories();
+
+    // category加入stacked后更新名字索引，pos为在stacked中的位置
+    void insertCategoryNameIndex(SARibbonCategory* c, int pos);
+    // stacked中pos位置的窗口移除后更新名字索引
+    void takeCategoryNameIndex(int pos);
+    // stacked中的窗口移动后更新名字索引
+    void moveCategoryNameIndex(int from, int to);
+    // category改名或改objectName后更新名字索引
+    void updateCategoryNameIndexKeys(SARibbonCategory* c);
+    // 按stacked重新记录[begin,end)范围内category的位置
+    void updateCategoryPosition(int begin, int end);
+    // 从from开始查找第一个索引名字为key的category
+    SARibbonCategory* findCategoryByKey(const QString& key, bool isObjectName, int from) const;
+    // 在pos位置出现了一个名字为key的category，如果它是第一个则更新索引
+    void addCategoryKey(QHash< QString, SARibbonCategory* >& index, const QString& key, SARibbonCategory* c, int pos);
+    // category不再使用key，如果它是key对应的第一个category，从from开始找下一个
+    void removeCategoryKey(QHash< QString, SARibbonCategory* >& index,
+                           const QString& key,
+                           bool isObjectName,
+                           const SARibbonCategory* c,
+                           int from);
+    // tab索引失效时重建
+    void ensureCategoryTabIndex();
+
+    // 重新计算上下文标签标题的区域
+    void updateContextCategoryTitleRect();
+
+    // 记录当前的显示环境（dpr、逻辑dpi），返回显示环境是否发生了变化
+    bool recordDisplayContext();
+    // 刷新category和显示环境相关的缓存
+    void warmUpCategory(SARibbonCategory* c);
+    // category如果还在等待刷新，立即刷新
+    void warmUpPendingCategory(SARibbonCategory* c);
+    // 刷新下一个等待的category，由mWarmUpTimer在空闲时触发
+    void warmUpNextPendingCategory();
+    // 显示环境和恢复布局快照时不一致，清除布局快照
+    void checkLayoutSnapshot();
 
     /**
      * @brief 通过输入高度计算iconSize
@@ -140,6 +229,15 @@ public:
 
 void SARibbonBar::PrivateData::init()
 {
+    mWarmUpTimer = new QTimer(q_ptr);
+    mWarmUpTimer->setInterval(0);
+    q_ptr->connect(mWarmUpTimer, &QTimer::timeout, q_ptr, [ this ]() { warmUpNextPendingCategory(); });
+    mContextCategoryVisibleTimer = new QTimer(q_ptr);
+    mContextCategoryVisibleTimer->setSingleShot(true);
+    mContextCategoryVisibleTimer->setInterval(0);
+    q_ptr->connect(mContextCategoryVisibleTimer, &QTimer::timeout, q_ptr, [ this ]() {
+        applyPendingVisibleContextCategories();
+    });
     mApplicationButton = RibbonSubElementFactory->createRibbonApplicationButton(q_ptr);
     q_ptr->connect(mApplicationButton, &QAbstractButton::clicked, q_ptr, &SARibbonBar::applicationButtonClicked);
     mRibbonTabBar = RibbonSubElementFactory->createRibbonTabBar(q_ptr);
@@ -156,6 +254,10 @@ void SARibbonBar::PrivateData::init()
                                      &SARibbonStackedWidget::hidWindow,
                                      q_ptr,
                                      &SARibbonBar::onStackWidgetHided);
+    // category移除或被delete时stacked会发出widgetRemoved，此时更新名字索引
+    q_ptr->connect(mStackedContainerWidget, &QStackedWidget::widgetRemoved, q_ptr, [ this ](int index) {
+        takeCategoryNameIndex(index);
+    });
     // 捕获事件，在popmode时必须用到
     mStackedContainerWidget->installEventFilter(q_ptr);
     //
@@ -391,35 +493,437 @@ QColor SARibbonBar::PrivateData::getContextCategoryColor()
     return (mContextCategoryColorList.at(mContextCategoryColorListIndex));
 }
 
-void SARibbonBar::PrivateData::updateTabData()
+/**
+ * @brief 插入category对应的tab，同时更新tab和category的对应关系以及上下文标签的tab位置
+ * @param index 插入位置，超出范围时追加到最后，和QTabBar::insertTab一致
+ * @param category
+ * @return tab实际的位置
+ */
+int SARibbonBar::PrivateData::insertCategoryTab(int index, SARibbonCategory* category)
 {
-    int tabcount = mRibbonTabBar->count();
+    if (index < 0 || index > mTabCategories.size()) {
+        index = mTabCategories.size();
+    }
+    // 先更新对应关系再插入tab，insertTab触发currentChanged时就能取到category
+    mTabCategories.insert(index, category);
+    for (_SAContextCategoryManagerData& cd : mCurrentShowingContextCategory) {
+        for (int& t : cd.tabPageIndex) {
+            if (t >= index) {
+                ++t;
+            }
+        }
+    }
+    mIsCategoryTabIndexDirty = true;
+    return mRibbonTabBar->insertTab(index, category->categoryName());
+}
 
-    for (int i = 0; i < tabcount; ++i) {
-        QVariant var = mRibbonTabBar->tabData(i);
-        if (var.isValid()) {
-            _SARibbonTabData p = var.value< _SARibbonTabData >();
-            p.index            = i;
-            mRibbonTabBar->setTabData(i, QVariant::fromValue(p));
+/**
+ * @brief 移除tab，同时更新tab和category的对应关系以及上下文标签的tab位置
+ * @param index
+ */
+void SARibbonBar::PrivateData::removeCategoryTab(int index)
+{
+    if (index < 0 || index >= mTabCategories.size()) {
+        return;
+    }
+    mTabCategories.removeAt(index);
+    for (_SAContextCategoryManagerData& cd : mCurrentShowingContextCategory) {
+        cd.tabPageIndex.removeAll(index);
+        for (int& t : cd.tabPageIndex) {
+            if (t > index) {
+                --t;
+            }
         }
     }
-    // 刷新完tabdata信息也要接着刷新ContextCategory信息
+    mIsCategoryTabIndexDirty = true;
+    mRibbonTabBar->removeTab(index);
+}
+
+/**
+ * @brief tab移动后，更新tab和category的对应关系以及上下文标签的tab位置
+ * @param from
+ * @param to
+ */
+void SARibbonBar::PrivateData::moveCategoryTab(int from, int to)
+{
+    if (from < 0 || from >= mTabCategories.size() || to < 0 || to >= mTabCategories.size()) {
+        return;
+    }
+    mTabCategories.move(from, to);
     for (_SAContextCategoryManagerData& cd : mCurrentShowingContextCategory) {
-        cd.tabPageIndex.clear();
-        for (int i = 0; i < cd.contextCategory->categoryCount(); ++i) {
-            SARibbonCategory* category = cd.contextCategory->categoryPage(i);
-            for (int t = 0; t < tabcount; ++t) {
-                QVariant v = mRibbonTabBar->tabData(t);
-                if (v.isValid()) {
-                    _SARibbonTabData d = v.value< _SARibbonTabData >();
-                    if (d.category == category) {
-                        cd.tabPageIndex.append(t);
-                    }
-                } else {
-                    cd.tabPageIndex.append(-1);
-                }
+        for (int& t : cd.tabPageIndex) {
+            if (t == from) {
+                t = to;
+            } else if (from < to && t > from && t <= to) {
+                --t;
+            } else if (to < from && t >= to && t < from) {
+                ++t;
             }
         }
+        // 上下文标签的区域取第一个和最后一个tab，需保持升序
+        std::sort(cd.tabPageIndex.begin(), cd.tabPageIndex.end());
+    }
+    mIsCategoryTabIndexDirty = true;
+}
+
+/**
+ * @brief 把上下文标签的category追加到tabbar
+ *
+ * 不会刷新上下文标签的区域，也不会触发重新布局，由调用者统一处理
+ * @param context
+ * @return 如果已经显示，返回false
+ */
+bool SARibbonBar::PrivateData::showContextCategoryTabs(SARibbonContextCategory* context)
+{
+    if (isContainContextCategoryInList(context)) {
+        return false;
+    }
+    _SAContextCategoryManagerData contextCategoryData;
+
+    contextCategoryData.contextCategory = context;
+    for (int i = 0; i < context->categoryCount(); ++i) {
+        SARibbonCategory* category = context->categoryPage(i);
+        // 此句如果模式重复设置不会进行多余操作
+        category->setPannelLayoutMode(mDefaulePannelLayoutMode);
+        // 切换模式后会改变高度，上下文标签显示时要保证显示出来
+        int index = insertCategoryTab(-1, category);
+        contextCategoryData.tabPageIndex.append(index);
+    }
+    // 上下文都是在最后追加，不会影响其它上下文标签的tab位置
+    mCurrentShowingContextCategory.append(contextCategoryData);
+    return true;
+}
+
+/**
+ * @brief 从tabbar移除上下文标签的category
+ *
+ * 不会刷新上下文标签的区域，也不会触发重新布局，由调用者统一处理
+ * @param context
+ * @return 如果没有显示，返回false
+ */
+bool SARibbonBar::PrivateData::hideContextCategoryTabs(SARibbonContextCategory* context)
+{
+    for (int i = 0; i < mCurrentShowingContextCategory.size(); ++i) {
+        if (mCurrentShowingContextCategory[ i ].contextCategory == context) {
+            // 先从显示列表中取出，removeCategoryTab会调整其余上下文标签的tab序号
+            const QList< int > indexs = mCurrentShowingContextCategory.takeAt(i).tabPageIndex;
+            for (int j = indexs.size() - 1; j >= 0; --j) {
+                removeCategoryTab(indexs[ j ]);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 把上下文标签的显示状态调整为mPendingVisibleContextCategories
+ *
+ * 只对显示状态发生变化的上下文标签增删tab，全部调整完后只刷新一次区域和布局
+ */
+void SARibbonBar::PrivateData::applyPendingVisibleContextCategories()
+{
+    mContextCategoryVisibleTimer->stop();
+    // 以mContextCategoryList为准，已经销毁的上下文标签不会被访问
+    const QList< SARibbonContextCategory* > contexts = mContextCategoryList;
+    bool changed                                     = false;
+    const bool updatesEnabled                        = mRibbonTabBar->updatesEnabled();
+    mRibbonTabBar->setUpdatesEnabled(false);
+    // 先隐藏再显示，隐藏时需要调整序号的上下文标签更少
+    for (SARibbonContextCategory* c : contexts) {
+        if (!mPendingVisibleContextCategories.contains(c) && hideContextCategoryTabs(c)) {
+            changed = true;
+        }
+    }
+    for (SARibbonContextCategory* c : contexts) {
+        if (mPendingVisibleContextCategories.contains(c) && showContextCategoryTabs(c)) {
+            changed = true;
+        }
+    }
+    mPendingVisibleContextCategories.clear();
+    mRibbonTabBar->setUpdatesEnabled(updatesEnabled);
+    if (changed) {
+        updateContextCategoryTitleRect();
+        QApplication::postEvent(q_ptr, new QResizeEvent(q_ptr->size(), q_ptr->size()));
+    }
+}
+
+/**
+ * @brief category加入stacked后更新名字索引
+ *
+ * 只更新插入位置之后的category的位置，以及新category的名字对应的索引项
+ * @param c
+ * @param pos category在stacked中的位置
+ */
+void SARibbonBar::PrivateData::insertCategoryNameIndex(SARibbonCategory* c, int pos)
+{
+    mStackedCategories.insert(pos, c);
+    updateCategoryPosition(pos + 1, mStackedContainerWidget->count());
+    _SARibbonCategoryIndexInfo& info = mCategoryIndexInfo[ c ];
+    info.position                    = pos;
+    info.name                        = c->categoryName();
+    info.objectName                  = c->objectName();
+    addCategoryKey(mCategoryNameIndex, info.name, c, pos);
+    addCategoryKey(mCategoryObjectNameIndex, info.objectName, c, pos);
+}
+
+/**
+ * @brief stacked中pos位置的窗口移除后更新名字索引
+ *
+ * 窗口可能正在被delete，这里只用它的指针作为key，不会访问它，
+ * 如果它是重名的第一个，向后查找下一个同名的category
+ * @param pos 移除前的位置
+ */
+void SARibbonBar::PrivateData::takeCategoryNameIndex(int pos)
+{
+    if ((pos < 0) || (pos >= mStackedCategories.size())) {
+        return;
+    }
+    const SARibbonCategory* c             = mStackedCategories.takeAt(pos);
+    const _SARibbonCategoryIndexInfo info = mCategoryIndexInfo.take(c);
+    updateCategoryPosition(pos, mStackedContainerWidget->count());
+    removeCategoryKey(mCategoryNameIndex, info.name, false, c, pos);
+    removeCategoryKey(mCategoryObjectNameIndex, info.objectName, true, c, pos);
+}
+
+/**
+ * @brief stacked中的窗口移动后更新名字索引
+ *
+ * 其它category之间的先后顺序不变，因此只有被移动的category的名字对应的索引项可能改变
+ * @param from
+ * @param to
+ */
+void SARibbonBar::PrivateData::moveCategoryNameIndex(int from, int to)
+{
+    if ((from >= 0) && (from < mStackedCategories.size()) && (to >= 0) && (to < mStackedCategories.size())) {
+        mStackedCategories.move(from, to);
+    }
+    updateCategoryPosition(qMin(from, to), qMax(from, to) + 1);
+    SARibbonCategory* c = qobject_cast< SARibbonCategory* >(mStackedContainerWidget->widget(to));
+    if (!c || !mCategoryIndexInfo.contains(c)) {
+        return;
+    }
+    const _SARibbonCategoryIndexInfo info = mCategoryIndexInfo.value(c);
+    removeCategoryKey(mCategoryNameIndex, info.name, false, c, 0);
+    removeCategoryKey(mCategoryObjectNameIndex, info.objectName, true, c, 0);
+    addCategoryKey(mCategoryNameIndex, info.name, c, to);
+    addCategoryKey(mCategoryObjectNameIndex, info.objectName, c, to);
+}
+
+/**
+ * @brief category改名或改objectName后更新名字索引，只修改旧名字和新名字对应的索引项
+ * @param c
+ */
+void SARibbonBar::PrivateData::updateCategoryNameIndexKeys(SARibbonCategory* c)
+{
+    auto it = mCategoryIndexInfo.find(c);
+    if (it == mCategoryIndexInfo.end()) {
+        return;
+    }
+    const int pos      = it.value().position;
+    const QString name = c->categoryName();
+    if (name != it.value().name) {
+        const QString oldName = it.value().name;
+        it.value().name       = name;
+        // category是旧名字的第一个时，前面不会有同名的category
+        removeCategoryKey(mCategoryNameIndex, oldName, false, c, pos + 1);
+        addCategoryKey(mCategoryNameIndex, name, c, pos);
+    }
+    const QString objname = c->objectName();
+    if (objname != it.value().objectName) {
+        const QString oldObjname = it.value().objectName;
+        it.value().objectName    = objname;
+        removeCategoryKey(mCategoryObjectNameIndex, oldObjname, true, c, pos + 1);
+        addCategoryKey(mCategoryObjectNameIndex, objname, c, pos);
+    }
+}
+
+void SARibbonBar::PrivateData::updateCategoryPosition(int begin, int end)
+{
+    for (int i = qMax(0, begin); i < end; ++i) {
+        if (SARibbonCategory* c = qobject_cast< SARibbonCategory* >(mStackedContainerWidget->widget(i))) {
+            auto it = mCategoryIndexInfo.find(c);
+            if (it != mCategoryIndexInfo.end()) {
+                it.value().position = i;
+            }
+        }
+    }
+}
+
+SARibbonCategory* SARibbonBar::PrivateData::findCategoryByKey(const QString& key, bool isObjectName, int from) const
+{
+    const int c = mStackedContainerWidget->count();
+    for (int i = qMax(0, from); i < c; ++i) {
+        SARibbonCategory* w = qobject_cast< SARibbonCategory* >(mStackedContainerWidget->widget(i));
+        if (!w) {
+            continue;
+        }
+        auto it = mCategoryIndexInfo.constFind(w);
+        if (it == mCategoryIndexInfo.constEnd()) {
+            continue;
+        }
+        if ((isObjectName ? it.value().objectName : it.value().name) == key) {
+            return (w);
+        }
+    }
+    return (nullptr);
+}
+
+void SARibbonBar::PrivateData::addCategoryKey(QHash< QString, SARibbonCategory* >& index,
+                                              const QString& key,
+                                              SARibbonCategory* c,
+                                              int pos)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        index.insert(key, c);
+    } else if (mCategoryIndexInfo.value(it.value()).position > pos) {
+        // 重名时记录位置靠前的
+        it.value() = c;
+    }
+}
+
+void SARibbonBar::PrivateData::removeCategoryKey(QHash< QString, SARibbonCategory* >& index,
+                                                 const QString& key,
+                                                 bool isObjectName,
+                                                 const SARibbonCategory* c,
+                                                 int from)
+{
+    auto it = index.find(key);
+    if ((it == index.end()) || (it.value() != c)) {
+        return;
+    }
+    if (SARibbonCategory* next = findCategoryByKey(key, isObjectName, from)) {
+        it.value() = next;
+    } else {
+        index.erase(it);
+    }
+}
+
+/**
+ * @brief tab索引失效时重建
+ *
+ * 由mTabCategories重建，之后categoryIndex等查找都不再遍历tab
+ */
+void SARibbonBar::PrivateData::ensureCategoryTabIndex()
+{
+    if (!mIsCategoryTabIndexDirty) {
+        return;
+    }
+    mIsCategoryTabIndexDirty = false;
+    mCategoryTabIndex.clear();
+    const int tabcount = mTabCategories.size();
+    for (int i = 0; i < tabcount; ++i) {
+        const SARibbonCategory* c = mTabCategories[ i ];
+        if (!mCategoryTabIndex.contains(c)) {
+            mCategoryTabIndex.insert(c, i);
+        }
+    }
+}
+
+/**
+ * @brief 重新计算上下文标签标题的区域
+ *
+ * 上下文标签的区域只在tab移动、尺寸改变、上下文标签显示隐藏时才会变化，因此在这些时机计算好保存起来，
+ * 绘图和点击判断直接使用保存的结果，避免每次绘图都调用tabRect
+ */
+void SARibbonBar::PrivateData::updateContextCategoryTitleRect()
+{
+    mContextCategoryRegion = QPoint(q_ptr->width(), -1);
+    if (mCurrentShowingContextCategory.isEmpty()) {
+        return;
+    }
+    const QMargins border  = q_ptr->contentsMargins();
+    const QMargins& margin = mRibbonTabBar->tabMargin();
+    const QPoint tabOffset = mRibbonTabBar->pos();
+    const int tabHeight    = mRibbonTabBar->height() - 1;  // 减1像素，避免tabbar基线覆盖
+    const int tabCount     = mRibbonTabBar->count();
+    for (_SAContextCategoryManagerData& cd : mCurrentShowingContextCategory) {
+        const QList< int >& indexs = cd.tabPageIndex;
+        if (indexs.isEmpty() || indexs.first() < 0 || indexs.last() < 0 || indexs.last() >= tabCount) {
+            cd.contextTitleRect = QRect();
+            continue;
+        }
+        QRect contextTitleRect = mRibbonTabBar->tabRect(indexs.first());
+        QRect endRect          = mRibbonTabBar->tabRect(indexs.last());
+        contextTitleRect.setRight(endRect.right());
+        contextTitleRect.translate(tabOffset);
+        contextTitleRect.setHeight(tabHeight);
+        contextTitleRect -= margin;
+        // 把区域顶部扩展到窗口顶部
+        contextTitleRect.setTop(border.top());
+        cd.contextTitleRect = contextTitleRect;
+        // 更新上下文标签的范围，用于控制标题栏的显示
+        if (contextTitleRect.left() < mContextCategoryRegion.x()) {
+            mContextCategoryRegion.setX(contextTitleRect.left());
+        }
+        if (contextTitleRect.right() > mContextCategoryRegion.y()) {
+            mContextCategoryRegion.setY(contextTitleRect.right());
+        }
+    }
+}
+
+/**
+ * @brief 记录当前的显示环境
+ * @return 如果dpr或逻辑dpi和上次记录的不一致，返回true
+ */
+bool SARibbonBar::PrivateData::recordDisplayContext()
+{
+    const qreal dpr = q_ptr->devicePixelRatioF();
+    const int dpi   = q_ptr->logicalDpiY();
+    if (qFuzzyCompare(dpr, mDisplayDevicePixelRatio) && (dpi == mDisplayLogicalDpi)) {
+        return false;
+    }
+    mDisplayDevicePixelRatio = dpr;
+    mDisplayLogicalDpi       = dpi;
+    return true;
+}
+
+/**
+ * @brief 刷新category和显示环境相关的缓存
+ *
+ * 包括按钮的sizehint和文字区域、pannel和category的布局，以及画廊的图标缓存
+ * @param c
+ */
+void SARibbonBar::PrivateData::warmUpCategory(SARibbonCategory* c)
+{
+    if (nullptr == c) {
+        return;
+    }
+    c->updateItemGeometry();
+    // 画廊缓存的图标是按dpr绘制的，显示环境变化后旧的缓存不会再命中，这里直接释放
+    const QList< SARibbonGalleryGroup* > groups = c->findChildren< SARibbonGalleryGroup* >();
+    for (SARibbonGalleryGroup* g : groups) {
+        g->clearItemPixmapCache();
+    }
+}
+
+void SARibbonBar::PrivateData::warmUpPendingCategory(SARibbonCategory* c)
+{
+    if (c && mPendingWarmUpCategories.removeAll(QPointer< SARibbonCategory >(c)) > 0) {
+        warmUpCategory(c);
+    }
+}
+
+void SARibbonBar::PrivateData::warmUpNextPendingCategory()
+{
+    // 每次只刷新一个category，避免长时间阻塞事件循环
+    while (!mPendingWarmUpCategories.isEmpty()) {
+        QPointer< SARibbonCategory > c = mPendingWarmUpCategories.takeFirst();
+        if (c) {
+            warmUpCategory(c.data());
+            break;
+        }
+    }
+    if (mPendingWarmUpCategories.isEmpty()) {
+        mWarmUpTimer->stop();
+    }
+}
+
+void SARibbonBar::PrivateData::checkLayoutSnapshot()
+{
+    if (!mLayoutSnapshotFingerprint.isEmpty() && mLayoutSnapshotFingerprint != q_ptr->layoutFingerprint()) {
+        q_ptr->clearLayoutSnapshot();
     }
 }
 
@@ -658,18 +1162,18 @@ void SARibbonBar::insertCategoryPage(SARibbonCategory* category, int index)
         return;
     }
     category->setPannelLayoutMode(d_ptr->mDefaulePannelLayoutMode);
-    int i = d_ptr->mRibbonTabBar->insertTab(index, category->categoryName());
-
-    _SARibbonTabData tabdata;
-
-    tabdata.category = category;
-    tabdata.index    = i;
-    d_ptr->mRibbonTabBar->setTabData(i, QVariant::fromValue(tabdata));
-    d_ptr->mStackedContainerWidget->insertWidget(index, category);
+    // 先加入stacked，插入tab触发currentChanged时category已经可以切换
+    const int stackedIndex = d_ptr->mStackedContainerWidget->insertWidget(index, category);
+    d_ptr->insertCategoryNameIndex(category, stackedIndex);
+    d_ptr->insertCategoryTab(index, category);
     connect(category, &QWidget::windowTitleChanged, this, &SARibbonBar::onCategoryWindowTitleChanged);
-    // 更新index信息
-    d_ptr->updateTabData();
+    connect(category, &QObject::objectNameChanged, this, [ this, category ]() {
+        d_ptr->updateCategoryNameIndexKeys(category);
+    });
+    // 插入的tab会改变上下文标签的位置
+    d_ptr->updateContextCategoryTitleRect();
     QApplication::postEvent(this, new QResizeEvent(size(), size()));
+    emit categoryAdded(category);
 }
 
 /**
@@ -681,17 +1185,7 @@ void SARibbonBar::insertCategoryPage(SARibbonCategory* category, int index)
  */
 SARibbonCategory* SARibbonBar::categoryByName(const QString& title) const
 {
-    int c = d_ptr->mStackedContainerWidget->count();
-
-    for (int i = 0; i < c; ++i) {
-        SARibbonCategory* w = qobject_cast< SARibbonCategory* >(d_ptr->mStackedContainerWidget->widget(i));
-        if (w) {
-            if (w->categoryName() == title) {
-                return (w);
-            }
-        }
-    }
-    return (nullptr);
+    return (d_ptr->mCategoryNameIndex.value(title, nullptr));
 }
 
 /**
@@ -702,17 +1196,7 @@ SARibbonCategory* SARibbonBar::categoryByName(const QString& title) const
  */
 SARibbonCategory* SARibbonBar::categoryByObjectName(const QString& objname) const
 {
-    int c = d_ptr->mStackedContainerWidget->count();
-
-    for (int i = 0; i < c; ++i) {
-        SARibbonCategory* w = qobject_cast< SARibbonCategory* >(d_ptr->mStackedContainerWidget->widget(i));
-        if (w) {
-            if (w->objectName() == objname) {
-                return (w);
-            }
-        }
-    }
-    return (nullptr);
+    return (d_ptr->mCategoryObjectNameIndex.value(objname, nullptr));
 }
 
 /**
@@ -727,13 +1211,7 @@ SARibbonCategory* SARibbonBar::categoryByObjectName(const QString& objname) cons
  */
 SARibbonCategory* SARibbonBar::categoryByIndex(int index) const
 {
-    QVariant var = d_ptr->mRibbonTabBar->tabData(index);
-
-    if (var.isValid()) {
-        _SARibbonTabData p = var.value< _SARibbonTabData >();
-        return (p.category);
-    }
-    return (nullptr);
+    return (d_ptr->mTabCategories.value(index, nullptr));
 }
 
 /**
@@ -742,21 +1220,17 @@ SARibbonCategory* SARibbonBar::categoryByIndex(int index) const
  */
 void SARibbonBar::hideCategory(SARibbonCategory* category)
 {
-    int tabcount = d_ptr->mRibbonTabBar->count();
-
-    for (int i = 0; i < tabcount; ++i) {
-        QVariant var = d_ptr->mRibbonTabBar->tabData(i);
-        if (var.isValid()) {
-            _SARibbonTabData p = var.value< _SARibbonTabData >();
-            if (p.category == category) {
-                d_ptr->mHidedCategory.append(p);
-                d_ptr->mRibbonTabBar->removeTab(i);  // 仅仅把tab移除
-                // 注意Category隐藏后，contex的位置就会发生变化，需要更新
-                d_ptr->updateTabData();
-                return;
-            }
-        }
+    const int i = categoryIndex(category);
+    if (i < 0) {
+        return;
     }
+    _SARibbonTabData p;
+    p.category = category;
+    p.index    = i;
+    d_ptr->mHidedCategory.append(p);
+    d_ptr->removeCategoryTab(i);  // 仅仅把tab移除
+    // 注意Category隐藏后，contex的位置就会发生变化，需要更新
+    d_ptr->updateContextCategoryTitleRect();
 }
 
 /**
@@ -768,12 +1242,9 @@ void SARibbonBar::showCategory(SARibbonCategory* category)
     for (auto i = d_ptr->mHidedCategory.begin(); i != d_ptr->mHidedCategory.end(); ++i) {
         if (i->category == category) {
             // 说明要显示
-            int index = d_ptr->mRibbonTabBar->insertTab(i->index, i->category->categoryName());
-            i->index  = index;
-            d_ptr->mRibbonTabBar->setTabData(index, QVariant::fromValue(*i));
+            d_ptr->insertCategoryTab(i->index, i->category);
             d_ptr->mHidedCategory.erase(i);  // 移除
-            // 更新index信息
-            d_ptr->updateTabData();
+            d_ptr->updateContextCategoryTitleRect();
             raiseCategory(category);
             return;
         }
@@ -801,18 +1272,8 @@ bool SARibbonBar::isCategoryVisible(const SARibbonCategory* c) const
 int SARibbonBar::categoryIndex(const SARibbonCategory* c) const
 {
     // category的顺序不能以stackedwidget为准，因为存在contextcategory，contextcategory正常是不显示的
-    int tabcount = d_ptr->mRibbonTabBar->count();
-
-    for (int i = 0; i < tabcount; ++i) {
-        QVariant var = d_ptr->mRibbonTabBar->tabData(i);
-        if (var.isValid()) {
-            _SARibbonTabData p = var.value< _SARibbonTabData >();
-            if (p.category == c) {
-                return (i);
-            }
-        }
-    }
-    return (-1);
+    d_ptr->ensureCategoryTabIndex();
+    return (d_ptr->mCategoryTabIndex.value(c, -1));
 }
 
 /**
@@ -823,9 +1284,7 @@ int SARibbonBar::categoryIndex(const SARibbonCategory* c) const
 void SARibbonBar::moveCategory(int from, int to)
 {
     d_ptr->mRibbonTabBar->moveTab(from, to);
-    // 这时要刷新所有tabdata的index信息
-    d_ptr->updateTabData();
-    // 这里会触发tabMoved信号，在tabMoved信号中调整stacked里窗口的位置
+    // 这里会触发tabMoved信号，在tabMoved信号中调整tab对应关系和stacked里窗口的位置
 }
 
 /**
@@ -863,22 +1322,24 @@ void SARibbonBar::removeCategory(SARibbonCategory* category)
     int index     = tabIndex(category);
     bool isupdate = false;
     if (index >= 0) {
-        d_ptr->mRibbonTabBar->removeTab(index);
+        d_ptr->removeCategoryTab(index);
         isupdate = true;
     }
     d_ptr->mStackedContainerWidget->removeWidget(category);
+    disconnect(category, &QObject::objectNameChanged, this, nullptr);
     // 同时验证这个category是否是contexcategory里的
 
     for (SARibbonContextCategory* c : qAsConst(d_ptr->mContextCategoryList)) {
         c->takeCategory(category);
     }
-    // 这时要刷新所有tabdata的index信息
+    // tab移除后上下文标签的位置会变化
     if (isupdate) {
-        d_ptr->updateTabData();
+        d_ptr->updateContextCategoryTitleRect();
     }
     // 移除完后需要重绘
     repaint();
     QApplication::postEvent(this, new QResizeEvent(size(), size()));
+    emit categoryRemoved(category);
 }
 
 /**
@@ -927,27 +1388,14 @@ void SARibbonBar::addContextCategory(SARibbonContextCategory* context)
  */
 void SARibbonBar::showContextCategory(SARibbonContextCategory* context)
 {
-    if (isContextCategoryVisible(context)) {
-        return;
+    if (d_ptr->mContextCategoryVisibleTimer->isActive()) {
+        // 同步修改还未应用的setVisibleContextCategories，避免稍后被还原
+        d_ptr->mPendingVisibleContextCategories.insert(context);
     }
-    _SAContextCategoryManagerData contextCategoryData;
-
-    contextCategoryData.contextCategory = context;
-    for (int i = 0; i < context->categoryCount(); ++i) {
-        SARibbonCategory* category = context->categoryPage(i);
-        // 此句如果模式重复设置不会进行多余操作
-        category->setPannelLayoutMode(d_ptr->mDefaulePannelLayoutMode);
-        // 切换模式后会改变高度，上下文标签显示时要保证显示出来
-        int index = d_ptr->mRibbonTabBar->addTab(category->categoryName());
-        contextCategoryData.tabPageIndex.append(index);
-
-        _SARibbonTabData tabdata;
-        tabdata.category = category;
-        tabdata.index    = index;
-        d_ptr->mRibbonTabBar->setTabData(index, QVariant::fromValue(tabdata));
+    if (!d_ptr->showContextCategoryTabs(context)) {
+        return;
     }
-    d_ptr->mCurrentShowingContextCategory.append(contextCategoryData);
-    // 由于上下文都是在最后追加，不需要调用updateTabData();
+    d_ptr->updateContextCategoryTitleRect();
     QApplication::postEvent(this, new QResizeEvent(size(), size()));
 }
 
@@ -957,23 +1405,10 @@ void SARibbonBar::showContextCategory(SARibbonContextCategory* context)
  */
 void SARibbonBar::hideContextCategory(SARibbonContextCategory* context)
 {
-    bool needResize = false;
-
-    for (int i = 0; i < d_ptr->mCurrentShowingContextCategory.size(); ++i) {
-        if (d_ptr->mCurrentShowingContextCategory[ i ].contextCategory == context) {
-            const QList< int >& indexs = d_ptr->mCurrentShowingContextCategory[ i ].tabPageIndex;
-            for (int j = indexs.size() - 1; j >= 0; --j) {
-                d_ptr->mRibbonTabBar->removeTab(indexs[ j ]);
-            }
-            // 注意，再删除ContextCategory后，tab的序号就会改变，这时，这个tab后面的都要调整它的序号
-            needResize = true;
-            d_ptr->mCurrentShowingContextCategory.removeAt(i);
-            // 移除了ContextCategory后需要break
-            break;
-        }
-    }
-    if (needResize) {
-        d_ptr->updateTabData();
+    // 同步修改还未应用的setVisibleContextCategories，避免稍后被还原
+    d_ptr->mPendingVisibleContextCategories.remove(context);
+    if (d_ptr->hideContextCategoryTabs(context)) {
+        d_ptr->updateContextCategoryTitleRect();
         QApplication::postEvent(this, new QResizeEvent(size(), size()));
     }
 }
@@ -1008,6 +1443,41 @@ void SARibbonBar::setContextCategoryVisible(SARibbonContextCategory* context, bo
     }
 }
 
+/**
+ * @brief 设置需要显示的上下文标签，不在集合中的上下文标签都会隐藏
+ *
+ * 和逐个调用@ref showContextCategory / @ref hideContextCategory 相比，此函数只对显示状态
+ * 发生变化的上下文标签增删tab，并且所有变化只触发一次重新布局
+ *
+ * 默认情况下不会立即应用，而是在回到事件循环后才应用，同一轮事件循环内多次调用只有最后一次生效，
+ * 因此选择集频繁变化时，短时间内显示又隐藏（或隐藏又显示）的上下文标签不会产生任何tab变化
+ * @code
+ * void MainWindow::onSelectionChanged()
+ * {
+ *     QSet< SARibbonContextCategory* > ctxs;
+ *     if (selectionHasTable()) {
+ *         ctxs.insert(mTableContext);
+ *     }
+ *     if (selectionHasImage()) {
+ *         ctxs.insert(mImageContext);
+ *     }
+ *     ribbonBar()->setVisibleContextCategories(ctxs);
+ * }
+ * @endcode
+ * @param contexts 需要显示的上下文标签，必须是已经添加到ribbonbar的上下文标签
+ * @param immediately 为true时立即应用，此时@ref isContextCategoryVisible 可以马上得到新的状态
+ * @note 应用前调用@ref showContextCategory / @ref hideContextCategory 会同步修改等待应用的集合
+ */
+void SARibbonBar::setVisibleContextCategories(const QSet< SARibbonContextCategory* >& contexts, bool immediately)
+{
+    d_ptr->mPendingVisibleContextCategories = contexts;
+    if (immediately) {
+        d_ptr->applyPendingVisibleContextCategories();
+    } else {
+        d_ptr->mContextCategoryVisibleTimer->start();
+    }
+}
+
 /**
  * @brief 获取所有的上下文标签
  * @return 返回上下文标签列表
@@ -1017,6 +1487,23 @@ QList< SARibbonContextCategory* > SARibbonBar::contextCategoryList() const
     return (d_ptr->mContextCategoryList);
 }
 
+/**
+ * @brief 获取点所在的上下文标签
+ *
+ * 判断使用的是缓存的上下文标签标题区域，不会重新计算tab的位置
+ * @param pos SARibbonBar坐标系下的点
+ * @return 如果点不在任何显示中的上下文标签标题区域内，返回nullptr
+ */
+SARibbonContextCategory* SARibbonBar::contextCategoryAt(const QPoint& pos) const
+{
+    for (const _SAContextCategoryManagerData& cd : qAsConst(d_ptr->mCurrentShowingContextCategory)) {
+        if (cd.contextTitleRect.contains(pos)) {
+            return cd.contextCategory;
+        }
+    }
+    return nullptr;
+}
+
 /**
  * @brief 销毁上下文标签，上下文标签的SARibbonCategory也会随之销毁
  * @param context 需要销毁的上下文标签指针
@@ -1247,6 +1734,9 @@ void SARibbonBar::onCategoryWindowTitleChanged(const QString& title)
 {
     // 全部更新一遍
     Q_UNUSED(title);
+    if (SARibbonCategory* c = qobject_cast< SARibbonCategory* >(sender())) {
+        d_ptr->updateCategoryNameIndexKeys(c);
+    }
     updateCategoryTitleToTabName();
 }
 
@@ -1263,14 +1753,11 @@ void SARibbonBar::onStackWidgetHided()
  */
 void SARibbonBar::onCurrentRibbonTabChanged(int index)
 {
-    QVariant var               = d_ptr->mRibbonTabBar->tabData(index);
-    SARibbonCategory* category = nullptr;
+    SARibbonCategory* category = d_ptr->mTabCategories.value(index, nullptr);
 
-    if (var.isValid()) {
-        _SARibbonTabData p = var.value< _SARibbonTabData >();
-        category           = p.category;
-    }
     if (category) {
+        // 显示环境变化后还没来得及刷新的category，在显示前立即刷新
+        d_ptr->warmUpPendingCategory(category);
         if (d_ptr->mStackedContainerWidget->currentWidget() != category) {
             d_ptr->mStackedContainerWidget->setCurrentWidget(category);
         }
@@ -1342,7 +1829,12 @@ void SARibbonBar::onCurrentRibbonTabDoubleClicked(int index)
 void SARibbonBar::onContextsCategoryPageAdded(SARibbonCategory* category)
 {
     Q_ASSERT_X(category != nullptr, "onContextsCategoryPageAdded", "add nullptr page");
-    d_ptr->mStackedContainerWidget->addWidget(category);  // 这里stackedWidget用append，其他地方都应该使用insert
+    // 这里stackedWidget用append，其他地方都应该使用insert
+    const int stackedIndex = d_ptr->mStackedContainerWidget->addWidget(category);
+    d_ptr->insertCategoryNameIndex(category, stackedIndex);
+    connect(category, &QObject::objectNameChanged, this, [ this, category ]() {
+        d_ptr->updateCategoryNameIndexKeys(category);
+    });
 }
 
 /**
@@ -1352,8 +1844,8 @@ void SARibbonBar::onContextsCategoryPageAdded(SARibbonCategory* category)
  */
 void SARibbonBar::onContextsCategoryCategoryNameChanged(SARibbonCategory* category, const QString& title)
 {
-    Q_UNUSED(category);
     Q_UNUSED(title);
+    d_ptr->updateCategoryNameIndexKeys(category);
     updateCategoryTitleToTabName();
 }
 
@@ -1367,6 +1859,11 @@ void SARibbonBar::onTabMoved(int from, int to)
     const QSignalBlocker blocker(d_ptr->mStackedContainerWidget);
     // 调整stacked widget的顺序，调整顺序是为了调用categoryPages函数返回的QList<SARibbonCategory *>顺序和tabbar一致
     d_ptr->mStackedContainerWidget->moveWidget(from, to);
+    d_ptr->moveCategoryTab(from, to);
+    // 移动时stacked的信号被阻塞，需要主动更新名字索引
+    d_ptr->moveCategoryNameIndex(from, to);
+    // tab移动后上下文标签的位置也会变化
+    d_ptr->updateContextCategoryTitleRect();
 }
 
 /**
@@ -1378,20 +1875,7 @@ void SARibbonBar::onTabMoved(int from, int to)
  */
 int SARibbonBar::tabIndex(SARibbonCategory* obj)
 {
-    const int size = d_ptr->mRibbonTabBar->count();
-
-    for (int i = 0; i < size; ++i) {
-        QVariant v = d_ptr->mRibbonTabBar->tabData(i);
-        if (v.isValid()) {
-            _SARibbonTabData innervalue = v.value< _SARibbonTabData >();
-            if (innervalue.category == obj) {
-                return (i);
-            }
-        }
-    }
-    // 如果找不到就从stackedwidget中找
-
-    return (-1);
+    return (categoryIndex(obj));
 }
 
 void SARibbonBar::resizeAll()
@@ -1626,16 +2110,438 @@ QColor SARibbonBar::tabBarBaseLineColor() const
  */
 void SARibbonBar::updateRibbonGeometry()
 {
+    // 所有category都会立即刷新，等待空闲刷新的列表不再需要
+    d_ptr->recordDisplayContext();
+    d_ptr->mPendingWarmUpCategories.clear();
+    d_ptr->mWarmUpTimer->stop();
     d_ptr->resetSize();
+    d_ptr->checkLayoutSnapshot();
     iterate([](SARibbonCategory* c) -> bool {
         c->updateItemGeometry();
         return true;
     });
+    // tab的margin等信息可能发生了变化，上下文标签区域需要重新计算
+    d_ptr->updateContextCategoryTitleRect();
     //! 直接给一个resizeevent，让所有刷新
     // QResizeEvent* e = new QResizeEvent(size(), QSize());
     // QApplication::postEvent(this, e);
 }
 
+/**
+ * @brief 显示环境（dpr、逻辑dpi）变化后刷新和显示环境相关的缓存
+ *
+ * 和@ref updateRibbonGeometry 一次性刷新所有category不同，此函数只立即刷新当前显示的category，
+ * 其余category放入等待列表，在事件循环空闲时逐个刷新，如果切换到还未刷新的category，会在显示前立即刷新，
+ * 这样窗口在不同缩放比例的屏幕之间拖动时不会因为一次性刷新所有category而卡顿
+ *
+ * SARibbonBar所在的屏幕发生变化时会自动调用此函数
+ * @param force 为true时，即使dpr和逻辑dpi没有变化也执行刷新
+ */
+void SARibbonBar::updateDisplayContext(bool force)
+{
+    const bool changed = d_ptr->recordDisplayContext();
+    if (!changed && !force) {
+        return;
+    }
+    // 标题栏、tabbar、category的高度都是根据字体计算的
+    d_ptr->resetSize();
+    d_ptr->checkLayoutSnapshot();
+    SARibbonCategory* current = qobject_cast< SARibbonCategory* >(d_ptr->mStackedContainerWidget->currentWidget());
+    d_ptr->mPendingWarmUpCategories.clear();
+    iterate([ this, current ](SARibbonCategory* c) -> bool {
+        if (c != current) {
+            d_ptr->mPendingWarmUpCategories.append(c);
+        }
+        return true;
+    });
+    d_ptr->warmUpCategory(current);
+    d_ptr->updateContextCategoryTitleRect();
+    if (d_ptr->mPendingWarmUpCategories.isEmpty()) {
+        d_ptr->mWarmUpTimer->stop();
+    } else {
+        d_ptr->mWarmUpTimer->start();
+    }
+}
+
+/**
+ * @brief 开始批量更新action状态
+ *
+ * 每个action的变化都会触发@ref SARibbonPannel 的重新布局以及category的尺寸调整，
+ * 一次修改大量action（例如选中对象变化时刷新所有action的enable状态）时会有明显的卡顿。
+ * 在beginActionStateUpdate和@ref endActionStateUpdate 之间，action变化引起的布局请求只会被记录，
+ * 在endActionStateUpdate时对涉及的pannel和category各进行一次布局，按钮自身的刷新不受影响
+ *
+ * pannel中action的添加、移除以及category中pannel的顺序调整同样会延迟到endActionStateUpdate，
+ * @ref SARibbonCustomizeDataApplier 批量应用自定义操作时依赖于此
+ *
+ * beginActionStateUpdate和endActionStateUpdate必须成对调用，可以嵌套，最外层的end才会进行布局
+ *
+ * @code
+ * ribbon->beginActionStateUpdate();
+ * actCut->setEnabled(hasSelection);
+ * actCopy->setEnabled(hasSelection);
+ * actBold->setChecked(isBold);
+ * ribbon->endActionStateUpdate();
+ * @endcode
+ */
+void SARibbonBar::beginActionStateUpdate()
+{
+    ++(d_ptr->mActionStateUpdateDepth);
+}
+
+/**
+ * @brief 结束批量更新action状态，对期间记录的pannel和category进行一次布局
+ * @sa beginActionStateUpdate
+ */
+void SARibbonBar::endActionStateUpdate()
+{
+    if (d_ptr->mActionStateUpdateDepth <= 0) {
+        return;
+    }
+    if (--(d_ptr->mActionStateUpdateDepth) > 0) {
+        return;
+    }
+    QHash< SARibbonPannel*, QPointer< SARibbonPannel > > pannels;
+    pannels.swap(d_ptr->mActionChangedPannels);
+    QList< QWidget* > categorys;
+    QSet< QWidget* > categorySet;
+    for (const QPointer< SARibbonPannel >& p : qAsConst(pannels)) {
+        if (!p) {
+            continue;
+        }
+        if (QLayout* lay = p->layout()) {
+            lay->invalidate();
+        }
+        QWidget* parw = p->parentWidget();
+        if (parw && !categorySet.contains(parw)) {
+            categorySet.insert(parw);
+            categorys.append(parw);
+        }
+    }
+    // 每个category只调整一次尺寸，原因见SARibbonPannel::actionEvent
+    for (QWidget* parw : qAsConst(categorys)) {
+        if (QLayout* pl = parw->layout()) {
+            pl->invalidate();
+        }
+        QApplication::postEvent(parw, new QResizeEvent(parw->size(), QSize()));
+    }
+}
+
+/**
+ * @brief 是否处于批量更新action状态中
+ * @return
+ */
+bool SARibbonBar::isActionStateUpdating() const
+{
+    return (d_ptr->mActionStateUpdateDepth > 0);
+}
+
+/**
+ * @brief 批量设置action的enable状态
+ * @param acts
+ * @param on
+ */
+void SARibbonBar::setActionsEnabled(const QList< QAction* >& acts, bool on)
+{
+    beginActionStateUpdate();
+    for (QAction* a : acts) {
+        a->setEnabled(on);
+    }
+    endActionStateUpdate();
+}
+
+/**
+ * @brief 批量设置action的check状态，只对checkable的action有效
+ * @param acts
+ * @param on
+ */
+void SARibbonBar::setActionsChecked(const QList< QAction* >& acts, bool on)
+{
+    beginActionStateUpdate();
+    for (QAction* a : acts) {
+        a->setChecked(on);
+    }
+    endActionStateUpdate();
+}
+
+/**
+ * @brief 批量设置action的可见状态
+ * @param acts
+ * @param on
+ */
+void SARibbonBar::setActionsVisible(const QList< QAction* >& acts, bool on)
+{
+    beginActionStateUpdate();
+    for (QAction* a : acts) {
+        a->setVisible(on);
+    }
+    endActionStateUpdate();
+}
+
+/**
+ * @brief 布局快照文件头标识"SARS"
+ */
+static const quint32 sa_layout_snapshot_magic = 0x53415253;
+
+/**
+ * @brief 布局快照的版本
+ */
+static const quint16 sa_layout_snapshot_version = 1;
+
+/**
+ * @brief 布局快照中用于识别action的字符串，优先使用SARibbonActionsManager的key，其次是objectName，最后是文本
+ */
+static QString sa_layout_snapshot_action_key(QAction* act, SARibbonActionsManager* mgr)
+{
+    if (nullptr == act) {
+        return QString();
+    }
+    if (mgr) {
+        QString k = mgr->key(act);
+        if (!k.isEmpty()) {
+            return k;
+        }
+    }
+    if (!act->objectName().isEmpty()) {
+        return act->objectName();
+    }
+    return act->text();
+}
+
+/**
+ * @brief 保存布局快照
+ *
+ * 快照包括@ref layoutFingerprint 、category和pannel的顺序、action的key和行占比，以及按钮计算好的sizehint，
+ * 下次启动构建好ribbon后通过@ref restoreLayoutSnapshot 恢复，可以省去按钮文字换行等尺寸计算
+ *
+ * @code
+ * // 程序退出前
+ * ribbonBar()->saveLayoutSnapshot(snapshotPath, actionsManager);
+ * // 程序启动，ribbon构建完成后，显示之前
+ * ribbonBar()->restoreLayoutSnapshot(snapshotPath, actionsManager);
+ * @endcode
+ * @param dev
+ * @param mgr 用于获取action的key，为空时使用action的objectName或文本识别action
+ * @return 成功返回true
+ * @note 需要在ribbonbar显示后调用，此时所有尺寸都已经确定
+ */
+bool SARibbonBar::saveLayoutSnapshot(QIODevice* dev, SARibbonActionsManager* mgr) const
+{
+    if (nullptr == dev) {
+        return false;
+    }
+    QDataStream st(dev);
+    st.setVersion(QDataStream::Qt_5_6);
+    st << sa_layout_snapshot_magic << sa_layout_snapshot_version << layoutFingerprint();
+    const QList< SARibbonCategory* > cs = categoryPages(true);
+    st << static_cast< quint32 >(cs.size());
+    for (SARibbonCategory* c : cs) {
+        const QList< SARibbonPannel* > ps = c->pannelList();
+        st << c->objectName() << c->categoryName() << static_cast< quint32 >(ps.size());
+        for (SARibbonPannel* p : ps) {
+            SARibbonPannelLayout* lay = p->pannelLayout();
+            const int cnt             = lay ? lay->count() : 0;
+            st << p->objectName() << p->pannelName() << static_cast< quint32 >(cnt);
+            for (int i = 0; i < cnt; ++i) {
+                SARibbonPannelItem* item = static_cast< SARibbonPannelItem* >(lay->itemAt(i));
+                SARibbonToolButton* btn  = qobject_cast< SARibbonToolButton* >(item->widget());
+                st << sa_layout_snapshot_action_key(item->action, mgr) << static_cast< qint8 >(item->rowProportion);
+                st << (nullptr != btn);
+                if (btn) {
+                    st << btn->text() << btn->sizeHint() << btn->isTextNeedWrap();
+                }
+            }
+        }
+    }
+    return (st.status() == QDataStream::Ok);
+}
+
+/**
+ * @brief 保存布局快照到文件
+ * @param filePath
+ * @param mgr
+ * @return 成功返回true
+ */
+bool SARibbonBar::saveLayoutSnapshot(const QString& filePath, SARibbonActionsManager* mgr) const
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return saveLayoutSnapshot(&f, mgr);
+}
+
+/**
+ * @brief 恢复布局快照
+ *
+ * 只有快照的@ref layoutFingerprint 和当前一致，且category、pannel、action的结构也完全一致时才会恢复，
+ * 否则不做任何改动，按正常的流程计算尺寸
+ *
+ * 恢复后按钮直接使用快照中的sizehint（见@ref SARibbonToolButton::setPresetSizeHint ），
+ * 按钮的action、字体、样式变化时，对应按钮会重新计算；主题、字体、dpr、ribbon样式等变化导致指纹不一致时，
+ * 整个快照失效
+ * @param dev
+ * @param mgr 需要和保存时一致
+ * @return 恢复成功返回true
+ */
+bool SARibbonBar::restoreLayoutSnapshot(QIODevice* dev, SARibbonActionsManager* mgr)
+{
+    if (nullptr == dev) {
+        return false;
+    }
+    QDataStream st(dev);
+    st.setVersion(QDataStream::Qt_5_6);
+    quint32 magic   = 0;
+    quint16 version = 0;
+    QByteArray fingerprint;
+    st >> magic >> version >> fingerprint;
+    if (st.status() != QDataStream::Ok || magic != sa_layout_snapshot_magic || version != sa_layout_snapshot_version
+        || fingerprint != layoutFingerprint()) {
+        return false;
+    }
+    // 先和当前的结构逐项对比，全部一致才应用
+    struct ButtonPreset
+    {
+        SARibbonToolButton* button;
+        QSize sizeHint;
+        bool textNeedWrap;
+    };
+    QList< ButtonPreset > presets;
+    QString objName, name;
+    quint32 count = 0;
+    const QList< SARibbonCategory* > cs = categoryPages(true);
+    st >> count;
+    if (count != static_cast< quint32 >(cs.size())) {
+        return false;
+    }
+    for (SARibbonCategory* c : cs) {
+        const QList< SARibbonPannel* > ps = c->pannelList();
+        st >> objName >> name >> count;
+        if (st.status() != QDataStream::Ok || objName != c->objectName() || name != c->categoryName()
+            || count != static_cast< quint32 >(ps.size())) {
+            return false;
+        }
+        for (SARibbonPannel* p : ps) {
+            SARibbonPannelLayout* lay = p->pannelLayout();
+            const int cnt             = lay ? lay->count() : 0;
+            st >> objName >> name >> count;
+            if (st.status() != QDataStream::Ok || objName != p->objectName() || name != p->pannelName()
+                || count != static_cast< quint32 >(cnt)) {
+                return false;
+            }
+            for (int i = 0; i < cnt; ++i) {
+                SARibbonPannelItem* item = static_cast< SARibbonPannelItem* >(lay->itemAt(i));
+                SARibbonToolButton* btn  = qobject_cast< SARibbonToolButton* >(item->widget());
+                QString key;
+                qint8 rowProportion = 0;
+                bool hasButton      = false;
+                st >> key >> rowProportion >> hasButton;
+                if (st.status() != QDataStream::Ok || key != sa_layout_snapshot_action_key(item->action, mgr)
+                    || rowProportion != static_cast< qint8 >(item->rowProportion) || hasButton != (nullptr != btn)) {
+                    return false;
+                }
+                if (btn) {
+                    QString text;
+                    ButtonPreset preset { btn, QSize(), false };
+                    st >> text >> preset.sizeHint >> preset.textNeedWrap;
+                    if (st.status() != QDataStream::Ok || text != btn->text() || !preset.sizeHint.isValid()) {
+                        return false;
+                    }
+                    presets.append(preset);
+                }
+            }
+        }
+    }
+    clearLayoutSnapshot();
+    for (const ButtonPreset& preset : qAsConst(presets)) {
+        preset.button->setPresetSizeHint(preset.sizeHint, preset.textNeedWrap);
+    }
+    d_ptr->mLayoutSnapshotFingerprint = fingerprint;
+    return true;
+}
+
+/**
+ * @brief 从文件恢复布局快照
+ * @param filePath
+ * @param mgr
+ * @return 恢复成功返回true，文件不存在也返回false
+ */
+bool SARibbonBar::restoreLayoutSnapshot(const QString& filePath, SARibbonActionsManager* mgr)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return restoreLayoutSnapshot(&f, mgr);
+}
+
+/**
+ * @brief 是否正在使用恢复的布局快照
+ * @return
+ */
+bool SARibbonBar::isLayoutSnapshotRestored() const
+{
+    return !(d_ptr->mLayoutSnapshotFingerprint.isEmpty());
+}
+
+/**
+ * @brief 清除恢复的布局快照，所有按钮重新计算尺寸
+ */
+void SARibbonBar::clearLayoutSnapshot()
+{
+    if (d_ptr->mLayoutSnapshotFingerprint.isEmpty()) {
+        return;
+    }
+    d_ptr->mLayoutSnapshotFingerprint.clear();
+    iterate([](SARibbonPannel* p) -> bool {
+        const QList< SARibbonToolButton* > btns = p->ribbonToolButtons();
+        for (SARibbonToolButton* b : btns) {
+            b->clearPresetSizeHint();
+        }
+        return true;
+    });
+}
+
+/**
+ * @brief 影响布局的显示环境的指纹
+ *
+ * 包括qt和SARibbon的版本、样式和qss（程序、所有父窗口以及ribbonbar自身的qss）、SARibbonMainWindow的主题、
+ * 主题引擎和作用范围、字体、dpr和逻辑dpi、ribbon样式以及各部分的高度，
+ * 指纹一致时同样的ribbon结构会得到同样的尺寸
+ * @return
+ */
+QByteArray SARibbonBar::layoutFingerprint() const
+{
+    QByteArray data;
+    QDataStream st(&data, QIODevice::WriteOnly);
+    st.setVersion(QDataStream::Qt_5_6);
+    st << static_cast< quint32 >(QT_VERSION) << static_cast< qint32 >(SA_RIBBON_BAR_VERSION_MAJ)
+       << static_cast< qint32 >(SA_RIBBON_BAR_VERSION_MIN) << static_cast< qint32 >(SA_RIBBON_BAR_VERSION_PAT);
+    st << QString::fromLatin1(style()->metaObject()->className()) << qApp->styleSheet() << styleSheet();
+    // 主窗口的qss主题作用在主窗口上，父窗口的qss同样会影响ribbonbar
+    for (const QWidget* w = parentWidget(); w; w = w->parentWidget()) {
+        st << w->styleSheet();
+    }
+    if (const SARibbonMainWindow* mainWindow = qobject_cast< const SARibbonMainWindow* >(window())) {
+        st << static_cast< qint32 >(mainWindow->ribbonTheme()) << static_cast< qint32 >(mainWindow->ribbonThemeEngine())
+           << static_cast< qint32 >(mainWindow->ribbonThemeScope());
+    }
+    st << font().toString() << static_cast< qint32 >(qRound(devicePixelRatioF() * 100)) << logicalDpiY();
+    st << static_cast< qint32 >(d_ptr->mRibbonStyle) << static_cast< qint32 >(d_ptr->mDefaulePannelLayoutMode);
+    st << d_ptr->titleBarHeight() << d_ptr->tabBarHeigth() << d_ptr->categoryHeight();
+    st << d_ptr->mPannelTitleHeight << d_ptr->mEnableShowPannelTitle << isEnableWordWrap();
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void SARibbonBar::addActionChangedPannel(SARibbonPannel* p)
+{
+    QPointer< SARibbonPannel >& v = d_ptr->mActionChangedPannels[ p ];
+    if (!v) {
+        // 新记录的pannel，或者之前记录的pannel已经销毁，地址被新的pannel复用
+        v = p;
+    }
+}
+
 /**
  * @brief SARibbonPannel的布局模式
  * @return
@@ -1982,16 +2888,15 @@ int SARibbonBar::minimumModeMainBarHeight() const
 void SARibbonBar::updateCategoryTitleToTabName()
 {
     SARibbonTabBar* tab = d_ptr->mRibbonTabBar;
-    for (int i = 0; i < tab->count(); ++i) {
-        // 鉴于tab不会很多，不考虑效率问题
-        QVariant var = tab->tabData(i);
-        if (var.isValid()) {
-            _SARibbonTabData p = var.value< _SARibbonTabData >();
-            if (p.category && p.category->categoryName() != tab->tabText(i)) {
-                tab->setTabText(i, p.category->categoryName());
-            }
+    const int c         = qMin(tab->count(), d_ptr->mTabCategories.size());
+    for (int i = 0; i < c; ++i) {
+        SARibbonCategory* category = d_ptr->mTabCategories[ i ];
+        if (category && category->categoryName() != tab->tabText(i)) {
+            tab->setTabText(i, category->categoryName());
         }
     }
+    // tab文字改变会引起tab宽度变化
+    d_ptr->updateContextCategoryTitleRect();
     repaint();
 }
 
@@ -2029,45 +2934,17 @@ void SARibbonBar::paintInLooseStyle()
 
     //! 显示上下文标签
     p.save();
-    QList< _SAContextCategoryManagerData > contextCategoryDataList = d_ptr->mCurrentShowingContextCategory;
-    // bool isCurrentSelectContextCategoryPage                        = false;
-
-    QPoint contextCategoryRegion(width(), -1);
-    QMargins border = contentsMargins();
-
-    for (int i = 0; i < contextCategoryDataList.size(); ++i) {
-        QRect contextTitleRect;
-        QList< int > indexs = contextCategoryDataList[ i ].tabPageIndex;
-        QColor clr          = contextCategoryDataList[ i ].contextCategory->contextColor();
-        if (!indexs.isEmpty()) {
-            contextTitleRect = d_ptr->mRibbonTabBar->tabRect(indexs.first());
-            QRect endRect    = d_ptr->mRibbonTabBar->tabRect(indexs.last());
-            contextTitleRect.setRight(endRect.right());
-            contextTitleRect.translate(d_ptr->mRibbonTabBar->x(), d_ptr->mRibbonTabBar->y());
-            contextTitleRect.setHeight(d_ptr->mRibbonTabBar->height() - 1);  // 减1像素，避免tabbar基线覆盖
-            contextTitleRect -= d_ptr->mRibbonTabBar->tabMargin();
-            // 把区域顶部扩展到窗口顶部
-            contextTitleRect.setTop(border.top());
-            // 绘制
-            paintContextCategoryTab(p, contextCategoryDataList[ i ].contextCategory->contextTitle(), contextTitleRect, clr);
-            // 更新上下文标签的范围，用于控制标题栏的显示
-            if (contextTitleRect.left() < contextCategoryRegion.x()) {
-                contextCategoryRegion.setX(contextTitleRect.left());
-            }
-            if (contextTitleRect.right() > contextCategoryRegion.y()) {
-                contextCategoryRegion.setY(contextTitleRect.right());
-            }
+    // 上下文标签的区域已经在布局时计算好，这里直接使用
+    const QPoint& contextCategoryRegion = d_ptr->mContextCategoryRegion;
+    QMargins border                     = contentsMargins();
+
+    for (const _SAContextCategoryManagerData& cd : qAsConst(d_ptr->mCurrentShowingContextCategory)) {
+        if (cd.contextTitleRect.isValid()) {
+            paintContextCategoryTab(p,
+                                    cd.contextCategory->contextTitle(),
+                                    cd.contextTitleRect,
+                                    cd.contextCategory->contextColor());
         }
-        // isCurrentSelectContextCategoryPage = indexs.contains(d_ptr->mRibbonTabBar->currentIndex());
-        // if (isCurrentSelectContextCategoryPage) {
-        //     QPen pen;
-        //     pen.setColor(clr);
-        //     pen.setWidth(1);
-        //     p.setPen(pen);
-        //     p.setBrush(Qt::NoBrush);
-        //     p.drawRect(d_ptr->mStackedContainerWidget->geometry());
-        //     isCurrentSelectContextCategoryPage = false;
-        // }
     }
     p.restore();
     //! 显示标题等
@@ -2114,23 +2991,10 @@ void SARibbonBar::paintInCompactStyle()
     paintTabbarBaseLine(p);
     //! 显示上下文标签
     p.save();
-    QList< _SAContextCategoryManagerData > contextCategoryDataList = d_ptr->mCurrentShowingContextCategory;
-    QMargins border                                                = contentsMargins();
-    for (int i = 0; i < contextCategoryDataList.size(); ++i) {
-        QRect contextTitleRect;
-        QList< int > indexs = contextCategoryDataList[ i ].tabPageIndex;
-        QColor clr          = contextCategoryDataList[ i ].contextCategory->contextColor();
-        if (!indexs.isEmpty()) {
-            contextTitleRect = d_ptr->mRibbonTabBar->tabRect(indexs.first());
-            QRect endRect    = d_ptr->mRibbonTabBar->tabRect(indexs.last());
-            contextTitleRect.setRight(endRect.right());
-            contextTitleRect.translate(d_ptr->mRibbonTabBar->x(), d_ptr->mRibbonTabBar->y());
-            contextTitleRect.setHeight(d_ptr->mRibbonTabBar->height() - 1);
-            contextTitleRect -= d_ptr->mRibbonTabBar->tabMargin();
-            // 把区域顶部扩展到窗口顶部
-            contextTitleRect.setTop(border.top());
-            // 绘制
-            paintContextCategoryTab(p, QString(), contextTitleRect, clr);
+    QMargins border = contentsMargins();
+    for (const _SAContextCategoryManagerData& cd : qAsConst(d_ptr->mCurrentShowingContextCategory)) {
+        if (cd.contextTitleRect.isValid()) {
+            paintContextCategoryTab(p, QString(), cd.contextTitleRect, cd.contextCategory->contextColor());
         }
     }
     p.restore();
@@ -2178,25 +3042,18 @@ void SARibbonBar::resizeStackedContainerWidget()
  */
 void SARibbonBar::updateContextCategoryManagerData()
 {
-    const int c = d_ptr->mRibbonTabBar->count();
-
+    d_ptr->ensureCategoryTabIndex();
     for (_SAContextCategoryManagerData& cd : d_ptr->mCurrentShowingContextCategory) {
         cd.tabPageIndex.clear();
         for (int i = 0; i < cd.contextCategory->categoryCount(); ++i) {
-            SARibbonCategory* category = cd.contextCategory->categoryPage(i);
-            for (int t = 0; t < c; ++t) {
-                QVariant v = d_ptr->mRibbonTabBar->tabData(t);
-                if (v.isValid()) {
-                    _SARibbonTabData d = v.value< _SARibbonTabData >();
-                    if (d.category == category) {
-                        cd.tabPageIndex.append(t);
-                    }
-                } else {
-                    cd.tabPageIndex.append(-1);
-                }
+            const int t = d_ptr->mCategoryTabIndex.value(cd.contextCategory->categoryPage(i), -1);
+            if (t >= 0) {
+                cd.tabPageIndex.append(t);
             }
         }
+        std::sort(cd.tabPageIndex.begin(), cd.tabPageIndex.end());
     }
+    d_ptr->updateContextCategoryTitleRect();
 }
 
 /**
@@ -2294,6 +3151,15 @@ bool SARibbonBar::event(QEvent* e)
         // 第一次显示刷新
         updateRibbonGeometry();
         break;
+    case QEvent::ScreenChangeInternal:
+        // 窗口移动到了其它屏幕，dpr和逻辑dpi可能发生了变化
+        updateDisplayContext();
+        break;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    case QEvent::DevicePixelRatioChange:
+        updateDisplayContext();
+        break;
+#endif
     default:
         break;
     }
@@ -2394,6 +3260,7 @@ void SARibbonBar::resizeInLooseStyle()
         }
     }
     resizeStackedContainerWidget();
+    d_ptr->updateContextCategoryTitleRect();
 }
 
 void SARibbonBar::resizeInCompactStyle()
@@ -2496,6 +3363,7 @@ void SARibbonBar::resizeInCompactStyle()
     }
     // 调整整个stackedContainer
     resizeStackedContainerWidget();
+    d_ptr->updateContextCategoryTitleRect();
 }
 
 /**
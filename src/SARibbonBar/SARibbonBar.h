@@ -5,9 +5,12 @@
 #include "SARibbonGlobal.h"
 #include <QMenuBar>
 #include <QScopedPointer>
+#include <QSet>
 #include <QVariant>
 
 class QAbstractButton;
+class QIODevice;
+class SARibbonActionsManager;
 class SARibbonElementFactory;
 class SARibbonTabBar;
 class SARibbonButtonGroupWidget;
@@ -93,6 +96,8 @@ class SA_RIBBON_EXPORT SARibbonBar : public QMenuBar
     Q_OBJECT
     SA_RIBBON_DECLARE_PRIVATE(SARibbonBar)
     friend class SARibbonMainWindow;
+    friend class SARibbonPannel;
+    friend class SARibbonCategoryLayout;
     Q_PROPERTY(RibbonStyles ribbonStyle READ currentRibbonStyle WRITE setRibbonStyle)
     Q_PROPERTY(bool minimumMode READ isMinimumMode WRITE setMinimumMode)
     Q_PROPERTY(bool minimumModeButton READ haveShowMinimumModeButton WRITE showMinimumModeButton)
@@ -222,9 +227,15 @@ public:
     // 设置上下文标签的显示或隐藏
     void setContextCategoryVisible(SARibbonContextCategory* context, bool visible);
 
+    // 设置需要显示的上下文标签，其余的上下文标签隐藏，默认合并同一轮事件循环内的多次调用
+    void setVisibleContextCategories(const QSet< SARibbonContextCategory* >& contexts, bool immediately = false);
+
     // 获取所有的上下文标签
     QList< SARibbonContextCategory* > contextCategoryList() const;
 
+    // 获取点所在的上下文标签，用于点击判断
+    SARibbonContextCategory* contextCategoryAt(const QPoint& pos) const;
+
     // 移除ContextCategory
     void destroyContextCategory(SARibbonContextCategory* context);
 
@@ -299,6 +310,27 @@ public:
 
     // 更新ribbon的布局数据，此函数适用于一些关键性尺寸变化，换起ribbon下面元素的布局,在发现刷新问题时，可以调用此函数
     void updateRibbonGeometry();
+    // 显示环境（dpr、逻辑dpi）变化后刷新缓存，当前category立即刷新，其余category在空闲时刷新
+    void updateDisplayContext(bool force = false);
+
+    // 批量更新action状态，begin和end之间action变化引起的pannel布局会合并到end时统一进行，可嵌套
+    void beginActionStateUpdate();
+    void endActionStateUpdate();
+    bool isActionStateUpdating() const;
+    // 批量设置action的状态，内部会调用beginActionStateUpdate/endActionStateUpdate
+    void setActionsEnabled(const QList< QAction* >& acts, bool on);
+    void setActionsChecked(const QList< QAction* >& acts, bool on);
+    void setActionsVisible(const QList< QAction* >& acts, bool on);
+
+    // 布局快照，保存按钮的尺寸计算结果，下次启动时如果显示环境和ribbon结构一致，直接恢复而不再计算
+    bool saveLayoutSnapshot(QIODevice* dev, SARibbonActionsManager* mgr = nullptr) const;
+    bool saveLayoutSnapshot(const QString& filePath, SARibbonActionsManager* mgr = nullptr) const;
+    bool restoreLayoutSnapshot(QIODevice* dev, SARibbonActionsManager* mgr = nullptr);
+    bool restoreLayoutSnapshot(const QString& filePath, SARibbonActionsManager* mgr = nullptr);
+    bool isLayoutSnapshotRestored() const;
+    void clearLayoutSnapshot();
+    // 影响布局的显示环境（主题、字体、dpr、ribbon样式等）的指纹
+    QByteArray layoutFingerprint() const;
 
     // 设置pannel的模式
     SARibbonPannel::PannelLayoutMode pannelLayoutMode() const;
@@ -392,6 +424,18 @@ signals:
      */
     void titleBarHeightChanged(int oldHeight, int newHeight);
 
+    /**
+       @brief category添加到ribbonbar后触发的信号
+       @param category
+     */
+    void categoryAdded(SARibbonCategory* category);
+
+    /**
+       @brief category从ribbonbar移除后触发的信号
+       @param category
+     */
+    void categoryRemoved(SARibbonCategory* category);
+
 protected:
     bool eventFilter(QObject* obj, QEvent* e) override;
     // 根据情况重置tabbar的宽度，主要针对wps模式
@@ -424,6 +468,8 @@ private:
     // 刷新所有ContextCategoryManagerData，这个在单独一个Category删除时调用
     void updateContextCategoryManagerData();
     void synchronousCategoryData(bool autoUpdate = true);
+    // 批量更新action状态期间，记录需要重新布局的pannel
+    void addActionChangedPannel(SARibbonPannel* p);
 
 protected:
     virtual void paintEvent(QPaintEvent* e) Q_DECL_OVERRIDE;
@@ -68,7 +68,11 @@ SOURCES += \
     $$PWD/SARibbonCtrlContainer.cpp \
     $$PWD/SARibbonPannelLayout.cpp \
     $$PWD/SARibbonPannelItem.cpp \
-    $$PWD/SARibbonLineWidgetContainer.cpp
+    $$PWD/SARibbonLineWidgetContainer.cpp \
+    $$PWD/SARibbonTheme.cpp \
+    $$PWD/SARibbonCommandSearchWidget.cpp \
+    $$PWD/SARibbonCommandUpdater.cpp \
+    $$PWD/SARibbonDescription.cpp
 
 HEADERS  += \
     $$PWD/SAFramelessHelper.h \
@@ -106,7 +110,12 @@ HEADERS  += \
     $$PWD/SARibbonCtrlContainer.h \
     $$PWD/SARibbonPannelLayout.h \
     $$PWD/SARibbonPannelItem.h \
-    $$PWD/SARibbonLineWidgetContainer.h
+    $$PWD/SARibbonLineWidgetContainer.h \
+    $$PWD/SARibbonTheme.h \
+    $$PWD/SARibbonThemePrivate.h \
+    $$PWD/SARibbonCommandSearchWidget.h \
+    $$PWD/SARibbonCommandUpdater.h \
+    $$PWD/SARibbonDescription.h
 
 RESOURCES += \
     $$PWD/resource.qrc
@@ -109,6 +109,7 @@ void SARibbonCategory::PrivateData::insertPannel(int index, SARibbonPannel* pann
     index = qMin(lay->pannelCount(), index);
     lay->insertPannel(index, pannel);
     pannel->setVisible(true);
+    emit q_ptr->pannelAdded(pannel);
 }
 
 bool SARibbonCategory::PrivateData::takePannel(SARibbonPannel* pannel)
@@ -117,7 +118,11 @@ bool SARibbonCategory::PrivateData::takePannel(SARibbonPannel* pannel)
     if (nullptr == lay) {
         return false;
     }
-    return lay->takePannel(pannel);
+    if (!lay->takePannel(pannel)) {
+        return false;
+    }
+    emit q_ptr->pannelRemoved(pannel);
+    return true;
 }
 
 bool SARibbonCategory::PrivateData::removePannel(SARibbonPannel* pannel)
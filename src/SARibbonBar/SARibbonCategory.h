@@ -119,6 +119,18 @@ signals:
      */
     void categoryNameChanged(const QString& n);
 
+    /**
+     * @brief pannel添加到category后触发的信号
+     * @param pannel
+     */
+    void pannelAdded(SARibbonPannel* pannel);
+
+    /**
+     * @brief pannel脱离category后触发的信号（包括take和remove）
+     * @param pannel
+     */
+    void pannelRemoved(SARibbonPannel* pannel);
+
 protected:
     virtual bool event(QEvent* e) Q_DECL_OVERRIDE;
     // 处理滚轮事件
@@ -1,6 +1,9 @@
 ﻿#include "SARibbonCategoryLayout.h"
+#include <QHash>
 #include <QLayoutItem>
 #include "SARibbonPannel.h"
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
 #include "SARibbonElementManager.h"
 #include "SARibbonSeparatorWidget.h"
 #include <QApplication>
@@ -19,6 +22,28 @@ public:
     PrivateData(SARibbonCategoryLayout* p);
     // 计算所有元素的sizehint总宽度
     int totalSizeHintWidth() const;
+    // 插入pannel后更新索引，pos为插入的位置
+    void insertPannelIndex(SARibbonPannel* pannel, int pos);
+    // 移除pannel后更新索引，pos为移除前的位置
+    void takePannelIndex(SARibbonPannel* pannel, int pos);
+    // 移动pannel后更新索引
+    void movePannelIndex(int from, int to);
+    // pannel改名或改objectName后更新索引
+    void updatePannelIndexKeys(SARibbonPannel* pannel);
+
+public:
+    /**
+     * @brief pannel在索引中记录的信息
+     *
+     * 记录建立索引时的名字，改名时才能找到旧的索引项
+     */
+    class PannelIndexInfo
+    {
+    public:
+        int position { -1 };  ///< 在mItemList中的位置
+        QString name;         ///< 索引中的pannelName
+        QString objectName;   ///< 索引中的objectName
+    };
 
 public:
     bool mDirty { true };
@@ -32,6 +57,23 @@ public:
     QSize mMinSizeHint;
     QList< SARibbonCategoryLayoutItem* > mItemList;
     SARibbonAlignment mCategoryAlignment { SARibbonAlignment::AlignLeft };  ///< 对齐方式
+    QHash< QString, SARibbonPannel* > mPannelNameIndex;                ///< pannelName到pannel的索引，重名时记录第一个
+    QHash< QString, SARibbonPannel* > mPannelObjectNameIndex;          ///< objectName到pannel的索引，重名时记录第一个
+    QHash< const SARibbonPannel*, PannelIndexInfo > mPannelIndexInfo;  ///< pannel到位置和名字的索引
+
+private:
+    // 按mItemList重新记录[begin,end)范围内pannel的位置
+    void updatePannelPosition(int begin, int end);
+    // 从from开始查找第一个索引名字为key的pannel
+    SARibbonPannel* findPannelByKey(const QString& key, bool isObjectName, int from) const;
+    // 在pos位置出现了一个名字为key的pannel，如果它是第一个则更新索引
+    void addPannelKey(QHash< QString, SARibbonPannel* >& index, const QString& key, SARibbonPannel* pannel, int pos);
+    // pannel不再使用key，如果它是key对应的第一个pannel，从from开始找下一个
+    void removePannelKey(QHash< QString, SARibbonPannel* >& index,
+                         const QString& key,
+                         bool isObjectName,
+                         SARibbonPannel* pannel,
+                         int from);
 };
 
 //=============================================================
@@ -42,6 +84,154 @@ SARibbonCategoryLayout::PrivateData::PrivateData(SARibbonCategoryLayout* p) : q_
 {
 }
 
+/**
+ * @brief 插入pannel后更新索引
+ *
+ * 只更新插入位置之后的pannel的位置，以及新pannel的名字对应的索引项
+ * @param pannel
+ * @param pos pannel插入的位置，此时pannel已经在mItemList中
+ */
+void SARibbonCategoryLayout::PrivateData::insertPannelIndex(SARibbonPannel* pannel, int pos)
+{
+    updatePannelPosition(pos + 1, mItemList.size());
+    PannelIndexInfo& info = mPannelIndexInfo[ pannel ];
+    info.position         = pos;
+    info.name             = pannel->pannelName();
+    info.objectName       = pannel->objectName();
+    addPannelKey(mPannelNameIndex, info.name, pannel, pos);
+    addPannelKey(mPannelObjectNameIndex, info.objectName, pannel, pos);
+}
+
+/**
+ * @brief 移除pannel后更新索引
+ *
+ * 只更新移除位置之后的pannel的位置，如果pannel是重名的第一个，向后查找下一个同名的pannel
+ * @param pannel
+ * @param pos pannel移除前的位置，此时pannel已经不在mItemList中
+ */
+void SARibbonCategoryLayout::PrivateData::takePannelIndex(SARibbonPannel* pannel, int pos)
+{
+    updatePannelPosition(pos, mItemList.size());
+    if (!mPannelIndexInfo.contains(pannel)) {
+        return;
+    }
+    const PannelIndexInfo info = mPannelIndexInfo.take(pannel);
+    // pannel是第一个，前面不会有同名的pannel
+    removePannelKey(mPannelNameIndex, info.name, false, pannel, pos);
+    removePannelKey(mPannelObjectNameIndex, info.objectName, true, pannel, pos);
+}
+
+/**
+ * @brief 移动pannel后更新索引
+ *
+ * 其它pannel之间的先后顺序不变，因此只有被移动的pannel的名字对应的索引项可能改变
+ * @param from
+ * @param to
+ */
+void SARibbonCategoryLayout::PrivateData::movePannelIndex(int from, int to)
+{
+    updatePannelPosition(qMin(from, to), qMax(from, to) + 1);
+    SARibbonPannel* pannel = mItemList[ to ]->toPannelWidget();
+    if (!pannel || !mPannelIndexInfo.contains(pannel)) {
+        return;
+    }
+    const PannelIndexInfo info = mPannelIndexInfo.value(pannel);
+    removePannelKey(mPannelNameIndex, info.name, false, pannel, 0);
+    removePannelKey(mPannelObjectNameIndex, info.objectName, true, pannel, 0);
+    addPannelKey(mPannelNameIndex, info.name, pannel, to);
+    addPannelKey(mPannelObjectNameIndex, info.objectName, pannel, to);
+}
+
+/**
+ * @brief pannel改名或改objectName后更新索引，只修改旧名字和新名字对应的索引项
+ * @param pannel
+ */
+void SARibbonCategoryLayout::PrivateData::updatePannelIndexKeys(SARibbonPannel* pannel)
+{
+    auto it = mPannelIndexInfo.find(pannel);
+    if (it == mPannelIndexInfo.end()) {
+        return;
+    }
+    const int pos      = it.value().position;
+    const QString name = pannel->pannelName();
+    if (name != it.value().name) {
+        const QString oldName = it.value().name;
+        it.value().name       = name;
+        // pannel是旧名字的第一个时，前面不会有同名的pannel
+        removePannelKey(mPannelNameIndex, oldName, false, pannel, pos + 1);
+        addPannelKey(mPannelNameIndex, name, pannel, pos);
+    }
+    const QString objname = pannel->objectName();
+    if (objname != it.value().objectName) {
+        const QString oldObjname = it.value().objectName;
+        it.value().objectName    = objname;
+        removePannelKey(mPannelObjectNameIndex, oldObjname, true, pannel, pos + 1);
+        addPannelKey(mPannelObjectNameIndex, objname, pannel, pos);
+    }
+}
+
+void SARibbonCategoryLayout::PrivateData::updatePannelPosition(int begin, int end)
+{
+    for (int i = qMax(0, begin); i < end; ++i) {
+        if (SARibbonPannel* pannel = mItemList[ i ]->toPannelWidget()) {
+            auto it = mPannelIndexInfo.find(pannel);
+            if (it != mPannelIndexInfo.end()) {
+                it.value().position = i;
+            }
+        }
+    }
+}
+
+SARibbonPannel*
+SARibbonCategoryLayout::PrivateData::findPannelByKey(const QString& key, bool isObjectName, int from) const
+{
+    for (int i = qMax(0, from); i < mItemList.size(); ++i) {
+        SARibbonPannel* pannel = mItemList[ i ]->toPannelWidget();
+        if (!pannel) {
+            continue;
+        }
+        auto it = mPannelIndexInfo.constFind(pannel);
+        if (it == mPannelIndexInfo.constEnd()) {
+            continue;
+        }
+        if ((isObjectName ? it.value().objectName : it.value().name) == key) {
+            return (pannel);
+        }
+    }
+    return (nullptr);
+}
+
+void SARibbonCategoryLayout::PrivateData::addPannelKey(QHash< QString, SARibbonPannel* >& index,
+                                                       const QString& key,
+                                                       SARibbonPannel* pannel,
+                                                       int pos)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        index.insert(key, pannel);
+    } else if (mPannelIndexInfo.value(it.value()).position > pos) {
+        // 重名时记录位置靠前的
+        it.value() = pannel;
+    }
+}
+
+void SARibbonCategoryLayout::PrivateData::removePannelKey(QHash< QString, SARibbonPannel* >& index,
+                                                          const QString& key,
+                                                          bool isObjectName,
+                                                          SARibbonPannel* pannel,
+                                                          int from)
+{
+    auto it = index.find(key);
+    if ((it == index.end()) || (it.value() != pannel)) {
+        return;
+    }
+    if (SARibbonPannel* next = findPannelByKey(key, isObjectName, from)) {
+        it.value() = next;
+    } else {
+        index.erase(it);
+    }
+}
+
 /**
  * @brief 计算所有元素的SizeHint宽度总和
  * @return
@@ -160,7 +350,9 @@ SARibbonCategoryLayoutItem* SARibbonCategoryLayout::takePannelItem(int index)
 {
     if ((index >= 0) && (index < d_ptr->mItemList.size())) {
         SARibbonCategoryLayoutItem* item = d_ptr->mItemList.takeAt(index);
+        d_ptr->takePannelIndex(item->toPannelWidget(), index);
         if (item->widget()) {
+            disconnect(item->widget(), nullptr, this, nullptr);
             item->widget()->hide();
         }
         if (item->separatorWidget) {
@@ -229,6 +421,12 @@ void SARibbonCategoryLayout::insertPannel(int index, SARibbonPannel* pannel)
     item->separatorWidget = RibbonSubElementFactory->createRibbonSeparatorWidget(parentWidget());
     // 插入list中
     d_ptr->mItemList.insert(index, item);
+    // 增量更新索引，只修改新pannel的名字和后面pannel的位置
+    d_ptr->insertPannelIndex(pannel, index);
+    connect(pannel, &SARibbonPannel::pannelNameChanged, this, [ this, pannel ]() {
+        d_ptr->updatePannelIndexKeys(pannel);
+    });
+    connect(pannel, &QObject::objectNameChanged, this, [ this, pannel ]() { d_ptr->updatePannelIndexKeys(pannel); });
     // 标记需要重新计算尺寸
     invalidate();
 }
@@ -500,14 +698,7 @@ QList< SARibbonPannel* > SARibbonCategoryLayout::pannels() const
  */
 SARibbonPannel* SARibbonCategoryLayout::pannelByObjectName(const QString& objname) const
 {
-    for (SARibbonCategoryLayoutItem* item : d_ptr->mItemList) {
-        if (SARibbonPannel* pannel = item->toPannelWidget()) {
-            if (pannel->objectName() == objname) {
-                return pannel;
-            }
-        }
-    }
-    return nullptr;
+    return d_ptr->mPannelObjectNameIndex.value(objname, nullptr);
 }
 
 /**
@@ -517,14 +708,7 @@ SARibbonPannel* SARibbonCategoryLayout::pannelByObjectName(const QString& objnam
  */
 SARibbonPannel* SARibbonCategoryLayout::pannelByName(const QString& pannelname) const
 {
-    for (SARibbonCategoryLayoutItem* item : qAsConst(d_ptr->mItemList)) {
-        if (SARibbonPannel* pannel = item->toPannelWidget()) {
-            if (pannel->pannelName() == pannelname) {
-                return (pannel);
-            }
-        }
-    }
-    return (nullptr);
+    return (d_ptr->mPannelNameIndex.value(pannelname, nullptr));
 }
 
 /**
@@ -548,6 +732,16 @@ SARibbonPannel* SARibbonCategoryLayout::pannelByIndex(int i) const
 void SARibbonCategoryLayout::movePannel(int from, int to)
 {
     d_ptr->mItemList.move(from, to);
+    d_ptr->movePannelIndex(from, to);
+    SARibbonCategory* category = ribbonCategory();
+    SARibbonBar* bar           = category ? category->ribbonBar() : nullptr;
+    SARibbonPannel* pannel     = d_ptr->mItemList[ to ]->toPannelWidget();
+    if (bar && bar->isActionStateUpdating() && pannel) {
+        // 批量更新期间只标记，布局延迟到SARibbonBar::endActionStateUpdate统一进行
+        invalidate();
+        bar->addActionChangedPannel(pannel);
+        return;
+    }
     doLayout();
 }
 
@@ -567,14 +761,7 @@ int SARibbonCategoryLayout::pannelCount() const
  */
 int SARibbonCategoryLayout::pannelIndex(SARibbonPannel* p) const
 {
-    int c = pannelCount();
-
-    for (int i = 0; i < c; ++i) {
-        if (d_ptr->mItemList[ i ]->toPannelWidget() == p) {
-            return (i);
-        }
-    }
-    return (-1);
+    return (d_ptr->mPannelIndexInfo.value(p).position);
 }
 
 /**
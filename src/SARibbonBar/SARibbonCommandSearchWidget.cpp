@@ -0,0 +1,700 @@
+﻿#include "SARibbonCommandSearchWidget.h"
+#include <QAbstractItemView>
+#include <QAction>
+#include <QAtomicInt>
+#include <QCompleter>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStandardItemModel>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+#include "SARibbonActionsManager.h"
+#include "SARibbonCategory.h"
+#include "SARibbonPannel.h"
+
+/**
+ * @def 工作线程每处理多少条命令检查一次查询是否过期
+ */
+#define SA_COMMAND_SEARCH_CANCEL_CHECK_STEP 256
+
+/**
+ * @def 工作线程每处理多少条命令返回一次中间结果
+ */
+#define SA_COMMAND_SEARCH_PARTIAL_RESULT_STEP 2048
+
+/**
+ * @brief 规范化文本，去除助记符&（&&保留为&）并转为小写
+ */
+static QString sa_normalize_command_text(const QString& text)
+{
+    QString res;
+    res.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        if (text.at(i) == QLatin1Char('&')) {
+            if (i + 1 < text.size() && text.at(i + 1) == QLatin1Char('&')) {
+                res.append(QLatin1Char('&'));
+                ++i;
+            }
+            continue;
+        }
+        res.append(text.at(i));
+    }
+    return res.toCaseFolded();
+}
+
+//===================================================
+// SARibbonCommandSearchWorker
+//===================================================
+
+/**
+ * @brief 命令搜索的后台匹配对象，运行在@ref SARibbonCommandSearchWidget 的工作线程中
+ *
+ * 匹配只针对一份不可变的快照进行，快照只包含字符串，不会在工作线程中访问QAction
+ *
+ * 此类只在本文件中使用，不需要信号槽，查询通过QTimer::singleShot投递到工作线程，
+ * 结果通过回调函数返回，回调函数在工作线程中调用
+ */
+class SARibbonCommandSearchWorker : public QObject
+{
+public:
+    /**
+     * @brief 快照中的一条命令，字符串都已经规范化（去除助记符并转为小写）
+     */
+    struct Entry
+    {
+        QString text;      ///< action的文本
+        QString toolTip;   ///< action的提示
+        QString key;       ///< action在SARibbonActionsManager中的key
+        QString category;  ///< 所在的category名字
+        QString pannel;    ///< 所在的pannel名字
+    };
+    using Snapshot = QVector< Entry >;
+    /**
+     * @brief 查询结果的回调，结果是按得分排序后快照的索引，finished为false说明是中间结果，后面还会有结果
+     */
+    using ResultsReadyCallback = std::function< void(int serial, const QVector< int >& rows, bool finished) >;
+
+public:
+    explicit SARibbonCommandSearchWorker(const ResultsReadyCallback& fun);
+    // 设置快照，线程安全
+    void setSnapshot(const QSharedPointer< const Snapshot >& s);
+    // 设置最新的查询序号，旧序号的查询会尽快终止，线程安全
+    void setLatestSerial(int serial);
+    // 设置结果的最大数量，线程安全
+    void setMaximumResultCount(int c);
+    // 计算模糊匹配的得分，不匹配返回-1
+    static int fuzzyScore(const QString& pattern, const QString& text);
+    // 查询，在工作线程中调用
+    void search(int serial, const QString& text);
+
+private:
+    ResultsReadyCallback mResultsReady;
+    QMutex mMutex;
+    QSharedPointer< const Snapshot > mSnapshot;
+    QAtomicInt mLatestSerial { 0 };
+    QAtomicInt mMaximumResultCount { 50 };
+};
+
+SARibbonCommandSearchWorker::SARibbonCommandSearchWorker(const ResultsReadyCallback& fun) : mResultsReady(fun)
+{
+}
+
+void SARibbonCommandSearchWorker::setSnapshot(const QSharedPointer< const Snapshot >& s)
+{
+    QMutexLocker locker(&mMutex);
+    mSnapshot = s;
+}
+
+void SARibbonCommandSearchWorker::setLatestSerial(int serial)
+{
+    mLatestSerial.storeRelease(serial);
+}
+
+void SARibbonCommandSearchWorker::setMaximumResultCount(int c)
+{
+    mMaximumResultCount.storeRelease(c);
+}
+
+/**
+ * @brief 计算模糊匹配的得分
+ *
+ * pattern的字符需要按顺序出现在text中，连续匹配、在开头或单词开头匹配会得到更高的分数，
+ * pattern作为完整子串出现时额外加分
+ * @param pattern 规范化后的关键词
+ * @param text 规范化后的文本
+ * @return 不匹配返回-1
+ */
+int SARibbonCommandSearchWorker::fuzzyScore(const QString& pattern, const QString& text)
+{
+    if (pattern.isEmpty() || text.size() < pattern.size()) {
+        return -1;
+    }
+    int score     = 0;
+    int pi        = 0;
+    int prevMatch = -2;
+    for (int ti = 0; ti < text.size() && pi < pattern.size(); ++ti) {
+        if (text.at(ti) != pattern.at(pi)) {
+            continue;
+        }
+        int s = 1;
+        if (ti == prevMatch + 1) {
+            s += 5;  // 连续匹配
+        }
+        if (0 == ti) {
+            s += 8;  // 文本开头
+        } else if (!text.at(ti - 1).isLetterOrNumber()) {
+            s += 6;  // 单词开头
+        }
+        score += s;
+        prevMatch = ti;
+        ++pi;
+    }
+    if (pi < pattern.size()) {
+        return -1;
+    }
+    const int pos = text.indexOf(pattern);
+    if (pos >= 0) {
+        score += (0 == pos) ? 20 : 10;
+    }
+    return score;
+}
+
+/**
+ * @brief 在快照中查找
+ *
+ * 多个关键词用空格分隔，每个关键词都要在某个字段匹配，每个关键词取各字段加权后的最高分，
+ * 文本的权重最高，其次是提示和category/pannel名字，最后是key
+ * @param serial 查询序号，序号过期时终止查找
+ * @param text 查询文本
+ */
+void SARibbonCommandSearchWorker::search(int serial, const QString& text)
+{
+    if (serial != mLatestSerial.loadAcquire()) {
+        return;
+    }
+    QSharedPointer< const Snapshot > snapshot;
+    {
+        QMutexLocker locker(&mMutex);
+        snapshot = mSnapshot;
+    }
+    const QStringList kws = sa_normalize_command_text(text).simplified().split(QLatin1Char(' '));
+    if (!snapshot || kws.isEmpty() || kws.first().isEmpty()) {
+        mResultsReady(serial, QVector< int >(), true);
+        return;
+    }
+    const int maxCount = qMax(1, mMaximumResultCount.loadAcquire());
+    // 得分高的在前，得分相同时文本短的在前
+    auto better = [ &snapshot ](const QPair< int, int >& a, const QPair< int, int >& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return snapshot->at(a.second).text.size() < snapshot->at(b.second).text.size();
+    };
+    QVector< QPair< int, int > > top;  // 得分，快照索引
+    top.reserve(maxCount + 1);
+    bool topChanged = false;
+    auto rowsOfTop  = [ &top ]() {
+        QVector< int > rows;
+        rows.reserve(top.size());
+        for (const QPair< int, int >& t : qAsConst(top)) {
+            rows.append(t.second);
+        }
+        return rows;
+    };
+    const int count = snapshot->size();
+    for (int i = 0; i < count; ++i) {
+        if (0 == (i % SA_COMMAND_SEARCH_CANCEL_CHECK_STEP) && serial != mLatestSerial.loadAcquire()) {
+            // 有新的查询，终止
+            return;
+        }
+        if (i > 0 && 0 == (i % SA_COMMAND_SEARCH_PARTIAL_RESULT_STEP) && topChanged) {
+            mResultsReady(serial, rowsOfTop(), false);
+            topChanged = false;
+        }
+        const Entry& e = snapshot->at(i);
+        int total      = 0;
+        for (const QString& k : kws) {
+            int best = fuzzyScore(k, e.text) * 4;
+            best     = qMax(best, fuzzyScore(k, e.toolTip) * 2);
+            best     = qMax(best, fuzzyScore(k, e.category) * 2);
+            best     = qMax(best, fuzzyScore(k, e.pannel) * 2);
+            best     = qMax(best, fuzzyScore(k, e.key));
+            if (best < 0) {
+                total = -1;
+                break;
+            }
+            total += best;
+        }
+        if (total < 0) {
+            continue;
+        }
+        const QPair< int, int > item(total, i);
+        if (top.size() >= maxCount && !better(item, top.last())) {
+            continue;
+        }
+        top.insert(std::upper_bound(top.begin(), top.end(), item, better), item);
+        if (top.size() > maxCount) {
+            top.removeLast();
+        }
+        topChanged = true;
+    }
+    mResultsReady(serial, rowsOfTop(), true);
+}
+
+//===================================================
+// SARibbonCommandSearchWidget::PrivateData
+//===================================================
+class SARibbonCommandSearchWidget::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonCommandSearchWidget)
+public:
+    PrivateData(SARibbonCommandSearchWidget* p);
+    void init();
+    // 清空快照后重新生成
+    void buildSnapshot();
+    // 安排一次和actionsManager的同步，多次变化只同步一次
+    void scheduleRefresh();
+    // 和actionsManager中的action比较，只处理新增和移除的action
+    void refreshEntries();
+    // action的文本或提示变化后更新对应的条目
+    void updateEntry(QAction* act);
+    // 把快照交给工作线程，有查询文本时用新快照重新查询
+    void publishSnapshot();
+    // 把查询投递到工作线程
+    void postSearch(int serial, const QString& text);
+    // 生成action对应的条目
+    SARibbonCommandSearchWorker::Entry makeEntry(QAction* act) const;
+    // 查找action所在的category和pannel
+    static void findOwner(QAction* act, QString& category, QString& pannel);
+    // 把结果显示在弹出列表中
+    void showResults(const QVector< int >& rows);
+
+public:
+    QPointer< SARibbonActionsManager > mMgr;
+    QThread* mThread { nullptr };
+    SARibbonCommandSearchWorker* mWorker { nullptr };
+    QCompleter* mCompleter { nullptr };
+    QStandardItemModel* mResultModel { nullptr };
+    SARibbonCommandSearchWorker::Snapshot mEntries;   ///< 界面线程维护的快照，移除的位置为空条目
+    QVector< QPointer< QAction > > mSnapshotActions;  ///< 和快照一一对应的action，移除的位置为nullptr
+    QHash< QAction*, int > mEntryIndex;               ///< action在快照中的位置
+    QVector< QPointer< QAction > > mResultActions;    ///< 和结果列表一一对应的action
+    int mHoleCount { 0 };                             ///< 快照中空条目的数量
+    int mSerial { 0 };                                ///< 查询序号
+    int mMaximumResultCount { 50 };
+    bool mRefreshPending { false };  ///< 已经安排了和actionsManager的同步
+    bool mHasSearchText { false };   ///< 当前是否有查询文本
+};
+
+SARibbonCommandSearchWidget::PrivateData::PrivateData(SARibbonCommandSearchWidget* p) : q_ptr(p)
+{
+}
+
+void SARibbonCommandSearchWidget::PrivateData::init()
+{
+    SARibbonCommandSearchWidget* q = q_ptr;
+    mThread                        = new QThread(q);
+    // 回调在工作线程中调用，通过QTimer::singleShot把结果投递回界面线程
+    mWorker = new SARibbonCommandSearchWorker([ q ](int serial, const QVector< int >& rows, bool finished) {
+        QTimer::singleShot(0, q, [ q, serial, rows, finished ]() { q->onResultsReady(serial, rows, finished); });
+    });
+    mWorker->setMaximumResultCount(mMaximumResultCount);
+    mWorker->moveToThread(mThread);
+    mThread->start();
+
+    mResultModel = new QStandardItemModel(q);
+    mCompleter   = new QCompleter(mResultModel, q);
+    mCompleter->setWidget(q);
+    mCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    mCompleter->setMaxVisibleItems(12);
+    q->connect(mCompleter,
+               QOverload< const QModelIndex& >::of(&QCompleter::activated),
+               q,
+               &SARibbonCommandSearchWidget::onResultActivated);
+    q->connect(q, &QLineEdit::textChanged, q, &SARibbonCommandSearchWidget::onTextChanged);
+    q->connect(q, &QLineEdit::returnPressed, q, &SARibbonCommandSearchWidget::onReturnPressed);
+    q->setClearButtonEnabled(true);
+}
+
+/**
+ * @brief 清空快照后重新生成，category和pannel的名字也会重新获取
+ */
+void SARibbonCommandSearchWidget::PrivateData::buildSnapshot()
+{
+    mEntries.clear();
+    mSnapshotActions.clear();
+    mEntryIndex.clear();
+    mHoleCount = 0;
+    refreshEntries();
+    if (mEntries.isEmpty()) {
+        // 没有任何条目时refreshEntries认为没有变化，不会把空快照交给工作线程
+        publishSnapshot();
+    }
+}
+
+/**
+ * @brief 安排一次和actionsManager的同步
+ *
+ * 标签的变化往往是成批的（例如autoRegisteActions），在事件循环中合并为一次同步，
+ * 同步不在输入的处理过程中进行，输入时只投递查询
+ */
+void SARibbonCommandSearchWidget::PrivateData::scheduleRefresh()
+{
+    if (mRefreshPending) {
+        return;
+    }
+    mRefreshPending = true;
+    QTimer::singleShot(0, q_ptr, [ this ]() {
+        if (mRefreshPending) {
+            refreshEntries();
+        }
+    });
+}
+
+/**
+ * @brief 和actionsManager中的action比较，增量更新快照
+ *
+ * 快照只包含规范化后的字符串，QAction指针保存在界面线程中。
+ * 新增的action追加到末尾，移除的action只把对应位置置空，已有条目的位置不变，
+ * 因此正在进行的查询结果依然有效；空条目过多时再统一压缩，压缩后位置变化，会使正在进行的查询过期
+ */
+void SARibbonCommandSearchWidget::PrivateData::refreshEntries()
+{
+    mRefreshPending = false;
+    bool changed    = false;
+    QSet< QAction* > alive;
+    if (mMgr) {
+        const QList< QAction* > acts = mMgr->allActions();
+        alive.reserve(acts.size());
+        for (QAction* a : acts) {
+            if (!a || a->isSeparator() || a->text().isEmpty()) {
+                continue;
+            }
+            alive.insert(a);
+            const int i = mEntryIndex.value(a, -1);
+            if (i >= 0 && mSnapshotActions.at(i) == a) {
+                continue;
+            }
+            // 新增的action，或者原来的action已经销毁、地址被新的action复用
+            mEntryIndex.insert(a, mEntries.size());
+            mEntries.append(makeEntry(a));
+            mSnapshotActions.append(QPointer< QAction >(a));
+            changed = true;
+            if (i >= 0) {
+                mEntries[ i ]         = SARibbonCommandSearchWorker::Entry();
+                mSnapshotActions[ i ] = nullptr;
+                ++mHoleCount;
+            }
+        }
+    }
+    for (auto i = mEntryIndex.begin(); i != mEntryIndex.end();) {
+        if (alive.contains(i.key())) {
+            ++i;
+            continue;
+        }
+        mEntries[ i.value() ]         = SARibbonCommandSearchWorker::Entry();
+        mSnapshotActions[ i.value() ] = nullptr;
+        ++mHoleCount;
+        changed = true;
+        i       = mEntryIndex.erase(i);
+    }
+    if (!changed) {
+        return;
+    }
+    if (mHoleCount > 16 && mHoleCount * 2 > mEntries.size()) {
+        SARibbonCommandSearchWorker::Snapshot entries;
+        QVector< QPointer< QAction > > acts;
+        entries.reserve(mEntryIndex.size());
+        acts.reserve(mEntryIndex.size());
+        mEntryIndex.clear();
+        for (int i = 0; i < mEntries.size(); ++i) {
+            if (QAction* a = mSnapshotActions.at(i)) {
+                mEntryIndex.insert(a, entries.size());
+                entries.append(mEntries.at(i));
+                acts.append(mSnapshotActions.at(i));
+            }
+        }
+        mEntries         = entries;
+        mSnapshotActions = acts;
+        mHoleCount       = 0;
+        // 位置发生了变化，正在进行的查询结果不再对应
+        mWorker->setLatestSerial(++mSerial);
+    }
+    publishSnapshot();
+}
+
+/**
+ * @brief action的文本或提示变化后更新对应的条目，其余的变化（例如enabled、checked）不需要更新
+ * @param act
+ */
+void SARibbonCommandSearchWidget::PrivateData::updateEntry(QAction* act)
+{
+    const int i = mEntryIndex.value(act, -1);
+    if (i < 0 || mSnapshotActions.at(i) != act) {
+        if (!act->isSeparator() && !act->text().isEmpty()) {
+            // 之前文本为空没有加入快照
+            scheduleRefresh();
+        }
+        return;
+    }
+    const QString text                    = sa_normalize_command_text(act->text());
+    const QString toolTip                 = sa_normalize_command_text(act->toolTip());
+    SARibbonCommandSearchWorker::Entry& e = mEntries[ i ];
+    if (e.text == text && e.toolTip == toolTip) {
+        return;
+    }
+    if (text.isEmpty()) {
+        scheduleRefresh();
+        return;
+    }
+    e.text    = text;
+    e.toolTip = toolTip;
+    publishSnapshot();
+}
+
+/**
+ * @brief 把快照交给工作线程
+ *
+ * 快照是隐式共享的，交给工作线程只是增加引用计数，之后界面线程修改快照时才会复制
+ */
+void SARibbonCommandSearchWidget::PrivateData::publishSnapshot()
+{
+    mWorker->setSnapshot(QSharedPointer< const SARibbonCommandSearchWorker::Snapshot >(
+        new SARibbonCommandSearchWorker::Snapshot(mEntries)));
+    const QString text = q_ptr->text();
+    if (!text.trimmed().isEmpty()) {
+        const int serial = ++mSerial;
+        mWorker->setLatestSerial(serial);
+        postSearch(serial, text);
+    }
+}
+
+/**
+ * @brief 生成action对应的条目，字符串都已经规范化
+ */
+SARibbonCommandSearchWorker::Entry SARibbonCommandSearchWidget::PrivateData::makeEntry(QAction* act) const
+{
+    SARibbonCommandSearchWorker::Entry e;
+    e.text    = sa_normalize_command_text(act->text());
+    e.toolTip = sa_normalize_command_text(act->toolTip());
+    e.key     = sa_normalize_command_text(mMgr->key(act));
+    findOwner(act, e.category, e.pannel);
+    e.category = sa_normalize_command_text(e.category);
+    e.pannel   = sa_normalize_command_text(e.pannel);
+    return e;
+}
+
+void SARibbonCommandSearchWidget::PrivateData::postSearch(int serial, const QString& text)
+{
+    SARibbonCommandSearchWorker* worker = mWorker;
+    QTimer::singleShot(0, worker, [ worker, serial, text ]() { worker->search(serial, text); });
+}
+
+/**
+ * @brief 通过action关联的窗口查找其所在的category和pannel
+ */
+void SARibbonCommandSearchWidget::PrivateData::findOwner(QAction* act, QString& category, QString& pannel)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const QList< QObject* > objs = act->associatedObjects();
+#else
+    const QList< QWidget* > objs = act->associatedWidgets();
+#endif
+    for (QObject* o : objs) {
+        for (QObject* w = o; w; w = w->parent()) {
+            if (pannel.isEmpty()) {
+                if (SARibbonPannel* p = qobject_cast< SARibbonPannel* >(w)) {
+                    pannel = p->pannelName();
+                }
+            }
+            if (SARibbonCategory* c = qobject_cast< SARibbonCategory* >(w)) {
+                category = c->categoryName();
+                return;
+            }
+        }
+    }
+}
+
+void SARibbonCommandSearchWidget::PrivateData::showResults(const QVector< int >& rows)
+{
+    SARibbonCommandSearchWidget* q = q_ptr;
+    mResultModel->clear();
+    mResultActions.clear();
+    for (int r : rows) {
+        QAction* a = mSnapshotActions.value(r);
+        if (!a) {
+            continue;
+        }
+        QStandardItem* item = new QStandardItem(a->icon(), QString(a->text()).remove(QLatin1Char('&')));
+        item->setEnabled(a->isEnabled());
+        item->setToolTip(a->toolTip());
+        mResultModel->appendRow(item);
+        // 快照压缩后行号会变化，结果列表直接记录action
+        mResultActions.append(QPointer< QAction >(a));
+    }
+    if (mResultModel->rowCount() > 0 && q->hasFocus()) {
+        mCompleter->complete();
+    } else {
+        mCompleter->popup()->hide();
+    }
+}
+
+//===================================================
+// SARibbonCommandSearchWidget
+//===================================================
+
+SARibbonCommandSearchWidget::SARibbonCommandSearchWidget(QWidget* parent)
+    : SARibbonLineEdit(parent), d_ptr(new SARibbonCommandSearchWidget::PrivateData(this))
+{
+    d_ptr->init();
+}
+
+SARibbonCommandSearchWidget::SARibbonCommandSearchWidget(SARibbonActionsManager* mgr, QWidget* parent)
+    : SARibbonLineEdit(parent), d_ptr(new SARibbonCommandSearchWidget::PrivateData(this))
+{
+    d_ptr->init();
+    setActionsManager(mgr);
+}
+
+SARibbonCommandSearchWidget::~SARibbonCommandSearchWidget()
+{
+    // 让正在进行的查询尽快结束
+    d_ptr->mWorker->setLatestSerial(++(d_ptr->mSerial));
+    d_ptr->mThread->quit();
+    d_ptr->mThread->wait();
+    delete d_ptr->mWorker;
+}
+
+/**
+ * @brief 设置搜索的actionsManager
+ * @param mgr
+ */
+void SARibbonCommandSearchWidget::setActionsManager(SARibbonActionsManager* mgr)
+{
+    if (d_ptr->mMgr == mgr) {
+        return;
+    }
+    if (d_ptr->mMgr) {
+        disconnect(d_ptr->mMgr.data(),
+                   &SARibbonActionsManager::actionTagChanged,
+                   this,
+                   &SARibbonCommandSearchWidget::onSnapshotOutdated);
+        disconnect(d_ptr->mMgr.data(),
+                   &SARibbonActionsManager::actionChanged,
+                   this,
+                   &SARibbonCommandSearchWidget::onActionChanged);
+    }
+    d_ptr->mMgr = mgr;
+    if (mgr) {
+        connect(mgr, &SARibbonActionsManager::actionTagChanged, this, &SARibbonCommandSearchWidget::onSnapshotOutdated);
+        connect(mgr, &SARibbonActionsManager::actionChanged, this, &SARibbonCommandSearchWidget::onActionChanged);
+    }
+    // 更换manager后原有的条目都没有意义，旧的结果也要清空
+    d_ptr->mWorker->setLatestSerial(++(d_ptr->mSerial));
+    d_ptr->showResults(QVector< int >());
+    d_ptr->buildSnapshot();
+}
+
+SARibbonActionsManager* SARibbonCommandSearchWidget::actionsManager() const
+{
+    return d_ptr->mMgr.data();
+}
+
+/**
+ * @brief 设置搜索结果的最大数量，默认为50
+ * @param c
+ */
+void SARibbonCommandSearchWidget::setMaximumResultCount(int c)
+{
+    d_ptr->mMaximumResultCount = c;
+    d_ptr->mWorker->setMaximumResultCount(c);
+}
+
+int SARibbonCommandSearchWidget::maximumResultCount() const
+{
+    return d_ptr->mMaximumResultCount;
+}
+
+/**
+ * @brief 重新生成搜索快照
+ *
+ * action的文本和提示变化以及标签变化会自动增量更新到快照中，
+ * category或pannel改名后，可调用此函数让搜索使用最新的名字
+ */
+void SARibbonCommandSearchWidget::updateSnapshot()
+{
+    // 所有位置都会变化，正在进行的查询结果不再对应
+    d_ptr->mWorker->setLatestSerial(++(d_ptr->mSerial));
+    d_ptr->buildSnapshot();
+}
+
+void SARibbonCommandSearchWidget::onTextChanged(const QString& text)
+{
+    if (text.trimmed().isEmpty()) {
+        d_ptr->mHasSearchText = false;
+        d_ptr->mWorker->setLatestSerial(++(d_ptr->mSerial));
+        d_ptr->showResults(QVector< int >());
+        return;
+    }
+    if (!d_ptr->mHasSearchText) {
+        // 开始一次新的查找，向已有标签注册action不会有信号，在事件循环中同步一次，
+        // 同步只对新增的action生成条目，完成后会用新快照重新查询
+        d_ptr->mHasSearchText = true;
+        d_ptr->scheduleRefresh();
+    }
+    // 快照在标签或action变化时增量更新，输入时只投递查询
+    const int serial = ++(d_ptr->mSerial);
+    d_ptr->mWorker->setLatestSerial(serial);
+    d_ptr->postSearch(serial, text);
+}
+
+void SARibbonCommandSearchWidget::onResultsReady(int serial, const QVector< int >& rows, bool finished)
+{
+    Q_UNUSED(finished);
+    if (serial != d_ptr->mSerial) {
+        // 过期的结果
+        return;
+    }
+    d_ptr->showResults(rows);
+}
+
+void SARibbonCommandSearchWidget::onResultActivated(const QModelIndex& index)
+{
+    QAction* act = d_ptr->mResultActions.value(index.row());
+    if (!act || !act->isEnabled()) {
+        return;
+    }
+    clear();
+    act->trigger();
+    emit actionTriggered(act);
+}
+
+/**
+ * @brief 回车触发第一个结果
+ */
+void SARibbonCommandSearchWidget::onReturnPressed()
+{
+    if (d_ptr->mCompleter->popup()->isVisible() && d_ptr->mCompleter->popup()->currentIndex().isValid()) {
+        // 弹出列表中有选中项，由QCompleter处理
+        return;
+    }
+    if (d_ptr->mResultModel->rowCount() > 0) {
+        onResultActivated(d_ptr->mResultModel->index(0, 0));
+    }
+}
+
+void SARibbonCommandSearchWidget::onSnapshotOutdated()
+{
+    d_ptr->scheduleRefresh();
+}
+
+void SARibbonCommandSearchWidget::onActionChanged(QAction* act)
+{
+    d_ptr->updateEntry(act);
+}
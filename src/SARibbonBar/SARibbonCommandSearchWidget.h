@@ -0,0 +1,61 @@
+﻿#ifndef SARIBBONCOMMANDSEARCHWIDGET_H
+#define SARIBBONCOMMANDSEARCHWIDGET_H
+#include "SARibbonGlobal.h"
+#include <QVector>
+#include "SARibbonLineEdit.h"
+class QAction;
+class QModelIndex;
+class SARibbonActionsManager;
+
+/**
+ * @brief 命令搜索框（类似office的“告诉我你想要做什么”）
+ *
+ * 基于@ref SARibbonActionsManager 管理的action进行搜索，输入时对action的文本、提示、key以及所在的category和pannel
+ * 进行模糊匹配，匹配结果按得分排序后以弹出列表显示，选中结果会触发对应的action
+ *
+ * 匹配在工作线程中进行，匹配对象是action信息的一份快照，输入过程中不会阻塞界面，
+ * 匹配过程中会不断返回中间结果，新的输入会终止旧的匹配
+ *
+ * @code
+ * SARibbonActionsManager* mgr        = new SARibbonActionsManager(ribbonBar);
+ * SARibbonCommandSearchWidget* search = new SARibbonCommandSearchWidget(mgr, this);
+ * ribbonBar->rightButtonGroup()->addWidget(search);
+ * @endcode
+ *
+ * 快照在界面线程中维护，SARibbonActionsManager的标签变化后在事件循环中增量同步（只处理新增和移除的action），
+ * action的文本和提示变化后只更新对应的条目，输入时不会生成快照；
+ * category或pannel改名后，需要通过@ref updateSnapshot 主动重新生成
+ */
+class SA_RIBBON_EXPORT SARibbonCommandSearchWidget : public SARibbonLineEdit
+{
+    Q_OBJECT
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonCommandSearchWidget)
+public:
+    explicit SARibbonCommandSearchWidget(QWidget* parent = nullptr);
+    explicit SARibbonCommandSearchWidget(SARibbonActionsManager* mgr, QWidget* parent = nullptr);
+    ~SARibbonCommandSearchWidget() Q_DECL_OVERRIDE;
+    // 设置搜索的actionsManager
+    void setActionsManager(SARibbonActionsManager* mgr);
+    SARibbonActionsManager* actionsManager() const;
+    // 搜索结果的最大数量
+    void setMaximumResultCount(int c);
+    int maximumResultCount() const;
+    // 重新生成搜索快照
+    void updateSnapshot();
+signals:
+    /**
+     * @brief 通过搜索结果触发了action
+     * @param act
+     */
+    void actionTriggered(QAction* act);
+
+private slots:
+    void onTextChanged(const QString& text);
+    void onResultsReady(int serial, const QVector< int >& rows, bool finished);
+    void onResultActivated(const QModelIndex& index);
+    void onReturnPressed();
+    void onSnapshotOutdated();
+    void onActionChanged(QAction* act);
+};
+
+#endif  // SARIBBONCOMMANDSEARCHWIDGET_H
@@ -0,0 +1,496 @@
+﻿#include "SARibbonCommandUpdater.h"
+#include <QAction>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QHash>
+#include <QMap>
+#include <QPointer>
+#include <QTimer>
+#include "SARibbonActionsManager.h"
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+
+class SARibbonCommandUpdater::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonCommandUpdater)
+public:
+    /**
+     * @brief action更新的优先级
+     */
+    enum Priority
+    {
+        PriorityVisible,    ///< 当前可见
+        PriorityNotRibbon,  ///< 不在ribbon的category中
+        PrioritySkip        ///< 只在未显示的category中，跳过
+    };
+    /**
+     * @brief action所在位置的缓存，action关联的窗口数量变化时失效
+     */
+    struct OwnerCache
+    {
+        QPointer< QAction > action;  ///< 缓存的action，action删除后缓存失效
+        int widgetCount;             ///< 缓存时action关联的窗口数量
+        bool inCategory;             ///< 关联的窗口是否都在category中
+    };
+    PrivateData(SARibbonCommandUpdater* p);
+    // 判断action的更新优先级
+    Priority priority(QAction* act);
+    // 生成本轮的回调表
+    void buildCycleUpdaters();
+    // 开始新的一轮分类
+    void beginCycle();
+    // 分类下一个action，没有需要分类的action时返回false
+    bool classifyNext();
+    // 是否还有需要在空闲时处理的工作
+    bool hasIdleWork() const;
+    // 是否可以进行更新
+    bool canUpdate() const;
+    // 有等待更新的action时启动空闲定时器
+    void startIdle();
+    // 根据状态启停定时更新
+    void updateIntervalTimer();
+
+public:
+    QPointer< SARibbonBar > mBar;
+    QPointer< SARibbonActionsManager > mMgr;
+    QHash< QAction*, FpActionUpdater > mActionUpdaters;  ///< action对应的回调
+    QMap< int, FpActionUpdater > mTagUpdaters;           ///< tag对应的回调
+    QHash< QAction*, FpActionUpdater > mCycleUpdaters;   ///< 本轮更新的回调表，由action和tag的回调合并而来
+    QList< QPointer< QAction > > mQueue;                 ///< 等待更新的可见action
+    QList< QPointer< QAction > > mNotRibbon;             ///< 等待更新的不在ribbon的category中的action
+    QList< QPointer< QAction > > mDeferred;              ///< 只在未显示的category中，延后更新的action
+    QHash< QAction*, OwnerCache > mOwnerCache;           ///< action所在位置的缓存
+    QList< QAction* > mClassifyActions;                  ///< 正在分类的action列表
+    int mClassifyPos { 0 };                              ///< mClassifyActions中下一个分类的位置
+    int mClassifyTag { -1 };                             ///< mClassifyActions对应的tag，-1代表action的回调
+    QList< int > mClassifyTags;                          ///< 还没有分类的tag
+    bool mIsCyclePending { false };                      ///< 请求了新的一轮更新，还没有开始
+    bool mIsClassifying { false };                       ///< 本轮还有没分类的action
+    QTimer* mIdleTimer { nullptr };                      ///< 空闲时更新的定时器
+    QTimer* mIntervalTimer { nullptr };                  ///< 定时更新的定时器
+    int mTimeBudget { 5 };
+};
+
+SARibbonCommandUpdater::PrivateData::PrivateData(SARibbonCommandUpdater* p) : q_ptr(p)
+{
+}
+
+/**
+ * @brief 通过action关联的窗口判断更新优先级
+ *
+ * 关联的窗口是否在category中需要遍历父窗口，结果会缓存，只在关联的窗口数量变化时重新计算
+ * @param act
+ * @return
+ */
+SARibbonCommandUpdater::PrivateData::Priority SARibbonCommandUpdater::PrivateData::priority(QAction* act)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const QList< QObject* > objs = act->associatedObjects();
+#else
+    const QList< QWidget* > objs = act->associatedWidgets();
+#endif
+    if (objs.isEmpty()) {
+        return PriorityNotRibbon;
+    }
+    for (QObject* o : objs) {
+        QWidget* w = qobject_cast< QWidget* >(o);
+        if (w && w->isVisible()) {
+            return PriorityVisible;
+        }
+    }
+    auto ite = mOwnerCache.find(act);
+    if (ite == mOwnerCache.end() || ite.value().action != act || ite.value().widgetCount != objs.size()) {
+        bool inCategory = true;
+        for (QObject* o : objs) {
+            QWidget* par = qobject_cast< QWidget* >(o);
+            while (par && !qobject_cast< SARibbonCategory* >(par)) {
+                par = par->parentWidget();
+            }
+            if (nullptr == par) {
+                inCategory = false;
+                break;
+            }
+        }
+        ite = mOwnerCache.insert(act, OwnerCache { act, int(objs.size()), inCategory });
+    }
+    return ite.value().inCategory ? PrioritySkip : PriorityNotRibbon;
+}
+
+/**
+ * @brief 合并action和tag的回调，action的回调优先，tag按从小到大的顺序优先
+ */
+void SARibbonCommandUpdater::PrivateData::buildCycleUpdaters()
+{
+    mCycleUpdaters = mActionUpdaters;
+    if (!mMgr) {
+        return;
+    }
+    for (auto i = mTagUpdaters.begin(); i != mTagUpdaters.end(); ++i) {
+        const QList< QAction* > acts = mMgr->actions(i.key());
+        for (QAction* a : acts) {
+            if (!mCycleUpdaters.contains(a)) {
+                mCycleUpdaters.insert(a, i.value());
+            }
+        }
+    }
+}
+
+/**
+ * @brief 开始新的一轮分类，清空上一轮还没有更新完的action
+ */
+void SARibbonCommandUpdater::PrivateData::beginCycle()
+{
+    mIsCyclePending = false;
+    mIsClassifying  = true;
+    mCycleUpdaters.clear();
+    mQueue.clear();
+    mNotRibbon.clear();
+    mDeferred.clear();
+    mClassifyActions = mActionUpdaters.keys();
+    mClassifyPos     = 0;
+    mClassifyTag     = -1;
+    mClassifyTags    = mTagUpdaters.keys();
+}
+
+/**
+ * @brief 分类下一个action并放入对应的队列
+ *
+ * 先分类有action回调的action，再按tag从小到大的顺序分类tag下的action，已经分类过的action跳过，
+ * tag下的action在分类到这个tag时才从actionsManager获取
+ * @return 本轮所有action都已经分类时返回false
+ */
+bool SARibbonCommandUpdater::PrivateData::classifyNext()
+{
+    while (mIsClassifying) {
+        if (mClassifyPos >= mClassifyActions.size()) {
+            if (mClassifyTags.isEmpty() || !mMgr) {
+                mIsClassifying = false;
+                mClassifyActions.clear();
+                mClassifyTags.clear();
+                if (mOwnerCache.size() > 2 * mCycleUpdaters.size()) {
+                    // 移除已经删除的action的缓存
+                    for (auto i = mOwnerCache.begin(); i != mOwnerCache.end();) {
+                        if (i.value().action.isNull()) {
+                            i = mOwnerCache.erase(i);
+                        } else {
+                            ++i;
+                        }
+                    }
+                }
+                break;
+            }
+            mClassifyTag     = mClassifyTags.takeFirst();
+            mClassifyActions = static_cast< const SARibbonActionsManager* >(mMgr.data())->actions(mClassifyTag);
+            mClassifyPos     = 0;
+            continue;
+        }
+        QAction* a = mClassifyActions.at(mClassifyPos++);
+        if (mCycleUpdaters.contains(a)) {
+            continue;
+        }
+        FpActionUpdater fp;
+        if (mClassifyTag < 0) {
+            fp = mActionUpdaters.value(a);
+        } else if (!mActionUpdaters.contains(a) && !mMgr->key(a).isEmpty()) {
+            // 分类过程中action可能已经从actionsManager中移除
+            fp = mTagUpdaters.value(mClassifyTag);
+        }
+        if (!fp) {
+            continue;
+        }
+        mCycleUpdaters.insert(a, fp);
+        switch (priority(a)) {
+        case PriorityVisible:
+            mQueue.append(a);
+            break;
+        case PriorityNotRibbon:
+            mNotRibbon.append(a);
+            break;
+        default:
+            mDeferred.append(a);
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool SARibbonCommandUpdater::PrivateData::hasIdleWork() const
+{
+    return (mIsCyclePending || mIsClassifying || !mQueue.isEmpty() || !mNotRibbon.isEmpty());
+}
+
+/**
+ * @brief 窗口不可见、最小化或程序不处于激活状态时不更新
+ * @return
+ */
+bool SARibbonCommandUpdater::PrivateData::canUpdate() const
+{
+    if (!mBar || !mBar->isVisible()) {
+        return false;
+    }
+    if (mBar->window()->isMinimized()) {
+        return false;
+    }
+    return (QGuiApplication::applicationState() == Qt::ApplicationActive);
+}
+
+void SARibbonCommandUpdater::PrivateData::startIdle()
+{
+    // 是否可以更新在onIdle中判断，不能更新时定时器会停止
+    if (hasIdleWork() && !mIdleTimer->isActive()) {
+        mIdleTimer->start();
+    }
+}
+
+void SARibbonCommandUpdater::PrivateData::updateIntervalTimer()
+{
+    if (mIntervalTimer->interval() > 0 && canUpdate()) {
+        if (!mIntervalTimer->isActive()) {
+            mIntervalTimer->start();
+        }
+    } else {
+        mIntervalTimer->stop();
+    }
+}
+
+//===================================================
+// SARibbonCommandUpdater
+//===================================================
+
+/**
+ * @brief 构造函数
+ * @param bar 调度器会作为bar的子对象
+ * @param mgr tag回调需要通过actionsManager获取tag下的action
+ */
+SARibbonCommandUpdater::SARibbonCommandUpdater(SARibbonBar* bar, SARibbonActionsManager* mgr)
+    : QObject(bar), d_ptr(new SARibbonCommandUpdater::PrivateData(this))
+{
+    d_ptr->mBar       = bar;
+    d_ptr->mMgr       = mgr;
+    d_ptr->mIdleTimer = new QTimer(this);
+    d_ptr->mIdleTimer->setInterval(0);
+    d_ptr->mIntervalTimer = new QTimer(this);
+    d_ptr->mIntervalTimer->setInterval(0);
+    connect(d_ptr->mIdleTimer, &QTimer::timeout, this, &SARibbonCommandUpdater::onIdle);
+    connect(d_ptr->mIntervalTimer, &QTimer::timeout, this, &SARibbonCommandUpdater::requestUpdate);
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &SARibbonCommandUpdater::onApplicationStateChanged);
+    if (bar) {
+        connect(bar, &SARibbonBar::currentRibbonTabChanged, this, &SARibbonCommandUpdater::onCurrentRibbonTabChanged);
+        // 窗口显示、隐藏以及最小化时ribbonbar都会收到show/hide事件
+        bar->installEventFilter(this);
+    }
+}
+
+SARibbonCommandUpdater::~SARibbonCommandUpdater()
+{
+}
+
+void SARibbonCommandUpdater::setActionsManager(SARibbonActionsManager* mgr)
+{
+    d_ptr->mMgr = mgr;
+}
+
+SARibbonActionsManager* SARibbonCommandUpdater::actionsManager() const
+{
+    return d_ptr->mMgr.data();
+}
+
+/**
+ * @brief 为action设置状态回调
+ * @param act
+ * @param fp 回调函数，传入空函数取消设置
+ * @note 回调只会在@ref requestUpdate 之后生效
+ */
+void SARibbonCommandUpdater::setActionUpdater(QAction* act, const FpActionUpdater& fp)
+{
+    if (nullptr == act) {
+        return;
+    }
+    if (fp) {
+        d_ptr->mActionUpdaters.insert(act, fp);
+        connect(act, &QObject::destroyed, this, &SARibbonCommandUpdater::onActionDestroyed, Qt::UniqueConnection);
+    } else {
+        d_ptr->mActionUpdaters.remove(act);
+        disconnect(act, &QObject::destroyed, this, &SARibbonCommandUpdater::onActionDestroyed);
+    }
+}
+
+/**
+ * @brief 为tag下的所有action设置状态回调
+ *
+ * tag下的action在每次@ref requestUpdate 时通过actionsManager获取，因此tag中后续加入的action同样有效
+ * @param tag
+ * @param fp 回调函数，传入空函数取消设置
+ * @note 一个action属于多个有回调的tag时，只调用值最小的tag的回调
+ */
+void SARibbonCommandUpdater::setTagUpdater(int tag, const FpActionUpdater& fp)
+{
+    if (fp) {
+        d_ptr->mTagUpdaters.insert(tag, fp);
+    } else {
+        d_ptr->mTagUpdaters.remove(tag);
+    }
+}
+
+/**
+ * @brief 设置每次空闲时最多占用的时间
+ * @param ms 毫秒，最小为1
+ */
+void SARibbonCommandUpdater::setTimeBudget(int ms)
+{
+    d_ptr->mTimeBudget = qMax(1, ms);
+}
+
+int SARibbonCommandUpdater::timeBudget() const
+{
+    return d_ptr->mTimeBudget;
+}
+
+/**
+ * @brief 设置定时更新的间隔
+ *
+ * 定时器只在窗口可见且程序激活时运行
+ * @param ms 毫秒，小于等于0不定时更新
+ */
+void SARibbonCommandUpdater::setUpdateInterval(int ms)
+{
+    d_ptr->mIntervalTimer->setInterval(qMax(0, ms));
+    d_ptr->updateIntervalTimer();
+}
+
+int SARibbonCommandUpdater::updateInterval() const
+{
+    return d_ptr->mIntervalTimer->interval();
+}
+
+/**
+ * @brief 请求在空闲时更新所有action的状态
+ *
+ * 此函数只做标记，action的收集和分类都在空闲时按时间预算分片进行，
+ * 多次调用会合并，上一轮还没有更新完的action会按新的顺序重新排队
+ */
+void SARibbonCommandUpdater::requestUpdate()
+{
+    d_ptr->mIsCyclePending = true;
+    d_ptr->startIdle();
+}
+
+/**
+ * @brief 立即更新所有action的状态，包括未显示的category中的action
+ */
+void SARibbonCommandUpdater::updateNow()
+{
+    d_ptr->buildCycleUpdaters();
+    d_ptr->mQueue.clear();
+    d_ptr->mNotRibbon.clear();
+    d_ptr->mDeferred.clear();
+    d_ptr->mClassifyActions.clear();
+    d_ptr->mClassifyTags.clear();
+    d_ptr->mIsCyclePending = false;
+    d_ptr->mIsClassifying  = false;
+    d_ptr->mIdleTimer->stop();
+    if (d_ptr->mBar) {
+        d_ptr->mBar->beginActionStateUpdate();
+    }
+    for (auto i = d_ptr->mCycleUpdaters.begin(); i != d_ptr->mCycleUpdaters.end(); ++i) {
+        i.value()(i.key());
+    }
+    if (d_ptr->mBar) {
+        d_ptr->mBar->endActionStateUpdate();
+    }
+}
+
+bool SARibbonCommandUpdater::isUpdatePending() const
+{
+    return (d_ptr->hasIdleWork() || !d_ptr->mDeferred.isEmpty());
+}
+
+bool SARibbonCommandUpdater::eventFilter(QObject* obj, QEvent* e)
+{
+    if (obj == d_ptr->mBar && (e->type() == QEvent::Show || e->type() == QEvent::Hide)) {
+        d_ptr->startIdle();
+        d_ptr->updateIntervalTimer();
+    }
+    return QObject::eventFilter(obj, e);
+}
+
+/**
+ * @brief 空闲时在时间预算内依次分类action并调用回调
+ *
+ * 可见的action分类后立即更新，不在ribbon的category中的action等本轮分类完成后再更新
+ */
+void SARibbonCommandUpdater::onIdle()
+{
+    if (!d_ptr->canUpdate() || !d_ptr->hasIdleWork()) {
+        d_ptr->mIdleTimer->stop();
+        return;
+    }
+    QElapsedTimer t;
+    t.start();
+    if (d_ptr->mIsCyclePending) {
+        d_ptr->beginCycle();
+    }
+    d_ptr->mBar->beginActionStateUpdate();
+    while (t.elapsed() < d_ptr->mTimeBudget) {
+        QAction* a = nullptr;
+        if (!d_ptr->mQueue.isEmpty()) {
+            a = d_ptr->mQueue.takeFirst().data();
+        } else if (d_ptr->mIsClassifying) {
+            d_ptr->classifyNext();
+            continue;
+        } else if (!d_ptr->mNotRibbon.isEmpty()) {
+            a = d_ptr->mNotRibbon.takeFirst().data();
+        } else {
+            break;
+        }
+        if (nullptr == a) {
+            continue;
+        }
+        const FpActionUpdater fp = d_ptr->mCycleUpdaters.value(a);
+        if (fp) {
+            fp(a);
+        }
+    }
+    d_ptr->mBar->endActionStateUpdate();
+    if (!d_ptr->hasIdleWork()) {
+        d_ptr->mIdleTimer->stop();
+    }
+}
+
+/**
+ * @brief category切换后，把延后的并且已经可见的action提到队列最前面
+ * @param index
+ */
+void SARibbonCommandUpdater::onCurrentRibbonTabChanged(int index)
+{
+    Q_UNUSED(index);
+    QList< QPointer< QAction > > visible;
+    for (auto i = d_ptr->mDeferred.begin(); i != d_ptr->mDeferred.end();) {
+        if (i->isNull()) {
+            i = d_ptr->mDeferred.erase(i);
+        } else if (d_ptr->priority(i->data()) != PrivateData::PrioritySkip) {
+            visible.append(*i);
+            i = d_ptr->mDeferred.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    if (visible.isEmpty()) {
+        return;
+    }
+    d_ptr->mQueue = visible + d_ptr->mQueue;
+    d_ptr->startIdle();
+}
+
+void SARibbonCommandUpdater::onApplicationStateChanged(Qt::ApplicationState state)
+{
+    Q_UNUSED(state);
+    d_ptr->startIdle();
+    d_ptr->updateIntervalTimer();
+}
+
+void SARibbonCommandUpdater::onActionDestroyed(QObject* o)
+{
+    d_ptr->mActionUpdaters.remove(static_cast< QAction* >(o));
+}
@@ -0,0 +1,75 @@
+﻿#ifndef SARIBBONCOMMANDUPDATER_H
+#define SARIBBONCOMMANDUPDATER_H
+#include "SARibbonGlobal.h"
+#include <QObject>
+#include <functional>
+class QAction;
+class SARibbonBar;
+class SARibbonActionsManager;
+
+/**
+ * @brief action状态的更新调度器（类似MFC的ON_UPDATE_COMMAND_UI）
+ *
+ * 应用程序为action或者@ref SARibbonActionsManager 的tag注册状态回调函数，回调函数中根据程序的状态设置action的
+ * enable、checked等属性，调度器在事件循环空闲时调用这些回调，每次只占用@ref timeBudget 指定的时间，
+ * 剩余的留到下一次空闲时继续，不会阻塞界面
+ *
+ * 调用的顺序：
+ * - 当前可见的action优先（当前category、快速响应栏、右侧按钮组中的action）
+ * - 其次是不在ribbon category中的action（例如菜单中的action）
+ * - 只存在于未显示的category中的action会被跳过，等这个category显示时再更新
+ *
+ * 程序状态变化（例如选中对象变化）时调用@ref requestUpdate 即可，也可通过@ref setUpdateInterval 定时更新，
+ * 窗口不可见、最小化或应用程序不处于激活状态时不会进行任何计算
+ *
+ * 每个时间片内的action变化通过@ref SARibbonBar::beginActionStateUpdate 合并布局
+ *
+ * @code
+ * SARibbonCommandUpdater* updater = new SARibbonCommandUpdater(ribbonBar, actionsManager);
+ * updater->setActionUpdater(actCopy, [ this ](QAction* a) { a->setEnabled(hasSelection()); });
+ * updater->setTagUpdater(editTag, [ this ](QAction* a) { a->setEnabled(!isReadOnly()); });
+ * // 选中对象变化时
+ * updater->requestUpdate();
+ * @endcode
+ */
+class SA_RIBBON_EXPORT SARibbonCommandUpdater : public QObject
+{
+    Q_OBJECT
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonCommandUpdater)
+public:
+    using FpActionUpdater = std::function< void(QAction*) >;
+
+public:
+    explicit SARibbonCommandUpdater(SARibbonBar* bar, SARibbonActionsManager* mgr = nullptr);
+    ~SARibbonCommandUpdater();
+    // 设置actionsManager，tag回调依赖actionsManager
+    void setActionsManager(SARibbonActionsManager* mgr);
+    SARibbonActionsManager* actionsManager() const;
+    // 为action设置状态回调，传入空函数取消设置，action回调优先于tag回调
+    void setActionUpdater(QAction* act, const FpActionUpdater& fp);
+    // 为tag下的所有action设置状态回调，传入空函数取消设置
+    void setTagUpdater(int tag, const FpActionUpdater& fp);
+    // 每次空闲时最多占用的时间（毫秒），默认为5ms
+    void setTimeBudget(int ms);
+    int timeBudget() const;
+    // 定时更新的间隔（毫秒），小于等于0不定时更新，默认为0
+    void setUpdateInterval(int ms);
+    int updateInterval() const;
+    // 请求在空闲时更新所有action的状态
+    void requestUpdate();
+    // 立即更新所有action的状态（包括未显示的category中的action）
+    void updateNow();
+    // 是否还有等待更新的action
+    bool isUpdatePending() const;
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* e) Q_DECL_OVERRIDE;
+
+private slots:
+    void onIdle();
+    void onCurrentRibbonTabChanged(int index);
+    void onApplicationStateChanged(Qt::ApplicationState state);
+    void onActionDestroyed(QObject* o);
+};
+
+#endif  // SARIBBONCOMMANDUPDATER_H
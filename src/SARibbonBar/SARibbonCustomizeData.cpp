@@ -1,7 +1,9 @@
 ﻿#include "SARibbonCustomizeData.h"
 #include "SARibbonBar.h"
 #include <QDebug>
+#include <QHash>
 #include <QObject>
+#include <QVector>
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// SARibbonCustomizeData
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -553,141 +555,287 @@ void SARibbonCustomizeData::setCanCustomize(QObject* obj, bool canbe)
     obj->setProperty(SA_RIBBON_BAR_PROP_CAN_CUSTOMIZE, canbe);
 }
 
-QList< SARibbonCustomizeData > remove_indexs(const QList< SARibbonCustomizeData >& csd, const QList< int >& willremoveIndex);
-
-QList< SARibbonCustomizeData > remove_indexs(const QList< SARibbonCustomizeData >& csd, const QList< int >& willremoveIndex)
+/**
+ * @brief 获取操作所针对的对象层级，0为category，1为pannel，2为action，未知操作返回-1
+ */
+static int sa_customize_data_level(SARibbonCustomizeData::ActionType t)
 {
-    QList< SARibbonCustomizeData > res;
-
-    for (int i = 0; i < csd.size(); ++i) {
-        if (!willremoveIndex.contains(i)) {
-            res << csd[ i ];
-        }
+    switch (t) {
+    case SARibbonCustomizeData::AddCategoryActionType:
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType:
+    case SARibbonCustomizeData::RenameCategoryActionType:
+    case SARibbonCustomizeData::VisibleCategoryActionType:
+        return 0;
+    case SARibbonCustomizeData::AddPannelActionType:
+    case SARibbonCustomizeData::RemovePannelActionType:
+    case SARibbonCustomizeData::ChangePannelOrderActionType:
+    case SARibbonCustomizeData::RenamePannelActionType:
+        return 1;
+    case SARibbonCustomizeData::AddActionActionType:
+    case SARibbonCustomizeData::RemoveActionActionType:
+    case SARibbonCustomizeData::ChangeActionOrderActionType:
+        return 2;
+    default:
+        break;
     }
-    return (res);
+    return -1;
 }
 
+/**
+ * @brief simplify中记录同一个父对象下（同一层级）最近的位置相关操作
+ *
+ * 位置相关操作包括添加、删除、调整顺序和显示隐藏，这些操作会影响同层级其它对象的位置，
+ * 因此只有在两个操作之间没有其它对象的位置相关操作时，才能对同一个对象的操作进行合并或抵消
+ */
+struct SARibbonCustomizeSimplifyScope
+{
+    int lastIndex { -1 };   ///< 最近一次位置相关操作的索引
+    QString lastEntity;     ///< 最近一次位置相关操作的对象
+    int otherIndex { -1 };  ///< 对象不是lastEntity的最近一次位置相关操作的索引
+    void mark(int i, const QString& entity)
+    {
+        if (entity != lastEntity) {
+            otherIndex = lastIndex;
+            lastEntity = entity;
+        }
+        lastIndex = i;
+    }
+    // 除entity以外的对象最近一次位置相关操作的索引
+    int foreignIndex(const QString& entity) const
+    {
+        return (entity == lastEntity) ? otherIndex : lastIndex;
+    }
+};
+
 /**
  * @brief 对QList<SARibbonCustomizeData>进行简化操作
  *
- * 此函数会执行如下操作：
- * 1、针对同一个category/pannel连续出现的添加和删除操作进行移除（前一步添加，后一步删除）
+ * 按操作的对象（category、pannel、action）分组，只遍历一次，此函数会执行如下操作：
+ * 1、对同一个对象的添加和删除操作进行抵消，两者不需要相邻，只要中间没有同层级其它对象的位置相关操作即可，
+ * 抵消时此对象在两者之间的所有操作（包括其下pannel和action的操作）一并移除
  *
- * 2、针对VisibleCategoryActionType，对于连续出现的操作只保留最后一步
+ * 2、删除一个对象时，此对象之前的更名操作，以及其下pannel和action的所有操作都不再有意义，会被移除
  *
- * 3、针对RenameCategoryActionType和RenamePannelActionType操作，只保留最后一个
+ * 3、针对VisibleCategoryActionType，同一个category连续（中间没有其它位置相关操作）的操作中，隐藏操作会被其后的操作覆盖
  *
- * 4、针对连续的ChangeCategoryOrderActionType，ChangePannelOrderActionType，ChangeActionOrderActionType进行合并为一个动作，
- * 如果合并后原地不动，则删除
+ * 4、针对RenameCategoryActionType和RenamePannelActionType操作，只保留最后一个
+ *
+ * 5、针对同一个对象连续的ChangeCategoryOrderActionType，ChangePannelOrderActionType，ChangeActionOrderActionType
+ * 合并为一个动作，如果合并后原地不动，则删除
  *
  * @param csd
  * @return 返回简化的QList<SARibbonCustomizeData>
  */
 QList< SARibbonCustomizeData > SARibbonCustomizeData::simplify(const QList< SARibbonCustomizeData >& csd)
 {
-    int size = csd.size();
+    const int size = csd.size();
 
     if (size <= 1) {
         return (csd);
     }
-    QList< SARibbonCustomizeData > res;
-    QList< int > willremoveIndex;  //记录要删除的index
+    const QChar sep(0x1F);
+    QList< SARibbonCustomizeData > ops = csd;
+    QVector< bool > alive(size, true);
+    // 每个层级的记录，key为对象的唯一标识（category/pannel/key的objname组合）
+    QHash< QString, int > lastAdd[ 3 ];
+    QHash< QString, int > lastMove[ 3 ];
+    QHash< QString, int > lastRename[ 2 ];
+    QHash< QString, int > lastVisible;
+    QHash< QString, QList< int > > subtree[ 3 ];  ///< 对象及其子对象的所有操作
+    QHash< QString, SARibbonCustomizeSimplifyScope > scopes[ 3 ];  ///< key为父对象的标识
+    auto isLiving = [ &alive ](int i) { return (i >= 0 && alive[ i ]); };
 
-    //! 首先针对连续出现的添加和删除操作进行优化
-    for (int i = 1; i < size; ++i) {
-        if ((csd[ i - 1 ].actionType() == AddCategoryActionType) && (csd[ i ].actionType() == RemoveCategoryActionType)) {
-            if (csd[ i - 1 ].categoryObjNameValue == csd[ i ].categoryObjNameValue) {
-                willremoveIndex << i - 1 << i;
+    for (int i = 0; i < size; ++i) {
+        SARibbonCustomizeData& d = ops[ i ];
+        const int level          = sa_customize_data_level(d.actionType());
+        if (level < 0) {
+            continue;
+        }
+        QString keys[ 3 ];
+        keys[ 0 ] = d.categoryObjNameValue;
+        keys[ 1 ] = keys[ 0 ] + sep + d.pannelObjNameValue;
+        keys[ 2 ] = keys[ 1 ] + sep + d.keyValue;
+        const QString& entity = keys[ level ];
+        const QString parent  = (0 == level) ? QString() : keys[ level - 1 ];
+        for (int l = 0; l <= level; ++l) {
+            subtree[ l ][ keys[ l ] ].append(i);
+        }
+        SARibbonCustomizeSimplifyScope& scope = scopes[ level ][ parent ];
+
+        switch (d.actionType()) {
+        case AddCategoryActionType:
+        case AddPannelActionType:
+        case AddActionActionType:
+            lastAdd[ level ][ entity ] = i;
+            scope.mark(i, entity);
+            break;
+
+        case RemoveCategoryActionType:
+        case RemovePannelActionType:
+        case RemoveActionActionType: {
+            const int addIndex = lastAdd[ level ].value(entity, -1);
+            const bool cancel  = isLiving(addIndex) && scope.foreignIndex(entity) < addIndex;
+            for (int j : qAsConst(subtree[ level ][ entity ])) {
+                if (!alive[ j ]) {
+                    continue;
+                }
+                const SARibbonCustomizeData::ActionType t = ops[ j ].actionType();
+                if (sa_customize_data_level(t) > level) {
+                    // 子对象的操作
+                    alive[ j ] = false;
+                } else if (cancel && j >= addIndex) {
+                    alive[ j ] = false;
+                } else if (t == RenameCategoryActionType || t == RenamePannelActionType) {
+                    alive[ j ] = false;
+                }
             }
-        } else if ((csd[ i - 1 ].actionType() == AddPannelActionType) && (csd[ i ].actionType() == RemovePannelActionType)) {
-            if ((csd[ i - 1 ].pannelObjNameValue == csd[ i ].pannelObjNameValue)
-                && (csd[ i - 1 ].categoryObjNameValue == csd[ i ].categoryObjNameValue)) {
-                willremoveIndex << i - 1 << i;
+            subtree[ level ].remove(entity);
+            lastAdd[ level ].remove(entity);
+            lastMove[ level ].remove(entity);
+            if (level < 2) {
+                lastRename[ level ].remove(entity);
             }
-        } else if ((csd[ i - 1 ].actionType() == AddActionActionType) && (csd[ i ].actionType() == RemoveActionActionType)) {
-            if ((csd[ i - 1 ].keyValue == csd[ i ].keyValue) && (csd[ i - 1 ].pannelObjNameValue == csd[ i ].pannelObjNameValue)
-                && (csd[ i - 1 ].categoryObjNameValue == csd[ i ].categoryObjNameValue)) {
-                willremoveIndex << i - 1 << i;
+            if (0 == level) {
+                lastVisible.remove(entity);
             }
-        }
-    }
-    res = remove_indexs(csd, willremoveIndex);
-    willremoveIndex.clear();
-
-    //! 筛选VisibleCategoryActionType，对于连续出现的操作只保留最后一步
-    size = res.size();
-    for (int i = 1; i < size; ++i) {
-        if ((res[ i - 1 ].actionType() == VisibleCategoryActionType) && (res[ i ].actionType() == VisibleCategoryActionType)) {
-            if (res[ i - 1 ].categoryObjNameValue == res[ i ].categoryObjNameValue) {
-                //要保证操作的是同一个内容
-                willremoveIndex << i - 1;  //删除前一个只保留最后一个
+            if (!cancel) {
+                scope.mark(i, entity);
             }
-        }
-    }
-    res = remove_indexs(res, willremoveIndex);
-    willremoveIndex.clear();
+        } break;
+
+        case ChangeCategoryOrderActionType:
+        case ChangePannelOrderActionType:
+        case ChangeActionOrderActionType: {
+            const int prev = lastMove[ level ].value(entity, -1);
+            if (isLiving(prev) && scope.lastIndex == prev) {
+                // 说明连续两个顺序调整，把前一个indexvalue加到后一个，前一个删除
+                d.indexValue += ops[ prev ].indexValue;
+                alive[ prev ] = false;
+            }
+            if (0 == d.indexValue) {
+                alive[ i ] = false;
+                lastMove[ level ].remove(entity);
+            } else {
+                lastMove[ level ][ entity ] = i;
+                scope.mark(i, entity);
+            }
+        } break;
 
-    //! 针对RenameCategoryActionType和RenamePannelActionType操作，只需保留最后一个
-    size = res.size();
-    for (int i = 0; i < size; ++i) {
-        if (res[ i ].actionType() == RenameCategoryActionType) {
-            //向后查询，如果查询到有同一个Category改名，把这个索引加入删除队列
-            for (int j = i + 1; j < size; ++j) {
-                if ((res[ j ].actionType() == RenameCategoryActionType)
-                    && (res[ i ].categoryObjNameValue == res[ j ].categoryObjNameValue)) {
-                    willremoveIndex << i;
-                }
+        case RenameCategoryActionType:
+        case RenamePannelActionType: {
+            const int prev = lastRename[ level ].value(entity, -1);
+            if (isLiving(prev)) {
+                alive[ prev ] = false;
             }
-        } else if (res[ i ].actionType() == RenamePannelActionType) {
-            //向后查询，如果查询到有同一个pannel改名，把这个索引加入删除队列
-            for (int j = i + 1; j < size; ++j) {
-                if ((res[ j ].actionType() == RenamePannelActionType) && (res[ i ].pannelObjNameValue == res[ j ].pannelObjNameValue)
-                    && (res[ i ].categoryObjNameValue == res[ j ].categoryObjNameValue)) {
-                    willremoveIndex << i;
-                }
+            lastRename[ level ][ entity ] = i;
+        } break;
+
+        case VisibleCategoryActionType: {
+            const int prev = lastVisible.value(entity, -1);
+            // 显示后再隐藏时，隐藏记录的位置是显示时插入的位置（超出范围时会被修正），和之前记录的位置不一定相同，
+            // 因此只有前一个是隐藏操作时才能移除
+            if (isLiving(prev) && scope.lastIndex == prev && 1 != ops[ prev ].indexValue) {
+                alive[ prev ] = false;
             }
+            lastVisible[ entity ] = i;
+            scope.mark(i, entity);
+        } break;
+
+        default:
+            break;
         }
     }
-    res = remove_indexs(res, willremoveIndex);
-    willremoveIndex.clear();
-
-    //! 针对连续的ChangeCategoryOrderActionType，ChangePannelOrderActionType，ChangeActionOrderActionType进行合并
-    size = res.size();
-    for (int i = 1; i < size; ++i) {
-        if ((res[ i - 1 ].actionType() == ChangeCategoryOrderActionType) && (res[ i ].actionType() == ChangeCategoryOrderActionType)
-            && (res[ i - 1 ].categoryObjNameValue == res[ i ].categoryObjNameValue)) {
-            //说明连续两个顺序调整，把前一个indexvalue和后一个indexvalue相加，前一个删除
-            res[ i ].indexValue += res[ i - 1 ].indexValue;
-            willremoveIndex << i - 1;
-        } else if ((res[ i - 1 ].actionType() == ChangePannelOrderActionType) && (res[ i ].actionType() == ChangePannelOrderActionType)
-                   && (res[ i - 1 ].pannelObjNameValue == res[ i ].pannelObjNameValue)
-                   && (res[ i - 1 ].categoryObjNameValue == res[ i ].categoryObjNameValue)) {
-            //说明连续两个顺序调整，把前一个indexvalue和后一个indexvalue相加，前一个删除
-            res[ i ].indexValue += res[ i - 1 ].indexValue;
-            willremoveIndex << i - 1;
-        } else if ((res[ i - 1 ].actionType() == ChangeActionOrderActionType)
-                   && (res[ i ].actionType() == ChangeActionOrderActionType) && (res[ i - 1 ].keyValue == res[ i ].keyValue)
-                   && (res[ i - 1 ].pannelObjNameValue == res[ i ].pannelObjNameValue)
-                   && (res[ i - 1 ].categoryObjNameValue == res[ i ].categoryObjNameValue)) {
-            //说明连续两个顺序调整，把前一个indexvalue和后一个indexvalue相加，前一个删除
-            res[ i ].indexValue += res[ i - 1 ].indexValue;
-            willremoveIndex << i - 1;
-        }
-    }
-    res = remove_indexs(res, willremoveIndex);
-    willremoveIndex.clear();
-
-    //! 上一步操作可能会产生indexvalue为0的情况，此操作把indexvalue为0的删除
-    size = res.size();
+    QList< SARibbonCustomizeData > res;
+    res.reserve(size);
     for (int i = 0; i < size; ++i) {
-        if ((res[ i ].actionType() == ChangeCategoryOrderActionType) || (res[ i ].actionType() == ChangePannelOrderActionType)
-            || (res[ i ].actionType() == ChangeActionOrderActionType)) {
-            if (0 == res[ i ].indexValue) {
-                willremoveIndex << i;
-            }
+        if (alive[ i ]) {
+            res.append(ops[ i ]);
         }
     }
-    res = remove_indexs(res, willremoveIndex);
-    willremoveIndex.clear();
     return (res);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// SARibbonCustomizeDataApplier
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SARibbonCustomizeDataApplier::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonCustomizeDataApplier)
+public:
+    PrivateData(SARibbonCustomizeDataApplier* p, SARibbonBar* bar);
+
+public:
+    SARibbonBar* mBar { nullptr };
+    QList< int > mFailedIndexes;
+};
+
+SARibbonCustomizeDataApplier::PrivateData::PrivateData(SARibbonCustomizeDataApplier* p, SARibbonBar* bar)
+    : q_ptr(p), mBar(bar)
+{
+}
+
+SARibbonCustomizeDataApplier::SARibbonCustomizeDataApplier(SARibbonBar* bar)
+    : d_ptr(new SARibbonCustomizeDataApplier::PrivateData(this, bar))
+{
+}
+
+SARibbonCustomizeDataApplier::~SARibbonCustomizeDataApplier()
+{
+}
+
+SARibbonBar* SARibbonCustomizeDataApplier::ribbonBar() const
+{
+    return d_ptr->mBar;
+}
+
+/**
+ * @brief 应用所有的SARibbonCustomizeData
+ *
+ * 应用过程中ribbonbar不刷新，所有操作都在@ref SARibbonBar::beginActionStateUpdate 和
+ * @ref SARibbonBar::endActionStateUpdate 之间进行，action的添加移除以及pannel的顺序调整引起的布局
+ * 会延迟到结束时，对涉及的pannel和category各进行一次
+ *
+ * 某一条应用失败不会中断后续的应用，失败的条目索引可以通过@ref failedIndexes 获取
+ * @param cds
+ * @return 成功应用的个数
+ */
+int SARibbonCustomizeDataApplier::apply(const QList< SARibbonCustomizeData >& cds)
+{
+    d_ptr->mFailedIndexes.clear();
+    SARibbonBar* bar = d_ptr->mBar;
+    if (nullptr == bar) {
+        for (int i = 0; i < cds.size(); ++i) {
+            d_ptr->mFailedIndexes.append(i);
+        }
+        return (0);
+    }
+    const bool updatesEnabled = bar->updatesEnabled();
+    bar->setUpdatesEnabled(false);
+    bar->beginActionStateUpdate();
+    int c = 0;
+    for (int i = 0; i < cds.size(); ++i) {
+        // category和pannel通过SARibbonBar和SARibbonCategoryLayout的objectName索引查找
+        if (cds[ i ].apply(bar)) {
+            ++c;
+        } else {
+            d_ptr->mFailedIndexes.append(i);
+        }
+    }
+    bar->endActionStateUpdate();
+    bar->setUpdatesEnabled(updatesEnabled);
+    if (updatesEnabled) {
+        bar->update();
+    }
+    return (c);
+}
+
+/**
+ * @brief 最近一次apply中应用失败的条目索引
+ * @return 按从小到大排列
+ */
+QList< int > SARibbonCustomizeDataApplier::failedIndexes() const
+{
+    return d_ptr->mFailedIndexes;
+}
@@ -144,6 +144,36 @@ private:
 };
 Q_DECLARE_METATYPE(SARibbonCustomizeData)
 
+/**
+ * @brief 批量应用SARibbonCustomizeData
+ *
+ * 逐条调用@ref SARibbonCustomizeData::apply 时，每一次修改都会触发一次刷新和布局，
+ * 条目很多时（例如启动时加载自定义配置）会很慢
+ *
+ * 此类在一次关闭刷新的过程中完成所有操作，期间的布局合并到结束时进行，只涉及修改过的pannel和category，
+ * category和pannel通过SARibbonBar和SARibbonCategoryLayout的objectName索引查找
+ *
+ * @code
+ * SARibbonCustomizeDataApplier applier(ribbonBar);
+ * applier.apply(cds);
+ * for (int i : applier.failedIndexes()) {
+ *     qWarning() << "customize data apply failed:" << i;
+ * }
+ * @endcode
+ */
+class SA_RIBBON_EXPORT SARibbonCustomizeDataApplier
+{
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonCustomizeDataApplier)
+public:
+    explicit SARibbonCustomizeDataApplier(SARibbonBar* bar);
+    ~SARibbonCustomizeDataApplier();
+    SARibbonBar* ribbonBar() const;
+    //应用所有的SARibbonCustomizeData，返回成功应用的个数
+    int apply(const QList< SARibbonCustomizeData >& cds);
+    //最近一次apply中应用失败的条目索引
+    QList< int > failedIndexes() const;
+};
+
 typedef QList< SARibbonCustomizeData > SARibbonCustomizeDataList;
 
 #endif  // SARIBBONCUSTOMIZEDATA_H
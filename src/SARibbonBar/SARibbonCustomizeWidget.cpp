@@ -18,7 +18,9 @@
 #include <QtWidgets/QWidget>
 #include "SARibbonMainWindow.h"
 #include "SARibbonPannel.h"
-#include <QStandardItemModel>
+#include <QPointer>
+#include <QPersistentModelIndex>
+#include <QUndoStack>
 #include <QButtonGroup>
 #include <QInputDialog>
 #include <QLineEdit>
@@ -29,6 +31,9 @@
 #include "SARibbonBar.h"
 #include <QFile>
 #include <QMessageBox>
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// SARibbonCustomizeWidget
@@ -123,16 +128,147 @@ QList< SARibbonCustomizeData > sa_customize_datas_from_xml(QXmlStreamReader* xml
     return (res);
 }
 
-int sa_customize_datas_apply(const QList< SARibbonCustomizeData >& cds, SARibbonBar* bar)
-{
-    int c = 0;
+/**
+ * @brief 二进制格式的文件头标识"SARC"
+ */
+static const quint32 sa_customize_binary_magic = 0x53415243;
 
+/**
+ * @brief 二进制格式的版本
+ */
+static const quint16 sa_customize_binary_version = 1;
+
+bool sa_customize_datas_to_binary(QIODevice* dev, const QList< SARibbonCustomizeData >& cds)
+{
+    if (cds.size() <= 0 || nullptr == dev) {
+        return (false);
+    }
+    // 字符串表，category、pannel和key都有大量重复，每个字符串只写一次，操作中只记录索引
+    QStringList strings;
+    QHash< QString, quint32 > stringIndexs;
+    auto intern = [ &strings, &stringIndexs ](const QString& s) -> quint32 {
+        auto i = stringIndexs.constFind(s);
+        if (i != stringIndexs.constEnd()) {
+            return i.value();
+        }
+        quint32 index = static_cast< quint32 >(strings.size());
+        strings.append(s);
+        stringIndexs.insert(s, index);
+        return index;
+    };
+    QVector< quint32 > refs;
+    refs.reserve(cds.size() * 3);
     for (const SARibbonCustomizeData& d : cds) {
-        if (d.apply(bar)) {
-            ++c;
+        refs << intern(d.keyValue) << intern(d.categoryObjNameValue) << intern(d.pannelObjNameValue);
+    }
+
+    QDataStream st(dev);
+    st.setVersion(QDataStream::Qt_5_6);  // 固定版本，保证不同qt版本生成的文件一致
+    st << sa_customize_binary_magic << sa_customize_binary_version;
+    st << static_cast< quint32 >(strings.size());
+    for (const QString& s : qAsConst(strings)) {
+        st << s;
+    }
+    st << static_cast< quint32 >(cds.size());
+    for (int i = 0; i < cds.size(); ++i) {
+        const SARibbonCustomizeData& d = cds[ i ];
+        st << static_cast< qint8 >(d.actionType()) << static_cast< qint32 >(d.indexValue);
+        st << refs[ i * 3 ] << refs[ i * 3 + 1 ] << refs[ i * 3 + 2 ];
+        st << static_cast< qint8 >(d.actionRowProportionValue);
+    }
+    if (st.status() != QDataStream::Ok) {
+        qWarning() << "write customize data has error";
+        return (false);
+    }
+    return (true);
+}
+
+QList< SARibbonCustomizeData > sa_customize_datas_from_binary(QIODevice* dev, SARibbonActionsManager* mgr)
+{
+    QList< SARibbonCustomizeData > res;
+    if (!sa_customize_datas_is_binary(dev)) {
+        return (res);
+    }
+    QDataStream st(dev);
+    st.setVersion(QDataStream::Qt_5_6);
+    quint32 magic   = 0;
+    quint16 version = 0;
+    st >> magic >> version;
+    if (version > sa_customize_binary_version) {
+        qWarning() << "unsupported customize data version:" << version;
+        return (res);
+    }
+    quint32 stringCount = 0;
+    st >> stringCount;
+    QVector< QString > strings;
+    for (quint32 i = 0; i < stringCount && st.status() == QDataStream::Ok; ++i) {
+        QString s;
+        st >> s;
+        strings.append(s);
+    }
+    quint32 count = 0;
+    st >> count;
+    const quint32 stringSize = static_cast< quint32 >(strings.size());
+    for (quint32 i = 0; i < count && st.status() == QDataStream::Ok; ++i) {
+        qint8 type = 0, rowProp = 0;
+        qint32 index = -1;
+        quint32 key = 0, category = 0, pannel = 0;
+        st >> type >> index >> key >> category >> pannel >> rowProp;
+        if (st.status() != QDataStream::Ok || key >= stringSize || category >= stringSize || pannel >= stringSize) {
+            break;
         }
+        // 枚举值超出范围同样视为数据损坏
+        if (type < SARibbonCustomizeData::UnknowActionType || type > SARibbonCustomizeData::VisibleCategoryActionType
+            || rowProp < SARibbonPannelItem::None || rowProp > SARibbonPannelItem::Small) {
+            break;
+        }
+        SARibbonCustomizeData d(static_cast< SARibbonCustomizeData::ActionType >(type), mgr);
+        d.indexValue               = index;
+        d.keyValue                 = strings[ key ];
+        d.categoryObjNameValue     = strings[ category ];
+        d.pannelObjNameValue       = strings[ pannel ];
+        d.actionRowProportionValue = static_cast< SARibbonPannelItem::RowProportion >(rowProp);
+        res.append(d);
+    }
+    if (st.status() != QDataStream::Ok || static_cast< quint32 >(res.size()) != count) {
+        // 数据不完整时不返回部分结果，避免只应用一半的自定义操作
+        qWarning() << "customize data is corrupted";
+        res.clear();
+    }
+    return (res);
+}
+
+bool sa_customize_datas_is_binary(QIODevice* dev)
+{
+    if (nullptr == dev) {
+        return (false);
+    }
+    QByteArray head = dev->peek(sizeof(quint32));
+    if (head.size() != sizeof(quint32)) {
+        return (false);
     }
-    return (c);
+    QDataStream st(head);
+    quint32 magic = 0;
+    st >> magic;
+    return (magic == sa_customize_binary_magic);
+}
+
+QList< SARibbonCustomizeData > sa_customize_datas_from_device(QIODevice* dev, SARibbonActionsManager* mgr)
+{
+    if (nullptr == dev) {
+        return (QList< SARibbonCustomizeData >());
+    }
+    if (sa_customize_datas_is_binary(dev)) {
+        return (sa_customize_datas_from_binary(dev, mgr));
+    }
+    QXmlStreamReader xml(dev);
+    return (sa_customize_datas_from_xml(&xml, mgr));
+}
+
+int sa_customize_datas_apply(const QList< SARibbonCustomizeData >& cds, SARibbonBar* bar)
+{
+    SARibbonCustomizeDataApplier applier(bar);
+    return (applier.apply(cds));
 }
 
 int sa_customize_datas_reverse(const QList< SARibbonCustomizeData >& cds, SARibbonBar* bar)
@@ -146,13 +282,13 @@ bool sa_apply_customize_from_xml_file(const QString& filePath, SARibbonBar* bar,
 {
     QFile f(filePath);
 
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // 文件可能是二进制格式，不能以文本方式打开
+    if (!f.open(QIODevice::ReadOnly)) {
         return (false);
     }
-    f.seek(0);
-    QXmlStreamReader xml(&f);
+    QList< SARibbonCustomizeData > cds = sa_customize_datas_from_device(&f, mgr);
 
-    return (SARibbonCustomizeWidget::fromXml(&xml, bar, mgr));
+    return (sa_customize_datas_apply(cds, bar) > 0);
 }
 
 /**
@@ -187,6 +323,8 @@ public:
     QPushButton* pushButtonNewCategory;
     QPushButton* pushButtonNewPannel;
     QPushButton* pushButtonRename;
+    QPushButton* pushButtonUndo;
+    QPushButton* pushButtonRedo;
     QVBoxLayout* verticalLayoutRightButtons;
     QSpacerItem* verticalSpacerUp2;
     QToolButton* toolButtonUp;
@@ -315,6 +453,18 @@ public:
 
         horizontalLayoutActionOptBtns->addWidget(pushButtonRename);
 
+        pushButtonUndo = new QPushButton(customizeWidget);
+        pushButtonUndo->setObjectName(QStringLiteral("pushButtonUndo"));
+        pushButtonUndo->setEnabled(false);
+        pushButtonUndo->setShortcut(QKeySequence::Undo);
+        horizontalLayoutActionOptBtns->addWidget(pushButtonUndo);
+
+        pushButtonRedo = new QPushButton(customizeWidget);
+        pushButtonRedo->setObjectName(QStringLiteral("pushButtonRedo"));
+        pushButtonRedo->setEnabled(false);
+        pushButtonRedo->setShortcut(QKeySequence::Redo);
+        horizontalLayoutActionOptBtns->addWidget(pushButtonRedo);
+
         pushButtonReset = new QPushButton(customizeWidget);
         pushButtonReset->setObjectName(QStringLiteral("pushButtonReset"));
         horizontalLayoutActionOptBtns->addWidget(pushButtonReset);
@@ -369,274 +519,1119 @@ public:
         pushButtonNewCategory->setText(QApplication::translate("SARibbonCustomizeWidget", "New Category", Q_NULLPTR));  // cn:新建选项卡
         pushButtonNewPannel->setText(QApplication::translate("SARibbonCustomizeWidget", "New Group", Q_NULLPTR));  // cn:新建组
         pushButtonRename->setText(QApplication::translate("SARibbonCustomizeWidget", "Rename", Q_NULLPTR));  // cn:重命名
+        pushButtonUndo->setText(QApplication::translate("SARibbonCustomizeWidget", "Undo", Q_NULLPTR));  // cn:撤销
+        pushButtonRedo->setText(QApplication::translate("SARibbonCustomizeWidget", "Redo", Q_NULLPTR));  // cn:重做
         pushButtonReset->setText(QApplication::translate("SARibbonCustomizeWidget", "reset", Q_NULLPTR));  // cn:重置
         labelProportion->setText(QApplication::translate("SARibbonCustomizeWidget", "proportion:", Q_NULLPTR));  // cn:比例
     }  // retranslateUi
 };
 
+//===================================================
+// SARibbonCustomizeTreeModel
+//===================================================
+
 /**
- * @brief 管理SARibbonCustomizeWidget的业务逻辑
+ * @brief SARibbonCustomizeTreeModel的节点和节点操作
  */
-class SARibbonCustomizeWidget::PrivateData
+class SARibbonCustomizeTreeModel::PrivateData
 {
-    SA_RIBBON_DECLARE_PUBLIC(SARibbonCustomizeWidget)
-public:
-    SARibbonCustomizeWidget::RibbonTreeShowType mShowType { SARibbonCustomizeWidget::ShowAllCategory };  ///< 显示类型
-    SARibbonBar* mRibbonBar { nullptr };                   ///< 保存SARibbonMainWindow的指针
-    SARibbonActionsManager* mActionMgr { nullptr };        ///< action管理器
-    SARibbonActionsManagerModel* mAcionModel { nullptr };  ///< action管理器对应的model
-    QStandardItemModel* mRibbonModel { nullptr };          ///< 用于很成ribbon的树
-    int mCustomizeCategoryCount { 0 };                     ///< 记录自定义Category的个数
-    int mCustomizePannelCount { 0 };                       ///< 记录自定义Pannel的个数
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonCustomizeTreeModel)
 public:
-    PrivateData(SARibbonCustomizeWidget* p);
-    void updateModel();
+    /**
+     * @brief ribbon树的一个节点
+     *
+     * 非自定义节点直接引用ribbonbar中的对象，文字等信息实时读取，
+     * 自定义节点（尚未应用到ribbonbar）记录自己的文字和objectName
+     */
+    class Node
+    {
+    public:
+        ~Node()
+        {
+            qDeleteAll(children);
+        }
+        int level { -1 };                             ///< 0：category 1：pannel 2：action，根节点为-1
+        Node* parent { nullptr };                     ///< 父节点
+        QList< Node* > children;                      ///< 子节点
+        bool isChildrenLoaded { false };              ///< 子节点是否已经加载
+        QPointer< SARibbonCategory > category;        ///< level==0的非自定义节点有效
+        QPointer< SARibbonPannel > pannel;            ///< level==1的非自定义节点有效
+        SARibbonPannelItem* pannelItem { nullptr };   ///< level==2的非自定义节点有效
+        QPointer< QAction > action;                   ///< level==2时有效
+        bool isCustomize { false };                   ///< 是否为自定义的节点
+        bool isCanCustomize { false };                ///< 是否可以自定义
+        QString customizeObjName;                     ///< 自定义节点的objectName
+        QString text;                                 ///< 自定义节点或改名后的文字
+        bool isTextOverride { false };                ///< 为true时显示text而不是实时读取
+        bool isCheckable { false };                   ///< 是否可以勾选（category的显示/隐藏）
+        Qt::CheckState checkState { Qt::Unchecked };  ///< 勾选状态
+    };
+
+    /**
+     * @brief 撤销一次applyCustomizeData所需的记录
+     *
+     * 撤销严格按后进先出的顺序进行，因此记录中直接保存节点指针，撤销时不需要查找，
+     * 被删除的节点从树上摘下后由记录持有，每条记录只占用固定的空间（加上被删除的节点）
+     */
+    class JournalEntry
+    {
+    public:
+        SARibbonCustomizeData::ActionType type { SARibbonCustomizeData::UnknowActionType };
+        Node* node { nullptr };                       ///< 受影响的节点，为nullptr说明此操作没有修改model
+        Node* parent { nullptr };                     ///< 删除操作时节点原来的父节点
+        bool isRemoved { false };                     ///< 删除操作，node已从树上摘下，由此记录持有
+        int row { -1 };                               ///< 删除和移动操作时节点原来的位置
+        QString text;                                 ///< 改名前的文字
+        bool isTextOverride { false };                ///< 改名前的isTextOverride
+        Qt::CheckState checkState { Qt::Unchecked };  ///< 改变显示状态前的勾选状态
+    };
 
-    QList< SARibbonCustomizeData > mCustomizeDatasCache;    ///< 缓存记录所有的自定义动作
-    QList< SARibbonCustomizeData > mCustomizeDatasApplied;  ///< 应用后的所有的自定义动作
-    QList< SARibbonCustomizeData > mOldCustomizeDatas;      ///< 记录旧的自定义动作,本地文件缓存
-    // 创建一个随机id，形如：pre_QDateTime::currentMSecsSinceEpoch_suf
-    static QString makeRandomObjName(const QString& pre);
+public:
+    PrivateData(SARibbonCustomizeTreeModel* p);
+    ~PrivateData();
+    // 加载节点的子节点，已经加载的不做处理
+    void loadChildren(Node* n);
+    Node* nodeFromIndex(const QModelIndex& index) const;
+    QModelIndex indexFromNode(Node* n) const;
+    QString objectName(const Node* n) const;
+    QString displayText(const Node* n) const;
+    Node* findCategoryNode(const QString& objName);
+    Node* findPannelNode(Node* categoryNode, const QString& objName);
+    Node* findActionNode(Node* pannelNode, QAction* act);
+    // 已经解析好的节点，target无效、不属于此model或level不一致时返回nullptr
+    Node* targetNode(const QModelIndex& target, int level) const;
+    // 以下操作在非reset过程中会发出对应的信号
+    void insertNode(Node* parent, int row, Node* n);
+    // 把节点从树上摘下，不会删除节点
+    Node* takeNode(Node* n);
+    bool moveNode(Node* n, int offset);
+    void nodeChanged(Node* n);
 
-    int itemLevel(QStandardItem* item) const;
+public:
+    SARibbonBar* mRibbonBar { nullptr };  ///< ribbonbar
+    bool mShowContextCategory { true };   ///< 是否显示上下文标签
+    bool mIsResetting { false };          ///< 是否处于reset过程中，此时不发出增删信号
+    Node mRoot;                           ///< 根节点，子节点为category
+    QList< JournalEntry > mJournal;       ///< applyCustomizeData的撤销记录
+    // 清空撤销记录，并删除记录持有的节点
+    void clearJournal();
+    // 删除最早的撤销记录，只保留最近的keepCount条
+    void trimJournal(int keepCount);
+};
 
-    //
-    bool isCustomizeItem(QStandardItem* item) const;
+SARibbonCustomizeTreeModel::PrivateData::PrivateData(SARibbonCustomizeTreeModel* p) : q_ptr(p)
+{
+    mRoot.isChildrenLoaded = true;
+}
 
-    // 把item转换为category
-    SARibbonCategory* itemToCategory(QStandardItem* item) const;
+SARibbonCustomizeTreeModel::PrivateData::~PrivateData()
+{
+    clearJournal();
+}
 
-    // 把item转换为SARibbonPannel
-    SARibbonPannel* itemToPannel(QStandardItem* item) const;
+void SARibbonCustomizeTreeModel::PrivateData::clearJournal()
+{
+    for (const JournalEntry& e : qAsConst(mJournal)) {
+        // 被删除的节点由删除记录持有，其子节点会随之一起删除
+        if (e.isRemoved) {
+            delete e.node;
+        }
+    }
+    mJournal.clear();
+}
 
-    // 获取item对应的object name
-    QString itemObjectName(QStandardItem* item) const;
+void SARibbonCustomizeTreeModel::PrivateData::trimJournal(int keepCount)
+{
+    while (mJournal.size() > qMax(0, keepCount)) {
+        JournalEntry e = mJournal.takeFirst();
+        if (e.isRemoved) {
+            delete e.node;
+        }
+    }
+}
 
-    // 判断是否可以自定义
-    bool isItemCanCustomize(QStandardItem* item) const;
+/**
+ * @brief 加载子节点
+ *
+ * category加载pannel，pannel加载action（忽略分割线），自定义节点在创建时就已经是加载状态，
+ * 加载前视图看到的行数为0，因此非reset过程中会发出插入信号
+ * @param n
+ */
+void SARibbonCustomizeTreeModel::PrivateData::loadChildren(Node* n)
+{
+    if (n->isChildrenLoaded) {
+        return;
+    }
+    n->isChildrenLoaded = true;
+    QList< Node* > children;
+    if (0 == n->level && n->category) {
+        const QList< SARibbonPannel* > pannels = n->category->pannelList();
+        for (SARibbonPannel* p : pannels) {
+            Node* pn           = new Node();
+            pn->level          = 1;
+            pn->parent         = n;
+            pn->pannel         = p;
+            pn->isCanCustomize = p->isCanCustomize();
+            children.append(pn);
+        }
+    } else if (1 == n->level && n->pannel) {
+        const QList< SARibbonPannelItem* >& items = n->pannel->ribbonPannelItem();
+        for (SARibbonPannelItem* i : items) {
+            if (i->action->isSeparator()) {
+                continue;
+            }
+            Node* an           = new Node();
+            an->level          = 2;
+            an->parent         = n;
+            an->pannelItem     = i;
+            an->action         = i->action;
+            an->isCanCustomize = SARibbonCustomizeData::isCanCustomize(i->action);
+            children.append(an);
+        }
+    }
+    if (children.isEmpty()) {
+        return;
+    }
+    // 根节点在构造时就已经加载，没有父节点说明是已经从树上摘下的节点
+    if (mIsResetting || (nullptr == n->parent)) {
+        n->children = children;
+        return;
+    }
+    q_ptr->beginInsertRows(indexFromNode(n), 0, children.size() - 1);
+    n->children = children;
+    q_ptr->endInsertRows();
+}
 
-    // 从item转为action
-    QAction* itemToAction(QStandardItem* item) const;
-};
+SARibbonCustomizeTreeModel::PrivateData::Node*
+SARibbonCustomizeTreeModel::PrivateData::nodeFromIndex(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return (const_cast< Node* >(&mRoot));
+    }
+    return (static_cast< Node* >(index.internalPointer()));
+}
 
-SARibbonCustomizeWidget::PrivateData::PrivateData(SARibbonCustomizeWidget* p)
-    : q_ptr(p), mAcionModel(new SARibbonActionsManagerModel(p)), mRibbonModel(new QStandardItemModel(p))
+QModelIndex SARibbonCustomizeTreeModel::PrivateData::indexFromNode(Node* n) const
 {
+    if ((nullptr == n) || (nullptr == n->parent)) {
+        return (QModelIndex());
+    }
+    return (q_ptr->createIndex(n->parent->children.indexOf(n), 0, n));
 }
 
-void SARibbonCustomizeWidget::PrivateData::updateModel()
+/**
+ * @brief 节点对应的objectName
+ *
+ * 和原来的行为保持一致，非自定义的action节点返回空
+ * @param n
+ * @return
+ */
+QString SARibbonCustomizeTreeModel::PrivateData::objectName(const Node* n) const
 {
-    if (mRibbonBar == nullptr) {
-        return;
+    if (n->isCustomize) {
+        return (n->customizeObjName);
     }
-    mRibbonModel->clear();
-    SARibbonBar* ribbonbar               = mRibbonBar;
-    QList< SARibbonCategory* > categorys = ribbonbar->categoryPages();
+    if (0 == n->level && n->category) {
+        return (n->category->objectName());
+    } else if (1 == n->level && n->pannel) {
+        return (n->pannel->objectName());
+    }
+    return (QString());
+}
 
-    for (const SARibbonCategory* c : qAsConst(categorys)) {
-        if ((mShowType == SARibbonCustomizeWidget::ShowMainCategory) && c->isContextCategory()) {
-            // 如果是只显示主内容，如果是上下文标签就忽略
-            continue;
+QString SARibbonCustomizeTreeModel::PrivateData::displayText(const Node* n) const
+{
+    if (n->isTextOverride) {
+        return (n->text);
+    }
+    if (0 == n->level && n->category) {
+        if (n->category->isContextCategory()) {
+            return (QString("[%1]").arg(n->category->categoryName()));
         }
-        QStandardItem* ci = new QStandardItem();
-        if (c->isContextCategory()) {
-            ci->setText(QString("[%1]").arg(c->categoryName()));
-        } else {
-            ci->setText(c->categoryName());
+        return (n->category->categoryName());
+    } else if (1 == n->level && n->pannel) {
+        return (n->pannel->pannelName());
+    } else if (2 == n->level && n->action) {
+        return (n->action->text());
+    }
+    return (n->text);
+}
+
+SARibbonCustomizeTreeModel::PrivateData::Node*
+SARibbonCustomizeTreeModel::PrivateData::findCategoryNode(const QString& objName)
+{
+    if (objName.isEmpty()) {
+        return (nullptr);
+    }
+    for (Node* c : qAsConst(mRoot.children)) {
+        if (objectName(c) == objName) {
+            return (c);
         }
-        if (c->isCanCustomize() && !c->isContextCategory()) {
-            // 上下文标签不做显示隐藏处理
-            ci->setCheckable(true);
-            ci->setCheckState(ribbonbar->isCategoryVisible(c) ? Qt::Checked : Qt::Unchecked);
-            ci->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 标记这个是可以自定义的
+    }
+    return (nullptr);
+}
+
+SARibbonCustomizeTreeModel::PrivateData::Node*
+SARibbonCustomizeTreeModel::PrivateData::findPannelNode(Node* categoryNode, const QString& objName)
+{
+    if ((nullptr == categoryNode) || objName.isEmpty()) {
+        return (nullptr);
+    }
+    loadChildren(categoryNode);
+    for (Node* p : qAsConst(categoryNode->children)) {
+        if (objectName(p) == objName) {
+            return (p);
         }
-        ci->setData(0, SARibbonCustomizeWidget::LevelRole);
-        ci->setData(QVariant::fromValue< qintptr >(qintptr(c)), SARibbonCustomizeWidget::PointerRole);
-        QList< SARibbonPannel* > pannels = c->pannelList();
-        for (const SARibbonPannel* p : qAsConst(pannels)) {
-            QStandardItem* pi = new QStandardItem(p->pannelName());
-            pi->setData(1, SARibbonCustomizeWidget::LevelRole);
-            pi->setData(QVariant::fromValue< qintptr >(qintptr(p)), SARibbonCustomizeWidget::PointerRole);
-            if (p->isCanCustomize()) {
-                pi->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 标记这个是可以自定义的
-            }
-            ci->appendRow(pi);
-            const QList< SARibbonPannelItem* >& items = p->ribbonPannelItem();
-            for (SARibbonPannelItem* i : qAsConst(items)) {
-                if (i->action->isSeparator()) {
-                    continue;
-                }
-                QStandardItem* ii = new QStandardItem();
-                //                if (i->customWidget) {
-                //                    //如果是自定义窗口
-                //                    if (i->widget()->windowTitle().isEmpty() && i->widget()->windowIcon().isNull()) {
-                //                        delete ii;
-                //                        continue;  //如果窗口啥也没有，就跳过
-                //                    }
-                //                    ii->setText(i->widget()->windowTitle());
-                //                    ii->setIcon(i->widget()->windowIcon());
-                //                    if (SARibbonCustomizeData::isCanCustomize(i->widget())) {
-                //                        ii->setData(true, SARibbonCustomizeWidget::CanCustomizeRole); //标记这个是可以自定义的
-                //                    }
-                //                } else {
-                //                    //不是自定义，说明是action
-                //                    ii->setText(i->action->text());
-                //                    ii->setIcon(i->action->icon());
-                //                    if (SARibbonCustomizeData::isCanCustomize(i->action)) {
-                //                        ii->setData(true, SARibbonCustomizeWidget::CanCustomizeRole); //标记这个是可以自定义的
-                //                    }
-                //                }
-				ii->setText(i->action->text());
-				ii->setIcon(i->action->icon());
-				if (SARibbonCustomizeData::isCanCustomize(i->action)) {
-                    ii->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 标记这个是可以自定义的
-				}
-                ii->setData(2, SARibbonCustomizeWidget::LevelRole);
-                ii->setData(QVariant::fromValue< qintptr >(qintptr(i)), SARibbonCustomizeWidget::PointerRole);
-                pi->appendRow(ii);
-            }
+    }
+    return (nullptr);
+}
+
+SARibbonCustomizeTreeModel::PrivateData::Node*
+SARibbonCustomizeTreeModel::PrivateData::targetNode(const QModelIndex& target, int level) const
+{
+    if (!target.isValid() || (target.model() != q_ptr)) {
+        return (nullptr);
+    }
+    Node* n = nodeFromIndex(target);
+    return ((level == n->level) ? n : nullptr);
+}
+
+SARibbonCustomizeTreeModel::PrivateData::Node*
+SARibbonCustomizeTreeModel::PrivateData::findActionNode(Node* pannelNode, QAction* act)
+{
+    if ((nullptr == pannelNode) || (nullptr == act)) {
+        return (nullptr);
+    }
+    loadChildren(pannelNode);
+    for (Node* a : qAsConst(pannelNode->children)) {
+        if (a->action == act) {
+            return (a);
         }
-        mRibbonModel->appendRow(ci);
     }
+    return (nullptr);
+}
+
+void SARibbonCustomizeTreeModel::PrivateData::insertNode(Node* parent, int row, Node* n)
+{
+    loadChildren(parent);
+    row       = qBound(0, row, parent->children.size());
+    n->parent = parent;
+    if (mIsResetting) {
+        parent->children.insert(row, n);
+        return;
+    }
+    q_ptr->beginInsertRows(indexFromNode(parent), row, row);
+    parent->children.insert(row, n);
+    q_ptr->endInsertRows();
 }
 
 /**
- * @brief 创建一个随机id，形如：pre_QDateTime::currentMSecsSinceEpoch
- * @param pre 前缀
+ * @brief 把节点从树上摘下
+ * @param n
+ * @return 返回n，节点的parent会置为nullptr，由调用者负责删除
+ */
+SARibbonCustomizeTreeModel::PrivateData::Node* SARibbonCustomizeTreeModel::PrivateData::takeNode(Node* n)
+{
+    Node* parent = n->parent;
+    int row      = parent->children.indexOf(n);
+    if (mIsResetting) {
+        parent->children.removeAt(row);
+    } else {
+        q_ptr->beginRemoveRows(indexFromNode(parent), row, row);
+        parent->children.removeAt(row);
+        q_ptr->endRemoveRows();
+    }
+    n->parent = nullptr;
+    return (n);
+}
+
+/**
+ * @brief 移动节点
+ * @param n
+ * @param offset 移动的位置，-1代表向上移动一个位置，1代表向下移动一个位置
+ * @return 超出范围返回false
+ */
+bool SARibbonCustomizeTreeModel::PrivateData::moveNode(Node* n, int offset)
+{
+    Node* parent = n->parent;
+    int from     = parent->children.indexOf(n);
+    int to       = from + offset;
+    if ((0 == offset) || (to < 0) || (to >= parent->children.size())) {
+        return (false);
+    }
+    if (mIsResetting) {
+        parent->children.move(from, to);
+        return (true);
+    }
+    QModelIndex parentIndex = indexFromNode(parent);
+    // beginMoveRows的目标位置是移动前的位置，向下移动时要在目标的后面
+    if (!q_ptr->beginMoveRows(parentIndex, from, from, parentIndex, (to > from) ? (to + 1) : to)) {
+        return (false);
+    }
+    parent->children.move(from, to);
+    q_ptr->endMoveRows();
+    return (true);
+}
+
+void SARibbonCustomizeTreeModel::PrivateData::nodeChanged(Node* n)
+{
+    if (mIsResetting) {
+        return;
+    }
+    QModelIndex i = indexFromNode(n);
+    Q_EMIT q_ptr->dataChanged(i, i);
+}
+
+SARibbonCustomizeTreeModel::SARibbonCustomizeTreeModel(QObject* p)
+    : QAbstractItemModel(p), d_ptr(new SARibbonCustomizeTreeModel::PrivateData(this))
+{
+}
+
+SARibbonCustomizeTreeModel::~SARibbonCustomizeTreeModel()
+{
+}
+
+QModelIndex SARibbonCustomizeTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return (QModelIndex());
+    }
+    PrivateData::Node* p = d_ptr->nodeFromIndex(parent);
+    return (createIndex(row, column, p->children.at(row)));
+}
+
+QModelIndex SARibbonCustomizeTreeModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return (QModelIndex());
+    }
+    return (d_ptr->indexFromNode(d_ptr->nodeFromIndex(index)->parent));
+}
+
+/**
+ * @brief 只返回已经加载的子节点个数，未加载的子节点通过@ref fetchMore 加载
+ * @param parent
  * @return
  */
-QString SARibbonCustomizeWidget::PrivateData::makeRandomObjName(const QString& pre)
+int SARibbonCustomizeTreeModel::rowCount(const QModelIndex& parent) const
 {
-    return (QString("%1_%2").arg(pre).arg(QDateTime::currentMSecsSinceEpoch()));
+    if (parent.column() > 0) {
+        return (0);
+    }
+    return (d_ptr->nodeFromIndex(parent)->children.size());
+}
+
+int SARibbonCustomizeTreeModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return (1);
 }
 
 /**
- * @brief 获取item的level
- * @param item
+ * @brief 视图绘制展开标记时会调用此函数，这里不加载子节点
+ * @param parent
  * @return
  */
-int SARibbonCustomizeWidget::PrivateData::itemLevel(QStandardItem* item) const
+bool SARibbonCustomizeTreeModel::hasChildren(const QModelIndex& parent) const
 {
-    return (item->data(SARibbonCustomizeWidget::LevelRole).toInt());
+    if (parent.column() > 0) {
+        return (false);
+    }
+    PrivateData::Node* p = d_ptr->nodeFromIndex(parent);
+    if (p->isChildrenLoaded) {
+        return (!p->children.isEmpty());
+    }
+    if (0 == p->level) {
+        return (p->category && !p->category->pannelList().isEmpty());
+    } else if (1 == p->level) {
+        return (p->pannel && !p->pannel->ribbonPannelItem().isEmpty());
+    }
+    return (false);
 }
 
 /**
- * @brief 判断itemn为自定义的item，自定义的item都带有CustomizeRole角色
- * @param item
+ * @brief 子节点还没有加载时返回true，视图展开节点时会调用@ref fetchMore
+ * @param parent
  * @return
  */
-bool SARibbonCustomizeWidget::PrivateData::isCustomizeItem(QStandardItem* item) const
+bool SARibbonCustomizeTreeModel::canFetchMore(const QModelIndex& parent) const
 {
-    if (nullptr == item) {
+    if (parent.column() > 0) {
         return (false);
     }
-    return (item->data(SARibbonCustomizeWidget::CustomizeRole).isValid());
+    return (!d_ptr->nodeFromIndex(parent)->isChildrenLoaded && hasChildren(parent));
 }
 
 /**
- * @brief 把item转换为category
- * @param item
- * @return无法转换返回nullptr
+ * @brief 加载子节点，会发出插入信号
+ * @param parent
  */
-SARibbonCategory* SARibbonCustomizeWidget::PrivateData::itemToCategory(QStandardItem* item) const
+void SARibbonCustomizeTreeModel::fetchMore(const QModelIndex& parent)
 {
-    int level = item->data(SARibbonCustomizeWidget::LevelRole).toInt();
+    if (parent.column() > 0) {
+        return;
+    }
+    d_ptr->loadChildren(d_ptr->nodeFromIndex(parent));
+}
 
-    if (level != 0) {
-        return (nullptr);
+Qt::ItemFlags SARibbonCustomizeTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return (Qt::NoItemFlags);
     }
-    qintptr p = item->data(SARibbonCustomizeWidget::PointerRole).value< qintptr >();
+    Qt::ItemFlags f = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (d_ptr->nodeFromIndex(index)->isCheckable) {
+        f |= Qt::ItemIsUserCheckable;
+    }
+    return (f);
+}
 
-    return (reinterpret_cast< SARibbonCategory* >(p));
+QVariant SARibbonCustomizeTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return (QVariant());
+    }
+    const PrivateData::Node* n = d_ptr->nodeFromIndex(index);
+    switch (role) {
+    case Qt::DisplayRole:
+        return (d_ptr->displayText(n));
+    case Qt::DecorationRole:
+        if (2 == n->level && n->action) {
+            return (n->action->icon());
+        }
+        break;
+    case Qt::CheckStateRole:
+        if (n->isCheckable) {
+            return (n->checkState);
+        }
+        break;
+    case SARibbonCustomizeWidget::LevelRole:
+        return (n->level);
+    case SARibbonCustomizeWidget::PointerRole:
+        // 自定义的action节点存放的是action指针，非自定义的存放SARibbonPannelItem指针
+        if (0 == n->level && n->category) {
+            return (QVariant::fromValue< qintptr >(qintptr(n->category.data())));
+        } else if (1 == n->level && n->pannel) {
+            return (QVariant::fromValue< qintptr >(qintptr(n->pannel.data())));
+        } else if (2 == n->level) {
+            if (n->isCustomize) {
+                return (QVariant::fromValue< qintptr >(qintptr(n->action.data())));
+            }
+            return (QVariant::fromValue< qintptr >(qintptr(n->pannelItem)));
+        }
+        break;
+    case SARibbonCustomizeWidget::CanCustomizeRole:
+        if (n->isCanCustomize) {
+            return (true);
+        }
+        break;
+    case SARibbonCustomizeWidget::CustomizeRole:
+        if (n->isCustomize) {
+            return (true);
+        }
+        break;
+    case SARibbonCustomizeWidget::CustomizeObjNameRole:
+        if (n->isCustomize) {
+            return (n->customizeObjName);
+        }
+        break;
+    default:
+        break;
+    }
+    return (QVariant());
 }
 
 /**
- * @brief 把item转换为pannel
- * @param item
- * @return 无法转换返回nullptr
+ * @brief 只处理category的勾选
+ *
+ * 勾选不会直接修改model，而是发射@ref categoryCheckStateChanged ，由接收者生成对应的
+ * @ref SARibbonCustomizeData 并通过@ref applyCustomizeData 应用，这样勾选也能被撤销
+ * @param index
+ * @param value
+ * @param role
+ * @return
  */
-SARibbonPannel* SARibbonCustomizeWidget::PrivateData::itemToPannel(QStandardItem* item) const
+bool SARibbonCustomizeTreeModel::setData(const QModelIndex& index, const QVariant& value, int role)
 {
-    int level = item->data(SARibbonCustomizeWidget::LevelRole).toInt();
-
-    if (level != 1) {
-        return (nullptr);
+    if (!index.isValid() || (role != Qt::CheckStateRole)) {
+        return (false);
+    }
+    PrivateData::Node* n = d_ptr->nodeFromIndex(index);
+    if (!n->isCheckable) {
+        return (false);
+    }
+    Qt::CheckState s = static_cast< Qt::CheckState >(value.toInt());
+    if (s != n->checkState) {
+        Q_EMIT categoryCheckStateChanged(index, s == Qt::Checked);
     }
-    qintptr p = item->data(SARibbonCustomizeWidget::PointerRole).value< qintptr >();
+    return (true);
+}
 
-    return (reinterpret_cast< SARibbonPannel* >(p));
+void SARibbonCustomizeTreeModel::setRibbonBar(SARibbonBar* bar)
+{
+    d_ptr->mRibbonBar = bar;
+}
+
+SARibbonBar* SARibbonCustomizeTreeModel::ribbonBar() const
+{
+    return (d_ptr->mRibbonBar);
+}
+
+void SARibbonCustomizeTreeModel::setShowContextCategory(bool on)
+{
+    d_ptr->mShowContextCategory = on;
+}
+
+bool SARibbonCustomizeTreeModel::isShowContextCategory() const
+{
+    return (d_ptr->mShowContextCategory);
 }
 
 /**
- * @brief 获取item对应的objectname
- * @param item
- * @return 如果无法获取，返回一个空的QString
+ * @brief 从ribbonbar重新加载
+ *
+ * 只创建category节点，pannel和action在展开时才加载，pending会在同一次reset中叠加到model上
+ * @param pending 尚未应用到ribbonbar的自定义操作
  */
-QString SARibbonCustomizeWidget::PrivateData::itemObjectName(QStandardItem* item) const
-{
-    QString objName;
+void SARibbonCustomizeTreeModel::reload(const QList< SARibbonCustomizeData >& pending)
+{
+    beginResetModel();
+    d_ptr->mIsResetting = true;
+    d_ptr->clearJournal();
+    qDeleteAll(d_ptr->mRoot.children);
+    d_ptr->mRoot.children.clear();
+    if (SARibbonBar* bar = d_ptr->mRibbonBar) {
+        const QList< SARibbonCategory* > categorys = bar->categoryPages();
+        for (SARibbonCategory* c : categorys) {
+            if (!d_ptr->mShowContextCategory && c->isContextCategory()) {
+                // 如果是只显示主内容，如果是上下文标签就忽略
+                continue;
+            }
+            PrivateData::Node* cn = new PrivateData::Node();
+            cn->level             = 0;
+            cn->parent            = &(d_ptr->mRoot);
+            cn->category          = c;
+            if (c->isCanCustomize() && !c->isContextCategory()) {
+                // 上下文标签不做显示隐藏处理
+                cn->isCanCustomize = true;
+                cn->isCheckable    = true;
+                cn->checkState     = bar->isCategoryVisible(c) ? Qt::Checked : Qt::Unchecked;
+            }
+            d_ptr->mRoot.children.append(cn);
+        }
+    }
+    for (const SARibbonCustomizeData& d : pending) {
+        applyCustomizeData(d);
+    }
+    d_ptr->mIsResetting = false;
+    endResetModel();
+}
 
-    if (isCustomizeItem(item)) {
-        // 说明是自定义的
-        objName = item->data(SARibbonCustomizeWidget::CustomizeObjNameRole).toString();
-    } else {
-        // 说明这个是非自定义的
-        int level = itemLevel(item);
-        if (0 == level) {
-            SARibbonCategory* category = itemToCategory(item);
-            if (category) {
-                objName = category->objectName();
+/**
+ * @brief 把一条自定义操作同步到model
+ *
+ * 只会修改受影响的节点，每次调用（包括失败的调用）都会记录一条撤销记录，
+ * 因此可以和自定义操作列表一一对应地通过@ref revertLastCustomizeData 撤销
+ *
+ * 节点默认按objectName逐个查找，如果调用者已经知道操作的节点（例如撤销后重做同一个操作），
+ * 可以通过target传入，此时不再查找，添加操作的target为父节点，其它操作的target为节点本身，
+ * target的level和操作不一致时仍然按objectName查找
+ * @param d
+ * @param target 已经解析好的节点，一般是上一次调用返回值的QPersistentModelIndex
+ * @return 新增、移动、改名、改变显示状态的节点，删除或失败时返回无效的QModelIndex
+ */
+QModelIndex SARibbonCustomizeTreeModel::applyCustomizeData(const SARibbonCustomizeData& d, const QModelIndex& target)
+{
+    typedef PrivateData::Node Node;
+    // actionManager不是const函数
+    SARibbonActionsManager* mgr = SARibbonCustomizeData(d).actionManager();
+    Node* n                     = nullptr;
+    PrivateData::JournalEntry e;
+
+    // 操作节点的level，添加操作为父节点的level
+    int targetLevel = -1;
+    switch (d.actionType()) {
+    case SARibbonCustomizeData::AddPannelActionType:
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType:
+    case SARibbonCustomizeData::RenameCategoryActionType:
+    case SARibbonCustomizeData::VisibleCategoryActionType:
+        targetLevel = 0;
+        break;
+    case SARibbonCustomizeData::AddActionActionType:
+    case SARibbonCustomizeData::RemovePannelActionType:
+    case SARibbonCustomizeData::ChangePannelOrderActionType:
+    case SARibbonCustomizeData::RenamePannelActionType:
+        targetLevel = 1;
+        break;
+    case SARibbonCustomizeData::RemoveActionActionType:
+    case SARibbonCustomizeData::ChangeActionOrderActionType:
+        targetLevel = 2;
+        break;
+    default:
+        break;
+    }
+    Node* t = d_ptr->targetNode(target, targetLevel);
+
+    e.type = d.actionType();
+    switch (d.actionType()) {
+    case SARibbonCustomizeData::AddCategoryActionType: {
+        n                   = new Node();
+        n->level            = 0;
+        n->isChildrenLoaded = true;
+        n->isCustomize      = true;
+        n->isCanCustomize   = true;
+        n->customizeObjName = d.categoryObjNameValue;
+        n->text             = d.keyValue;
+        n->isTextOverride   = true;
+        d_ptr->insertNode(&(d_ptr->mRoot), d.indexValue, n);
+        break;
+    }
+    case SARibbonCustomizeData::AddPannelActionType: {
+        Node* c = t ? t : d_ptr->findCategoryNode(d.categoryObjNameValue);
+        if (nullptr == c) {
+            break;
+        }
+        n                   = new Node();
+        n->level            = 1;
+        n->isChildrenLoaded = true;
+        n->isCustomize      = true;
+        n->isCanCustomize   = true;
+        n->customizeObjName = d.pannelObjNameValue;
+        n->text             = d.keyValue;
+        n->isTextOverride   = true;
+        d_ptr->insertNode(c, d.indexValue, n);
+        break;
+    }
+    case SARibbonCustomizeData::AddActionActionType: {
+        Node* p = t;
+        if (nullptr == p) {
+            p = d_ptr->findPannelNode(d_ptr->findCategoryNode(d.categoryObjNameValue), d.pannelObjNameValue);
+        }
+        QAction* act = mgr ? mgr->action(d.keyValue) : nullptr;
+        if ((nullptr == p) || (nullptr == act)) {
+            break;
+        }
+        n                   = new Node();
+        n->level            = 2;
+        n->isChildrenLoaded = true;
+        n->isCustomize      = true;
+        n->isCanCustomize   = true;
+        n->customizeObjName = act->objectName();
+        n->action           = act;
+        d_ptr->insertNode(p, p->children.size(), n);
+        break;
+    }
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+    case SARibbonCustomizeData::RemovePannelActionType:
+    case SARibbonCustomizeData::RemoveActionActionType: {
+        Node* c = t ? nullptr : d_ptr->findCategoryNode(d.categoryObjNameValue);
+        if (t) {
+            n = t;
+        } else if (SARibbonCustomizeData::RemoveCategoryActionType == d.actionType()) {
+            n = c;
+        } else if (SARibbonCustomizeData::RemovePannelActionType == d.actionType()) {
+            n = d_ptr->findPannelNode(c, d.pannelObjNameValue);
+        } else {
+            n = d_ptr->findActionNode(d_ptr->findPannelNode(c, d.pannelObjNameValue), mgr ? mgr->action(d.keyValue) : nullptr);
+        }
+        if (n) {
+            e.parent    = n->parent;
+            e.row       = n->parent->children.indexOf(n);
+            e.isRemoved = true;
+            d_ptr->takeNode(n);
+        }
+        break;
+    }
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType:
+    case SARibbonCustomizeData::ChangePannelOrderActionType:
+    case SARibbonCustomizeData::ChangeActionOrderActionType: {
+        Node* c = t ? nullptr : d_ptr->findCategoryNode(d.categoryObjNameValue);
+        if (t) {
+            n = t;
+        } else if (SARibbonCustomizeData::ChangeCategoryOrderActionType == d.actionType()) {
+            n = c;
+        } else if (SARibbonCustomizeData::ChangePannelOrderActionType == d.actionType()) {
+            n = d_ptr->findPannelNode(c, d.pannelObjNameValue);
+        } else {
+            n = d_ptr->findActionNode(d_ptr->findPannelNode(c, d.pannelObjNameValue), mgr ? mgr->action(d.keyValue) : nullptr);
+        }
+        if (n) {
+            e.row = n->parent->children.indexOf(n);
+            if (!d_ptr->moveNode(n, d.indexValue)) {
+                n = nullptr;
             }
-        } else if (1 == level) {
-            SARibbonPannel* pannel = itemToPannel(item);
-            if (pannel) {
-                objName = pannel->objectName();
+        }
+        break;
+    }
+    case SARibbonCustomizeData::RenameCategoryActionType:
+    case SARibbonCustomizeData::RenamePannelActionType: {
+        n = t;
+        if (nullptr == n) {
+            n = d_ptr->findCategoryNode(d.categoryObjNameValue);
+            if (SARibbonCustomizeData::RenamePannelActionType == d.actionType()) {
+                n = d_ptr->findPannelNode(n, d.pannelObjNameValue);
             }
         }
+        if (n) {
+            e.text            = n->text;
+            e.isTextOverride  = n->isTextOverride;
+            n->text           = d.keyValue;
+            n->isTextOverride = true;
+            d_ptr->nodeChanged(n);
+        }
+        break;
+    }
+    case SARibbonCustomizeData::VisibleCategoryActionType: {
+        n = t ? t : d_ptr->findCategoryNode(d.categoryObjNameValue);
+        if (n && !n->isCheckable) {
+            n = nullptr;
+        }
+        if (n) {
+            e.checkState  = n->checkState;
+            n->checkState = (1 == d.indexValue) ? Qt::Checked : Qt::Unchecked;
+            d_ptr->nodeChanged(n);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    e.node = n;
+    d_ptr->mJournal.append(e);
+    if ((nullptr == n) || e.isRemoved) {
+        return (QModelIndex());
+    }
+    return (d_ptr->indexFromNode(n));
+}
+
+/**
+ * @brief 撤销最近一次@ref applyCustomizeData
+ *
+ * 撤销记录中保存了节点指针和修改前的状态，不需要查找，也不会重建model
+ * @return 撤销后受影响的节点，撤销的是添加操作或没有记录时返回无效的QModelIndex
+ */
+QModelIndex SARibbonCustomizeTreeModel::revertLastCustomizeData()
+{
+    if (d_ptr->mJournal.isEmpty()) {
+        return (QModelIndex());
+    }
+    PrivateData::JournalEntry e = d_ptr->mJournal.takeLast();
+    PrivateData::Node* n        = e.node;
+
+    if (nullptr == n) {
+        // 此操作没有修改model
+        return (QModelIndex());
     }
-    return (objName);
+    switch (e.type) {
+    case SARibbonCustomizeData::AddCategoryActionType:
+    case SARibbonCustomizeData::AddPannelActionType:
+    case SARibbonCustomizeData::AddActionActionType:
+        delete d_ptr->takeNode(n);
+        return (QModelIndex());
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+    case SARibbonCustomizeData::RemovePannelActionType:
+    case SARibbonCustomizeData::RemoveActionActionType:
+        d_ptr->insertNode(e.parent, e.row, n);
+        break;
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType:
+    case SARibbonCustomizeData::ChangePannelOrderActionType:
+    case SARibbonCustomizeData::ChangeActionOrderActionType:
+        d_ptr->moveNode(n, e.row - n->parent->children.indexOf(n));
+        break;
+    case SARibbonCustomizeData::RenameCategoryActionType:
+    case SARibbonCustomizeData::RenamePannelActionType:
+        n->text           = e.text;
+        n->isTextOverride = e.isTextOverride;
+        d_ptr->nodeChanged(n);
+        break;
+    case SARibbonCustomizeData::VisibleCategoryActionType:
+        n->checkState = e.checkState;
+        d_ptr->nodeChanged(n);
+        break;
+    default:
+        break;
+    }
+    return (d_ptr->indexFromNode(n));
 }
 
 /**
- * @brief 判断item是否可自定义
- * @param item
+ * @brief 撤销记录的条数，和调用@ref applyCustomizeData 的次数一致
  * @return
  */
-bool SARibbonCustomizeWidget::PrivateData::isItemCanCustomize(QStandardItem* item) const
+int SARibbonCustomizeTreeModel::journalCount() const
+{
+    return (d_ptr->mJournal.size());
+}
+
+/**
+ * @brief 清空撤销记录，一般在自定义操作应用到ribbonbar后调用
+ */
+void SARibbonCustomizeTreeModel::clearJournal()
+{
+    d_ptr->clearJournal();
+}
+
+/**
+ * @brief 删除最早的撤销记录，只保留最近的keepCount条
+ *
+ * 撤销栈限制了步数（QUndoStack::setUndoLimit）时，超出限制的操作已经无法撤销，
+ * 需要通过此函数删除对应的撤销记录以及记录持有的被删除节点，否则撤销记录会一直增长
+ * @param keepCount
+ */
+void SARibbonCustomizeTreeModel::trimJournal(int keepCount)
+{
+    d_ptr->trimJournal(keepCount);
+}
+
+int SARibbonCustomizeTreeModel::indexLevel(const QModelIndex& index) const
 {
-    if (nullptr == item) {
+    if (!index.isValid()) {
+        return (-1);
+    }
+    return (d_ptr->nodeFromIndex(index)->level);
+}
+
+QString SARibbonCustomizeTreeModel::indexObjectName(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return (QString());
+    }
+    return (d_ptr->objectName(d_ptr->nodeFromIndex(index)));
+}
+
+bool SARibbonCustomizeTreeModel::isCustomizeIndex(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
         return (false);
     }
-    QVariant v = item->data(SARibbonCustomizeWidget::CanCustomizeRole);
+    return (d_ptr->nodeFromIndex(index)->isCustomize);
+}
 
-    if (v.isValid()) {
-        return (v.toBool());
+bool SARibbonCustomizeTreeModel::isIndexCanCustomize(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return (false);
     }
-    return (false);
+    return (d_ptr->nodeFromIndex(index)->isCanCustomize);
+}
+
+SARibbonCategory* SARibbonCustomizeTreeModel::indexToCategory(const QModelIndex& index) const
+{
+    if (0 != indexLevel(index)) {
+        return (nullptr);
+    }
+    return (d_ptr->nodeFromIndex(index)->category.data());
+}
+
+SARibbonPannel* SARibbonCustomizeTreeModel::indexToPannel(const QModelIndex& index) const
+{
+    if (1 != indexLevel(index)) {
+        return (nullptr);
+    }
+    return (d_ptr->nodeFromIndex(index)->pannel.data());
 }
 
+QAction* SARibbonCustomizeTreeModel::indexToAction(const QModelIndex& index) const
+{
+    if (2 != indexLevel(index)) {
+        return (nullptr);
+    }
+    return (d_ptr->nodeFromIndex(index)->action.data());
+}
+
+//===================================================
+// SARibbonCustomizeUndoCommand
+//===================================================
+
 /**
- * @brief 从item 转为action
- * @param item
+ * @brief SARibbonCustomizeWidget中的一步自定义操作
+ *
+ * redo时把SARibbonCustomizeData加入缓存并同步到model，undo时从缓存中移除并通过
+ * @ref SARibbonCustomizeTreeModel::revertLastCustomizeData 撤销model的修改，
+ * 两者都不需要重建model，每一步只保存一条SARibbonCustomizeData
+ *
+ * 第一次redo后记录操作的节点（添加操作为父节点），之后的redo直接使用此节点，不再按objectName查找
+ */
+class SARibbonCustomizeUndoCommand : public QUndoCommand
+{
+public:
+    SARibbonCustomizeUndoCommand(const SARibbonCustomizeData& d,
+                                 QList< SARibbonCustomizeData >* cache,
+                                 SARibbonCustomizeTreeModel* model);
+    void undo() override;
+    void redo() override;
+    // 最近一次redo/undo受影响的节点
+    QModelIndex affectedIndex() const;
+
+private:
+    SARibbonCustomizeData mData;
+    QList< SARibbonCustomizeData >* mCache { nullptr };
+    SARibbonCustomizeTreeModel* mModel { nullptr };
+    QModelIndex mAffectedIndex;
+    QPersistentModelIndex mTarget;  ///< 已经解析好的操作节点，节点被删除或model重置后自动失效
+};
+
+/**
+ * @brief 自定义操作的描述，用于QUndoCommand::text
+ * @param d
  * @return
  */
-QAction* SARibbonCustomizeWidget::PrivateData::itemToAction(QStandardItem* item) const
+static QString sa_customize_data_text(const SARibbonCustomizeData& d)
+{
+    switch (d.actionType()) {
+    case SARibbonCustomizeData::AddCategoryActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "add category %1").arg(d.keyValue));
+    case SARibbonCustomizeData::AddPannelActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "add group %1").arg(d.keyValue));
+    case SARibbonCustomizeData::AddActionActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "add command %1").arg(d.keyValue));
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+    case SARibbonCustomizeData::RemovePannelActionType:
+    case SARibbonCustomizeData::RemoveActionActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "remove"));
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType:
+    case SARibbonCustomizeData::ChangePannelOrderActionType:
+    case SARibbonCustomizeData::ChangeActionOrderActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "move"));
+    case SARibbonCustomizeData::RenameCategoryActionType:
+    case SARibbonCustomizeData::RenamePannelActionType:
+        return (QApplication::translate("SARibbonCustomizeWidget", "rename to %1").arg(d.keyValue));
+    case SARibbonCustomizeData::VisibleCategoryActionType:
+        return ((1 == d.indexValue) ? QApplication::translate("SARibbonCustomizeWidget", "show category")
+                                    : QApplication::translate("SARibbonCustomizeWidget", "hide category"));
+    default:
+        break;
+    }
+    return (QString());
+}
+
+SARibbonCustomizeUndoCommand::SARibbonCustomizeUndoCommand(const SARibbonCustomizeData& d,
+                                                           QList< SARibbonCustomizeData >* cache,
+                                                           SARibbonCustomizeTreeModel* model)
+    : QUndoCommand(sa_customize_data_text(d)), mData(d), mCache(cache), mModel(model)
 {
-    if (2 != itemLevel(item)) {
-        return (nullptr);
+}
+
+void SARibbonCustomizeUndoCommand::undo()
+{
+    // 撤销是后进先出的，此时缓存的最后一条和model的最后一条撤销记录都对应此操作
+    if (!mCache->isEmpty()) {
+        mCache->removeLast();
     }
-    // 这里要非常注意，SARibbonCustomizeWidget::CustomizeRole为true时，说明这个是自定义的内容，
-    // 这时PointerRole里存放的是action指针，不是SARibbonPannelItem
-    QAction* act = nullptr;
+    mAffectedIndex = mModel->revertLastCustomizeData();
+    if (mAffectedIndex.isValid()) {
+        // 删除操作撤销后节点重新插入，记录下来供redo使用
+        mTarget = mAffectedIndex;
+    }
+}
 
-    if (item->data(SARibbonCustomizeWidget::CustomizeRole).toBool()) {
-        act = reinterpret_cast< QAction* >(item->data(SARibbonCustomizeWidget::PointerRole).value< qintptr >());
-    } else {
-        SARibbonPannelItem* pi = reinterpret_cast< SARibbonPannelItem* >(
-            item->data(SARibbonCustomizeWidget::PointerRole).value< qintptr >());
-        act = (pi->action);
+void SARibbonCustomizeUndoCommand::redo()
+{
+    mCache->append(mData);
+    mAffectedIndex = mModel->applyCustomizeData(mData, mTarget);
+    if (!mAffectedIndex.isValid()) {
+        return;
+    }
+    switch (mData.actionType()) {
+    case SARibbonCustomizeData::AddCategoryActionType:
+    case SARibbonCustomizeData::AddPannelActionType:
+    case SARibbonCustomizeData::AddActionActionType:
+        // 添加的节点在undo时会被删除，记录父节点
+        mTarget = mAffectedIndex.parent();
+        break;
+    default:
+        mTarget = mAffectedIndex;
+        break;
     }
-    return (act);
+}
+
+QModelIndex SARibbonCustomizeUndoCommand::affectedIndex() const
+{
+    return (mAffectedIndex);
+}
+
+/**
+ * @brief 管理SARibbonCustomizeWidget的业务逻辑
+ */
+class SARibbonCustomizeWidget::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonCustomizeWidget)
+public:
+    SARibbonCustomizeWidget::RibbonTreeShowType mShowType { SARibbonCustomizeWidget::ShowAllCategory };  ///< 显示类型
+    SARibbonBar* mRibbonBar { nullptr };                   ///< 保存SARibbonMainWindow的指针
+    SARibbonActionsManager* mActionMgr { nullptr };        ///< action管理器
+    SARibbonActionsManagerModel* mAcionModel { nullptr };  ///< action管理器对应的model
+    SARibbonCustomizeTreeModel* mRibbonModel { nullptr };  ///< 用于很成ribbon的树
+    QUndoStack* mUndoStack { nullptr };                    ///< 自定义操作的撤销栈
+    int mCustomizeCategoryCount { 0 };                     ///< 记录自定义Category的个数
+    int mCustomizePannelCount { 0 };                       ///< 记录自定义Pannel的个数
+public:
+    PrivateData(SARibbonCustomizeWidget* p);
+    void updateModel();
+
+    QList< SARibbonCustomizeData > mCustomizeDatasCache;    ///< 缓存记录所有的自定义动作
+    QList< SARibbonCustomizeData > mCustomizeDatasApplied;  ///< 应用后的所有的自定义动作
+    QList< SARibbonCustomizeData > mOldCustomizeDatas;      ///< 记录旧的自定义动作,本地文件缓存
+    // 创建一个随机id，形如：pre_QDateTime::currentMSecsSinceEpoch_suf
+    static QString makeRandomObjName(const QString& pre);
+
+    // 记录一条自定义动作并同步到ribbon树
+    QModelIndex addCustomizeData(const SARibbonCustomizeData& d);
+    // 缓存被整体修改后，撤销栈和model的撤销记录已经无法对应，需要清空
+    void clearUndo();
+};
+
+SARibbonCustomizeWidget::PrivateData::PrivateData(SARibbonCustomizeWidget* p)
+    : q_ptr(p)
+    , mAcionModel(new SARibbonActionsManagerModel(p))
+    , mRibbonModel(new SARibbonCustomizeTreeModel(p))
+    , mUndoStack(new QUndoStack(p))
+{
+}
+
+/**
+ * @brief 重新加载ribbon树，未应用的自定义动作会叠加到树上
+ */
+void SARibbonCustomizeWidget::PrivateData::updateModel()
+{
+    mRibbonModel->setRibbonBar(mRibbonBar);
+    mRibbonModel->setShowContextCategory(mShowType == SARibbonCustomizeWidget::ShowAllCategory);
+    mRibbonModel->reload(mCustomizeDatasCache);
+    // reload会为缓存中的每一条动作记录撤销记录，只有撤销栈中的操作需要保留
+    mRibbonModel->trimJournal(mUndoStack->index());
+}
+
+/**
+ * @brief 创建一个随机id，形如：pre_QDateTime::currentMSecsSinceEpoch
+ * @param pre 前缀
+ * @return
+ */
+QString SARibbonCustomizeWidget::PrivateData::makeRandomObjName(const QString& pre)
+{
+    return (QString("%1_%2").arg(pre).arg(QDateTime::currentMSecsSinceEpoch()));
+}
+
+/**
+ * @brief 记录一条自定义动作并同步到ribbon树
+ *
+ * 动作以@ref SARibbonCustomizeUndoCommand 的形式压入撤销栈，压栈时执行
+ * @param d
+ * @return 受影响的节点，见@ref SARibbonCustomizeTreeModel::applyCustomizeData
+ */
+QModelIndex SARibbonCustomizeWidget::PrivateData::addCustomizeData(const SARibbonCustomizeData& d)
+{
+    SARibbonCustomizeUndoCommand* cmd = new SARibbonCustomizeUndoCommand(d, &mCustomizeDatasCache, mRibbonModel);
+    mUndoStack->push(cmd);
+    // 超出撤销步数的操作已经被撤销栈删除，对应的撤销记录也不再需要
+    mRibbonModel->trimJournal(mUndoStack->index());
+    return (cmd->affectedIndex());
+}
+
+void SARibbonCustomizeWidget::PrivateData::clearUndo()
+{
+    mUndoStack->clear();
+    mRibbonModel->clearJournal();
 }
 
 //===================================================
@@ -700,9 +1695,17 @@ void SARibbonCustomizeWidget::initConnection()
     connect(ui->treeViewResult, &QAbstractItemView::clicked, this, &SARibbonCustomizeWidget::onTreeViewResultClicked);
     connect(ui->toolButtonUp, &QToolButton::clicked, this, &SARibbonCustomizeWidget::onToolButtonUpClicked);
     connect(ui->toolButtonDown, &QToolButton::clicked, this, &SARibbonCustomizeWidget::onToolButtonDownClicked);
-    connect(d_ptr->mRibbonModel, &QStandardItemModel::itemChanged, this, &SARibbonCustomizeWidget::onItemChanged);
+    connect(d_ptr->mRibbonModel,
+            &SARibbonCustomizeTreeModel::categoryCheckStateChanged,
+            this,
+            &SARibbonCustomizeWidget::onCategoryCheckStateChanged);
     connect(ui->lineEditSearchAction, &QLineEdit::textEdited, this, &SARibbonCustomizeWidget::onLineEditSearchActionTextEdited);
     connect(ui->pushButtonReset, &QPushButton::clicked, this, &SARibbonCustomizeWidget::onPushButtonResetClicked);
+    connect(ui->pushButtonUndo, &QPushButton::clicked, d_ptr->mUndoStack, &QUndoStack::undo);
+    connect(ui->pushButtonRedo, &QPushButton::clicked, d_ptr->mUndoStack, &QUndoStack::redo);
+    connect(d_ptr->mUndoStack, &QUndoStack::canUndoChanged, ui->pushButtonUndo, &QPushButton::setEnabled);
+    connect(d_ptr->mUndoStack, &QUndoStack::canRedoChanged, ui->pushButtonRedo, &QPushButton::setEnabled);
+    connect(d_ptr->mUndoStack, &QUndoStack::indexChanged, this, &SARibbonCustomizeWidget::onUndoStackIndexChanged);
 }
 
 /**
@@ -745,11 +1748,25 @@ bool SARibbonCustomizeWidget::isCached() const
     return (d_ptr->mCustomizeDatasCache.size() > 0);
 }
 
+/**
+ * @brief 获取自定义动作的撤销栈
+ *
+ * 每一步自定义动作都是一个QUndoCommand，撤销和重做都只修改受影响的节点，
+ * 可以通过QUndoStack::setUndoLimit限制撤销的步数，超出限制的操作其撤销记录会一并删除，因此也限制了撤销占用的内存，
+ * 或通过QUndoStack::createUndoAction加入到其它菜单
+ * @note 在@ref applys 、@ref clearCache 后撤销栈会被清空
+ * @return
+ */
+QUndoStack* SARibbonCustomizeWidget::undoStack() const
+{
+    return (d_ptr->mUndoStack);
+}
+
 /**
  * @brief 获取model
  * @return
  */
-const QStandardItemModel* SARibbonCustomizeWidget::model() const
+const SARibbonCustomizeTreeModel* SARibbonCustomizeWidget::model() const
 {
     return (d_ptr->mRibbonModel);
 }
@@ -854,6 +1871,42 @@ bool SARibbonCustomizeWidget::toXml(QXmlStreamWriter* xml) const
     return (sa_customize_datas_to_xml(xml, res));
 }
 
+/**
+ * @brief 以二进制格式保存配置
+ *
+ * 二进制格式比xml更小，加载更快，@ref fromXml 和@ref sa_apply_customize_from_xml_file 会自动识别格式
+ * @param dev
+ * @return 如果出现异常，返回false,如果没有自定义数据也会返回false
+ * @see sa_customize_datas_to_binary
+ */
+bool SARibbonCustomizeWidget::toBinary(QIODevice* dev) const
+{
+    QList< SARibbonCustomizeData > res = d_ptr->mOldCustomizeDatas;
+
+    if (isApplied())
+        res << d_ptr->mCustomizeDatasApplied;
+    if (isCached())
+        res << d_ptr->mCustomizeDatasCache;
+
+    res = SARibbonCustomizeData::simplify(res);
+    return (sa_customize_datas_to_binary(dev, res));
+}
+
+/**
+ * @brief 以二进制格式把配置写入文件中
+ * @param filepath
+ * @return
+ */
+bool SARibbonCustomizeWidget::toBinary(const QString& filepath) const
+{
+    QFile f(filepath);
+
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return (false);
+    }
+    return (toBinary(&f));
+}
+
 /**
  * @brief 把配置写入文件中
  * @param xmlpath
@@ -909,13 +1962,11 @@ void SARibbonCustomizeWidget::fromXml(const QString& xmlpath)
 {
     QFile f(xmlpath);
 
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // 同时支持二进制格式，不能以文本方式打开
+    if (!f.open(QIODevice::ReadOnly)) {
         return;
     }
-    f.seek(0);
-    QXmlStreamReader xml(&f);
-
-    fromXml(&xml);
+    d_ptr->mOldCustomizeDatas = sa_customize_datas_from_device(&f, d_ptr->mActionMgr);
 }
 
 /**
@@ -972,6 +2023,7 @@ void SARibbonCustomizeWidget::clearApplied()
 void SARibbonCustomizeWidget::clearCache()
 {
     d_ptr->mCustomizeDatasCache.clear();
+    d_ptr->clearUndo();
 }
 
 /**
@@ -985,10 +2037,13 @@ void SARibbonCustomizeWidget::clear()
 
 /**
  * @brief 精简
+ *
+ * 精简后缓存和撤销栈不再一一对应，撤销栈会被清空
  */
 void SARibbonCustomizeWidget::simplify()
 {
     d_ptr->mCustomizeDatasCache = SARibbonCustomizeData::simplify(d_ptr->mCustomizeDatasCache);
+    d_ptr->clearUndo();
 }
 
 /**
@@ -1003,7 +2058,7 @@ SARibbonPannelItem::RowProportion SARibbonCustomizeWidget::selectedRowProportion
 /**
  * @brief 获取listview中选中的action
  * @return 如果没有选中action，返回nullptr
- * @note 如果要获取treeview选中的action，使用@ref itemToAction 函数
+ * @note 如果要获取treeview选中的action，使用@ref indexToAction 函数
  */
 QAction* SARibbonCustomizeWidget::selectedAction() const
 {
@@ -1018,29 +2073,27 @@ QAction* SARibbonCustomizeWidget::selectedAction() const
 }
 
 /**
- * @brief 把item转换为action
- * @param item
+ * @brief 把ribbon树的节点转换为action
+ * @param index
  * @return 如果没有action可转换，返回nullptr
  */
-QAction* SARibbonCustomizeWidget::itemToAction(QStandardItem* item) const
+QAction* SARibbonCustomizeWidget::indexToAction(const QModelIndex& index) const
 {
-    return (d_ptr->itemToAction(item));
+    return (d_ptr->mRibbonModel->indexToAction(index));
 }
 
 /**
- * @brief 获取ribbon tree选中的item
- * @return
+ * @brief 获取ribbon tree选中的节点
+ * @return 没有选中返回无效的QModelIndex
  */
-QStandardItem* SARibbonCustomizeWidget::selectedItem() const
+QModelIndex SARibbonCustomizeWidget::selectedIndex() const
 {
     QItemSelectionModel* m = ui->treeViewResult->selectionModel();
 
     if ((nullptr == m) || !m->hasSelection()) {
-        return (nullptr);
+        return (QModelIndex());
     }
-    QModelIndex i = m->currentIndex();
-
-    return (d_ptr->mRibbonModel->itemFromIndex(i));
+    return (m->currentIndex());
 }
 
 /**
@@ -1049,81 +2102,65 @@ QStandardItem* SARibbonCustomizeWidget::selectedItem() const
  */
 int SARibbonCustomizeWidget::selectedRibbonLevel() const
 {
-    QStandardItem* item = selectedItem();
-
-    if (item) {
-        return (itemLevel(item));
-    }
-    return (-1);
+    return (indexLevel(selectedIndex()));
 }
 
 /**
- * @brief 获取StandardItem 的level
- * @param item
- * @return
+ * @brief 获取节点的level
+ * @param index
+ * @return 无效节点返回-1
  */
-int SARibbonCustomizeWidget::itemLevel(QStandardItem* item) const
+int SARibbonCustomizeWidget::indexLevel(const QModelIndex& index) const
 {
-    return (d_ptr->itemLevel(item));
+    return (d_ptr->mRibbonModel->indexLevel(index));
 }
 
 /**
- * @brief 设置某个item被选中
- * @param item
+ * @brief 设置某个节点被选中
+ * @param index
  */
-void SARibbonCustomizeWidget::setSelectItem(QStandardItem* item, bool ensureVisible)
+void SARibbonCustomizeWidget::setSelectIndex(const QModelIndex& index, bool ensureVisible)
 {
     QItemSelectionModel* m = ui->treeViewResult->selectionModel();
 
-    if (nullptr == m) {
+    if ((nullptr == m) || !index.isValid()) {
         return;
     }
-    if (m) {
-        m->clearSelection();
-        m->setCurrentIndex(item->index(), QItemSelectionModel::SelectCurrent);
-    }
+    m->clearSelection();
+    m->setCurrentIndex(index, QItemSelectionModel::SelectCurrent);
     if (ensureVisible) {
-        ui->treeViewResult->scrollTo(item->index());
+        ui->treeViewResult->scrollTo(index);
     }
 }
 
 /**
- * @brief 判断itemn能否改动，可以改动返回true
- * @param item
+ * @brief 判断节点能否改动，可以改动返回true
+ * @param index
  * @return
  */
-bool SARibbonCustomizeWidget::isItemCanCustomize(QStandardItem* item) const
+bool SARibbonCustomizeWidget::isIndexCanCustomize(const QModelIndex& index) const
 {
-    return (d_ptr->isItemCanCustomize(item));
+    return (d_ptr->mRibbonModel->isIndexCanCustomize(index));
 }
 
 bool SARibbonCustomizeWidget::isSelectedItemCanCustomize() const
 {
-    return (isItemCanCustomize(selectedItem()));
+    return (isIndexCanCustomize(selectedIndex()));
 }
 
 /**
- * @brief 判断itemn能否改动，可以改动返回true
- * @param item
+ * @brief 判断节点是否是自定义的节点
+ * @param index
  * @return
  */
-bool SARibbonCustomizeWidget::isCustomizeItem(QStandardItem* item) const
+bool SARibbonCustomizeWidget::isCustomizeIndex(const QModelIndex& index) const
 {
-    return (d_ptr->isCustomizeItem(item));
+    return (d_ptr->mRibbonModel->isCustomizeIndex(index));
 }
 
 bool SARibbonCustomizeWidget::isSelectedItemIsCustomize() const
 {
-    return (isCustomizeItem(selectedItem()));
-}
-
-void SARibbonCustomizeWidget::removeItem(QStandardItem* item)
-{
-    if (item->parent()) {
-        item->parent()->removeRow(item->row());
-    } else {
-        d_ptr->mRibbonModel->removeRow(item->row());
-    }
+    return (isCustomizeIndex(selectedIndex()));
 }
 
 void SARibbonCustomizeWidget::onComboBoxActionIndexCurrentIndexChanged(int index)
@@ -1140,135 +2177,112 @@ void SARibbonCustomizeWidget::onRadioButtonGroupButtonClicked(QAbstractButton* b
 
 void SARibbonCustomizeWidget::onPushButtonNewCategoryClicked()
 {
-    int row                = d_ptr->mRibbonModel->rowCount();
-    QItemSelectionModel* m = ui->treeViewResult->selectionModel();
+    int row       = d_ptr->mRibbonModel->rowCount();
+    QModelIndex i = selectedIndex();
 
-    if (m && m->hasSelection()) {
-        QModelIndex i = m->currentIndex();
+    if (i.isValid()) {
         while (i.parent().isValid()) {
             i = i.parent();
         }
         // 获取选中的最顶层item
         row = i.row() + 1;
     }
-    QStandardItem* ni = new QStandardItem(tr("new category[customize]%1").arg(++(d_ptr->mCustomizeCategoryCount)));
-
-    ni->setData(0, SARibbonCustomizeWidget::LevelRole);
-    d_ptr->mRibbonModel->insertRow(row, ni);
-    // 设置新增的为选中
-    setSelectItem(ni);
     // 把动作插入动作列表中
-    SARibbonCustomizeData d = SARibbonCustomizeData::makeAddCategoryCustomizeData(ni->text(),
-                                                                                  ni->row(),
-                                                                                  SARibbonCustomizeWidget::PrivateData::makeRandomObjName(
-                                                                                      "category"));
+    SARibbonCustomizeData d = SARibbonCustomizeData::makeAddCategoryCustomizeData(
+        tr("new category[customize]%1").arg(++(d_ptr->mCustomizeCategoryCount)),
+        row,
+        SARibbonCustomizeWidget::PrivateData::makeRandomObjName("category"));
 
-    d_ptr->mCustomizeDatasCache.append(d);
-    ni->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 有CustomizeRole，必有CanCustomizeRole
-    ni->setData(true, SARibbonCustomizeWidget::CustomizeRole);
-    ni->setData(d.categoryObjNameValue, SARibbonCustomizeWidget::CustomizeObjNameRole);
+    // 设置新增的为选中
+    setSelectIndex(d_ptr->addCustomizeData(d));
 }
 
 void SARibbonCustomizeWidget::onPushButtonNewPannelClicked()
 {
-    QStandardItem* item = selectedItem();
+    QModelIndex index = selectedIndex();
 
-    if (nullptr == item) {
+    if (!index.isValid()) {
         return;
     }
-    int level = selectedRibbonLevel();
-
-    QStandardItem* ni = new QStandardItem(tr("new pannel[customize]%1").arg(++(d_ptr->mCustomizePannelCount)));
-
-    ni->setData(1, SARibbonCustomizeWidget::LevelRole);
+    int level = indexLevel(index);
+    int row   = 0;
+    QModelIndex categoryIndex;
 
     if (0 == level) {
-        // 说明是category,插入到最后
-        item->appendRow(ni);
+        // 说明是category,插入到最后，未展开的category需要先加载pannel
+        categoryIndex = index;
+        if (d_ptr->mRibbonModel->canFetchMore(index)) {
+            d_ptr->mRibbonModel->fetchMore(index);
+        }
+        row = d_ptr->mRibbonModel->rowCount(index);
     } else if (1 == level) {
         // 说明选择的是pannel，插入到此pannel之后
-        QStandardItem* categoryItem = item->parent();
-        if (nullptr == categoryItem) {
-            return;
-        }
-        categoryItem->insertRow(item->row() + 1, ni);
+        categoryIndex = index.parent();
+        row           = index.row() + 1;
     } else {
-        // 不符合就删除退出
-        delete ni;
-        ni = nullptr;
         return;
     }
     // 查找category的object name
-    QStandardItem* categoryItem = ni->parent();
-    QString categoryObjName     = "";
-
-    categoryObjName         = d_ptr->itemObjectName(categoryItem);
-    SARibbonCustomizeData d = SARibbonCustomizeData::makeAddPannelCustomizeData(ni->text(),
-                                                                                ni->row(),
-                                                                                categoryObjName,
-                                                                                SARibbonCustomizeWidget::PrivateData::makeRandomObjName(
-                                                                                    "pannel"));
-
-    d_ptr->mCustomizeDatasCache.append(d);
-    ni->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 有CustomizeRole，必有CanCustomizeRole
-    ni->setData(true, SARibbonCustomizeWidget::CustomizeRole);
-    ni->setData(d.pannelObjNameValue, SARibbonCustomizeWidget::CustomizeObjNameRole);
-    setSelectItem(ni);
+    QString categoryObjName = d_ptr->mRibbonModel->indexObjectName(categoryIndex);
+    SARibbonCustomizeData d = SARibbonCustomizeData::makeAddPannelCustomizeData(
+        tr("new pannel[customize]%1").arg(++(d_ptr->mCustomizePannelCount)),
+        row,
+        categoryObjName,
+        SARibbonCustomizeWidget::PrivateData::makeRandomObjName("pannel"));
+
+    setSelectIndex(d_ptr->addCustomizeData(d));
 }
 
 void SARibbonCustomizeWidget::onPushButtonRenameClicked()
 {
-    QStandardItem* item = selectedItem();
+    QModelIndex index = selectedIndex();
 
-    if (nullptr == item) {
+    if (!index.isValid()) {
         return;
     }
     bool ok;
     QString text = "";
 
-    text = QInputDialog::getText(this, tr("rename"), tr("name:"), QLineEdit::Normal, item->text(), &ok);
+    text = QInputDialog::getText(this, tr("rename"), tr("name:"), QLineEdit::Normal, index.data().toString(), &ok);
 
     if (!ok || text.isEmpty()) {
         return;
     }
-    int level = itemLevel(item);
+    int level = indexLevel(index);
 
     if (0 == level) {
         // 改Category名
-        QString cateObjName     = d_ptr->itemObjectName(item);
+        QString cateObjName     = d_ptr->mRibbonModel->indexObjectName(index);
         SARibbonCustomizeData d = SARibbonCustomizeData::makeRenameCategoryCustomizeData(text, cateObjName);
-        d_ptr->mCustomizeDatasCache.append(d);
+        d_ptr->addCustomizeData(d);
     } else if (1 == level) {
-        QString cateObjName   = d_ptr->itemObjectName(item->parent());
-        QString pannelObjName = d_ptr->itemObjectName(item);
+        QString cateObjName   = d_ptr->mRibbonModel->indexObjectName(index.parent());
+        QString pannelObjName = d_ptr->mRibbonModel->indexObjectName(index);
         SARibbonCustomizeData d = SARibbonCustomizeData::makeRenamePannelCustomizeData(text, cateObjName, pannelObjName);
-        d_ptr->mCustomizeDatasCache.append(d);
-    } else {
-        // action 不允许改名
-        return;
+        d_ptr->addCustomizeData(d);
     }
-    item->setText(text);
+    // action 不允许改名
 }
 
 void SARibbonCustomizeWidget::onPushButtonAddClicked()
 {
-    QAction* act        = selectedAction();
-    QStandardItem* item = selectedItem();
+    QAction* act      = selectedAction();
+    QModelIndex index = selectedIndex();
 
-    if ((nullptr == act) || (nullptr == item)) {
+    if ((nullptr == act) || !index.isValid()) {
         return;
     }
-    int level = itemLevel(item);
+    int level = indexLevel(index);
 
     if (0 == level) {
         // 选中category不进行操作
         return;
     } else if (2 == level) {
         // 选中action，添加到这个action之后,把item设置为pannel
-        item = item->parent();
+        index = index.parent();
     }
-    QString pannelObjName   = d_ptr->itemObjectName(item);
-    QString categoryObjName = d_ptr->itemObjectName(item->parent());
+    QString pannelObjName   = d_ptr->mRibbonModel->indexObjectName(index);
+    QString categoryObjName = d_ptr->mRibbonModel->indexObjectName(index.parent());
     QString key             = d_ptr->mActionMgr->key(act);
 
     SARibbonCustomizeData d = SARibbonCustomizeData::makeAddActionCustomizeData(key,
@@ -1277,45 +2291,34 @@ void SARibbonCustomizeWidget::onPushButtonAddClicked()
                                                                                 categoryObjName,
                                                                                 pannelObjName);
 
-    d_ptr->mCustomizeDatasCache.append(d);
-
-    QStandardItem* actItem = new QStandardItem(act->icon(), act->text());
-
-    actItem->setData(2, SARibbonCustomizeWidget::LevelRole);
-    actItem->setData(true, SARibbonCustomizeWidget::CanCustomizeRole);  // 有CustomizeRole，必有CanCustomizeRole
-    actItem->setData(true, SARibbonCustomizeWidget::CustomizeRole);
-    actItem->setData(act->objectName(), SARibbonCustomizeWidget::CustomizeObjNameRole);
-    actItem->setData(qintptr(act), SARibbonCustomizeWidget::PointerRole);  // 把action指针传入
-    item->appendRow(actItem);
+    d_ptr->addCustomizeData(d);
 }
 
 void SARibbonCustomizeWidget::onPushButtonDeleteClicked()
 {
-    QStandardItem* item = selectedItem();
+    QModelIndex index = selectedIndex();
 
-    if (nullptr == item) {
-        return;
-    }
-    if (!isItemCanCustomize(item)) {
+    if (!isIndexCanCustomize(index)) {
         return;
     }
-    int level = itemLevel(item);
+    const SARibbonCustomizeTreeModel* m = d_ptr->mRibbonModel;
+    int level                           = indexLevel(index);
 
     if (0 == level) {
         // 删除category
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeRemoveCategoryCustomizeData(d_ptr->itemObjectName(item));
-        d_ptr->mCustomizeDatasCache.append(d);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeRemoveCategoryCustomizeData(m->indexObjectName(index));
+        d_ptr->addCustomizeData(d);
     } else if (1 == level) {
         // 删除pannel
-        QString catObjName      = d_ptr->itemObjectName(item->parent());
-        QString pannelObjName   = d_ptr->itemObjectName(item);
+        QString catObjName      = m->indexObjectName(index.parent());
+        QString pannelObjName   = m->indexObjectName(index);
         SARibbonCustomizeData d = SARibbonCustomizeData::makeRemovePannelCustomizeData(catObjName, pannelObjName);
-        d_ptr->mCustomizeDatasCache.append(d);
+        d_ptr->addCustomizeData(d);
     } else if (2 == level) {
         // 删除Action
-        QString catObjName    = d_ptr->itemObjectName(item->parent()->parent());
-        QString pannelObjName = d_ptr->itemObjectName(item->parent());
-        QAction* act          = itemToAction(item);
+        QString catObjName    = m->indexObjectName(index.parent().parent());
+        QString pannelObjName = m->indexObjectName(index.parent());
+        QAction* act          = indexToAction(index);
         QString key           = d_ptr->mActionMgr->key(act);
         if (key.isEmpty() || catObjName.isEmpty() || pannelObjName.isEmpty()) {
             return;
@@ -1325,10 +2328,8 @@ void SARibbonCustomizeWidget::onPushButtonDeleteClicked()
                                                                                        pannelObjName,
                                                                                        key,
                                                                                        d_ptr->mActionMgr);
-        d_ptr->mCustomizeDatasCache.append(d);
+        d_ptr->addCustomizeData(d);
     }
-    // 执行删除操作
-    removeItem(item);
     // 删除后重新识别
     ui->pushButtonAdd->setEnabled(selectedAction() && isSelectedItemIsCustomize() && selectedRibbonLevel() > 0);
     ui->pushButtonDelete->setEnabled(isSelectedItemIsCustomize());
@@ -1347,151 +2348,123 @@ void SARibbonCustomizeWidget::onTreeViewResultClicked(const QModelIndex& index)
 {
     Q_UNUSED(index);
     // 每次点击，判断是否可以进行操作，决定pushButtonAdd和pushButtonDelete的显示状态
-    QStandardItem* item = selectedItem();
+    QModelIndex selIndex = selectedIndex();
 
-    if (nullptr == item) {
+    if (!selIndex.isValid()) {
         return;
     }
-    int level = itemLevel(item);
+    int level = indexLevel(selIndex);
 
-    ui->pushButtonAdd->setEnabled(selectedAction() && (level > 0) && isItemCanCustomize(item));
-    ui->pushButtonDelete->setEnabled(isItemCanCustomize(item));  // 有CustomizeRole，必有CanCustomizeRole
-    ui->pushButtonRename->setEnabled(
-        level != 2 || isItemCanCustomize(item));  // QAction 不能改名 ， 有CustomizeRole，必有CanCustomizeRole
+    ui->pushButtonAdd->setEnabled(selectedAction() && (level > 0) && isIndexCanCustomize(selIndex));
+    ui->pushButtonDelete->setEnabled(isIndexCanCustomize(selIndex));  // 有CustomizeRole，必有CanCustomizeRole
+    // QAction 不能改名 ， 有CustomizeRole，必有CanCustomizeRole
+    ui->pushButtonRename->setEnabled(level != 2 || isIndexCanCustomize(selIndex));
 }
 
 void SARibbonCustomizeWidget::onToolButtonUpClicked()
 {
-    QStandardItem* item = selectedItem();
+    QModelIndex index = selectedIndex();
 
-    if ((nullptr == item) || (0 == item->row())) {
+    if (!index.isValid() || (0 == index.row())) {
         return;
     }
-    int level = itemLevel(item);
+    const SARibbonCustomizeTreeModel* m = d_ptr->mRibbonModel;
+    int level                           = indexLevel(index);
+    QModelIndex movedIndex;
 
     if (0 == level) {
         // 移动category
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeCategoryOrderCustomizeData(d_ptr->itemObjectName(item),
-                                                                                              -1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = d_ptr->mRibbonModel->takeItem(r);
-        d_ptr->mRibbonModel->removeRow(r);
-        d_ptr->mRibbonModel->insertRow(r - 1, item);
+        QString catObjName      = m->indexObjectName(index);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeCategoryOrderCustomizeData(catObjName, -1);
+        movedIndex              = d_ptr->addCustomizeData(d);
     } else if (1 == level) {
-        QStandardItem* paritem = item->parent();
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangePannelOrderCustomizeData(d_ptr->itemObjectName(paritem),
-                                                                                            d_ptr->itemObjectName(item),
-                                                                                            -1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = paritem->takeChild(r);
-        paritem->removeRow(r);
-        paritem->insertRow(r - 1, item);
+        QString catObjName      = m->indexObjectName(index.parent());
+        QString pannelObjName   = m->indexObjectName(index);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangePannelOrderCustomizeData(catObjName, pannelObjName, -1);
+        movedIndex              = d_ptr->addCustomizeData(d);
     } else if (2 == level) {
-        QStandardItem* pannelItem   = item->parent();
-        QStandardItem* categoryItem = pannelItem->parent();
-        QAction* act                = itemToAction(item);
+        QAction* act = indexToAction(index);
         if (!act) {
             return;
         }
-        QString key = d_ptr->mActionMgr->key(act);
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeActionOrderCustomizeData(d_ptr->itemObjectName(categoryItem),
-                                                                                            d_ptr->itemObjectName(pannelItem),
-                                                                                            key,
-                                                                                            d_ptr->mActionMgr,
-                                                                                            -1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = pannelItem->takeChild(r);
-        pannelItem->removeRow(r);
-        pannelItem->insertRow(r - 1, item);
+        QString catObjName      = m->indexObjectName(index.parent().parent());
+        QString pannelObjName   = m->indexObjectName(index.parent());
+        QString key             = d_ptr->mActionMgr->key(act);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeActionOrderCustomizeData(
+            catObjName, pannelObjName, key, d_ptr->mActionMgr, -1);
+        movedIndex = d_ptr->addCustomizeData(d);
     }
 
     // 保持焦点，方便连续操作
-	setSelectItem(item);
-	onTreeViewResultClicked(item->index());
+    setSelectIndex(movedIndex);
+    onTreeViewResultClicked(movedIndex);
 }
 
 void SARibbonCustomizeWidget::onToolButtonDownClicked()
 {
-    QStandardItem* item = selectedItem();
+    QModelIndex index = selectedIndex();
 
-    if (item == nullptr) {
+    if (!index.isValid()) {
         return;
     }
-    int count = 0;
+    const SARibbonCustomizeTreeModel* m = d_ptr->mRibbonModel;
+    int count                           = m->rowCount(index.parent());
 
-    if (item->parent()) {
-        count = item->parent()->rowCount();
-    } else {
-        count = d_ptr->mRibbonModel->rowCount();
-    }
-    if ((nullptr == item) || ((count - 1) == item->row())) {
+    if ((count - 1) == index.row()) {
         return;
     }
-    int level = itemLevel(item);
+    int level = indexLevel(index);
+    QModelIndex movedIndex;
 
     if (0 == level) {
         // 移动category
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeCategoryOrderCustomizeData(d_ptr->itemObjectName(item),
-                                                                                              1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = d_ptr->mRibbonModel->takeItem(item->row());
-        d_ptr->mRibbonModel->removeRow(r);
-        d_ptr->mRibbonModel->insertRow(r + 1, item);
+        QString catObjName      = m->indexObjectName(index);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeCategoryOrderCustomizeData(catObjName, 1);
+        movedIndex              = d_ptr->addCustomizeData(d);
     } else if (1 == level) {
-        QStandardItem* paritem = item->parent();
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangePannelOrderCustomizeData(d_ptr->itemObjectName(paritem),
-                                                                                            d_ptr->itemObjectName(item),
-                                                                                            1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = paritem->takeChild(r);
-        paritem->removeRow(r);
-        paritem->insertRow(r + 1, item);
+        QString catObjName      = m->indexObjectName(index.parent());
+        QString pannelObjName   = m->indexObjectName(index);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangePannelOrderCustomizeData(catObjName, pannelObjName, 1);
+        movedIndex              = d_ptr->addCustomizeData(d);
     } else if (2 == level) {
-        QStandardItem* pannelItem   = item->parent();
-        QStandardItem* categoryItem = pannelItem->parent();
-        QAction* act                = itemToAction(item);
+        QAction* act = indexToAction(index);
         if (!act) {
             return;
         }
-        QString key = d_ptr->mActionMgr->key(act);
-        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeActionOrderCustomizeData(d_ptr->itemObjectName(categoryItem),
-                                                                                            d_ptr->itemObjectName(pannelItem),
-                                                                                            key,
-                                                                                            d_ptr->mActionMgr,
-                                                                                            -1);
-        d_ptr->mCustomizeDatasCache.append(d);
-        int r = item->row();
-        item  = pannelItem->takeChild(r);
-        pannelItem->removeRow(r);
-        pannelItem->insertRow(r + 1, item);
+        QString catObjName      = m->indexObjectName(index.parent().parent());
+        QString pannelObjName   = m->indexObjectName(index.parent());
+        QString key             = d_ptr->mActionMgr->key(act);
+        SARibbonCustomizeData d = SARibbonCustomizeData::makeChangeActionOrderCustomizeData(
+            catObjName, pannelObjName, key, d_ptr->mActionMgr, 1);
+        movedIndex = d_ptr->addCustomizeData(d);
     }
 
     // 保持焦点，方便连续操作
-	setSelectItem(item);
-	onTreeViewResultClicked(item->index());
+    setSelectIndex(movedIndex);
+    onTreeViewResultClicked(movedIndex);
 }
 
-void SARibbonCustomizeWidget::onItemChanged(QStandardItem* item)
+/**
+ * @brief 用户勾选了category，记录为可撤销的自定义动作，由model同步勾选状态
+ * @param index
+ * @param checked
+ */
+void SARibbonCustomizeWidget::onCategoryCheckStateChanged(const QModelIndex& index, bool checked)
 {
-    if (item == nullptr) {
+    if (0 != indexLevel(index)) {
         return;
     }
-    int level = itemLevel(item);
+    QString objname         = d_ptr->mRibbonModel->indexObjectName(index);
+    SARibbonCustomizeData d = SARibbonCustomizeData::makeVisibleCategoryCustomizeData(objname, checked);
+    d_ptr->addCustomizeData(d);
+}
 
-    if (0 == level) {
-        if (item->isCheckable()) {
-            QString objname         = d_ptr->itemObjectName(item);
-            SARibbonCustomizeData d = SARibbonCustomizeData::makeVisibleCategoryCustomizeData(objname,
-                                                                                              item->checkState()
-                                                                                                  == Qt::Checked);
-            d_ptr->mCustomizeDatasCache.append(d);
-        }
-    }
+void SARibbonCustomizeWidget::onUndoStackIndexChanged(int idx)
+{
+    Q_UNUSED(idx);
+    // 撤销/重做后选中的节点可能已经被移除，重新判断按钮状态
+    ui->pushButtonAdd->setEnabled(selectedAction() && isSelectedItemCanCustomize() && selectedRibbonLevel() > 0);
+    ui->pushButtonDelete->setEnabled(isSelectedItemCanCustomize());
 }
 
 void SARibbonCustomizeWidget::onLineEditSearchActionTextEdited(const QString& text)
@@ -1509,5 +2482,7 @@ void SARibbonCustomizeWidget::onPushButtonResetClicked()
 
     if (btn == QMessageBox::Yes) {
         clear();
+        // 未应用的动作已经清除，树恢复为ribbonbar当前的状态
+        updateModel();
     }
 }
@@ -2,6 +2,7 @@
 #define SARIBBONCUSTOMIZEWIDGET_H
 #include "SARibbonGlobal.h"
 #include <QWidget>
+#include <QAbstractItemModel>
 #include "SARibbonActionsManager.h"
 #include "SARibbonPannel.h"
 #include "SARibbonCustomizeData.h"
@@ -10,13 +11,14 @@
 class SARibbonCustomizeWidgetUi;
 class SARibbonMainWindow;
 class SARibbonBar;
+class SARibbonCustomizeTreeModel;
 //
-class QStandardItemModel;
-class QStandardItem;
 class QAbstractButton;
+class QUndoStack;
 //
 class QXmlStreamWriter;
 class QXmlStreamReader;
+class QIODevice;
 
 /**
  * @brief 自定义界面窗口
@@ -45,7 +47,7 @@ public:
     };
 
     /**
-     * @brief QStandardItem对应的role
+     * @brief ribbon树节点对应的role，见@ref SARibbonCustomizeTreeModel
      */
     enum ItemRole
     {
@@ -66,7 +68,10 @@ public:
 	bool isCached() const;
 
     //获取model
-    const QStandardItemModel* model() const;
+    const SARibbonCustomizeTreeModel* model() const;
+
+    //获取撤销栈
+    QUndoStack* undoStack() const;
 
     //根据当前的radiobutton选项来更新model
     void updateModel();
@@ -81,8 +86,13 @@ public:
     bool toXml(QXmlStreamWriter* xml) const;
     bool toXml(const QString& xmlpath) const;
 
+    //转换为二进制格式，比xml更小，加载更快
+    bool toBinary(QIODevice* dev) const;
+    bool toBinary(const QString& filepath) const;
+
     //从xml中加载QList<SARibbonCustomizeData>，对于基于配置文件的设置，对话框显示前建议调用此函数，保证叠加设置的正确记录
     void fromXml(QXmlStreamReader* xml);
+    //从文件中加载，自动识别xml和二进制格式
     void fromXml(const QString& xmlpath);
 
     //应用xml配置，可以结合customize_datas_from_xml和customize_datas_apply函数
@@ -105,30 +115,27 @@ protected:
     SARibbonPannelItem::RowProportion selectedRowProportion() const;
 
     QAction* selectedAction() const;
-    QAction* itemToAction(QStandardItem* item) const;
+    QAction* indexToAction(const QModelIndex& index) const;
 
-    QStandardItem* selectedItem() const;
+    QModelIndex selectedIndex() const;
 
     //获取选中的ribbon tree 的level
     int selectedRibbonLevel() const;
 
-    //根据选中的item判断
-    int itemLevel(QStandardItem* item) const;
+    //获取节点的level
+    int indexLevel(const QModelIndex& index) const;
 
-    //设置某个item被选中
-    void setSelectItem(QStandardItem* item, bool ensureVisible = true);
+    //设置某个节点被选中
+    void setSelectIndex(const QModelIndex& index, bool ensureVisible = true);
 
-    //判断itemn能否改动，可以改动返回true
-    bool isItemCanCustomize(QStandardItem* item) const;
+    //判断节点能否改动，可以改动返回true
+    bool isIndexCanCustomize(const QModelIndex& index) const;
     bool isSelectedItemCanCustomize() const;
 
-    //判断item是否是自定义的item
-    bool isCustomizeItem(QStandardItem* item) const;
+    //判断节点是否是自定义的
+    bool isCustomizeIndex(const QModelIndex& index) const;
     bool isSelectedItemIsCustomize() const;
 
-    //删除一个item
-    void removeItem(QStandardItem* item);
-
 private slots:
     void onComboBoxActionIndexCurrentIndexChanged(int index);
     void onRadioButtonGroupButtonClicked(QAbstractButton* b);
@@ -141,7 +148,8 @@ private slots:
     void onTreeViewResultClicked(const QModelIndex& index);
     void onToolButtonUpClicked();
     void onToolButtonDownClicked();
-    void onItemChanged(QStandardItem* item);
+    void onCategoryCheckStateChanged(const QModelIndex& index, bool checked);
+    void onUndoStackIndexChanged(int idx);
     void onLineEditSearchActionTextEdited(const QString& text);
     void onPushButtonResetClicked();
 
@@ -153,6 +161,76 @@ private:
     SARibbonCustomizeWidgetUi* ui;
 };
 
+/**
+ * @brief 自定义界面中的ribbon树
+ *
+ * 直接读取ribbonbar中的category、pannel和action，并叠加尚未应用的@ref SARibbonCustomizeData ，
+ * pannel和action在第一次被访问（展开）时才加载
+ *
+ * 自定义操作通过@ref applyCustomizeData 同步到model，只修改受影响的节点并发出对应的
+ * insert/remove/move/dataChanged信号，不会重建整个model，每次同步都会记录撤销所需的信息，
+ * 通过@ref revertLastCustomizeData 按后进先出的顺序撤销
+ *
+ * 节点的数据角色见@ref SARibbonCustomizeWidget::ItemRole
+ */
+class SA_RIBBON_EXPORT SARibbonCustomizeTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonCustomizeTreeModel)
+public:
+    explicit SARibbonCustomizeTreeModel(QObject* p = nullptr);
+    ~SARibbonCustomizeTreeModel();
+    virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    virtual QModelIndex parent(const QModelIndex& index) const override;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    virtual bool canFetchMore(const QModelIndex& parent) const override;
+    virtual void fetchMore(const QModelIndex& parent) override;
+    virtual Qt::ItemFlags flags(const QModelIndex& index) const override;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    virtual bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    //设置ribbonbar
+    void setRibbonBar(SARibbonBar* bar);
+    SARibbonBar* ribbonBar() const;
+    //是否显示上下文标签，reload后生效
+    void setShowContextCategory(bool on);
+    bool isShowContextCategory() const;
+    //从ribbonbar重新加载，并叠加未应用的自定义操作
+    void reload(const QList< SARibbonCustomizeData >& pending = QList< SARibbonCustomizeData >());
+    //把一条自定义操作同步到model，返回受影响的节点
+    QModelIndex applyCustomizeData(const SARibbonCustomizeData& d, const QModelIndex& target = QModelIndex());
+    //撤销最近一次applyCustomizeData，返回受影响的节点
+    QModelIndex revertLastCustomizeData();
+    //撤销记录的条数
+    int journalCount() const;
+    //清空撤销记录
+    void clearJournal();
+    //删除最早的撤销记录，只保留最近的keepCount条
+    void trimJournal(int keepCount);
+    //节点的level，0：category 1：pannel 2：action，无效节点返回-1
+    int indexLevel(const QModelIndex& index) const;
+    //节点对应的objectName，自定义节点返回自定义的objectName
+    QString indexObjectName(const QModelIndex& index) const;
+    //是否是自定义的节点
+    bool isCustomizeIndex(const QModelIndex& index) const;
+    //是否允许自定义
+    bool isIndexCanCustomize(const QModelIndex& index) const;
+    //节点转换为对应的对象，非此类节点或自定义节点（action除外）返回nullptr
+    SARibbonCategory* indexToCategory(const QModelIndex& index) const;
+    SARibbonPannel* indexToPannel(const QModelIndex& index) const;
+    QAction* indexToAction(const QModelIndex& index) const;
+
+signals:
+    /**
+     * @brief 用户通过勾选请求改变category的显示状态
+     *
+     * 只有通过界面（setData）勾选才会发射，model不会直接修改勾选状态，
+     * 接收者需要通过@ref applyCustomizeData 应用对应的@ref SARibbonCustomizeData::VisibleCategoryActionType
+     */
+    void categoryCheckStateChanged(const QModelIndex& index, bool checked);
+};
+
 /**
  * @brief 转换为xml
  *
@@ -174,8 +252,44 @@ bool SA_RIBBON_EXPORT sa_customize_datas_to_xml(QXmlStreamWriter* xml, const QLi
  */
 QList< SARibbonCustomizeData > SA_RIBBON_EXPORT sa_customize_datas_from_xml(QXmlStreamReader* xml, SARibbonActionsManager* mgr);
 
+/**
+ * @brief 以二进制格式写入QList<SARibbonCustomizeData>
+ *
+ * 格式为：文件头标识"SARC"、版本号、字符串表、操作列表，category、pannel的objectName和action的key
+ * 都存放在字符串表中，操作中只记录字符串的索引，因此比xml小很多，加载时也不需要解析文本
+ * @param dev 已打开的QIODevice
+ * @param cds 基于QList<SARibbonCustomizeData>生成的步骤
+ * @return 如果出现异常，返回false,如果没有自定义数据也会返回false
+ */
+bool SA_RIBBON_EXPORT sa_customize_datas_to_binary(QIODevice* dev, const QList< SARibbonCustomizeData >& cds);
+
+/**
+ * @brief 读取@ref sa_customize_datas_to_binary 写入的QList<SARibbonCustomizeData>
+ * @param dev 已打开的QIODevice
+ * @param mgr
+ * @return QList<SARibbonCustomizeData>，数据异常时返回空
+ */
+QList< SARibbonCustomizeData > SA_RIBBON_EXPORT sa_customize_datas_from_binary(QIODevice* dev, SARibbonActionsManager* mgr);
+
+/**
+ * @brief 判断QIODevice当前位置的数据是否是二进制格式，不会改变读取位置
+ * @param dev
+ * @return
+ */
+bool SA_RIBBON_EXPORT sa_customize_datas_is_binary(QIODevice* dev);
+
+/**
+ * @brief 从QIODevice中读取QList<SARibbonCustomizeData>，自动识别xml和二进制格式
+ * @param dev 已打开的QIODevice，如果是文件，不要以QIODevice::Text方式打开
+ * @param mgr
+ * @return QList<SARibbonCustomizeData>
+ */
+QList< SARibbonCustomizeData > SA_RIBBON_EXPORT sa_customize_datas_from_device(QIODevice* dev, SARibbonActionsManager* mgr);
+
 /**
  * @brief 应用QList<SARibbonCustomizeData>
+ *
+ * 通过@ref SARibbonCustomizeDataApplier 批量应用，需要获取失败条目时直接使用SARibbonCustomizeDataApplier
  * @param cds
  * @param w SARibbonBar指针
  * @return 成功应用的个数
@@ -192,7 +306,9 @@ int SA_RIBBON_EXPORT sa_customize_datas_reverse(const QList< SARibbonCustomizeDa
 
 /**
  * @brief 直接加载xml自定义ribbon配置文件用于ribbon的自定义显示
- * @param filePath xml配置文件
+ *
+ * 会自动识别@ref sa_customize_datas_to_binary 生成的二进制格式
+ * @param filePath xml或二进制配置文件
  * @param w 主窗体
  * @param mgr action管理器
  * @return 成功返回true
@@ -0,0 +1,595 @@
+﻿#include "SARibbonDescription.h"
+#include <QColor>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QXmlStreamReader>
+#include "SARibbonActionsManager.h"
+#include "SARibbonBar.h"
+#include "SARibbonElementManager.h"
+#include "SARibbonGallery.h"
+#include "SARibbonQuickAccessBar.h"
+
+/**
+ * @brief 解析行占比，支持large、medium、small、none以及对应的数字
+ */
+static SARibbonPannelItem::RowProportion sa_description_row_proportion(const QString& s)
+{
+    const QString v = s.trimmed().toLower();
+    if (v.isEmpty() || v == QLatin1String("large")) {
+        return SARibbonPannelItem::Large;
+    } else if (v == QLatin1String("medium")) {
+        return SARibbonPannelItem::Medium;
+    } else if (v == QLatin1String("small")) {
+        return SARibbonPannelItem::Small;
+    } else if (v == QLatin1String("none")) {
+        return SARibbonPannelItem::None;
+    }
+    bool isOk = false;
+    int n     = v.toInt(&isOk);
+    if (isOk && n >= SARibbonPannelItem::None && n <= SARibbonPannelItem::Small) {
+        return static_cast< SARibbonPannelItem::RowProportion >(n);
+    }
+    return SARibbonPannelItem::Large;
+}
+
+//===================================================
+// json
+//===================================================
+
+static bool sa_description_item_from_json(const QJsonValue& v, SARibbonDescription::Item& item, QString& err)
+{
+    if (v.isString()) {
+        item.type = SARibbonDescription::Item::Action;
+        item.key  = v.toString();
+        return true;
+    }
+    if (!v.isObject()) {
+        err = QStringLiteral("item must be a string or an object");
+        return false;
+    }
+    const QJsonObject obj = v.toObject();
+    const QString type    = obj.value(QStringLiteral("type")).toString(QStringLiteral("action"));
+    if (type == QLatin1String("action")) {
+        item.type          = SARibbonDescription::Item::Action;
+        item.key           = obj.value(QStringLiteral("key")).toString();
+        item.rowProportion = sa_description_row_proportion(obj.value(QStringLiteral("row")).toVariant().toString());
+    } else if (type == QLatin1String("separator")) {
+        item.type = SARibbonDescription::Item::Separator;
+    } else if (type == QLatin1String("gallery")) {
+        item.type               = SARibbonDescription::Item::Gallery;
+        const QJsonArray groups = obj.value(QStringLiteral("groups")).toArray();
+        for (const QJsonValue& g : groups) {
+            const QJsonObject gobj = g.toObject();
+            SARibbonDescription::GalleryGroup group;
+            group.title              = gobj.value(QStringLiteral("title")).toString();
+            const QJsonArray actions = gobj.value(QStringLiteral("actions")).toArray();
+            for (const QJsonValue& a : actions) {
+                group.actionKeys.append(a.toString());
+            }
+            item.galleryGroups.append(group);
+        }
+    } else {
+        err = QStringLiteral("unknown item type \"%1\"").arg(type);
+        return false;
+    }
+    return true;
+}
+
+static bool sa_description_category_from_json(const QJsonObject& obj, SARibbonDescription::Category& c, QString& err)
+{
+    c.name                   = obj.value(QStringLiteral("name")).toString();
+    c.objectName             = obj.value(QStringLiteral("objectName")).toString(c.name);
+    const QJsonArray pannels = obj.value(QStringLiteral("pannels")).toArray();
+    for (const QJsonValue& pv : pannels) {
+        const QJsonObject pobj = pv.toObject();
+        SARibbonDescription::Pannel p;
+        p.name                 = pobj.value(QStringLiteral("name")).toString();
+        p.objectName           = pobj.value(QStringLiteral("objectName")).toString(p.name);
+        const QJsonArray items = pobj.value(QStringLiteral("items")).toArray();
+        for (const QJsonValue& iv : items) {
+            SARibbonDescription::Item item;
+            if (!sa_description_item_from_json(iv, item, err)) {
+                err = QStringLiteral("pannel \"%1\": %2").arg(p.name, err);
+                return false;
+            }
+            p.items.append(item);
+        }
+        c.pannels.append(p);
+    }
+    return true;
+}
+
+//===================================================
+// xml
+//===================================================
+
+static SARibbonDescription::Item sa_description_action_from_xml(QXmlStreamReader& xml)
+{
+    SARibbonDescription::Item item;
+    item.type          = SARibbonDescription::Item::Action;
+    item.key           = xml.attributes().value(QStringLiteral("key")).toString();
+    item.rowProportion = sa_description_row_proportion(xml.attributes().value(QStringLiteral("row")).toString());
+    xml.skipCurrentElement();
+    return item;
+}
+
+static SARibbonDescription::Item sa_description_gallery_from_xml(QXmlStreamReader& xml)
+{
+    SARibbonDescription::Item item;
+    item.type = SARibbonDescription::Item::Gallery;
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("group")) {
+            SARibbonDescription::GalleryGroup group;
+            group.title = xml.attributes().value(QStringLiteral("title")).toString();
+            while (xml.readNextStartElement()) {
+                if (xml.name() == QLatin1String("action")) {
+                    group.actionKeys.append(xml.attributes().value(QStringLiteral("key")).toString());
+                }
+                xml.skipCurrentElement();
+            }
+            item.galleryGroups.append(group);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    return item;
+}
+
+/**
+ * @brief 读取action和separator，返回false说明不是这两种元素
+ */
+static bool sa_description_simple_item_from_xml(QXmlStreamReader& xml, QList< SARibbonDescription::Item >& items)
+{
+    if (xml.name() == QLatin1String("action")) {
+        items.append(sa_description_action_from_xml(xml));
+        return true;
+    } else if (xml.name() == QLatin1String("separator")) {
+        SARibbonDescription::Item item;
+        item.type = SARibbonDescription::Item::Separator;
+        items.append(item);
+        xml.skipCurrentElement();
+        return true;
+    }
+    return false;
+}
+
+static SARibbonDescription::Category sa_description_category_from_xml(QXmlStreamReader& xml)
+{
+    SARibbonDescription::Category c;
+    c.name       = xml.attributes().value(QStringLiteral("name")).toString();
+    c.objectName = xml.attributes().hasAttribute(QStringLiteral("objectName"))
+                       ? xml.attributes().value(QStringLiteral("objectName")).toString()
+                       : c.name;
+    while (xml.readNextStartElement()) {
+        if (xml.name() != QLatin1String("pannel")) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        SARibbonDescription::Pannel p;
+        p.name       = xml.attributes().value(QStringLiteral("name")).toString();
+        p.objectName = xml.attributes().hasAttribute(QStringLiteral("objectName"))
+                           ? xml.attributes().value(QStringLiteral("objectName")).toString()
+                           : p.name;
+        while (xml.readNextStartElement()) {
+            if (sa_description_simple_item_from_xml(xml, p.items)) {
+                continue;
+            }
+            if (xml.name() == QLatin1String("gallery")) {
+                p.items.append(sa_description_gallery_from_xml(xml));
+            } else {
+                xml.skipCurrentElement();
+            }
+        }
+        c.pannels.append(p);
+    }
+    return c;
+}
+
+//===================================================
+// SARibbonDescription
+//===================================================
+
+/**
+ * @brief 解析json
+ * @param data
+ * @param errorString 失败时记录错误信息
+ * @return 失败返回false，此时内容为空
+ */
+bool SARibbonDescription::fromJson(const QByteArray& data, QString* errorString)
+{
+    clear();
+    QJsonParseError jsonErr;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &jsonErr);
+    QString err;
+    if (jsonErr.error != QJsonParseError::NoError) {
+        err = jsonErr.errorString();
+    } else if (!doc.isObject()) {
+        err = QStringLiteral("root must be an object");
+    }
+    const QJsonObject root = doc.object();
+    if (err.isEmpty()) {
+        const QJsonArray cs = root.value(QStringLiteral("categories")).toArray();
+        for (int i = 0; i < cs.size() && err.isEmpty(); ++i) {
+            Category c;
+            if (sa_description_category_from_json(cs[ i ].toObject(), c, err)) {
+                categories.append(c);
+            }
+        }
+    }
+    if (err.isEmpty()) {
+        const QJsonArray ccs = root.value(QStringLiteral("contextCategories")).toArray();
+        for (int i = 0; i < ccs.size() && err.isEmpty(); ++i) {
+            const QJsonObject obj = ccs[ i ].toObject();
+            ContextCategory cc;
+            cc.title            = obj.value(QStringLiteral("title")).toString();
+            cc.color            = obj.value(QStringLiteral("color")).toString();
+            cc.id               = obj.value(QStringLiteral("id")).toVariant().toString();
+            const QJsonArray cs = obj.value(QStringLiteral("categories")).toArray();
+            for (int j = 0; j < cs.size() && err.isEmpty(); ++j) {
+                Category c;
+                if (sa_description_category_from_json(cs[ j ].toObject(), c, err)) {
+                    cc.categories.append(c);
+                }
+            }
+            contextCategories.append(cc);
+        }
+    }
+    if (err.isEmpty()) {
+        const QJsonArray qs = root.value(QStringLiteral("quickAccessBar")).toArray();
+        for (int i = 0; i < qs.size() && err.isEmpty(); ++i) {
+            Item item;
+            if (sa_description_item_from_json(qs[ i ], item, err)) {
+                quickAccessItems.append(item);
+            }
+        }
+    }
+    if (!err.isEmpty()) {
+        clear();
+        if (errorString) {
+            *errorString = err;
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 解析xml
+ * @param data
+ * @param errorString 失败时记录错误信息
+ * @return 失败返回false，此时内容为空
+ */
+bool SARibbonDescription::fromXml(const QByteArray& data, QString* errorString)
+{
+    clear();
+    QXmlStreamReader xml(data);
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("sa-ribbon")) {
+        while (xml.readNextStartElement()) {
+            if (xml.name() == QLatin1String("category")) {
+                categories.append(sa_description_category_from_xml(xml));
+            } else if (xml.name() == QLatin1String("context-category")) {
+                ContextCategory cc;
+                cc.title = xml.attributes().value(QStringLiteral("title")).toString();
+                cc.color = xml.attributes().value(QStringLiteral("color")).toString();
+                cc.id    = xml.attributes().value(QStringLiteral("id")).toString();
+                while (xml.readNextStartElement()) {
+                    if (xml.name() == QLatin1String("category")) {
+                        cc.categories.append(sa_description_category_from_xml(xml));
+                    } else {
+                        xml.skipCurrentElement();
+                    }
+                }
+                contextCategories.append(cc);
+            } else if (xml.name() == QLatin1String("quick-access-bar")) {
+                while (xml.readNextStartElement()) {
+                    if (!sa_description_simple_item_from_xml(xml, quickAccessItems)) {
+                        xml.skipCurrentElement();
+                    }
+                }
+            } else {
+                xml.skipCurrentElement();
+            }
+        }
+    } else if (!xml.hasError()) {
+        xml.raiseError(QStringLiteral("root element must be sa-ribbon"));
+    }
+    if (xml.hasError()) {
+        if (errorString) {
+            *errorString = QStringLiteral("line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        }
+        clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 根据内容自动识别json或xml，第一个非空白字符为<时按xml解析
+ * @param data
+ * @param errorString
+ * @return
+ */
+bool SARibbonDescription::fromData(const QByteArray& data, QString* errorString)
+{
+    for (char ch : data) {
+        if (ch == '<') {
+            return fromXml(data, errorString);
+        } else if (!QChar::isSpace(static_cast< uchar >(ch)) && static_cast< uchar >(ch) < 0x80) {
+            break;
+        }
+    }
+    return fromJson(data, errorString);
+}
+
+/**
+ * @brief 校验描述
+ *
+ * 检查未知的action key、空的名字以及重复的objectName，此函数可以在非gui线程调用
+ * @param actionKeys 可用的action key，见@ref SARibbonDescriptionBuilder::actionKeys
+ * @return 所有的错误信息，没有错误返回空
+ */
+QStringList SARibbonDescription::validate(const QSet< QString >& actionKeys) const
+{
+    QStringList errs;
+    QSet< QString > categoryObjNames;
+    auto checkKey = [ & ](const QString& key, const QString& where) {
+        if (key.isEmpty()) {
+            errs << QStringLiteral("%1: empty action key").arg(where);
+        } else if (!actionKeys.contains(key)) {
+            errs << QStringLiteral("%1: unknown action key \"%2\"").arg(where, key);
+        }
+    };
+    auto checkCategory = [ & ](const Category& c) {
+        if (c.name.isEmpty()) {
+            errs << QStringLiteral("category with empty name");
+        }
+        if (categoryObjNames.contains(c.objectName)) {
+            errs << QStringLiteral("duplicate category objectName \"%1\"").arg(c.objectName);
+        }
+        categoryObjNames.insert(c.objectName);
+        QSet< QString > pannelObjNames;
+        for (const Pannel& p : c.pannels) {
+            const QString where = QStringLiteral("%1/%2").arg(c.name, p.name);
+            if (pannelObjNames.contains(p.objectName)) {
+                errs << QStringLiteral("%1: duplicate pannel objectName \"%2\"").arg(where, p.objectName);
+            }
+            pannelObjNames.insert(p.objectName);
+            for (const Item& item : p.items) {
+                if (Item::Action == item.type) {
+                    checkKey(item.key, where);
+                } else if (Item::Gallery == item.type) {
+                    for (const GalleryGroup& g : item.galleryGroups) {
+                        for (const QString& k : g.actionKeys) {
+                            checkKey(k, where);
+                        }
+                    }
+                }
+            }
+        }
+    };
+    for (const Category& c : categories) {
+        checkCategory(c);
+    }
+    for (const ContextCategory& cc : contextCategories) {
+        for (const Category& c : cc.categories) {
+            checkCategory(c);
+        }
+    }
+    for (const Item& item : quickAccessItems) {
+        if (Item::Action == item.type) {
+            checkKey(item.key, QStringLiteral("quick access bar"));
+        }
+    }
+    return errs;
+}
+
+/**
+ * @brief 描述中引用的所有action的key
+ * @return
+ */
+QSet< QString > SARibbonDescription::referencedActionKeys() const
+{
+    QSet< QString > res;
+    auto addItems = [ &res ](const QList< Item >& items) {
+        for (const Item& item : items) {
+            if (Item::Action == item.type) {
+                res.insert(item.key);
+            } else if (Item::Gallery == item.type) {
+                for (const GalleryGroup& g : item.galleryGroups) {
+                    for (const QString& k : g.actionKeys) {
+                        res.insert(k);
+                    }
+                }
+            }
+        }
+    };
+    auto addCategory = [ &addItems ](const Category& c) {
+        for (const Pannel& p : c.pannels) {
+            addItems(p.items);
+        }
+    };
+    for (const Category& c : categories) {
+        addCategory(c);
+    }
+    for (const ContextCategory& cc : contextCategories) {
+        for (const Category& c : cc.categories) {
+            addCategory(c);
+        }
+    }
+    addItems(quickAccessItems);
+    return res;
+}
+
+void SARibbonDescription::clear()
+{
+    categories.clear();
+    contextCategories.clear();
+    quickAccessItems.clear();
+}
+
+//===================================================
+// SARibbonDescriptionBuilder
+//===================================================
+
+class SARibbonDescriptionBuilder::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonDescriptionBuilder)
+public:
+    PrivateData(SARibbonDescriptionBuilder* p, SARibbonBar* bar, SARibbonActionsManager* mgr);
+    QAction* action(const QString& key, const QString& where);
+    // 在ribbonbar之外构建category
+    SARibbonCategory* buildCategory(const SARibbonDescription::Category& desc);
+
+public:
+    SARibbonBar* mBar { nullptr };
+    SARibbonActionsManager* mActionsManager { nullptr };
+    QStringList mErrors;
+};
+
+SARibbonDescriptionBuilder::PrivateData::PrivateData(SARibbonDescriptionBuilder* p,
+                                                     SARibbonBar* bar,
+                                                     SARibbonActionsManager* mgr)
+    : q_ptr(p), mBar(bar), mActionsManager(mgr)
+{
+}
+
+QAction* SARibbonDescriptionBuilder::PrivateData::action(const QString& key, const QString& where)
+{
+    QAction* act = mActionsManager ? mActionsManager->action(key) : nullptr;
+    if (nullptr == act) {
+        mErrors << QStringLiteral("%1: unknown action key \"%2\"").arg(where, key);
+    }
+    return act;
+}
+
+SARibbonCategory* SARibbonDescriptionBuilder::PrivateData::buildCategory(const SARibbonDescription::Category& desc)
+{
+    SARibbonCategory* category = RibbonSubElementFactory->createRibbonCategory(nullptr);
+    category->setCategoryName(desc.name);
+    category->setObjectName(desc.objectName);
+    for (const SARibbonDescription::Pannel& pd : desc.pannels) {
+        const QString where    = QStringLiteral("%1/%2").arg(desc.name, pd.name);
+        SARibbonPannel* pannel = RibbonSubElementFactory->createRibbonPannel(category);
+        pannel->setPannelName(pd.name);
+        pannel->setObjectName(pd.objectName);
+        for (const SARibbonDescription::Item& item : pd.items) {
+            switch (item.type) {
+            case SARibbonDescription::Item::Action:
+                if (QAction* act = action(item.key, where)) {
+                    pannel->addAction(act, item.rowProportion);
+                }
+                break;
+            case SARibbonDescription::Item::Separator:
+                pannel->addSeparator();
+                break;
+            case SARibbonDescription::Item::Gallery: {
+                SARibbonGallery* gallery = pannel->addGallery();
+                for (const SARibbonDescription::GalleryGroup& g : item.galleryGroups) {
+                    QList< QAction* > acts;
+                    for (const QString& k : g.actionKeys) {
+                        if (QAction* act = action(k, where)) {
+                            acts.append(act);
+                        }
+                    }
+                    gallery->addCategoryActions(g.title, acts);
+                }
+            } break;
+            default:
+                break;
+            }
+        }
+        category->addPannel(pannel);
+    }
+    return category;
+}
+
+SARibbonDescriptionBuilder::SARibbonDescriptionBuilder(SARibbonBar* bar, SARibbonActionsManager* mgr)
+    : d_ptr(new SARibbonDescriptionBuilder::PrivateData(this, bar, mgr))
+{
+}
+
+SARibbonDescriptionBuilder::~SARibbonDescriptionBuilder()
+{
+}
+
+/**
+ * @brief 构建ribbon
+ *
+ * 描述中的内容追加到ribbonbar现有内容之后，找不到的action会跳过并记录到@ref errors
+ * @param desc
+ * @return 全部成功返回true
+ */
+bool SARibbonDescriptionBuilder::build(const SARibbonDescription& desc)
+{
+    d_ptr->mErrors.clear();
+    SARibbonBar* bar = d_ptr->mBar;
+    if (nullptr == bar) {
+        d_ptr->mErrors << QStringLiteral("ribbon bar is null");
+        return false;
+    }
+    const bool updatesEnabled = bar->updatesEnabled();
+    bar->setUpdatesEnabled(false);
+    bar->beginActionStateUpdate();
+    for (const SARibbonDescription::Category& c : desc.categories) {
+        bar->addCategoryPage(d_ptr->buildCategory(c));
+    }
+    for (const SARibbonDescription::ContextCategory& cc : desc.contextCategories) {
+        SARibbonContextCategory* context = bar->addContextCategory(cc.title,
+                                                                   cc.color.isEmpty() ? QColor() : QColor(cc.color),
+                                                                   cc.id.isEmpty() ? QVariant() : QVariant(cc.id));
+        for (const SARibbonDescription::Category& c : cc.categories) {
+            SARibbonCategory* category = d_ptr->buildCategory(c);
+            // 上下文标签的category不经过insertCategoryPage，这里同步pannel的布局方式
+            category->setPannelLayoutMode(bar->pannelLayoutMode());
+            context->addCategoryPage(category);
+        }
+    }
+    if (SARibbonQuickAccessBar* quickAccessBar = bar->quickAccessBar()) {
+        for (const SARibbonDescription::Item& item : desc.quickAccessItems) {
+            if (SARibbonDescription::Item::Separator == item.type) {
+                quickAccessBar->addSeparator();
+            } else if (SARibbonDescription::Item::Action == item.type) {
+                if (QAction* act = d_ptr->action(item.key, QStringLiteral("quick access bar"))) {
+                    quickAccessBar->addAction(act);
+                }
+            }
+        }
+    }
+    bar->endActionStateUpdate();
+    bar->updateRibbonGeometry();
+    bar->setUpdatesEnabled(updatesEnabled);
+    if (updatesEnabled) {
+        bar->update();
+    }
+    return d_ptr->mErrors.isEmpty();
+}
+
+/**
+ * @brief 最近一次build的错误信息
+ * @return
+ */
+QStringList SARibbonDescriptionBuilder::errors() const
+{
+    return d_ptr->mErrors;
+}
+
+/**
+ * @brief 获取SARibbonActionsManager所有的key
+ *
+ * 需要在gui线程调用，返回值可以传给其它线程用于@ref SARibbonDescription::validate
+ * @param mgr
+ * @return
+ */
+QSet< QString > SARibbonDescriptionBuilder::actionKeys(SARibbonActionsManager* mgr)
+{
+    QSet< QString > res;
+    if (nullptr == mgr) {
+        return res;
+    }
+    const QList< QAction* > acts = mgr->allActions();
+    for (QAction* act : acts) {
+        res.insert(mgr->key(act));
+    }
+    return res;
+}
@@ -0,0 +1,167 @@
+﻿#ifndef SARIBBONDESCRIPTION_H
+#define SARIBBONDESCRIPTION_H
+#include "SARibbonGlobal.h"
+#include "SARibbonPannelItem.h"
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+class SARibbonBar;
+class SARibbonCategory;
+class SARibbonActionsManager;
+
+/**
+ * @brief ribbon的声明式描述
+ *
+ * 通过json或xml描述整个ribbon（category、上下文标签、pannel、action、画廊和快速响应栏），
+ * action通过@ref SARibbonActionsManager 的key引用，由@ref SARibbonDescriptionBuilder 构建
+ *
+ * 此类只包含字符串等数据，不涉及任何QObject，解析（@ref fromJson 、@ref fromXml ）和校验（@ref validate ）
+ * 都可以在非gui线程中进行
+ *
+ * json格式：
+ * @code
+ * {
+ *   "categories": [
+ *     { "name": "Main", "objectName": "main",
+ *       "pannels": [
+ *         { "name": "File", "objectName": "file",
+ *           "items": [
+ *             { "type": "action", "key": "open", "row": "large" },
+ *             "save",
+ *             { "type": "separator" },
+ *             { "type": "gallery", "groups": [ { "title": "Shapes", "actions": [ "rect", "circle" ] } ] }
+ *           ] } ] } ],
+ *   "contextCategories": [
+ *     { "title": "Table", "color": "#c86464", "id": "table", "categories": [ ... ] } ],
+ *   "quickAccessBar": [ "undo", "redo", { "type": "separator" } ]
+ * }
+ * @endcode
+ * 字符串形式的item等价于{ "type": "action", "key": 字符串 }，row可选large、medium、small，默认为large
+ *
+ * xml格式：
+ * @code
+ * <sa-ribbon>
+ *   <category name="Main" objectName="main">
+ *     <pannel name="File" objectName="file">
+ *       <action key="open" row="large"/>
+ *       <separator/>
+ *       <gallery>
+ *         <group title="Shapes"><action key="rect"/><action key="circle"/></group>
+ *       </gallery>
+ *     </pannel>
+ *   </category>
+ *   <context-category title="Table" color="#c86464" id="table">
+ *     <category name="Layout">...</category>
+ *   </context-category>
+ *   <quick-access-bar><action key="undo"/><separator/></quick-access-bar>
+ * </sa-ribbon>
+ * @endcode
+ * objectName可省略，省略时和name一致
+ */
+class SA_RIBBON_EXPORT SARibbonDescription
+{
+public:
+    /**
+     * @brief 画廊中的一组action
+     */
+    struct GalleryGroup
+    {
+        QString title;
+        QStringList actionKeys;
+    };
+
+    /**
+     * @brief pannel中的一项
+     */
+    struct Item
+    {
+        enum Type
+        {
+            Action,     ///< action
+            Separator,  ///< 分割线
+            Gallery     ///< 画廊
+        };
+        Type type { Action };
+        QString key;  ///< action的key，type==Action时有效
+        SARibbonPannelItem::RowProportion rowProportion { SARibbonPannelItem::Large };
+        QList< GalleryGroup > galleryGroups;  ///< type==Gallery时有效
+    };
+
+    struct Pannel
+    {
+        QString name;
+        QString objectName;
+        QList< Item > items;
+    };
+
+    struct Category
+    {
+        QString name;
+        QString objectName;
+        QList< Pannel > pannels;
+    };
+
+    struct ContextCategory
+    {
+        QString title;
+        QString color;  ///< 颜色名，例如#c86464，为空时使用默认的色系
+        QString id;
+        QList< Category > categories;
+    };
+
+public:
+    //解析json，失败返回false
+    bool fromJson(const QByteArray& data, QString* errorString = nullptr);
+    //解析xml，失败返回false
+    bool fromXml(const QByteArray& data, QString* errorString = nullptr);
+    //根据内容自动识别json或xml
+    bool fromData(const QByteArray& data, QString* errorString = nullptr);
+    //校验，返回所有错误信息，没有错误返回空
+    QStringList validate(const QSet< QString >& actionKeys) const;
+    //描述中引用的所有action的key
+    QSet< QString > referencedActionKeys() const;
+    //清空
+    void clear();
+
+public:
+    QList< Category > categories;
+    QList< ContextCategory > contextCategories;
+    QList< Item > quickAccessItems;  ///< 快速响应栏，只支持action和separator
+};
+
+/**
+ * @brief 根据@ref SARibbonDescription 构建ribbon
+ *
+ * 每个category先在ribbonbar之外完整构建，再添加到ribbonbar，构建过程中ribbonbar不刷新，
+ * 结束后调用一次@ref SARibbonBar::updateRibbonGeometry ，避免逐个添加时反复触发布局
+ *
+ * 在其它线程中解析和校验，在gui线程中构建：
+ * @code
+ * QSet< QString > keys = SARibbonDescriptionBuilder::actionKeys(mgr);  // gui线程
+ * QFuture< SARibbonDescription > f = QtConcurrent::run([ data, keys ]() {
+ *     SARibbonDescription desc;
+ *     desc.fromData(data);
+ *     desc.validate(keys);
+ *     return desc;
+ * });
+ * // ... 完成后回到gui线程
+ * SARibbonDescriptionBuilder builder(ribbonBar, mgr);
+ * builder.build(f.result());
+ * @endcode
+ */
+class SA_RIBBON_EXPORT SARibbonDescriptionBuilder
+{
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonDescriptionBuilder)
+public:
+    SARibbonDescriptionBuilder(SARibbonBar* bar, SARibbonActionsManager* mgr);
+    ~SARibbonDescriptionBuilder();
+    //构建，找不到的action会跳过并记录错误，全部成功返回true
+    bool build(const SARibbonDescription& desc);
+    //最近一次build的错误信息
+    QStringList errors() const;
+    //获取SARibbonActionsManager所有的key，用于在其它线程中校验
+    static QSet< QString > actionKeys(SARibbonActionsManager* mgr);
+};
+
+#endif  // SARIBBONDESCRIPTION_H
@@ -105,6 +105,7 @@ public:
         viewportGroup->setSpacing(v->spacing());
         viewportGroup->setGridMaximumWidth(v->gridMaximumWidth());
         viewportGroup->setGridMinimumWidth(v->gridMinimumWidth());
+        viewportGroup->setEnableItemPixmapCache(v->isEnableItemPixmapCache());
         viewportGroup->setRecalcGridSizeBlock(false);
         viewportGroup->recalcGridSize(viewportGroup->height());
         viewportGroup->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
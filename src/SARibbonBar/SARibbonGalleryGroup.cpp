@@ -3,6 +3,9 @@
 #include <QDebug>
 #include <QActionGroup>
 #include <QItemSelectionModel>
+#include <QPixmapCache>
+#include <QHash>
+#include <QEvent>
 #include "SARibbonElementManager.h"
 /**
  * @brief The SARibbonGalleryGroupPrivate class
@@ -18,6 +21,11 @@ public:
     int mGridMinimumWidth { 0 };             ///< grid最小宽度
     int mGridMaximumWidth { 0 };             ///< grid最大宽度
     QActionGroup* mActionGroup { nullptr };  ///< 所有GalleryGroup管理的actions都由这个actiongroup管理
+    QList< QMetaObject::Connection > mModelConnections;  ///< 和model的关联，用于model变化时清除缓存
+    bool mIsItemPixmapCacheOn { false };                 ///< 是否通过setEnableItemPixmapCache开启了缓存
+    bool mUniformItemSizesBeforeCache { true };          ///< 开启缓存前的uniformItemSizes，关闭缓存时恢复
+    QListView::LayoutMode mLayoutModeBeforeCache { QListView::SinglePass };  ///< 开启缓存前的layoutMode，关闭缓存时恢复
+    QHash< SARibbonGalleryItem*, QMetaObject::Connection > mActionItemConnections;  ///< action条目和QAction::changed的关联
 public:
     PrivateData(SARibbonGalleryGroup* p) : q_ptr(p)
     {
@@ -25,8 +33,62 @@ public:
         p->connect(mActionGroup, &QActionGroup::triggered, p, &SARibbonGalleryGroup::triggered);
         p->connect(mActionGroup, &QActionGroup::hovered, p, &SARibbonGalleryGroup::hovered);
     }
+    // action改变时递增条目的版本号并刷新
+    void connectActionItem(SARibbonGalleryItem* item);
+    // 条目将要从model移除，断开和action的关联
+    void disconnectActionItems(int first, int last);
+    // 断开所有条目和action的关联
+    void disconnectAllActionItems();
+    // 断开和model的关联
+    void disconnectModel();
 };
 
+void SARibbonGalleryGroup::PrivateData::connectActionItem(SARibbonGalleryItem* item)
+{
+    QAction* act = item->action();
+    if (nullptr == act) {
+        return;
+    }
+    SARibbonGalleryGroup* q = q_ptr;
+    // 条目被移除前会断开，因此可以直接捕获条目指针
+    mActionItemConnections.insert(item, q->connect(act, &QAction::changed, q, [ q, item ]() {
+        item->increaseGeneration();
+        q->viewport()->update();
+    }));
+}
+
+void SARibbonGalleryGroup::PrivateData::disconnectActionItems(int first, int last)
+{
+    SARibbonGalleryGroupModel* m = q_ptr->groupModel();
+    if (nullptr == m || mActionItemConnections.isEmpty()) {
+        return;
+    }
+    for (int i = first; i <= last; ++i) {
+        auto it = mActionItemConnections.find(m->at(i));
+        if (it != mActionItemConnections.end()) {
+            QObject::disconnect(it.value());
+            mActionItemConnections.erase(it);
+        }
+    }
+}
+
+void SARibbonGalleryGroup::PrivateData::disconnectAllActionItems()
+{
+    for (const QMetaObject::Connection& c : qAsConst(mActionItemConnections)) {
+        QObject::disconnect(c);
+    }
+    mActionItemConnections.clear();
+}
+
+void SARibbonGalleryGroup::PrivateData::disconnectModel()
+{
+    for (const QMetaObject::Connection& c : qAsConst(mModelConnections)) {
+        QObject::disconnect(c);
+    }
+    mModelConnections.clear();
+    disconnectAllActionItems();
+}
+
 //===================================================
 // SARibbonGalleryGroupItemDelegate
 //===================================================
@@ -41,6 +103,24 @@ void SARibbonGalleryGroupItemDelegate::paint(QPainter* painter, const QStyleOpti
     if (nullptr == m_group) {
         return;
     }
+    // 只缓存普通和鼠标悬停两种状态，选中和焦点状态出现的次数很少，直接绘制
+    if (m_enablePixmapCache && !(option.state & (QStyle::State_Selected | QStyle::State_HasFocus))) {
+        paintByPixmapCache(painter, option, index);
+        return;
+    }
+    paintByGroupStyle(painter, option, index);
+}
+
+/**
+ * @brief 按照SARibbonGalleryGroup::GalleryGroupStyle进行绘制
+ * @param painter
+ * @param option
+ * @param index
+ */
+void SARibbonGalleryGroupItemDelegate::paintByGroupStyle(QPainter* painter,
+                                                         const QStyleOptionViewItem& option,
+                                                         const QModelIndex& index) const
+{
     switch (m_group->galleryGroupStyle()) {
     case SARibbonGalleryGroup::IconWithText:
         paintIconWithText(painter, option, index);
@@ -87,6 +167,63 @@ void SARibbonGalleryGroupItemDelegate::paintIconWithTextWordWrap(QPainter* paint
     QStyledItemDelegate::paint(painter, option, index);
 }
 
+/**
+ * @brief 通过缓存绘制条目
+ *
+ * 缓存的key由条目指针、条目版本号（@ref SARibbonGalleryItem::generation ）、尺寸、设备像素比和状态这些整数直接拼成，
+ * 不需要格式化字符串，也不需要读取文字，grid尺寸或屏幕变化后会自然生成新的缓存，
+ * 条目的文字和图标可能直接来自QAction，action改变时由SARibbonGalleryGroup递增条目的版本号，
+ * 如果model不是SARibbonGalleryGroupModel，用图标的cacheKey代替版本号，文字的变化依赖model的dataChanged清除缓存
+ * @param painter
+ * @param option
+ * @param index
+ */
+void SARibbonGalleryGroupItemDelegate::paintByPixmapCache(QPainter* painter,
+                                                          const QStyleOptionViewItem& option,
+                                                          const QModelIndex& index) const
+{
+    const QSize cellSize = option.rect.size();
+    if (cellSize.isEmpty()) {
+        return;
+    }
+    const qreal dpr       = painter->device()->devicePixelRatioF();
+    const int cachedState = int(option.state & (QStyle::State_MouseOver | QStyle::State_Enabled | QStyle::State_Active));
+    qint64 itemGeneration = 0;
+    if (const SARibbonGalleryGroupModel* m = qobject_cast< const SARibbonGalleryGroupModel* >(index.model())) {
+        if (const SARibbonGalleryItem* item = m->at(index.row())) {
+            itemGeneration = item->generation();
+        }
+    } else {
+        itemGeneration = index.data(Qt::DecorationRole).value< QIcon >().cacheKey();
+    }
+    // 整数直接作为key的内容，避免每次绘制都格式化字符串
+    const qint64 keyData[] = { qint64(reinterpret_cast< quintptr >(this)),
+                               m_pixmapCacheGeneration,
+                               qint64(index.internalId()),
+                               index.row(),
+                               itemGeneration,
+                               (qint64(cellSize.width()) << 32) | cellSize.height(),
+                               (qint64(option.decorationSize.width()) << 32) | option.decorationSize.height(),
+                               (qint64(qRound(dpr * 100)) << 32) | cachedState };
+    const QString cacheKey(reinterpret_cast< const QChar* >(keyData), int(sizeof(keyData) / sizeof(QChar)));
+    QPixmap pixmap;
+    if (!QPixmapCache::find(cacheKey, &pixmap)) {
+        pixmap = QPixmap(cellSize * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(Qt::transparent);
+        QPainter cachePainter(&pixmap);
+        cachePainter.setFont(painter->font());
+        cachePainter.setPen(painter->pen());
+        cachePainter.setRenderHints(painter->renderHints());
+        QStyleOptionViewItem opt = option;
+        opt.rect                 = QRect(QPoint(0, 0), cellSize);
+        paintByGroupStyle(&cachePainter, opt, index);
+        cachePainter.end();
+        QPixmapCache::insert(cacheKey, pixmap);
+    }
+    painter->drawPixmap(option.rect.topLeft(), pixmap);
+}
+
 QSize SARibbonGalleryGroupItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
     Q_UNUSED(index);
@@ -94,6 +231,33 @@ QSize SARibbonGalleryGroupItemDelegate::sizeHint(const QStyleOptionViewItem& opt
     return m_group->gridSize();
 }
 
+/**
+ * @brief 设置是否缓存条目的绘制结果
+ *
+ * 缓存使用QPixmapCache，内存由QPixmapCache::cacheLimit限制，超出后最久未使用的条目会被淘汰
+ * @param on
+ */
+void SARibbonGalleryGroupItemDelegate::setEnablePixmapCache(bool on)
+{
+    m_enablePixmapCache = on;
+    clearPixmapCache();
+}
+
+bool SARibbonGalleryGroupItemDelegate::isEnablePixmapCache() const
+{
+    return m_enablePixmapCache;
+}
+
+/**
+ * @brief 清除缓存
+ *
+ * 并不会立即释放内存，而是让旧的缓存不再被命中
+ */
+void SARibbonGalleryGroupItemDelegate::clearPixmapCache()
+{
+    ++m_pixmapCacheGeneration;
+}
+
 //===================================================
 // SARibbonGalleryGroupModel
 //===================================================
@@ -209,6 +373,8 @@ SARibbonGalleryGroup::SARibbonGalleryGroup(QWidget* w)
 
 SARibbonGalleryGroup::~SARibbonGalleryGroup()
 {
+    // model是子对象，在QWidget析构时才会删除，此时d_ptr已经不存在，需要提前断开
+    d_ptr->disconnectModel();
 }
 
 /**
@@ -344,7 +510,10 @@ void SARibbonGalleryGroup::addActionItem(QAction* act)
         return;
     }
     d_ptr->mActionGroup->addAction(act);
-    groupModel()->append(new SARibbonGalleryItem(act));
+    SARibbonGalleryItem* item = new SARibbonGalleryItem(act);
+    // action改变时model不会通知，需要主动刷新
+    d_ptr->connectActionItem(item);
+    groupModel()->append(item);
 }
 
 void SARibbonGalleryGroup::addActionItemList(const QList< QAction* >& acts)
@@ -356,9 +525,10 @@ void SARibbonGalleryGroup::addActionItemList(const QList< QAction* >& acts)
     }
     for (QAction* a : acts) {
         d_ptr->mActionGroup->addAction(a);
-    }
-    for (int i = 0; i < acts.size(); ++i) {
-        model->append(new SARibbonGalleryItem(acts[ i ]));
+        SARibbonGalleryItem* item = new SARibbonGalleryItem(a);
+        // action改变时model不会通知，需要主动刷新
+        d_ptr->connectActionItem(item);
+        model->append(item);
     }
 }
 
@@ -465,6 +635,94 @@ QActionGroup* SARibbonGalleryGroup::actionGroup() const
     return d_ptr->mActionGroup;
 }
 
+/**
+ * @brief 开启条目绘制缓存
+ *
+ * 开启后条目在普通和鼠标悬停状态下的绘制结果会被缓存，同时启用QListView的统一尺寸和分批布局，
+ * 对于有上千个条目的gallery，滚动时只需要贴图，关闭后恢复开启前的统一尺寸和布局方式
+ * @note 此函数需要代理是@ref SARibbonGalleryGroupItemDelegate ，如果设置了其他代理，只会设置布局方式
+ * @param on
+ */
+void SARibbonGalleryGroup::setEnableItemPixmapCache(bool on)
+{
+    if (SARibbonGalleryGroupItemDelegate* d = dynamic_cast< SARibbonGalleryGroupItemDelegate* >(itemDelegate())) {
+        d->setEnablePixmapCache(on);
+    }
+    if (on && !d_ptr->mIsItemPixmapCacheOn) {
+        d_ptr->mUniformItemSizesBeforeCache = uniformItemSizes();
+        d_ptr->mLayoutModeBeforeCache       = layoutMode();
+        setUniformItemSizes(true);
+        setLayoutMode(QListView::Batched);
+    } else if (!on && d_ptr->mIsItemPixmapCacheOn) {
+        setUniformItemSizes(d_ptr->mUniformItemSizesBeforeCache);
+        setLayoutMode(d_ptr->mLayoutModeBeforeCache);
+    }
+    d_ptr->mIsItemPixmapCacheOn = on;
+    viewport()->update();
+}
+
+bool SARibbonGalleryGroup::isEnableItemPixmapCache() const
+{
+    if (SARibbonGalleryGroupItemDelegate* d = dynamic_cast< SARibbonGalleryGroupItemDelegate* >(itemDelegate())) {
+        return d->isEnablePixmapCache();
+    }
+    return false;
+}
+
+/**
+ * @brief 清除条目绘制缓存
+ *
+ * model的变化以及样式、字体、调色板的变化都会自动清除，一般不需要手动调用
+ */
+void SARibbonGalleryGroup::clearItemPixmapCache()
+{
+    if (SARibbonGalleryGroupItemDelegate* d = dynamic_cast< SARibbonGalleryGroupItemDelegate* >(itemDelegate())) {
+        d->clearPixmapCache();
+    }
+}
+
+void SARibbonGalleryGroup::setModel(QAbstractItemModel* m)
+{
+    // 原model的条目不再由此group显示，和action的关联也一并断开
+    d_ptr->disconnectModel();
+    QListView::setModel(m);
+    clearItemPixmapCache();
+    if (m) {
+        auto fpClear = [ this ]() { this->clearItemPixmapCache(); };
+        d_ptr->mModelConnections << connect(m, &QAbstractItemModel::dataChanged, this, fpClear)
+                                 << connect(m, &QAbstractItemModel::rowsRemoved, this, fpClear)
+                                 << connect(m, &QAbstractItemModel::rowsMoved, this, fpClear)
+                                 << connect(m, &QAbstractItemModel::modelReset, this, fpClear)
+                                 << connect(m, &QAbstractItemModel::layoutChanged, this, fpClear);
+        // 条目移除或model清空前断开条目和action的关联
+        d_ptr->mModelConnections << connect(m,
+                                            &QAbstractItemModel::rowsAboutToBeRemoved,
+                                            this,
+                                            [ this ](const QModelIndex& parent, int first, int last) {
+                                                if (!parent.isValid()) {
+                                                    d_ptr->disconnectActionItems(first, last);
+                                                }
+                                            })
+                                 << connect(m, &QAbstractItemModel::modelAboutToBeReset, this, [ this ]() {
+                                        d_ptr->disconnectAllActionItems();
+                                    });
+    }
+}
+
+void SARibbonGalleryGroup::changeEvent(QEvent* e)
+{
+    switch (e->type()) {
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+    case QEvent::PaletteChange:
+        clearItemPixmapCache();
+        break;
+    default:
+        break;
+    }
+    QListView::changeEvent(e);
+}
+
 void SARibbonGalleryGroup::onItemClicked(const QModelIndex& index)
 {
     if (index.isValid()) {
@@ -9,6 +9,9 @@
 ///
 /// \brief SARibbonGalleryGroup对应的显示代理
 ///
+/// 开启缓存模式（@ref setEnablePixmapCache ）后，每个条目在普通和鼠标悬停两种状态下的绘制结果会以当前grid尺寸缓存为QPixmap，
+/// 再次绘制时直接贴图，适用于条目很多、需要频繁滚动的gallery
+///
 class SA_RIBBON_EXPORT SARibbonGalleryGroupItemDelegate : public QStyledItemDelegate
 {
 public:
@@ -19,9 +22,22 @@ public:
     virtual void paintIconOnly(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
     virtual void paintIconWithText(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
     virtual void paintIconWithTextWordWrap(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    // 设置是否缓存条目的绘制结果
+    void setEnablePixmapCache(bool on);
+    bool isEnablePixmapCache() const;
+    // 清除缓存，条目内容、样式、字体变化时需要调用
+    void clearPixmapCache();
+
+protected:
+    // 按照GalleryGroupStyle绘制，不经过缓存
+    void paintByGroupStyle(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    // 通过缓存绘制
+    void paintByPixmapCache(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
 
 private:
     SARibbonGalleryGroup* m_group;
+    bool m_enablePixmapCache { false };
+    int m_pixmapCacheGeneration { 0 };  ///< 缓存代数，清除缓存时递增，旧的缓存不会再被命中，由QPixmapCache自行淘汰
 };
 
 ///
@@ -114,6 +130,16 @@ public:
     int gridMaximumWidth() const;
     // 获取SARibbonGalleryGroup管理的actiongroup
     QActionGroup* actionGroup() const;
+    // 开启条目绘制缓存，同时启用统一尺寸和分批布局，适用于条目很多的gallery
+    void setEnableItemPixmapCache(bool on);
+    bool isEnableItemPixmapCache() const;
+    // 清除条目绘制缓存
+    void clearItemPixmapCache();
+    // 设置model，会关联model的变化信号用于清除缓存
+    virtual void setModel(QAbstractItemModel* m) Q_DECL_OVERRIDE;
+
+protected:
+    virtual void changeEvent(QEvent* e) Q_DECL_OVERRIDE;
 private slots:
     void onItemClicked(const QModelIndex& index);
     void onItemEntered(const QModelIndex& index);
@@ -26,6 +26,7 @@ SARibbonGalleryItem::~SARibbonGalleryItem()
 void SARibbonGalleryItem::setData(int role, const QVariant& data)
 {
     m_datas[ role ] = data;
+    ++m_generation;
 }
 
 QVariant SARibbonGalleryItem::data(int role) const
@@ -131,12 +132,17 @@ void SARibbonGalleryItem::setFlags(Qt::ItemFlags flag)
 
 Qt::ItemFlags SARibbonGalleryItem::flags() const
 {
+    // 可用状态以action为准，action的可用状态改变时不会通知到条目
+    if (m_action) {
+        return (m_action->isEnabled() ? (m_flags | Qt::ItemIsEnabled) : (m_flags & (~Qt::ItemIsEnabled)));
+    }
     return (m_flags);
 }
 
 void SARibbonGalleryItem::setAction(QAction* act)
 {
     m_action = act;
+    ++m_generation;
     if (nullptr == m_action) {
         return;
     }
@@ -161,3 +167,25 @@ Qt::Alignment SARibbonGalleryItem::textAlignment() const
 {
     return qvariant_cast< Qt::Alignment >(data(Qt::TextAlignmentRole));
 }
+
+/**
+ * @brief 显示内容的版本号
+ *
+ * setData、setAction以及@ref increaseGeneration 都会递增版本号，
+ * 绘制缓存以条目指针和版本号作为key，不需要每次绘制都读取文字和图标
+ * @return
+ */
+quint32 SARibbonGalleryItem::generation() const
+{
+    return (m_generation);
+}
+
+/**
+ * @brief 显示内容在外部被改变时调用
+ *
+ * 条目的文字和图标可能直接来自QAction，action改变时需要调用此函数让旧的绘制缓存失效
+ */
+void SARibbonGalleryItem::increaseGeneration()
+{
+    ++m_generation;
+}
@@ -53,11 +53,17 @@ public:
     void setTextAlignment(Qt::Alignment a);
     Qt::Alignment textAlignment() const;
 
+    // 显示内容的版本号，用于绘制缓存
+    quint32 generation() const;
+    // 显示内容在外部被改变（例如action改变）时调用，递增版本号
+    void increaseGeneration();
+
 private:
     friend class SARibbonGalleryGroupModel;
     QMap< int, QVariant > m_datas;
     Qt::ItemFlags m_flags;
     QAction* m_action;
+    quint32 m_generation { 0 };  ///< 显示内容的版本号，setData时递增
 };
 
 #endif  // SARIBBONGALLERYITEM_H
@@ -2,12 +2,15 @@
 #include "SARibbonBar.h"
 #include "SARibbonElementManager.h"
 #include "SARibbonTabBar.h"
+#include "SARibbonTheme.h"
+#include "SARibbonThemePrivate.h"
 #include <QApplication>
 #include <QDebug>
 #include <QFile>
 #include <QHash>
 #include <QWindowStateChangeEvent>
 #include <QScreen>
+#include <QVariant>
 
 #include "SARibbonSystemButtonBar.h"
 #if SARIBBON_USE_3RDPARTY_FRAMELESSHELPER
@@ -28,9 +31,14 @@ class SARibbonMainWindow::PrivateData
 public:
     PrivateData(SARibbonMainWindow* p);
     void installFrameless(SARibbonMainWindow* p);
+    // 按照主题的实现方式和作用范围设置主题
+    void applyRibbonTheme(SARibbonMainWindow::RibbonTheme theme);
 
 public:
     SARibbonMainWindow::RibbonTheme mCurrentRibbonTheme { SARibbonMainWindow::RibbonThemeOffice2021Blue };
+    SARibbonMainWindow::RibbonThemeEngine mThemeEngine { SARibbonMainWindow::RibbonThemeEngineQss };
+    SARibbonMainWindow::RibbonThemeScope mThemeScope { SARibbonMainWindow::RibbonThemeScopeWindow };
+    bool mSyncThemeOnPolish { false };  ///< 在窗口polish之前设置了主题，polish时需要重新同步
     SARibbonSystemButtonBar* mWindowButtonGroup { nullptr };
 #if SARIBBON_USE_3RDPARTY_FRAMELESSHELPER
     QWK::WidgetWindowAgent* mFramelessHelper { nullptr };
@@ -53,6 +61,64 @@ void SARibbonMainWindow::PrivateData::installFrameless(SARibbonMainWindow* p)
 #endif
 }
 
+/**
+ * @brief 按照主题的实现方式和作用范围设置主题
+ *
+ * 作用范围为@ref SARibbonMainWindow::RibbonThemeScopeRibbonBar 时，qss只设置在ribbonbar和系统按钮栏上，
+ * 主窗口上由之前主题设置的qss会被清除，这样切换主题只会对ribbon的窗口重新polish；
+ * 实现方式为@ref SARibbonMainWindow::RibbonThemeEngineStyle 时，SARibbonThemeStyle只设置在ribbonbar和系统按钮栏上
+ * @param theme
+ */
+void SARibbonMainWindow::PrivateData::applyRibbonTheme(SARibbonMainWindow::RibbonTheme theme)
+{
+    SARibbonMainWindow* w = q_ptr;
+    SARibbonBar* bar      = w->ribbonBar();
+    // 设置主题的过程中会对窗口重新polish，期间禁止刷新，避免中间状态的绘制，
+    // 主题只作用在ribbon窗口上时，只禁止ribbonbar和系统按钮栏的刷新，setUpdatesEnabled会遍历整个子窗口树
+    QList< QWidget* > suspends;
+    if (SARibbonMainWindow::RibbonThemeEngineStyle == mThemeEngine
+        || SARibbonMainWindow::RibbonThemeScopeRibbonBar == mThemeScope) {
+        suspends << bar << mWindowButtonGroup;
+    } else {
+        suspends << w;
+    }
+    QList< QWidget* > suspended;
+    for (QWidget* s : qAsConst(suspends)) {
+        if (s && s->updatesEnabled()) {
+            s->setUpdatesEnabled(false);
+            suspended.append(s);
+        }
+    }
+    if (SARibbonMainWindow::RibbonThemeEngineStyle == mThemeEngine) {
+        sa_clear_ribbon_theme_qss(w);
+        if (bar) {
+            sa_set_ribbon_theme_style(bar, theme);
+        }
+        if (mWindowButtonGroup) {
+            sa_set_ribbon_theme_style(mWindowButtonGroup, theme);
+        }
+    } else if (SARibbonMainWindow::RibbonThemeScopeRibbonBar == mThemeScope) {
+        sa_clear_ribbon_theme_style(bar);
+        sa_clear_ribbon_theme_style(mWindowButtonGroup);
+        sa_clear_ribbon_theme_qss(w);
+        if (bar) {
+            sa_set_ribbon_theme(bar, theme);
+        }
+        if (mWindowButtonGroup) {
+            sa_set_ribbon_theme(mWindowButtonGroup, theme);
+        }
+    } else {
+        sa_clear_ribbon_theme_style(bar);
+        sa_clear_ribbon_theme_style(mWindowButtonGroup);
+        sa_clear_ribbon_theme_qss(bar);
+        sa_clear_ribbon_theme_qss(mWindowButtonGroup);
+        sa_set_ribbon_theme(w, theme);
+    }
+    for (QWidget* s : qAsConst(suspended)) {
+        s->setUpdatesEnabled(true);
+    }
+}
+
 //===================================================
 // SARibbonMainWindow
 //===================================================
@@ -126,6 +192,12 @@ void SARibbonMainWindow::setRibbonBar(SARibbonBar* bar)
     d_ptr->mFramelessHelper->setTitleHeight(th);
     d_ptr->mFramelessHelper->setRubberBandOnResize(false);
 #endif
+    // 主题只作用于ribbonbar时，新的ribbonbar需要单独设置主题
+    if (RibbonThemeEngineStyle == d_ptr->mThemeEngine) {
+        sa_set_ribbon_theme_style(bar, ribbonTheme());
+    } else if (RibbonThemeScopeRibbonBar == d_ptr->mThemeScope) {
+        sa_set_ribbon_theme(bar, ribbonTheme());
+    }
 }
 
 #if SARIBBON_USE_3RDPARTY_FRAMELESSHELPER
@@ -197,75 +269,36 @@ void SARibbonMainWindow::updateWindowFlag(Qt::WindowFlags flags)
 /**
  * @brief SARibbonMainWindow::setRibbonTheme
  *
- * 注意主题在构造函数设置主题会不完全生效，使用QTimer投放到队列最后执行即可
- * @code
- * QTimer::singleShot(0, this, [ this ]() { this->setRibbonTheme(SARibbonMainWindow::RibbonThemeDark); });
- * @endcode
+ * 主题的qss会缓存在内存中，重复切换主题不会重复读取和解析，
+ * 可以在构造函数中直接设置主题，此时子窗口还未polish，窗口第一次polish时会重新同步主题相关的尺寸和颜色，
+ * 不再需要通过QTimer::singleShot延迟设置
  * @param theme
  */
 void SARibbonMainWindow::setRibbonTheme(SARibbonMainWindow::RibbonTheme theme)
 {
-    sa_set_ribbon_theme(this, theme);
+    d_ptr->applyRibbonTheme(theme);
     d_ptr->mCurrentRibbonTheme = theme;
+    // qss中的一些尺寸和颜色在C++代码中无法获取到，统一从SARibbonThemeData中获取
+    const SARibbonThemeData td = SARibbonThemeData::themeData(theme);
     if (SARibbonBar* bar = ribbonBar()) {
-        auto theme = ribbonTheme();
-        // 尺寸修正
-        switch (theme) {
-        case RibbonThemeWindows7:
-        case RibbonThemeOffice2013:
-        case RibbonThemeOffice2016Blue:
-        case RibbonThemeDark:
-        case RibbonThemeDark2: {
-            //! 在设置qss后需要针对margin信息重新设置进SARibbonTabBar中
-            //! office2013.qss的margin信息如下设置
-            //! margin-top: 0px;
-            //! margin-right: 0px;
-            //! margin-left: 5px;
-            //! margin-bottom: 0px;
-            SARibbonTabBar* tab = bar->ribbonTabBar();
-            if (!tab) {
-                break;
-            }
-            tab->setTabMargin(QMargins(5, 0, 0, 0));
-        } break;
-        case RibbonThemeOffice2021Blue: {
-            SARibbonTabBar* tab = bar->ribbonTabBar();
-            if (!tab) {
-                break;
-            }
-            //! 在设置qss后需要针对margin信息重新设置进SARibbonTabBar中
-            //! office2021.qss的margin信息如下设置
-            //! margin-top: 0px;
-            //! margin-right: 5px;
-            //! margin-left: 5px;
-            //! margin-bottom: 0px;
-            tab->setTabMargin(QMargins(5, 0, 5, 0));
+        //! 在设置qss后需要针对margin信息重新设置进SARibbonTabBar中，
+        //! 其值对应qss中SARibbonTabBar::tab的margin
+        if (SARibbonTabBar* tab = bar->ribbonTabBar()) {
+            tab->setTabMargin(td.tabMargin);
         }
-        default:
-            break;
-        }
-        // 上下文标签颜色设置,以及基线颜色设置
-        switch (theme) {
-        case RibbonThemeWindows7:
-        case RibbonThemeOffice2013:
-        case RibbonThemeDark:
-            bar->setContextCategoryColorList(QList< QColor >());  //< 设置空颜色列表会重置为默认色系
-            break;
-        case RibbonThemeOffice2016Blue:
-            bar->setContextCategoryColorList(QList< QColor >() << QColor(18, 64, 120));  //< 设置空颜色列表会重置为默认色系
-            break;
-        case RibbonThemeOffice2021Blue:
-            bar->setContextCategoryColorList(QList< QColor >() << QColor(209, 207, 209));  //< 设置空颜色列表会重置为默认色系
-            break;
-        default:
-            break;
+        // 上下文标签颜色设置，设置空颜色列表会重置为默认色系
+        if (td.changeContextCategoryColors) {
+            bar->setContextCategoryColorList(td.contextCategoryColors);
         }
         // 基线颜色设置
-        if (RibbonThemeOffice2013 == theme) {
-            bar->setTabBarBaseLineColor(QColor(186, 201, 219));
-        } else {
-            bar->setTabBarBaseLineColor(QColor());
-        }
+        bar->setTabBarBaseLineColor(td.tabBarBaseLineColor);
+    }
+    // 系统按钮图标，深色标题栏使用浅色图标
+    if (SARibbonSystemButtonBar* wg = d_ptr->mWindowButtonGroup) {
+        wg->setSystemIconStyle(td.systemIconStyle);
+    }
+    if (!testAttribute(Qt::WA_WState_Polished)) {
+        d_ptr->mSyncThemeOnPolish = true;
     }
 }
 
@@ -274,6 +307,58 @@ SARibbonMainWindow::RibbonTheme SARibbonMainWindow::ribbonTheme() const
     return (d_ptr->mCurrentRibbonTheme);
 }
 
+/**
+ * @brief 设置主题的实现方式
+ *
+ * 默认使用qss实现主题，qss会使所有子窗口都由QStyleSheetStyle接管，开销较大，
+ * 设置为@ref RibbonThemeEngineStyle 后，主题由@ref SARibbonThemeStyle 原生绘制，不再使用qss
+ *
+ * @note SARibbonThemeStyle只设置在ribbonbar和系统按钮栏及其子窗口上，不会改变应用程序的style，
+ * 切换回qss时这些窗口恢复为应用程序的style
+ * @param engine
+ */
+void SARibbonMainWindow::setRibbonThemeEngine(RibbonThemeEngine engine)
+{
+    if (d_ptr->mThemeEngine == engine) {
+        return;
+    }
+    d_ptr->mThemeEngine = engine;
+    if (isUseRibbon()) {
+        setRibbonTheme(ribbonTheme());
+    }
+}
+
+SARibbonMainWindow::RibbonThemeEngine SARibbonMainWindow::ribbonThemeEngine() const
+{
+    return (d_ptr->mThemeEngine);
+}
+
+/**
+ * @brief 设置qss主题的作用范围
+ *
+ * 默认qss设置在SARibbonMainWindow上，切换主题时整个窗口树都会重新polish，
+ * 如果中心窗口比较复杂，切换主题会比较慢，此时可设置为@ref RibbonThemeScopeRibbonBar ，
+ * qss只设置在SARibbonBar和系统按钮栏上，切换主题只影响ribbon相关的窗口
+ *
+ * @note 设置为@ref RibbonThemeScopeRibbonBar 后，用户在主窗口上设置的qss优先级低于ribbonbar上的主题qss
+ * @param scope
+ */
+void SARibbonMainWindow::setRibbonThemeScope(RibbonThemeScope scope)
+{
+    if (d_ptr->mThemeScope == scope) {
+        return;
+    }
+    d_ptr->mThemeScope = scope;
+    if (isUseRibbon()) {
+        setRibbonTheme(ribbonTheme());
+    }
+}
+
+SARibbonMainWindow::RibbonThemeScope SARibbonMainWindow::ribbonThemeScope() const
+{
+    return (d_ptr->mThemeScope);
+}
+
 bool SARibbonMainWindow::isUseRibbon() const
 {
     return (nullptr != ribbonBar());
@@ -333,6 +418,19 @@ void SARibbonMainWindow::changeEvent(QEvent* e)
     QMainWindow::changeEvent(e);
 }
 
+bool SARibbonMainWindow::event(QEvent* e)
+{
+    const bool res = QMainWindow::event(e);
+    if (e && QEvent::Polish == e->type() && d_ptr->mSyncThemeOnPolish) {
+        // 在构造函数中设置的主题，此时子窗口都已经创建，重新同步一次，qss没有变化不会重复设置
+        d_ptr->mSyncThemeOnPolish = false;
+        if (isUseRibbon()) {
+            setRibbonTheme(ribbonTheme());
+        }
+    }
+    return res;
+}
+
 /**
  * @brief 主屏幕切换触发的信号
  * @param screen
@@ -340,15 +438,30 @@ void SARibbonMainWindow::changeEvent(QEvent* e)
 void SARibbonMainWindow::onPrimaryScreenChanged(QScreen* screen)
 {
     Q_UNUSED(screen);
-    // 主屏幕切换后，从新计算所有尺寸
+    // 主屏幕切换后，从新计算所有尺寸，当前category立即刷新，其余的在空闲时刷新
     if (SARibbonBar* bar = ribbonBar()) {
         qDebug() << "Primary Screen Changed";
-        bar->updateRibbonGeometry();
+        bar->updateDisplayContext(true);
     }
 }
 
-void sa_set_ribbon_theme(QWidget* w, SARibbonMainWindow::RibbonTheme theme)
+/**
+ * @brief 获取主题对应的qss文本
+ *
+ * qss只在第一次使用时从资源中读取，之后从缓存中获取，多次切换主题或多个窗口设置主题不会重复读取，
+ * 缓存的只是文本，setStyleSheet时Qt仍会重新解析，需要避免qss开销时使用@ref SARibbonMainWindow::RibbonThemeEngineStyle
+ *
+ * @note SARibbonThemeData中的颜色是按这些qss设置的，修改qss时要同步修改，tst_SARibbonThemeStyle会检查两者是否一致
+ * @param theme
+ * @return 读取失败返回空字符串
+ */
+static QString sa_ribbon_theme_qss(SARibbonMainWindow::RibbonTheme theme)
 {
+    static QHash< int, QString > s_qssCache;
+    auto ite = s_qssCache.constFind(static_cast< int >(theme));
+    if (ite != s_qssCache.constEnd()) {
+        return ite.value();
+    }
     QFile file;
     switch (theme) {
     case SARibbonMainWindow::RibbonThemeWindows7:
@@ -374,9 +487,23 @@ void sa_set_ribbon_theme(QWidget* w, SARibbonMainWindow::RibbonTheme theme)
         break;
     }
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return;
+        return QString();
     }
     // 有反馈用qstring接住文件内容，再设置进去才能生效（qt5.7版本）
     QString qss = QString::fromUtf8(file.readAll());
-    w->setStyleSheet(qss);
+    s_qssCache.insert(static_cast< int >(theme), qss);
+    return qss;
+}
+
+void sa_set_ribbon_theme(QWidget* w, SARibbonMainWindow::RibbonTheme theme)
+{
+    const QString qss = sa_ribbon_theme_qss(theme);
+    if (qss.isEmpty()) {
+        return;
+    }
+    // 主题没有变化时不重新设置，setStyleSheet会对整个子窗口树重新polish
+    if (w->styleSheet() != qss) {
+        w->setStyleSheet(qss);
+    }
+    w->setProperty(SA_RIBBON_THEME_QSS_PROPERTY, true);
 }
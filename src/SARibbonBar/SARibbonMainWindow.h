@@ -39,6 +39,8 @@ class SA_RIBBON_EXPORT SARibbonMainWindow : public QMainWindow
     SA_RIBBON_DECLARE_PRIVATE(SARibbonMainWindow)
     friend class SARibbonBar;
     Q_PROPERTY(RibbonTheme ribbonTheme READ ribbonTheme WRITE setRibbonTheme)
+    Q_PROPERTY(RibbonThemeEngine ribbonThemeEngine READ ribbonThemeEngine WRITE setRibbonThemeEngine)
+    Q_PROPERTY(RibbonThemeScope ribbonThemeScope READ ribbonThemeScope WRITE setRibbonThemeScope)
 public:
     /**
      * @brief Ribbon主题，可以通过qss定制ribbon的主题，定制方法可参看源码中office2013.qss
@@ -58,6 +60,26 @@ public:
         RibbonThemeDark2
     };
     Q_ENUM(RibbonTheme)
+
+    /**
+     * @brief 主题的实现方式
+     */
+    enum RibbonThemeEngine
+    {
+        RibbonThemeEngineQss,   ///< 使用qss实现主题，默认方式，可通过qss自定义
+        RibbonThemeEngineStyle  ///< 使用SARibbonThemeStyle原生绘制主题，不使用qss，性能更好
+    };
+    Q_ENUM(RibbonThemeEngine)
+
+    /**
+     * @brief qss主题的作用范围
+     */
+    enum RibbonThemeScope
+    {
+        RibbonThemeScopeWindow,    ///< qss设置在SARibbonMainWindow上，默认方式
+        RibbonThemeScopeRibbonBar  ///< qss只设置在SARibbonBar和系统按钮栏上，切换主题时不会影响中心窗口等非ribbon窗口
+    };
+    Q_ENUM(RibbonThemeScope)
 public:
     SARibbonMainWindow(QWidget* parent = nullptr, bool useRibbon = true, const Qt::WindowFlags flags = {});
     ~SARibbonMainWindow() Q_DECL_OVERRIDE;
@@ -75,10 +97,15 @@ public:
     // 此函数仅用于控制最小最大化和关闭按钮的显示
     void updateWindowFlag(Qt::WindowFlags flags);
 
-    // 注意主题在构造函数设置主题会不完全生效，使用QTimer投放到队列最后执行即可
-    // QTimer::singleShot(0, this, [ this ]() { this->setRibbonTheme(SARibbonMainWindow::RibbonThemeDark); });
+    // 设置主题，可以在构造函数中直接调用，窗口第一次polish时会重新同步主题相关的尺寸
     void setRibbonTheme(RibbonTheme theme);
     RibbonTheme ribbonTheme() const;
+    // 设置主题的实现方式，默认为qss
+    void setRibbonThemeEngine(RibbonThemeEngine engine);
+    RibbonThemeEngine ribbonThemeEngine() const;
+    // 设置qss主题的作用范围，默认为整个窗口
+    void setRibbonThemeScope(RibbonThemeScope scope);
+    RibbonThemeScope ribbonThemeScope() const;
     // 判断当前是否使用ribbon模式
     bool isUseRibbon() const;
     // 把ribbonbar的事件传递到frameless
@@ -91,6 +118,7 @@ protected:
     SARibbonBar* createRibbonBar();
     virtual void resizeEvent(QResizeEvent* e) Q_DECL_OVERRIDE;
     virtual void changeEvent(QEvent* e) Q_DECL_OVERRIDE;
+    virtual bool event(QEvent* e) Q_DECL_OVERRIDE;
 private slots:
     void onPrimaryScreenChanged(QScreen* screen);
 };
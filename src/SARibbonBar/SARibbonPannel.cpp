@@ -1,4 +1,5 @@
 ﻿#include "SARibbonPannel.h"
+#include "SARibbonBar.h"
 #include "SARibbonCategory.h"
 #include "SARibbonElementManager.h"
 #include "SARibbonGallery.h"
@@ -855,6 +856,11 @@ void SARibbonPannel::actionEvent(QActionEvent* e)
             }
         }
         lay->insertAction(index, action, getActionRowProportionProperty(action));
+        SARibbonBar* bar = ribbonBar();
+        if (bar && bar->isActionStateUpdating()) {
+            // 批量更新期间，在SARibbonBar::endActionStateUpdate时让category统一调整
+            bar->addActionChangedPannel(this);
+        }
         // 由于pannel的尺寸发生变化，需要让category也调整
         // if (QWidget* parw = parentWidget()) {
         //     if (QLayout* pl = parw->layout()) {
@@ -864,6 +870,12 @@ void SARibbonPannel::actionEvent(QActionEvent* e)
     } break;
 
     case QEvent::ActionChanged: {
+        SARibbonBar* bar = ribbonBar();
+        if (bar && bar->isActionStateUpdating()) {
+            // 批量更新action状态期间，布局延迟到SARibbonBar::endActionStateUpdate统一进行
+            bar->addActionChangedPannel(this);
+            break;
+        }
         // 让布局重新绘制
         layout()->invalidate();
 
@@ -897,6 +909,10 @@ void SARibbonPannel::actionEvent(QActionEvent* e)
             QLayoutItem* item = lay->takeAt(index);
             delete item;
         }
+        SARibbonBar* bar = ribbonBar();
+        if (bar && bar->isActionStateUpdating()) {
+            bar->addActionChangedPannel(this);
+        }
         // 由于pannel的尺寸发生变化，需要让category也调整
         // if (QWidget* parw = parentWidget()) {
         //     if (QLayout* pl = parw->layout()) {
@@ -2,6 +2,9 @@
 #include <QToolButton>
 #include <QResizeEvent>
 #include <QStyle>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QImageReader>
 #include <QDebug>
 #include <QScopedPointer>
 #include "SARibbonMainWindow.h"
@@ -27,6 +30,7 @@ public:
     int mWindowButtonWidth { 35 };
     int mTitleBarHeight { 28 };
     Qt::WindowFlags mFlags { Qt::WindowMinMaxButtonsHint | Qt::WindowCloseButtonHint };
+    SARibbonSystemButtonBar::SystemIconStyle mSystemIconStyle { SARibbonSystemButtonBar::SystemIconDark };
     SARibbonButtonGroupWidget* mButtonGroup;
 
 public:
@@ -48,6 +52,7 @@ public:
             buttonMinimize = new SARibbonSystemToolButton(par);
             buttonMinimize->setObjectName(QStringLiteral("SAMinimizeWindowButton"));
             buttonMinimize->setFocusPolicy(Qt::NoFocus);  // 避免铺抓到
+            buttonMinimize->setGlyph(glyphPath(QStringLiteral("Min")));
             buttonMinimize->show();
             par->connect(buttonMinimize, &QAbstractButton::clicked, par, &SARibbonSystemButtonBar::minimizeWindow);
         } else {
@@ -72,6 +77,7 @@ public:
             buttonMaximize->setObjectName(QStringLiteral("SAMaximizeWindowButton"));
             buttonMaximize->setCheckable(true);
             buttonMaximize->setFocusPolicy(Qt::NoFocus);  // 避免铺抓到
+            buttonMaximize->setGlyph(glyphPath(QStringLiteral("Max")), glyphPath(QStringLiteral("Normal")));
             //            buttonMaximize->setIconSize(buttonMaximize->size() * mIconscale);
             buttonMaximize->show();
             par->connect(buttonMaximize, &QAbstractButton::clicked, par, &SARibbonSystemButtonBar::maximizeWindow);
@@ -96,6 +102,7 @@ public:
             buttonClose = new SARibbonSystemToolButton(par);
             buttonClose->setObjectName(QStringLiteral("SACloseWindowButton"));
             buttonClose->setFocusPolicy(Qt::NoFocus);  // 避免铺抓到
+            buttonClose->setGlyph(glyphPath(QStringLiteral("Close")));
             // buttonClose->setFlat(true);
             par->connect(buttonClose, &QAbstractButton::clicked, par, &SARibbonSystemButtonBar::closeWindow);
             //            buttonClose->setIconSize(buttonClose->size() * mIconscale);
@@ -109,6 +116,37 @@ public:
         updateSize();
     }
 
+    /**
+     * @brief 根据图标风格获取系统按钮的图标资源
+     * @param name Min/Max/Normal/Close
+     * @return SystemIconNone返回空字符串
+     */
+    QString glyphPath(const QString& name) const
+    {
+        switch (mSystemIconStyle) {
+        case SARibbonSystemButtonBar::SystemIconDark:
+            return QStringLiteral(":/image/resource/Titlebar_%1.svg").arg(name);
+        case SARibbonSystemButtonBar::SystemIconLight:
+            return QStringLiteral(":/image/resource/Titlebar_%1_Hover.svg").arg(name);
+        default:
+            break;
+        }
+        return QString();
+    }
+
+    void updateButtonGlyph()
+    {
+        if (buttonMinimize) {
+            buttonMinimize->setGlyph(glyphPath(QStringLiteral("Min")));
+        }
+        if (buttonMaximize) {
+            buttonMaximize->setGlyph(glyphPath(QStringLiteral("Max")), glyphPath(QStringLiteral("Normal")));
+        }
+        if (buttonClose) {
+            buttonClose->setGlyph(glyphPath(QStringLiteral("Close")));
+        }
+    }
+
     void updateSize()
     {
         resizeElement(q_ptr->size());
@@ -182,10 +220,87 @@ public:
 //===================================================
 // SARibbonSystemToolButton
 //===================================================
+/**
+ * @brief 把图标按dpr光栅化为pixmap
+ *
+ * 结果会放入QPixmapCache，多个窗口的系统按钮共享同一份光栅化结果
+ * @param path 图标路径
+ * @param dpr
+ * @return 路径无效返回空pixmap
+ */
+static QPixmap sa_rasterize_system_glyph(const QString& path, qreal dpr)
+{
+    if (path.isEmpty()) {
+        return QPixmap();
+    }
+    const QString key = QStringLiteral("SARibbonSystemGlyph:%1@%2").arg(path).arg(qRound(dpr * 100));
+    QPixmap pm;
+    if (QPixmapCache::find(key, &pm)) {
+        return pm;
+    }
+    QImageReader reader(path);
+    QSize logicalSize = reader.size();
+    if (!logicalSize.isValid()) {
+        logicalSize = QSize(16, 16);
+    }
+    // svg是矢量图，按物理像素尺寸渲染，避免高分屏下模糊
+    reader.setScaledSize(logicalSize * dpr);
+    const QImage img = reader.read();
+    if (img.isNull()) {
+        return QPixmap();
+    }
+    pm = QPixmap::fromImage(img);
+    pm.setDevicePixelRatio(dpr);
+    QPixmapCache::insert(key, pm);
+    return pm;
+}
+
 SARibbonSystemToolButton::SARibbonSystemToolButton(QWidget* p) : QToolButton(p)
 {
     setAutoRaise(true);
 }
+
+/**
+ * @brief 设置图标资源
+ *
+ * 图标会在设置时按当前的dpr预先光栅化，绘制时直接贴图，不会因为hover等状态变化重新渲染svg
+ * @param path 图标路径，为空时不绘制图标
+ * @param checkedPath checked状态下的图标路径，为空时使用path
+ */
+void SARibbonSystemToolButton::setGlyph(const QString& path, const QString& checkedPath)
+{
+    mGlyphPath        = path;
+    mCheckedGlyphPath = checkedPath;
+    rasterizeGlyph(devicePixelRatioF());
+    update();
+}
+
+void SARibbonSystemToolButton::rasterizeGlyph(qreal dpr)
+{
+    mGlyphDpr     = dpr;
+    mGlyph        = sa_rasterize_system_glyph(mGlyphPath, dpr);
+    mCheckedGlyph = sa_rasterize_system_glyph(mCheckedGlyphPath, dpr);
+}
+
+void SARibbonSystemToolButton::paintEvent(QPaintEvent* e)
+{
+    QToolButton::paintEvent(e);
+    if (mGlyphPath.isEmpty()) {
+        return;
+    }
+    const qreal dpr = devicePixelRatioF();
+    if (!qFuzzyCompare(dpr, mGlyphDpr)) {
+        // 窗口移动到了dpr不同的屏幕，重新光栅化
+        rasterizeGlyph(dpr);
+    }
+    const QPixmap& pm = (isChecked() && !mCheckedGlyph.isNull()) ? mCheckedGlyph : mGlyph;
+    if (pm.isNull()) {
+        return;
+    }
+    QPainter painter(this);
+    const QSize logicalSize = pm.size() / pm.devicePixelRatio();
+    painter.drawPixmap(QStyle::alignedRect(layoutDirection(), Qt::AlignCenter, logicalSize, rect()), pm);
+}
 //===================================================
 // SARibbonSystemButtonBar
 //===================================================
@@ -356,6 +471,31 @@ QAbstractButton* SARibbonSystemButtonBar::closeButton() const
     return d_ptr->buttonClose;
 }
 
+/**
+ * @brief 设置系统按钮图标的风格
+ *
+ * 图标会按dpr预先光栅化，hover等状态变化时直接贴图。
+ * 如果要通过qss的background-image或image指定图标，应设置为SystemIconNone，避免重复绘制
+ * @param s
+ */
+void SARibbonSystemButtonBar::setSystemIconStyle(SystemIconStyle s)
+{
+    if (d_ptr->mSystemIconStyle == s) {
+        return;
+    }
+    d_ptr->mSystemIconStyle = s;
+    d_ptr->updateButtonGlyph();
+}
+
+/**
+ * @brief 系统按钮图标的风格
+ * @return
+ */
+SARibbonSystemButtonBar::SystemIconStyle SARibbonSystemButtonBar::systemIconStyle() const
+{
+    return d_ptr->mSystemIconStyle;
+}
+
 void SARibbonSystemButtonBar::setIconSize(const QSize& ic)
 {
     d_ptr->mButtonGroup->setIconSize(ic);
@@ -3,6 +3,7 @@
 #include "SARibbonGlobal.h"
 #include <QFrame>
 #include <QToolButton>
+#include <QPixmap>
 
 /**
  * @brief 窗口的最大最小化按钮
@@ -18,6 +19,17 @@ class SA_RIBBON_EXPORT SARibbonSystemButtonBar : public QFrame
 {
     Q_OBJECT
     SA_RIBBON_DECLARE_PRIVATE(SARibbonSystemButtonBar)
+public:
+    /**
+     * @brief 最大最小化和关闭按钮图标的风格
+     */
+    enum SystemIconStyle
+    {
+        SystemIconDark,   ///< 深色图标，用于浅色的标题栏
+        SystemIconLight,  ///< 浅色图标，用于深色的标题栏
+        SystemIconNone    ///< 不绘制图标，图标完全由qss提供
+    };
+    Q_ENUM(SystemIconStyle)
 public:
     SARibbonSystemButtonBar(QWidget* parent);
     SARibbonSystemButtonBar(QWidget* parent, Qt::WindowFlags flags);
@@ -44,6 +56,9 @@ public:
     QAbstractButton* minimizeButton() const;
     QAbstractButton* maximizeButton() const;
     QAbstractButton* closeButton() const;
+    // 系统按钮图标的风格
+    void setSystemIconStyle(SystemIconStyle s);
+    SystemIconStyle systemIconStyle() const;
 
     // 图标尺寸
     void setIconSize(const QSize& ic);
@@ -81,6 +96,21 @@ class SARibbonSystemToolButton : public QToolButton
     Q_OBJECT
 public:
     SARibbonSystemToolButton(QWidget* p = nullptr);
+    // 设置图标资源，图标会按当前的dpr预先光栅化，checkedPath为checked状态下的图标
+    void setGlyph(const QString& path, const QString& checkedPath = QString());
+
+protected:
+    virtual void paintEvent(QPaintEvent* e) Q_DECL_OVERRIDE;
+
+private:
+    void rasterizeGlyph(qreal dpr);
+
+private:
+    QString mGlyphPath;
+    QString mCheckedGlyphPath;
+    QPixmap mGlyph;
+    QPixmap mCheckedGlyph;
+    qreal mGlyphDpr { 0 };  ///< 光栅化图标时的dpr，dpr变化时（例如移动到其他屏幕）重新光栅化
 };
 
 #endif  // SARIBBONSYSTEMBUTTONBAR_H
@@ -0,0 +1,808 @@
+﻿#include "SARibbonTheme.h"
+#include <QApplication>
+#include <QChildEvent>
+#include <QPainter>
+#include <QStyleFactory>
+#include <QStyleOption>
+#include <QStyleOptionTab>
+#include <QVariant>
+#include "SARibbonApplicationButton.h"
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonGallery.h"
+#include "SARibbonGalleryGroup.h"
+#include "SARibbonMenu.h"
+#include "SARibbonPannel.h"
+#include "SARibbonQuickAccessBar.h"
+#include "SARibbonSeparatorWidget.h"
+#include "SARibbonStackedWidget.h"
+#include "SARibbonTabBar.h"
+#include "SARibbonThemePrivate.h"
+
+/**
+ * @def 记录窗口被SARibbonThemeStyle polish过的属性名，值为polish前的autoFillBackground
+ */
+#define SA_RIBBON_THEME_POLISHED_PROPERTY "_sa_ribbon_theme_polished"
+
+/**
+ * @def 记录窗口的style是由SARibbonThemeStyle::installOn设置的属性名，移除时只恢复这些窗口，用户自己设置的style不做处理
+ */
+#define SA_RIBBON_THEME_STYLE_PROPERTY "_sa_ribbon_theme_style"
+
+/**
+ * @brief 设置背景类的颜色，对所有的ColorGroup生效，颜色无效时不设置
+ */
+static void sa_set_palette_background(QPalette& pl, QPalette::ColorRole role, const QColor& c)
+{
+    if (c.isValid()) {
+        pl.setColor(role, c);
+    }
+}
+
+/**
+ * @brief 设置文字类的颜色，只对Active和Inactive生效，保留Disabled的文字颜色，颜色无效时不设置
+ */
+static void sa_set_palette_text(QPalette& pl, QPalette::ColorRole role, const QColor& c)
+{
+    if (c.isValid()) {
+        pl.setColor(QPalette::Active, role, c);
+        pl.setColor(QPalette::Inactive, role, c);
+    }
+}
+
+/**
+ * @brief 用指定颜色绘制一个面板，背景和边框颜色都无效时什么也不绘制
+ */
+static void sa_draw_panel(QPainter* p, const QRect& r, const QColor& bk, const QColor& border, int radius)
+{
+    if (!bk.isValid() && !border.isValid()) {
+        return;
+    }
+    p->save();
+    p->setRenderHint(QPainter::Antialiasing, radius > 0);
+    p->setPen(border.isValid() ? QPen(border) : QPen(Qt::NoPen));
+    p->setBrush(bk.isValid() ? QBrush(bk) : QBrush(Qt::NoBrush));
+    const QRect dr = border.isValid() ? r.adjusted(0, 0, -1, -1) : r;
+    if (radius > 0) {
+        p->drawRoundedRect(dr, radius, radius);
+    } else {
+        p->drawRect(dr);
+    }
+    p->restore();
+}
+
+/**
+ * @brief 判断窗口是否位于ribbon相关的窗口中（包括自身）
+ */
+static bool sa_is_in_ribbon(const QWidget* w)
+{
+    while (w) {
+        if (SARibbonThemeStyle::isRibbonWidget(w)) {
+            return true;
+        }
+        if (w->isWindow()) {
+            break;
+        }
+        w = w->parentWidget();
+    }
+    return false;
+}
+
+//===================================================
+// SARibbonThemeData
+//===================================================
+
+/**
+ * @brief 获取内置主题对应的数据，颜色取自对应的theme-*.qss
+ *
+ * 修改qss后要同步修改此处，tst_SARibbonThemeStyle会逐项对比两者的颜色
+ * @param theme
+ * @return
+ */
+SARibbonThemeData SARibbonThemeData::themeData(SARibbonMainWindow::RibbonTheme theme)
+{
+    SARibbonThemeData d;
+    // 所有主题共用的系统按钮颜色
+    d.systemButtonPressedBackground = QColor(0xca, 0xca, 0xcb);
+    d.systemCloseHoverBackground    = QColor(0xe8, 0x11, 0x23);
+    d.systemClosePressedBackground  = QColor(0xf1, 0x70, 0x7a);
+    switch (theme) {
+    case SARibbonMainWindow::RibbonThemeWindows7: {
+        d.barBackground                      = QColor(0xe3, 0xe6, 0xe8);
+        d.titleText                          = QColor(0x44, 0x44, 0x44);
+        d.categoryBackground                 = Qt::white;
+        d.pannelText                         = QColor(0x44, 0x44, 0x44);
+        d.pannelTitleText                    = QColor(0x66, 0x66, 0x66);
+        d.separatorColor                     = QColor(0xbe, 0xc0, 0xc2);
+        d.applicationButtonText              = Qt::white;
+        d.applicationButtonBackground        = QColor(0x2a, 0x5f, 0xac);
+        d.applicationButtonHoverBackground   = QColor(0x3a, 0x70, 0xc0);
+        d.applicationButtonPressedBackground = QColor(0x1f, 0x4c, 0x8f);
+        d.tabText                            = QColor(0x44, 0x44, 0x44);
+        d.tabSelectedText                    = Qt::black;
+        d.tabSelectedBackground              = Qt::white;
+        d.tabSelectedBorder                  = QColor(0xba, 0xc9, 0xdb);
+        d.tabHoverText                       = Qt::black;
+        d.tabHoverBorder                     = QColor(0xec, 0xbc, 0x3d);
+        d.buttonText                         = QColor(0x44, 0x44, 0x44);
+        d.buttonHoverBackground              = QColor(0xfd, 0xee, 0xb3);
+        d.buttonPressedBackground            = QColor(0xfd, 0xee, 0xb3);
+        d.buttonCheckedBackground            = QColor(0xfd, 0xee, 0xb3);
+        d.menuText                           = QColor(0x44, 0x44, 0x44);
+        d.menuBackground                     = QColor(0xfc, 0xfc, 0xfc);
+        d.menuBorder                         = QColor(0x84, 0x92, 0xa6);
+        d.menuItemHoverBackground            = QColor(0xfd, 0xee, 0xb3);
+        d.menuItemHoverBorder                = QColor(0xfd, 0xee, 0xb3);
+        d.gallerySelectedBackground          = QColor(0xfd, 0xee, 0xb3);
+        d.systemButtonHoverBackground        = QColor(0xf5, 0xf6, 0xf6);
+    } break;
+    case SARibbonMainWindow::RibbonThemeOffice2016Blue: {
+        d.barBackground                      = QColor(0x22, 0x54, 0x97);
+        d.titleText                          = Qt::white;
+        d.categoryBackground                 = QColor(0xf1, 0xf1, 0xf1);
+        d.pannelBackground                   = QColor(0xf1, 0xf1, 0xf1);
+        d.pannelText                         = QColor(0x33, 0x33, 0x33);
+        d.pannelTitleText                    = QColor(0x66, 0x66, 0x66);
+        d.separatorColor                     = QColor(0xbe, 0xc0, 0xc2);
+        d.applicationButtonText              = Qt::white;
+        d.applicationButtonBackground        = QColor(0x22, 0x54, 0x97);
+        d.applicationButtonHoverBackground   = QColor(0x3e, 0x6d, 0xb5);
+        d.applicationButtonPressedBackground = QColor(0x22, 0x54, 0x97);
+        d.tabText                            = QColor(0xd2, 0xe4, 0xff);
+        d.tabSelectedText                    = QColor(0x22, 0x54, 0x97);
+        d.tabSelectedBackground              = QColor(0xf1, 0xf1, 0xf1);
+        d.tabSelectedBorder                  = QColor(0xf1, 0xf1, 0xf1);
+        d.tabHoverText                       = QColor(0xd2, 0xe4, 0xff);
+        d.tabHoverBackground                 = QColor(0x3e, 0x6d, 0xb6);
+        d.tabHoverBorder                     = QColor(0x3e, 0x6d, 0xb6);
+        d.buttonText                         = QColor(0x33, 0x33, 0x33);
+        d.buttonHoverBackground              = QColor(0xc5, 0xc5, 0xc5);
+        d.buttonPressedBackground            = QColor(0xc5, 0xc3, 0xc6);
+        d.buttonCheckedBackground            = QColor(0xc6, 0xc6, 0xc6);
+        d.menuText                           = QColor(0x33, 0x33, 0x33);
+        d.menuBackground                     = QColor(0xf1, 0xf1, 0xf1);
+        d.menuBorder                         = QColor(0xfc, 0xfc, 0xfc);
+        d.menuItemHoverBackground            = QColor(0xc5, 0xc5, 0xc5);
+        d.galleryBorder                      = QColor(0xc5, 0xc5, 0xc5);
+        d.gallerySelectedBackground          = QColor(0xc5, 0xc5, 0xc5);
+        d.systemButtonHoverBackground        = QColor(0xb8, 0xb8, 0xb8);
+        d.systemIconStyle                    = SARibbonSystemButtonBar::SystemIconLight;
+        d.contextCategoryColors              = { QColor(18, 64, 120) };
+    } break;
+    case SARibbonMainWindow::RibbonThemeOffice2021Blue: {
+        d.barBackground                      = QColor(0xe5, 0xe3, 0xe5);
+        d.titleText                          = QColor(0x24, 0x24, 0x24);
+        d.categoryBackground                 = Qt::white;
+        d.pannelBackground                   = Qt::white;
+        d.pannelText                         = QColor(0x24, 0x24, 0x24);
+        d.pannelTitleText                    = QColor(0x66, 0x66, 0x66);
+        d.separatorColor                     = QColor(0xbe, 0xc0, 0xc2);
+        d.applicationButtonText              = QColor(0x24, 0x24, 0x24);
+        d.applicationButtonHoverBackground   = QColor(0xd0, 0xce, 0xd1);
+        d.applicationButtonPressedBackground = QColor(0xc0, 0xbe, 0xc1);
+        d.tabText                            = QColor(0x24, 0x24, 0x24);
+        d.tabSelectedText                    = QColor(0x27, 0x60, 0xa7);
+        d.tabSelectedBorder                  = QColor(0x27, 0x60, 0xa7);
+        d.tabHoverText                       = QColor(0x24, 0x24, 0x24);
+        d.tabHoverBorder                     = QColor(0xd0, 0xce, 0xd1);
+        d.tabIndicatorWidth                  = 4;
+        d.tabMargin                          = QMargins(5, 0, 5, 0);
+        d.buttonText                         = QColor(0x24, 0x24, 0x24);
+        d.buttonHoverBackground              = QColor(0xf5, 0xf6, 0xf6);
+        d.buttonPressedBackground            = QColor(0xe1, 0xe1, 0xe1);
+        d.buttonCheckedBackground            = QColor(0xeb, 0xeb, 0xeb);
+        d.buttonCheckedBorder                = QColor(0x5f, 0x5f, 0x5f);
+        d.buttonBorderRadius                 = 4;
+        d.menuText                           = QColor(0x33, 0x33, 0x33);
+        d.menuBackground                     = QColor(0xf1, 0xf1, 0xf1);
+        d.menuItemHoverBackground            = QColor(0xc5, 0xc5, 0xc5);
+        d.gallerySelectedBackground          = QColor(0xc5, 0xc5, 0xc5);
+        d.systemButtonHoverBackground        = QColor(0xf5, 0xf6, 0xf6);
+        d.contextCategoryColors              = { QColor(209, 207, 209) };
+    } break;
+    case SARibbonMainWindow::RibbonThemeDark: {
+        d.barBackground                      = QColor(0x2b, 0x2b, 0x2b);
+        d.titleText                          = QColor(0xf0, 0xf1, 0xf2);
+        d.categoryBackground                 = QColor(0xb2, 0xb2, 0xb2);
+        d.pannelText                         = QColor(0x24, 0x24, 0x24);
+        d.pannelTitleText                    = QColor(0x24, 0x24, 0x24);
+        d.separatorColor                     = QColor(0x9b, 0x9b, 0x9b);
+        d.applicationButtonText              = QColor(0x24, 0x24, 0x24);
+        d.applicationButtonBackground        = QColor(0xb2, 0xb2, 0xb2);
+        d.applicationButtonHoverBackground   = QColor(0xa0, 0xa0, 0xa0);
+        d.applicationButtonPressedBackground = QColor(0x85, 0x85, 0x85);
+        d.tabText                            = QColor(0xf0, 0xf1, 0xf2);
+        d.tabSelectedText                    = QColor(0x24, 0x24, 0x24);
+        d.tabSelectedBackground              = QColor(0xb2, 0xb2, 0xb2);
+        d.tabSelectedBorder                  = QColor(0x73, 0x73, 0x73);
+        d.tabHoverText                       = Qt::white;
+        d.tabHoverBorder                     = QColor(0xa6, 0xa6, 0xa6);
+        d.buttonText                         = QColor(0x24, 0x24, 0x24);
+        d.buttonHoverBackground              = QColor(0xa0, 0xa0, 0xa0);
+        d.buttonPressedBackground            = QColor(0x85, 0x85, 0x85);
+        d.buttonCheckedBackground            = QColor(0x9b, 0x9b, 0x9b);
+        d.menuText                           = QColor(0x24, 0x24, 0x24);
+        d.menuBackground                     = QColor(0xb2, 0xb2, 0xb2);
+        d.menuItemHoverBackground            = QColor(0x9b, 0x9b, 0x9b);
+        d.galleryBorder                      = QColor(0x88, 0x88, 0x88);
+        d.galleryBackground                  = QColor(0xcc, 0xcc, 0xcc);
+        d.gallerySelectedBackground          = QColor(0x9b, 0x9b, 0x9b);
+        d.systemButtonHoverBackground        = QColor(0xb2, 0xb2, 0xb2);
+        d.systemIconStyle                    = SARibbonSystemButtonBar::SystemIconLight;
+    } break;
+    case SARibbonMainWindow::RibbonThemeDark2: {
+        d.barBackground                      = QColor(0x19, 0x24, 0x30);
+        d.titleText                          = QColor(0xda, 0xda, 0xda);
+        d.categoryBackground                 = QColor(0x19, 0x24, 0x30);
+        d.pannelBackground                   = QColor(0x34, 0x42, 0x53);
+        d.pannelText                         = QColor(0xda, 0xda, 0xda);
+        d.pannelTitleText                    = QColor(0xda, 0xda, 0xda);
+        d.pannelTitleBackground              = QColor(0x4d, 0x59, 0x73);
+        d.separatorColor                     = QColor(0x5d, 0x63, 0x6a);
+        d.applicationButtonText              = QColor(0xda, 0xda, 0xda);
+        d.applicationButtonBackground        = QColor(0x34, 0x42, 0x53);
+        d.applicationButtonHoverBackground   = QColor(0x43, 0x5c, 0x76);
+        d.applicationButtonPressedBackground = QColor(0x43, 0x5c, 0x76);
+        d.tabText                            = QColor(0xaf, 0xaf, 0xa6);
+        d.tabSelectedText                    = QColor(0xda, 0xda, 0xda);
+        d.tabSelectedBackground              = QColor(0x34, 0x42, 0x53);
+        d.tabSelectedBorder                  = QColor(0x34, 0x42, 0x53);
+        d.tabHoverText                       = Qt::white;
+        d.tabHoverBorder                     = QColor(0x34, 0x42, 0x53);
+        d.buttonText                         = QColor(0xda, 0xda, 0xda);
+        d.buttonHoverBackground              = QColor(0x43, 0x5c, 0x76);
+        d.buttonPressedBackground            = QColor(0x43, 0x5c, 0x76);
+        d.buttonCheckedBackground            = QColor(0x43, 0x5c, 0x76);
+        d.buttonCheckedBorder                = QColor(0x2a, 0x8d, 0xb5);
+        d.menuText                           = QColor(0xda, 0xda, 0xda);
+        d.menuBackground                     = QColor(0x4d, 0x59, 0x73);
+        d.menuItemHoverBackground            = QColor(0x43, 0x5c, 0x76);
+        d.galleryBorder                      = QColor(0x88, 0x88, 0x88);
+        d.galleryBackground                  = QColor(0x4d, 0x59, 0x73);
+        d.gallerySelectedBackground          = QColor(0x43, 0x5c, 0x76);
+        d.systemButtonHoverBackground        = QColor(0xb2, 0xb2, 0xb2);
+        d.systemIconStyle                    = SARibbonSystemButtonBar::SystemIconLight;
+        // dark2主题沿用当前的上下文标签颜色
+        d.changeContextCategoryColors = false;
+    } break;
+    case SARibbonMainWindow::RibbonThemeOffice2013:
+    default: {
+        d.barBackground                      = Qt::white;
+        d.titleText                          = QColor(0xb2, 0xb2, 0xb2);
+        d.categoryBackground                 = Qt::white;
+        d.pannelBackground                   = Qt::white;
+        d.pannelText                         = QColor(0x33, 0x33, 0x33);
+        d.pannelTitleText                    = QColor(0x66, 0x66, 0x66);
+        d.separatorColor                     = QColor(0xbe, 0xc0, 0xc2);
+        d.applicationButtonText              = Qt::white;
+        d.applicationButtonBackground        = QColor(0x2b, 0x57, 0x9a);
+        d.applicationButtonHoverBackground   = QColor(0x58, 0x88, 0xd0);
+        d.applicationButtonPressedBackground = QColor(0x33, 0x69, 0xb9);
+        d.tabText                            = QColor(0x57, 0x79, 0xaf);
+        d.tabSelectedText                    = QColor(0x57, 0x79, 0xaf);
+        d.tabSelectedBackground              = Qt::white;
+        d.tabSelectedBorder                  = QColor(0xc5, 0xd2, 0xe0);
+        d.tabHoverText                       = QColor(0x57, 0x79, 0xaf);
+        d.tabHoverBackground                 = Qt::white;
+        d.tabHoverBorder                     = QColor(0xc5, 0xd2, 0xe0);
+        d.buttonText                         = QColor(0x33, 0x33, 0x33);
+        d.buttonHoverBackground              = QColor(0xce, 0xe7, 0xfc);
+        d.buttonHoverBorder                  = QColor(0xba, 0xdf, 0xfa);
+        d.buttonPressedBackground            = QColor(0x9e, 0xd2, 0xf9);
+        d.buttonPressedBorder                = QColor(0x26, 0x9b, 0xf4);
+        d.buttonCheckedBackground            = QColor(0xce, 0xe8, 0xfc);
+        d.buttonCheckedBorder                = QColor(0xb9, 0xde, 0xfa);
+        d.menuText                           = QColor(0x33, 0x33, 0x33);
+        d.menuBackground                     = QColor(0xfc, 0xfc, 0xfc);
+        d.menuBorder                         = QColor(0xc2, 0xd0, 0xdf);
+        d.menuItemHoverBackground            = QColor(0xce, 0xe7, 0xfc);
+        d.menuItemHoverBorder                = QColor(0xba, 0xdf, 0xfa);
+        d.galleryBorder                      = QColor(0xc2, 0xd0, 0xdf);
+        d.gallerySelectedBackground          = QColor(0x9e, 0xd2, 0xf9);
+        d.systemButtonHoverBackground        = QColor(0xe5, 0xe5, 0xe5);
+        d.tabBarBaseLineColor                = QColor(186, 201, 219);
+    } break;
+    }
+    return d;
+}
+
+//===================================================
+// SARibbonThemeStyle::PrivateData
+//===================================================
+class SARibbonThemeStyle::PrivateData
+{
+    SA_RIBBON_DECLARE_PUBLIC(SARibbonThemeStyle)
+public:
+    PrivateData(SARibbonThemeStyle* p, const SARibbonThemeData& data);
+    // 按钮背景的绘制
+    void drawButtonPanel(const QStyleOption* opt, QPainter* p, const QWidget* w) const;
+    // tab背景的绘制
+    void drawTabShape(const QStyleOptionTab* opt, QPainter* p, const SARibbonTabBar* tab) const;
+    // 对窗口的调色板进行设置，返回false说明此窗口不需要处理
+    bool polishPalette(QWidget* w, QPalette& pl, bool& autoFill) const;
+
+public:
+    SARibbonThemeData mData;
+};
+
+SARibbonThemeStyle::PrivateData::PrivateData(SARibbonThemeStyle* p, const SARibbonThemeData& data)
+    : q_ptr(p), mData(data)
+{
+}
+
+void SARibbonThemeStyle::PrivateData::drawButtonPanel(const QStyleOption* opt, QPainter* p, const QWidget* w) const
+{
+    const bool enabled   = opt->state.testFlag(QStyle::State_Enabled);
+    const bool sunken    = opt->state.testFlag(QStyle::State_Sunken);
+    const bool checked   = opt->state.testFlag(QStyle::State_On);
+    const bool mouseOver = enabled && opt->state.testFlag(QStyle::State_MouseOver);
+    if (qobject_cast< const SARibbonSystemToolButton* >(w)) {
+        // 系统按钮，关闭按钮使用红色
+        const bool isClose = (w->objectName() == QStringLiteral("SACloseWindowButton"));
+        QColor bk;
+        if (sunken) {
+            bk = isClose ? mData.systemClosePressedBackground : mData.systemButtonPressedBackground;
+        } else if (mouseOver) {
+            bk = isClose ? mData.systemCloseHoverBackground : mData.systemButtonHoverBackground;
+        }
+        sa_draw_panel(p, opt->rect, bk, QColor(), 0);
+        return;
+    }
+    if (qobject_cast< const SARibbonApplicationButton* >(w)) {
+        QColor bk = mData.applicationButtonBackground;
+        if (sunken) {
+            bk = mData.applicationButtonPressedBackground;
+        } else if (mouseOver) {
+            bk = mData.applicationButtonHoverBackground;
+        }
+        sa_draw_panel(p, opt->rect, bk, QColor(), 0);
+        return;
+    }
+    if (sunken) {
+        sa_draw_panel(p, opt->rect, mData.buttonPressedBackground, mData.buttonPressedBorder, mData.buttonBorderRadius);
+    } else if (checked) {
+        sa_draw_panel(p, opt->rect, mData.buttonCheckedBackground, mData.buttonCheckedBorder, mData.buttonBorderRadius);
+    } else if (mouseOver) {
+        sa_draw_panel(p, opt->rect, mData.buttonHoverBackground, mData.buttonHoverBorder, mData.buttonBorderRadius);
+    }
+}
+
+void SARibbonThemeStyle::PrivateData::drawTabShape(const QStyleOptionTab* opt,
+                                                   QPainter* p,
+                                                   const SARibbonTabBar* tab) const
+{
+    const QMargins& mg   = tab->tabMargin();
+    const QRect r        = opt->rect.adjusted(mg.left(), mg.top(), -mg.right(), -mg.bottom());
+    const bool selected  = opt->state.testFlag(QStyle::State_Selected);
+    const bool mouseOver = opt->state.testFlag(QStyle::State_Enabled) && opt->state.testFlag(QStyle::State_MouseOver);
+    if (mData.tabIndicatorWidth > 0) {
+        // 指示条风格，在tab底部绘制一条横线
+        QColor bk, indicator;
+        if (selected) {
+            bk        = mData.tabSelectedBackground;
+            indicator = mData.tabSelectedBorder;
+        } else if (mouseOver) {
+            bk        = mData.tabHoverBackground;
+            indicator = mData.tabHoverBorder;
+        }
+        sa_draw_panel(p, r, bk, QColor(), 0);
+        if (indicator.isValid()) {
+            const int iw = qMin(mData.tabIndicatorWidth, r.height());
+            p->fillRect(QRect(r.left(), r.bottom() - iw + 1, r.width(), iw), indicator);
+        }
+        return;
+    }
+    // 边框风格，选中的tab底部不绘制边框，使其和category连成一体
+    if (selected) {
+        sa_draw_panel(p, r, mData.tabSelectedBackground, QColor(), 0);
+        if (mData.tabSelectedBorder.isValid()) {
+            p->save();
+            p->setPen(mData.tabSelectedBorder);
+            QPolygon edge;
+            edge << r.bottomLeft() << r.topLeft() << r.topRight() << r.bottomRight();
+            p->drawPolyline(edge);
+            p->restore();
+        }
+    } else if (mouseOver) {
+        sa_draw_panel(p, r, mData.tabHoverBackground, mData.tabHoverBorder, 0);
+    }
+}
+
+bool SARibbonThemeStyle::PrivateData::polishPalette(QWidget* w, QPalette& pl, bool& autoFill) const
+{
+    autoFill = false;
+    if (qobject_cast< SARibbonBar* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.barBackground);
+        sa_set_palette_background(pl, QPalette::Button, mData.barBackground);
+        sa_set_palette_text(pl, QPalette::WindowText, mData.titleText);
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.buttonText);
+        autoFill = mData.barBackground.isValid();
+    } else if (qobject_cast< SARibbonQuickAccessBar* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.quickAccessBarBackground);
+        autoFill = mData.quickAccessBarBackground.isValid();
+    } else if (qobject_cast< SARibbonTabBar* >(w)) {
+        sa_set_palette_text(pl, QPalette::WindowText, mData.tabText);
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.tabText);
+    } else if (qobject_cast< SARibbonStackedWidget* >(w) || qobject_cast< SARibbonCategory* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.categoryBackground);
+        sa_set_palette_text(pl, QPalette::WindowText, mData.pannelText);
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.buttonText);
+        autoFill = mData.categoryBackground.isValid();
+    } else if (qobject_cast< SARibbonPannel* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.pannelBackground);
+        sa_set_palette_text(pl, QPalette::WindowText, mData.pannelText);
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.buttonText);
+        autoFill = mData.pannelBackground.isValid();
+    } else if (qobject_cast< SARibbonPannelLabel* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.pannelTitleBackground);
+        sa_set_palette_text(pl, QPalette::WindowText, mData.pannelTitleText);
+        autoFill = mData.pannelTitleBackground.isValid();
+    } else if (qobject_cast< SARibbonSeparatorWidget* >(w)) {
+        sa_set_palette_background(pl, QPalette::WindowText, mData.separatorColor);
+    } else if (qobject_cast< SARibbonApplicationButton* >(w)) {
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.applicationButtonText);
+    } else if (qobject_cast< SARibbonMenu* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.menuBackground);
+        sa_set_palette_background(pl, QPalette::Highlight, mData.menuItemHoverBackground);
+        sa_set_palette_text(pl, QPalette::WindowText, mData.menuText);
+        sa_set_palette_text(pl, QPalette::ButtonText, mData.menuText);
+        sa_set_palette_text(pl, QPalette::Text, mData.menuText);
+        sa_set_palette_text(pl, QPalette::HighlightedText, mData.menuText);
+    } else if (qobject_cast< SARibbonGallery* >(w) || qobject_cast< SARibbonGalleryGroup* >(w)) {
+        sa_set_palette_background(pl, QPalette::Window, mData.galleryBackground);
+        sa_set_palette_background(pl, QPalette::Base, mData.galleryBackground);
+        sa_set_palette_background(pl, QPalette::Highlight, mData.gallerySelectedBackground);
+        sa_set_palette_text(pl, QPalette::HighlightedText, mData.buttonText);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+//===================================================
+// SARibbonThemeStyle
+//===================================================
+
+/**
+ * @brief 使用内置主题构造
+ * @param theme 内置主题
+ * @param baseStyle 基础style，SARibbonThemeStyle会接管其所有权，为nullptr时使用系统默认的style
+ */
+SARibbonThemeStyle::SARibbonThemeStyle(SARibbonMainWindow::RibbonTheme theme, QStyle* baseStyle)
+    : QProxyStyle(baseStyle), d_ptr(new SARibbonThemeStyle::PrivateData(this, SARibbonThemeData::themeData(theme)))
+{
+}
+
+/**
+ * @brief 使用自定义的主题数据构造
+ * @param data 主题数据
+ * @param baseStyle 基础style，SARibbonThemeStyle会接管其所有权，为nullptr时使用系统默认的style
+ */
+SARibbonThemeStyle::SARibbonThemeStyle(const SARibbonThemeData& data, QStyle* baseStyle)
+    : QProxyStyle(baseStyle), d_ptr(new SARibbonThemeStyle::PrivateData(this, data))
+{
+}
+
+SARibbonThemeStyle::~SARibbonThemeStyle()
+{
+}
+
+/**
+ * @brief 设置主题数据
+ *
+ * @note 此函数不会刷新已经polish过的窗口，需要对窗口重新polish，@ref sa_set_ribbon_theme_style 会处理这些
+ * @param data
+ */
+void SARibbonThemeStyle::setThemeData(const SARibbonThemeData& data)
+{
+    d_ptr->mData = data;
+}
+
+/**
+ * @brief 主题数据
+ * @return
+ */
+const SARibbonThemeData& SARibbonThemeStyle::themeData() const
+{
+    return d_ptr->mData;
+}
+
+/**
+ * @brief 判断是否为ribbon相关的窗口，类名（含父类）以SARibbon开头的都认为是ribbon相关的窗口
+ * @param w
+ * @return
+ */
+bool SARibbonThemeStyle::isRibbonWidget(const QWidget* w)
+{
+    if (!w) {
+        return false;
+    }
+    for (const QMetaObject* mo = w->metaObject(); mo; mo = mo->superClass()) {
+        if (qstrncmp(mo->className(), "SARibbon", 8) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 把此style设置到窗口w及其所有子窗口上
+ *
+ * QWidget::setStyle不会作用到子窗口，因此逐个设置，并在这些窗口上安装事件过滤，
+ * 之后加入的子窗口在polish时（QEvent::ChildPolished）也会设置此style。
+ * 应用程序的style不会改变，已经设置了其它style的窗口不做处理
+ * @param w
+ */
+void SARibbonThemeStyle::installOn(QWidget* w)
+{
+    if (!w) {
+        return;
+    }
+    QList< QWidget* > widgets = w->findChildren< QWidget* >();
+    widgets.prepend(w);
+    for (QWidget* c : qAsConst(widgets)) {
+        if (c->testAttribute(Qt::WA_SetStyle) && !c->property(SA_RIBBON_THEME_STYLE_PROPERTY).toBool()) {
+            // 用户自己设置的style
+            continue;
+        }
+        if (!c->property(SA_RIBBON_THEME_STYLE_PROPERTY).toBool()) {
+            c->setProperty(SA_RIBBON_THEME_STYLE_PROPERTY, true);
+            c->setStyle(this);
+        }
+        // 重复安装不会重复调用，只会移到最前
+        c->installEventFilter(this);
+    }
+}
+
+/**
+ * @brief 从窗口w及其子窗口上移除此style，这些窗口恢复为应用程序的style
+ * @param w
+ */
+void SARibbonThemeStyle::uninstallFrom(QWidget* w)
+{
+    if (!w) {
+        return;
+    }
+    QList< QWidget* > widgets = w->findChildren< QWidget* >();
+    widgets.prepend(w);
+    for (QWidget* c : qAsConst(widgets)) {
+        c->removeEventFilter(this);
+        if (c->property(SA_RIBBON_THEME_STYLE_PROPERTY).toBool()) {
+            c->setProperty(SA_RIBBON_THEME_STYLE_PROPERTY, QVariant());
+            // setStyle会先用此style unpolish，恢复调色板
+            c->setStyle(nullptr);
+        }
+    }
+}
+
+/**
+ * @brief 对窗口w及其子窗口中设置了此style的ribbon窗口重新polish，主题数据变化后调用
+ * @param w
+ */
+void SARibbonThemeStyle::repolish(QWidget* w)
+{
+    if (!w) {
+        return;
+    }
+    QList< QWidget* > widgets = w->findChildren< QWidget* >();
+    widgets.prepend(w);
+    for (QWidget* c : qAsConst(widgets)) {
+        if (c->property(SA_RIBBON_THEME_STYLE_PROPERTY).toBool() && isRibbonWidget(c)) {
+            unpolish(c);
+            polish(c);
+            c->update();
+        }
+    }
+}
+
+/**
+ * @brief 子窗口polish完成后设置此style
+ *
+ * 不在QEvent::ChildAdded时设置，此时子窗口可能还在构造中
+ * @param watched
+ * @param e
+ * @return
+ */
+bool SARibbonThemeStyle::eventFilter(QObject* watched, QEvent* e)
+{
+    if (QEvent::ChildPolished == e->type()) {
+        QObject* child = static_cast< QChildEvent* >(e)->child();
+        if (child && child->isWidgetType()) {
+            installOn(static_cast< QWidget* >(child));
+        }
+    }
+    return QProxyStyle::eventFilter(watched, e);
+}
+
+/**
+ * @brief 对ribbon的窗口设置调色板，非ribbon窗口交由基础style处理
+ *
+ * polish前的autoFillBackground会记录下来，在@ref unpolish 时恢复
+ * @param w
+ */
+void SARibbonThemeStyle::polish(QWidget* w)
+{
+    QProxyStyle::polish(w);
+    if (!isRibbonWidget(w)) {
+        return;
+    }
+    QPalette pl   = w->palette();
+    bool autoFill = false;
+    if (!d_ptr->polishPalette(w, pl, autoFill)) {
+        return;
+    }
+    if (!w->property(SA_RIBBON_THEME_POLISHED_PROPERTY).isValid()) {
+        w->setProperty(SA_RIBBON_THEME_POLISHED_PROPERTY, w->autoFillBackground());
+    }
+    w->setPalette(pl);
+    if (autoFill) {
+        w->setAutoFillBackground(true);
+    }
+}
+
+/**
+ * @brief 恢复被@ref polish 修改过的窗口
+ * @param w
+ */
+void SARibbonThemeStyle::unpolish(QWidget* w)
+{
+    const QVariant v = w->property(SA_RIBBON_THEME_POLISHED_PROPERTY);
+    if (v.isValid()) {
+        w->setPalette(QPalette());
+        w->setAutoFillBackground(v.toBool());
+        w->setProperty(SA_RIBBON_THEME_POLISHED_PROPERTY, QVariant());
+    }
+    QProxyStyle::unpolish(w);
+}
+
+void SARibbonThemeStyle::drawPrimitive(PrimitiveElement pe,
+                                       const QStyleOption* opt,
+                                       QPainter* p,
+                                       const QWidget* w) const
+{
+    switch (pe) {
+    case PE_PanelButtonTool:
+    case PE_PanelButtonBevel:
+        if (sa_is_in_ribbon(w)) {
+            d_ptr->drawButtonPanel(opt, p, w);
+            return;
+        }
+        break;
+    case PE_FrameFocusRect:
+        // ribbon不绘制焦点框
+        if (sa_is_in_ribbon(w)) {
+            return;
+        }
+        break;
+    case PE_FrameTabBarBase:
+        // 基线由SARibbonBar绘制
+        if (qobject_cast< const SARibbonTabBar* >(w)) {
+            return;
+        }
+        break;
+    case PE_PanelMenu:
+        if (qobject_cast< const SARibbonMenu* >(w)) {
+            sa_draw_panel(p, opt->rect, d_ptr->mData.menuBackground, QColor(), 0);
+            return;
+        }
+        break;
+    case PE_FrameMenu:
+        if (qobject_cast< const SARibbonMenu* >(w)) {
+            sa_draw_panel(p, opt->rect, QColor(), d_ptr->mData.menuBorder, 0);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    QProxyStyle::drawPrimitive(pe, opt, p, w);
+}
+
+void SARibbonThemeStyle::drawControl(ControlElement element,
+                                     const QStyleOption* opt,
+                                     QPainter* p,
+                                     const QWidget* w) const
+{
+    switch (element) {
+    case CE_TabBarTabShape:
+        if (const SARibbonTabBar* tab = qobject_cast< const SARibbonTabBar* >(w)) {
+            if (const QStyleOptionTab* tabOpt = qstyleoption_cast< const QStyleOptionTab* >(opt)) {
+                d_ptr->drawTabShape(tabOpt, p, tab);
+                return;
+            }
+        }
+        break;
+    case CE_TabBarTabLabel:
+        if (const SARibbonTabBar* tab = qobject_cast< const SARibbonTabBar* >(w)) {
+            if (const QStyleOptionTab* tabOpt = qstyleoption_cast< const QStyleOptionTab* >(opt)) {
+                const SARibbonThemeData& td = d_ptr->mData;
+                QStyleOptionTab labelOpt(*tabOpt);
+                QColor clr = td.tabText;
+                if (tabOpt->state.testFlag(State_Selected)) {
+                    clr = td.tabSelectedText;
+                } else if (tabOpt->state.testFlag(State_Enabled) && tabOpt->state.testFlag(State_MouseOver)) {
+                    clr = td.tabHoverText;
+                }
+                sa_set_palette_text(labelOpt.palette, QPalette::WindowText, clr);
+                const QMargins& mg = tab->tabMargin();
+                labelOpt.rect      = tabOpt->rect.adjusted(mg.left(), mg.top(), -mg.right(), -mg.bottom());
+                QProxyStyle::drawControl(element, &labelOpt, p, w);
+                return;
+            }
+        }
+        break;
+    case CE_ShapedFrame:
+        if (qobject_cast< const SARibbonGallery* >(w) && d_ptr->mData.galleryBorder.isValid()) {
+            const QStyleOptionFrame* frameOpt = qstyleoption_cast< const QStyleOptionFrame* >(opt);
+            if (frameOpt && frameOpt->frameShape != QFrame::NoFrame) {
+                sa_draw_panel(p, opt->rect, QColor(), d_ptr->mData.galleryBorder, 0);
+                return;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    QProxyStyle::drawControl(element, opt, p, w);
+}
+
+QSize SARibbonThemeStyle::sizeFromContents(ContentsType ct,
+                                           const QStyleOption* opt,
+                                           const QSize& contentsSize,
+                                           const QWidget* w) const
+{
+    QSize sz = QProxyStyle::sizeFromContents(ct, opt, contentsSize, w);
+    if (CT_TabBarTab == ct) {
+        if (const SARibbonTabBar* tab = qobject_cast< const SARibbonTabBar* >(w)) {
+            // 和qss一样，min-width/min-height不含margin
+            const QMargins& mg = tab->tabMargin();
+            sz                 = sz.expandedTo(d_ptr->mData.tabMinimumSize);
+            sz += QSize(mg.left() + mg.right(), mg.top() + mg.bottom());
+        }
+    }
+    return sz;
+}
+
+//===================================================
+// 全局函数
+//===================================================
+
+void sa_set_ribbon_theme_style(QWidget* w, SARibbonMainWindow::RibbonTheme theme)
+{
+    if (!w) {
+        return;
+    }
+    // 清除主题设置的qss，否则QStyleSheetStyle依然会接管所有子窗口，用户自己设置的qss不做处理
+    sa_clear_ribbon_theme_qss(w);
+    const SARibbonThemeData data   = SARibbonThemeData::themeData(theme);
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(w);
+    if (themeStyle) {
+        // 已经设置过，只对ribbon相关的窗口重新polish
+        themeStyle->setThemeData(data);
+        themeStyle->repolish(w);
+        return;
+    }
+    // QProxyStyle会接管基础style的所有权，因此按应用程序style的名字新建一个，
+    // 应用程序的style是无法通过名字创建的自定义style时，QStyleFactory返回nullptr，QProxyStyle使用平台默认的style
+    themeStyle = new SARibbonThemeStyle(data, QStyleFactory::create(QApplication::style()->objectName()));
+    themeStyle->setParent(w);
+    themeStyle->installOn(w);
+}
+
+void sa_clear_ribbon_theme_style(QWidget* w)
+{
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(w);
+    if (!themeStyle) {
+        return;
+    }
+    themeStyle->uninstallFrom(w);
+    delete themeStyle;
+}
+
+SARibbonThemeStyle* sa_ribbon_theme_style(const QWidget* w)
+{
+    if (!w) {
+        return nullptr;
+    }
+    return w->findChild< SARibbonThemeStyle* >(QString(), Qt::FindDirectChildrenOnly);
+}
@@ -0,0 +1,173 @@
+﻿#ifndef SARIBBONTHEME_H
+#define SARIBBONTHEME_H
+#include "SARibbonGlobal.h"
+#include <QColor>
+#include <QList>
+#include <QMargins>
+#include <QProxyStyle>
+#include <QSize>
+#include "SARibbonMainWindow.h"
+#include "SARibbonSystemButtonBar.h"
+
+/**
+ * @brief ribbon主题的颜色和尺寸数据
+ *
+ * 此类把theme-*.qss中的颜色和尺寸以强类型的方式描述出来，
+ * 既作为@ref SARibbonThemeStyle 绘制的依据，也作为qss主题设置后C++端尺寸修正的依据（例如tab的margin）
+ *
+ * 颜色为无效值（QColor()）时，表示此项不做设置，沿用默认的调色板
+ *
+ * 通过@ref themeData 可获取内置主题对应的数据，用户也可以在此基础上修改后设置到@ref SARibbonThemeStyle 中
+ */
+class SA_RIBBON_EXPORT SARibbonThemeData
+{
+public:
+    // 获取内置主题对应的数据
+    static SARibbonThemeData themeData(SARibbonMainWindow::RibbonTheme theme);
+
+public:
+    // ribbonbar
+    QColor barBackground;             ///< ribbonbar的背景
+    QColor titleText;                 ///< 窗口标题文字颜色
+    QColor quickAccessBarBackground;  ///< 快速响应栏背景
+    // category和pannel
+    QColor categoryBackground;     ///< category的背景
+    QColor pannelBackground;       ///< pannel的背景
+    QColor pannelText;             ///< pannel中文字的颜色
+    QColor pannelTitleText;        ///< pannel标题的文字颜色
+    QColor pannelTitleBackground;  ///< pannel标题的背景
+    QColor separatorColor;         ///< 分割线颜色
+    // applicationButton
+    QColor applicationButtonText;               ///< applicationButton文字颜色
+    QColor applicationButtonBackground;         ///< applicationButton背景
+    QColor applicationButtonHoverBackground;    ///< applicationButton鼠标悬停背景
+    QColor applicationButtonPressedBackground;  ///< applicationButton按下背景
+    // tab
+    QColor tabText;                     ///< tab文字颜色
+    QColor tabSelectedText;             ///< 选中tab的文字颜色
+    QColor tabSelectedBackground;       ///< 选中tab的背景
+    QColor tabSelectedBorder;           ///< 选中tab的边框（指示条风格下为指示条颜色）
+    QColor tabHoverText;                ///< 鼠标悬停tab的文字颜色
+    QColor tabHoverBackground;          ///< 鼠标悬停tab的背景
+    QColor tabHoverBorder;              ///< 鼠标悬停tab的边框（指示条风格下为指示条颜色）
+    int tabIndicatorWidth { 0 };        ///< tab底部指示条的高度，为0时为边框风格
+    QMargins tabMargin { 5, 0, 0, 0 };  ///< tab的margin，对应qss中SARibbonTabBar::tab的margin
+    QSize tabMinimumSize { 50, 25 };    ///< tab的最小尺寸，对应qss中的min-width和min-height
+    // 按钮
+    QColor buttonText;               ///< 按钮文字颜色
+    QColor buttonHoverBackground;    ///< 按钮鼠标悬停背景
+    QColor buttonHoverBorder;        ///< 按钮鼠标悬停边框
+    QColor buttonPressedBackground;  ///< 按钮按下背景
+    QColor buttonPressedBorder;      ///< 按钮按下边框
+    QColor buttonCheckedBackground;  ///< 按钮选中背景
+    QColor buttonCheckedBorder;      ///< 按钮选中边框
+    int buttonBorderRadius { 0 };    ///< 按钮圆角
+    // 菜单
+    QColor menuText;                 ///< 菜单文字颜色
+    QColor menuBackground;           ///< 菜单背景
+    QColor menuBorder;               ///< 菜单边框
+    QColor menuItemHoverBackground;  ///< 菜单项鼠标悬停背景
+    QColor menuItemHoverBorder;      ///< 菜单项鼠标悬停边框
+    // gallery
+    QColor galleryBorder;              ///< gallery边框
+    QColor galleryBackground;          ///< gallery背景
+    QColor gallerySelectedBackground;  ///< gallery选中项背景
+    // 系统按钮
+    QColor systemButtonHoverBackground;    ///< 最大最小化按钮鼠标悬停背景
+    QColor systemButtonPressedBackground;  ///< 最大最小化按钮按下背景
+    QColor systemCloseHoverBackground;     ///< 关闭按钮鼠标悬停背景
+    QColor systemClosePressedBackground;   ///< 关闭按钮按下背景
+    /// 系统按钮图标的风格
+    SARibbonSystemButtonBar::SystemIconStyle systemIconStyle { SARibbonSystemButtonBar::SystemIconDark };
+    // 其它
+    QColor tabBarBaseLineColor;                 ///< tabbar下基线颜色，无效值不绘制
+    QList< QColor > contextCategoryColors;      ///< 上下文标签颜色，为空时使用默认色系
+    bool changeContextCategoryColors { true };  ///< 为false时不修改上下文标签颜色
+};
+
+/**
+ * @brief 原生绘制的ribbon主题，是qss主题的替代方案
+ *
+ * qss主题通过setStyleSheet设置到窗口上，会使所有子窗口都由QStyleSheetStyle接管，
+ * polish、sizeHint和绘制都要经过qss规则的匹配，开销较大。
+ * SARibbonThemeStyle是一个QProxyStyle，根据@ref SARibbonThemeData 直接绘制ribbon的各个元素，
+ * 能得到和qss主题接近的外观，但不需要qss
+ *
+ * 一般不需要直接使用此类，通过@ref SARibbonMainWindow::setRibbonThemeEngine 或@ref sa_set_ribbon_theme_style 设置即可
+ *
+ * @code
+ * mainwindow->setRibbonThemeEngine(SARibbonMainWindow::RibbonThemeEngineStyle);
+ * mainwindow->setRibbonTheme(SARibbonMainWindow::RibbonThemeOffice2013);
+ * @endcode
+ *
+ * @note 此style只针对ribbon相关的窗口（类名以SARibbon开头的窗口以及ribbonbar中的按钮）做特殊处理，
+ * 其余窗口交由基础style绘制
+ *
+ * @note 此style不会设置为应用程序的style，通过@ref installOn 只设置到指定窗口及其子窗口上，
+ * 之后加入的子窗口也会自动设置，因此不会影响ribbon以外的窗口
+ */
+class SA_RIBBON_EXPORT SARibbonThemeStyle : public QProxyStyle
+{
+    Q_OBJECT
+    SA_RIBBON_DECLARE_PRIVATE(SARibbonThemeStyle)
+public:
+    explicit SARibbonThemeStyle(SARibbonMainWindow::RibbonTheme theme, QStyle* baseStyle = nullptr);
+    explicit SARibbonThemeStyle(const SARibbonThemeData& data, QStyle* baseStyle = nullptr);
+    ~SARibbonThemeStyle() Q_DECL_OVERRIDE;
+    // 主题数据
+    void setThemeData(const SARibbonThemeData& data);
+    const SARibbonThemeData& themeData() const;
+    // 判断是否为ribbon相关的窗口
+    static bool isRibbonWidget(const QWidget* w);
+    // 把此style设置到窗口及其所有子窗口上
+    void installOn(QWidget* w);
+    // 从窗口及其子窗口上移除此style
+    void uninstallFrom(QWidget* w);
+    // 对设置了此style的窗口重新polish，主题数据变化后调用
+    void repolish(QWidget* w);
+
+    using QProxyStyle::polish;
+    using QProxyStyle::unpolish;
+    virtual void polish(QWidget* w) Q_DECL_OVERRIDE;
+    virtual void unpolish(QWidget* w) Q_DECL_OVERRIDE;
+    virtual void drawPrimitive(PrimitiveElement pe,
+                               const QStyleOption* opt,
+                               QPainter* p,
+                               const QWidget* w = nullptr) const Q_DECL_OVERRIDE;
+    virtual void drawControl(ControlElement element,
+                             const QStyleOption* opt,
+                             QPainter* p,
+                             const QWidget* w = nullptr) const Q_DECL_OVERRIDE;
+    virtual QSize sizeFromContents(ContentsType ct,
+                                   const QStyleOption* opt,
+                                   const QSize& contentsSize,
+                                   const QWidget* w = nullptr) const Q_DECL_OVERRIDE;
+    virtual bool eventFilter(QObject* watched, QEvent* e) Q_DECL_OVERRIDE;
+};
+
+/**
+ * @brief 以原生绘制的方式设置ribbon theme
+ *
+ * 和@ref sa_set_ribbon_theme 对应，此函数会清除窗口w上的qss，并把@ref SARibbonThemeStyle 设置到窗口w及其子窗口上，
+ * style作为w的子对象，随w一起销毁，应用程序的style不会改变；
+ * 如果w已经设置了SARibbonThemeStyle，只更新主题数据并重新polish窗口w及其子窗口
+ *
+ * @param w
+ * @param theme
+ */
+void SA_RIBBON_EXPORT sa_set_ribbon_theme_style(QWidget* w, SARibbonMainWindow::RibbonTheme theme);
+
+/**
+ * @brief 清除由@ref sa_set_ribbon_theme_style 设置的主题，窗口w及其子窗口恢复为原来的style
+ * @param w
+ */
+void SA_RIBBON_EXPORT sa_clear_ribbon_theme_style(QWidget* w);
+
+/**
+ * @brief 获取由@ref sa_set_ribbon_theme_style 设置在窗口w上的主题style，没有设置过返回nullptr
+ * @param w
+ * @return
+ */
+SARibbonThemeStyle* SA_RIBBON_EXPORT sa_ribbon_theme_style(const QWidget* w);
+
+#endif  // SARIBBONTHEME_H
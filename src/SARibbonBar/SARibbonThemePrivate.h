@@ -0,0 +1,32 @@
+﻿#ifndef SARIBBONTHEMEPRIVATE_H
+#define SARIBBONTHEMEPRIVATE_H
+#include <QString>
+#include <QVariant>
+#include <QWidget>
+
+/**
+ * @file SARibbonThemePrivate.h
+ * @brief 主题相关的内部定义，qss主题（SARibbonMainWindow.cpp）和原生绘制主题（SARibbonTheme.cpp）共用，不对外安装
+ */
+
+/**
+ * @def 记录窗口的qss是由sa_set_ribbon_theme设置的属性名
+ */
+#define SA_RIBBON_THEME_QSS_PROPERTY "_sa_ribbon_theme_qss"
+
+/**
+ * @brief 清除由sa_set_ribbon_theme设置的qss，用户自己设置的qss不做处理
+ * @param w
+ */
+static inline void sa_clear_ribbon_theme_qss(QWidget* w)
+{
+    if (!w || !w->property(SA_RIBBON_THEME_QSS_PROPERTY).toBool()) {
+        return;
+    }
+    w->setProperty(SA_RIBBON_THEME_QSS_PROPERTY, QVariant());
+    if (!w->styleSheet().isEmpty()) {
+        w->setStyleSheet(QString());
+    }
+}
+
+#endif  // SARIBBONTHEMEPRIVATE_H
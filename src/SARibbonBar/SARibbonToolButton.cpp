@@ -1,5 +1,6 @@
 ﻿#include "SARibbonToolButton.h"
 #include "SARibbonPannel.h"
+#include "SARibbonTheme.h"
 
 #include <QAction>
 #include <QApplication>
@@ -87,6 +88,23 @@ QDebug operator<<(QDebug debug, const QStyleOptionToolButton& opt)
 }
 }
 
+/**
+ * @brief 查找窗口w的父窗口上由sa_set_ribbon_theme_style设置的SARibbonThemeStyle
+ *
+ * SARibbonToolButton设置了自己的style，SARibbonThemeStyle不会覆盖它，因此从父窗口上获取
+ * @param w
+ * @return
+ */
+static SARibbonThemeStyle* sa_tool_button_theme_style(const QWidget* w)
+{
+    for (const QWidget* p = (w ? w->parentWidget() : nullptr); p; p = p->parentWidget()) {
+        if (SARibbonThemeStyle* s = qobject_cast< SARibbonThemeStyle* >(p->style())) {
+            return s;
+        }
+    }
+    return nullptr;
+}
+
 //===================================================
 // SARibbonToolButtonProxyStyle
 //===================================================
@@ -161,6 +179,11 @@ public:
 			int yOffset = r.y() + (r.height() - size)/2;
 			p->drawPixmap(xOffset, yOffset, pixmap);
 		}
+		else if (SARibbonThemeStyle* themeStyle = sa_tool_button_theme_style(widget))
+		{
+			// 原生主题下，按钮的背景由父窗口上的SARibbonThemeStyle绘制
+			themeStyle->drawPrimitive(pe, opt, p, widget);
+		}
 		else
 		{
 			QProxyStyle::drawPrimitive(pe, opt, p, widget);
@@ -227,6 +250,8 @@ public:
     int getTextAlignment() const;
     // 确认文字是否确切要换行显示
     bool isTextNeedWrap() const;
+    // 预设的sizehint是否依然有效
+    bool isPresetSizeHintValid() const;
     // 仅仅对\n进行剔除，和QString::simplified不一样
     static QString simplified(const QString& str);
 
@@ -235,13 +260,18 @@ public:
     bool mMenuButtonPressed { false };  ///< 由于Indicator改变，因此hitButton不能用QToolButton的hitButton
     bool mWordWrap { false };           ///< 标记是否文字换行 @default false
     SARibbonToolButton::RibbonButtonType mButtonType { SARibbonToolButton::LargeButton };
-    int mSpacing { 1 };              ///< 按钮和边框的距离
-    int mIndicatorLen { 8 };         ///< Indicator的长度
-    QRect mDrawIconRect;             ///< 记录icon的绘制位置
-    QRect mDrawTextRect;             ///< 记录text的绘制位置
-    QRect mDrawIndicatorArrowRect;   ///< 记录IndicatorArrow的绘制位置
-    QSize mSizeHint;                 ///< 保存计算好的sizehint
-    bool mIsTextNeedWrap { false };  ///< 标记文字是否需要换行显示
+    int mSpacing { 1 };                ///< 按钮和边框的距离
+    int mIndicatorLen { 8 };           ///< Indicator的长度
+    QRect mDrawIconRect;               ///< 记录icon的绘制位置
+    QRect mDrawTextRect;               ///< 记录text的绘制位置
+    QRect mDrawIndicatorArrowRect;     ///< 记录IndicatorArrow的绘制位置
+    QSize mSizeHint;                   ///< 保存计算好的sizehint
+    bool mIsTextNeedWrap { false };    ///< 标记文字是否需要换行显示
+    bool mIsSizeHintPreset { false };  ///< 标记mSizeHint是预设的，不需要重新计算
+    QString mPresetText;               ///< 预设sizehint时按钮的文字
+    qint64 mPresetIconKey { 0 };       ///< 预设sizehint时按钮图标的cacheKey
+    QMenu* mPresetMenu { nullptr };    ///< 预设sizehint时按钮的菜单
+    QFont mPresetFont;                 ///< 预设sizehint时按钮的字体
 public:
     static bool s_enableWordWrap;  ///< 在lite模式下是否允许文字换行，如果允许，则图标相对比较小，默认不允许
 };
@@ -762,6 +792,19 @@ bool SARibbonToolButton::PrivateData::isTextNeedWrap() const
     return mIsTextNeedWrap;
 }
 
+/**
+ * @brief 预设的sizehint是否依然有效
+ *
+ * 只有影响尺寸的文字、图标、菜单和字体和预设时一致才有效，action的enable、check等状态变化不影响，
+ * 按钮自身的setText/setIcon没有对应的事件，因此在使用预设值时比较
+ * @return
+ */
+bool SARibbonToolButton::PrivateData::isPresetSizeHintValid() const
+{
+    return (mIsSizeHintPreset && mPresetText == q_ptr->text() && mPresetIconKey == q_ptr->icon().cacheKey()
+            && mPresetMenu == q_ptr->menu() && mPresetFont == q_ptr->font());
+}
+
 /**
  * @brief 仅仅对\n进行剔除
  * @param str
@@ -888,12 +931,67 @@ QSize SARibbonToolButton::sizeHint() const
 #if SA_RIBBON_TOOLBUTTON_DEBUG_PRINT && SA_DEBUG_PRINT_SIZE_HINT
     qDebug() << "| | |-SARibbonToolButton::sizeHint";
 #endif
+    if (d_ptr->isPresetSizeHintValid()) {
+        return d_ptr->mSizeHint;
+    }
+    d_ptr->mIsSizeHintPreset = false;
     QStyleOptionToolButton opt;
     initStyleOption(&opt);
     d_ptr->updateSizeHint(opt);
     return d_ptr->mSizeHint;
 }
 
+/**
+ * @brief 使用预设的sizehint
+ *
+ * 计算大按钮的sizehint需要多次测量文字的换行，按钮很多时比较耗时，如果已经知道结果（例如从布局快照中恢复），
+ * 可以通过此函数直接设置，在按钮的文字、图标、菜单、字体、样式或者按钮类型变化前，sizeHint都直接返回预设值，
+ * action的enable、check等状态变化不会使预设值失效
+ * @param s sizehint
+ * @param textNeedWrap 文字是否需要换行显示，见@ref isTextNeedWrap
+ * @sa SARibbonBar::restoreLayoutSnapshot
+ */
+void SARibbonToolButton::setPresetSizeHint(const QSize& s, bool textNeedWrap)
+{
+    d_ptr->mSizeHint         = s;
+    d_ptr->mIsTextNeedWrap   = textNeedWrap;
+    d_ptr->mIsSizeHintPreset = true;
+    d_ptr->mPresetText       = text();
+    d_ptr->mPresetIconKey    = icon().cacheKey();
+    d_ptr->mPresetMenu       = menu();
+    d_ptr->mPresetFont       = font();
+    updateRect();
+}
+
+/**
+ * @brief 清除预设的sizehint，下次调用sizeHint时重新计算
+ */
+void SARibbonToolButton::clearPresetSizeHint()
+{
+    if (d_ptr->mIsSizeHintPreset) {
+        d_ptr->mIsSizeHintPreset = false;
+        updateGeometry();
+    }
+}
+
+/**
+ * @brief 是否正在使用预设的sizehint
+ * @return
+ */
+bool SARibbonToolButton::isSizeHintPreset() const
+{
+    return d_ptr->isPresetSizeHintValid();
+}
+
+/**
+ * @brief 文字是否需要换行显示，此值在计算sizehint时确定
+ * @return
+ */
+bool SARibbonToolButton::isTextNeedWrap() const
+{
+    return d_ptr->isTextNeedWrap();
+}
+
 void SARibbonToolButton::paintEvent(QPaintEvent* e)
 {
     Q_UNUSED(e);
@@ -1131,7 +1229,8 @@ SARibbonToolButton::RibbonButtonType SARibbonToolButton::buttonType() const
  */
 void SARibbonToolButton::setButtonType(const RibbonButtonType& buttonType)
 {
-    d_ptr->mButtonType = buttonType;
+    d_ptr->mButtonType       = buttonType;
+    d_ptr->mIsSizeHintPreset = false;
     // 计算iconrect
     // 根据字体计算文字的高度
 
@@ -1207,10 +1306,15 @@ bool SARibbonToolButton::event(QEvent* e)
     case QEvent::WindowDeactivate:
         d_ptr->mMouseOnSubControl = false;
         break;
-    case QEvent::ActionChanged:
+    case QEvent::ActionChanged: {
+        // 预设的sizehint只在文字、图标、菜单或字体变化时失效，见PrivateData::isPresetSizeHintValid
+        d_ptr->mMouseOnSubControl = false;
+        updateRect();
+    } break;
     case QEvent::ActionRemoved:
     case QEvent::ActionAdded: {
         d_ptr->mMouseOnSubControl = false;
+        d_ptr->mIsSizeHintPreset  = false;
         updateRect();
     } break;
     default:
@@ -1223,8 +1327,9 @@ bool SARibbonToolButton::event(QEvent* e)
 void SARibbonToolButton::changeEvent(QEvent* e)
 {
     if (e) {
-        if (e->type() == QEvent::FontChange) {
-            // 说明字体改变，需要重新计算和字体相关的信息
+        if (e->type() == QEvent::FontChange || e->type() == QEvent::StyleChange) {
+            // 说明字体或样式改变，需要重新计算和字体相关的信息，预设的sizehint也不再有效
+            d_ptr->mIsSizeHintPreset = false;
             updateRect();
         }
     }
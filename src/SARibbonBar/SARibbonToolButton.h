@@ -46,6 +46,15 @@ public:
 
     virtual QSize sizeHint() const Q_DECL_OVERRIDE;
 
+    //使用预设的sizehint，按钮的内容、字体和样式变化前不再计算sizehint，用于从布局快照中恢复
+    void setPresetSizeHint(const QSize& s, bool textNeedWrap);
+    //清除预设的sizehint，恢复计算
+    void clearPresetSizeHint();
+    //是否正在使用预设的sizehint
+    bool isSizeHintPreset() const;
+    //文字是否需要换行显示
+    bool isTextNeedWrap() const;
+
 public:
     //在lite模式下是否允许文字换行
     static void setEnableWordWrap(bool on);
@@ -6,6 +6,7 @@
 #include <QColorDialog>
 // SA
 #include "SAColorGridWidget.h"
+#include "SAColorSwatchGridWidget.h"
 class SAColorPaletteGridWidget::PrivateData
 {
     SA_COLOR_WIDGETS_DECLARE_PUBLIC(SAColorPaletteGridWidget)
@@ -17,16 +18,17 @@ public:
 public:
     QList< int > mFactor { 180, 160, 140, 75, 50 };  ///< palette的比例因子，将调用QColor的lighter函数执行
     QVBoxLayout* mLayout { nullptr };                ///< 垂直布局
-    SAColorGridWidget* mMainColorList { nullptr };   ///< 这个用于显示标准颜色
-    SAColorGridWidget* mPaletteColorGrid { nullptr };  ///< 这个用于生成3行亮色，2行暗色的palette
+    SAColorSwatchGridWidget* mMainColorList { nullptr };     ///< 这个用于显示标准颜色
+    SAColorSwatchGridWidget* mPaletteColorGrid { nullptr };  ///< 这个用于生成3行亮色，2行暗色的palette
 };
 
 SAColorPaletteGridWidget::PrivateData::PrivateData(SAColorPaletteGridWidget* p) : q_ptr(p)
 {
     mLayout = new QVBoxLayout(p);
     p->setLayout(mLayout);
-    mMainColorList    = new SAColorGridWidget(p);
-    mPaletteColorGrid = new SAColorGridWidget(p);
+    // 色板的颜色块很多，使用单窗口绘制的SAColorSwatchGridWidget，避免每个颜色创建一个按钮
+    mMainColorList    = new SAColorSwatchGridWidget(p);
+    mPaletteColorGrid = new SAColorSwatchGridWidget(p);
     mLayout->addWidget(mMainColorList);
     mLayout->addWidget(mPaletteColorGrid);
     mLayout->setContentsMargins(1, 1, 1, 1);
@@ -79,8 +81,14 @@ SAColorPaletteGridWidget::~SAColorPaletteGridWidget()
 }
 void SAColorPaletteGridWidget::init()
 {
-    connect(d_ptr->mMainColorList, &SAColorGridWidget::colorClicked, this, &SAColorPaletteGridWidget::onMainColorClicked);
-    connect(d_ptr->mPaletteColorGrid, &SAColorGridWidget::colorClicked, this, &SAColorPaletteGridWidget::onPaletteColorClicked);
+    connect(d_ptr->mMainColorList,
+            &SAColorSwatchGridWidget::colorClicked,
+            this,
+            &SAColorPaletteGridWidget::onMainColorClicked);
+    connect(d_ptr->mPaletteColorGrid,
+            &SAColorSwatchGridWidget::colorClicked,
+            this,
+            &SAColorPaletteGridWidget::onPaletteColorClicked);
     QSizePolicy sizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
     setSizePolicy(sizePolicy);
     setColorIconSize(QSize(10, 10));
@@ -0,0 +1,625 @@
+﻿#include "SAColorSwatchGridWidget.h"
+#include "SAColorToolButton.h"
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOption>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QHash>
+
+class SAColorSwatchGridWidget::PrivateData
+{
+    SA_COLOR_WIDGETS_DECLARE_PUBLIC(SAColorSwatchGridWidget)
+public:
+    PrivateData(SAColorSwatchGridWidget* p);
+    // 实际的列数
+    int actualColumnCount() const;
+    int actualRowCount() const;
+    // 单个颜色块（含边距）的尺寸
+    QSize cellSize() const;
+    QRect cellRect(int index) const;
+    int indexAt(const QPoint& pos) const;
+    bool isValidIndex(int index) const;
+    void updateCell(int index);
+    void setCheckedIndex(int index);
+    void setHoverIndex(int index);
+    void setFocusIndex(int index);
+    void activate(int index);
+
+public:
+    QList< QColor > mColors;
+    QHash< int, QString > mToolTips;          ///< 颜色块的tooltip
+    QSize mIconSize { 16, 16 };
+    QMargins mColorMargins { 4, 4, 4, 4 };    ///< 颜色块和单元格的边距，和SAColorGridWidget的按钮保持一致
+    int mColumnCount { 8 };  ///< 列数，行数量会根据列数量来匹配,如果设置-1或者0，说明不限定列数量，这样会只有一行
+    int mHorizontalSpacing { 0 };
+    int mVerticalSpacing { 0 };
+    bool mColorCheckable { false };  ///< 设置颜色是否是checkable
+    int mCheckedIndex { -1 };        ///< 选中的颜色索引
+    int mHoverIndex { -1 };          ///< 鼠标悬停的颜色索引
+    int mPressedIndex { -1 };        ///< 鼠标按下的颜色索引
+    int mFocusIndex { -1 };          ///< 键盘焦点所在的颜色索引
+};
+
+SAColorSwatchGridWidget::PrivateData::PrivateData(SAColorSwatchGridWidget* p) : q_ptr(p)
+{
+}
+
+int SAColorSwatchGridWidget::PrivateData::actualColumnCount() const
+{
+    return (mColumnCount <= 0) ? mColors.size() : mColumnCount;
+}
+
+int SAColorSwatchGridWidget::PrivateData::actualRowCount() const
+{
+    const int col = actualColumnCount();
+    if (col <= 0) {
+        return 0;
+    }
+    return (mColors.size() + col - 1) / col;
+}
+
+QSize SAColorSwatchGridWidget::PrivateData::cellSize() const
+{
+    return QSize(mIconSize.width() + mColorMargins.left() + mColorMargins.right(),
+                 mIconSize.height() + mColorMargins.top() + mColorMargins.bottom());
+}
+
+/**
+ * @brief 计算颜色块所在单元格的区域
+ * @param index
+ * @return 索引无效返回空区域
+ */
+QRect SAColorSwatchGridWidget::PrivateData::cellRect(int index) const
+{
+    if (!isValidIndex(index)) {
+        return QRect();
+    }
+    const int col  = actualColumnCount();
+    const QSize cs = cellSize();
+    const QRect cr = q_ptr->contentsRect();
+    const int r    = index / col;
+    const int c    = index % col;
+    return QRect(cr.x() + c * (cs.width() + mHorizontalSpacing),
+                 cr.y() + r * (cs.height() + mVerticalSpacing),
+                 cs.width(),
+                 cs.height());
+}
+
+/**
+ * @brief 点击判断，直接通过坐标换算行列，不需要遍历
+ * @param pos
+ * @return 没有颜色块返回-1，落在间隔上也返回-1
+ */
+int SAColorSwatchGridWidget::PrivateData::indexAt(const QPoint& pos) const
+{
+    const int col = actualColumnCount();
+    if (col <= 0) {
+        return -1;
+    }
+    const QSize cs  = cellSize();
+    const QPoint pt = pos - q_ptr->contentsRect().topLeft();
+    if (pt.x() < 0 || pt.y() < 0) {
+        return -1;
+    }
+    const int stepW = cs.width() + mHorizontalSpacing;
+    const int stepH = cs.height() + mVerticalSpacing;
+    const int c     = pt.x() / stepW;
+    const int r     = pt.y() / stepH;
+    if (c >= col || (pt.x() - c * stepW) >= cs.width() || (pt.y() - r * stepH) >= cs.height()) {
+        return -1;
+    }
+    const int index = r * col + c;
+    return isValidIndex(index) ? index : -1;
+}
+
+bool SAColorSwatchGridWidget::PrivateData::isValidIndex(int index) const
+{
+    return (index >= 0 && index < mColors.size());
+}
+
+/**
+ * @brief 只刷新某个颜色块的区域
+ * @param index
+ */
+void SAColorSwatchGridWidget::PrivateData::updateCell(int index)
+{
+    if (isValidIndex(index)) {
+        q_ptr->update(cellRect(index));
+    }
+}
+
+/**
+ * @brief 设置选中的颜色，行为等同于exclusive的QButtonGroup，会发射colorToggled信号
+ * @param index -1代表清除选中
+ */
+void SAColorSwatchGridWidget::PrivateData::setCheckedIndex(int index)
+{
+    if (index == mCheckedIndex) {
+        return;
+    }
+    const int oldIndex = mCheckedIndex;
+    mCheckedIndex      = isValidIndex(index) ? index : -1;
+    updateCell(oldIndex);
+    updateCell(mCheckedIndex);
+    if (isValidIndex(oldIndex)) {
+        emit q_ptr->colorToggled(mColors[ oldIndex ], false);
+    }
+    if (isValidIndex(mCheckedIndex)) {
+        emit q_ptr->colorToggled(mColors[ mCheckedIndex ], true);
+    }
+}
+
+void SAColorSwatchGridWidget::PrivateData::setHoverIndex(int index)
+{
+    if (index == mHoverIndex) {
+        return;
+    }
+    updateCell(mHoverIndex);
+    mHoverIndex = index;
+    updateCell(mHoverIndex);
+}
+
+void SAColorSwatchGridWidget::PrivateData::setFocusIndex(int index)
+{
+    if (index == mFocusIndex || !isValidIndex(index)) {
+        return;
+    }
+    updateCell(mFocusIndex);
+    mFocusIndex = index;
+    updateCell(mFocusIndex);
+}
+
+/**
+ * @brief 触发颜色块，等同于按钮的click
+ * @param index
+ */
+void SAColorSwatchGridWidget::PrivateData::activate(int index)
+{
+    if (!isValidIndex(index)) {
+        return;
+    }
+    const QColor clr = mColors[ index ];
+    if (mColorCheckable) {
+        setCheckedIndex(index);
+    }
+    emit q_ptr->colorClicked(clr);
+}
+
+//==============================================================
+// SAColorSwatchGridWidget
+//==============================================================
+
+SAColorSwatchGridWidget::SAColorSwatchGridWidget(QWidget* par)
+    : QWidget(par), d_ptr(new SAColorSwatchGridWidget::PrivateData(this))
+{
+    setContentsMargins(1, 1, 1, 1);
+    setMouseTracking(true);
+    setFocusPolicy(Qt::TabFocus);
+    setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
+}
+
+SAColorSwatchGridWidget::~SAColorSwatchGridWidget()
+{
+}
+
+/**
+ * @brief 设置列数，行数量会根据列数量来匹配,如果设置-1或者0，说明不限定列数量，这样会只有一行
+ * @param c
+ */
+void SAColorSwatchGridWidget::setColumnCount(int c)
+{
+    d_ptr->mColumnCount = c;
+    updateGeometry();
+    update();
+}
+
+int SAColorSwatchGridWidget::columnCount() const
+{
+    return d_ptr->mColumnCount;
+}
+
+/**
+ * @brief 设置颜色列表
+ *
+ * 选中状态会保留在原来的位置上，超出新颜色数量的选中状态会被清除，tooltip会被清除
+ * @param cls
+ */
+void SAColorSwatchGridWidget::setColorList(const QList< QColor >& cls)
+{
+    d_ptr->mColors = cls;
+    d_ptr->mToolTips.clear();
+    if (!d_ptr->isValidIndex(d_ptr->mCheckedIndex)) {
+        d_ptr->mCheckedIndex = -1;
+    }
+    if (!d_ptr->isValidIndex(d_ptr->mFocusIndex)) {
+        d_ptr->mFocusIndex = -1;
+    }
+    d_ptr->mHoverIndex   = -1;
+    d_ptr->mPressedIndex = -1;
+    updateGeometry();
+    update();
+}
+
+/**
+ * @brief 获取颜色列表
+ * @return
+ */
+QList< QColor > SAColorSwatchGridWidget::getColorList() const
+{
+    return d_ptr->mColors;
+}
+
+/**
+ * @brief 获取间隔，水平间隔和垂直间隔不一致时返回-1，等同QGridLayout::spacing
+ * @return
+ */
+int SAColorSwatchGridWidget::spacing() const
+{
+    return (d_ptr->mHorizontalSpacing == d_ptr->mVerticalSpacing) ? d_ptr->mHorizontalSpacing : -1;
+}
+
+/**
+ * @brief 设置间隔，同时设置水平间隔和垂直间隔
+ * @param v
+ */
+void SAColorSwatchGridWidget::setSpacing(int v)
+{
+    d_ptr->mHorizontalSpacing = qMax(0, v);
+    d_ptr->mVerticalSpacing   = qMax(0, v);
+    updateGeometry();
+    update();
+}
+
+/**
+ * @brief 获取颜色的数量
+ * @return
+ */
+int SAColorSwatchGridWidget::colorCount() const
+{
+    return d_ptr->mColors.size();
+}
+
+/**
+ * @brief 设置图标 size
+ * @param s
+ */
+void SAColorSwatchGridWidget::setColorIconSize(const QSize& s)
+{
+    d_ptr->mIconSize = s;
+    updateGeometry();
+    update();
+}
+
+/**
+ * @brief 获取图标 size
+ * @return
+ */
+QSize SAColorSwatchGridWidget::colorIconSize() const
+{
+    return d_ptr->mIconSize;
+}
+
+/**
+ * @brief 设置颜色是否是checkable
+ *
+ * 设置为不可check时会清除当前的选中状态
+ * @param on
+ */
+void SAColorSwatchGridWidget::setColorCheckable(bool on)
+{
+    d_ptr->mColorCheckable = on;
+    if (!on) {
+        clearCheckedState();
+    }
+}
+
+/**
+ * @brief 颜色是否是checkable
+ * @return
+ */
+bool SAColorSwatchGridWidget::isColorCheckable() const
+{
+    return d_ptr->mColorCheckable;
+}
+
+/**
+ * @brief 获取当前选中的颜色
+ * @return 没有选中返回无效颜色
+ */
+QColor SAColorSwatchGridWidget::currentCheckedColor() const
+{
+    return d_ptr->mColors.value(d_ptr->mCheckedIndex);
+}
+
+/**
+ * @brief 等同GridLayout的VerticalSpacing属性
+ * @param v
+ */
+void SAColorSwatchGridWidget::setVerticalSpacing(int v)
+{
+    d_ptr->mVerticalSpacing = qMax(0, v);
+    updateGeometry();
+    update();
+}
+
+/**
+ * @brief 等同GridLayout的VerticalSpacing属性
+ * @return
+ */
+int SAColorSwatchGridWidget::verticalSpacing() const
+{
+    return d_ptr->mVerticalSpacing;
+}
+
+/**
+ * @brief 等同GridLayout的HorizontalSpacing属性
+ * @param v
+ */
+void SAColorSwatchGridWidget::setHorizontalSpacing(int v)
+{
+    d_ptr->mHorizontalSpacing = qMax(0, v);
+    updateGeometry();
+    update();
+}
+
+/**
+ * @brief 等同GridLayout的HorizontalSpacing属性
+ * @return
+ */
+int SAColorSwatchGridWidget::horizontalSpacing() const
+{
+    return d_ptr->mHorizontalSpacing;
+}
+
+/**
+ * @brief 清除选中状态，这时没有颜色是选中的
+ */
+void SAColorSwatchGridWidget::clearCheckedState()
+{
+    d_ptr->setCheckedIndex(-1);
+}
+
+/**
+ * @brief 设置颜色块的tooltip，替代SAColorGridWidget::iterationColorBtns设置tooltip的方式
+ *
+ * @note 调用setColorList后tooltip会被清除
+ * @param index
+ * @param tip
+ */
+void SAColorSwatchGridWidget::setColorToolTip(int index, const QString& tip)
+{
+    if (tip.isEmpty()) {
+        d_ptr->mToolTips.remove(index);
+    } else {
+        d_ptr->mToolTips[ index ] = tip;
+    }
+}
+
+QString SAColorSwatchGridWidget::colorToolTip(int index) const
+{
+    return d_ptr->mToolTips.value(index);
+}
+
+/**
+ * @brief 获取颜色块的区域（含边距）
+ * @param index
+ * @return
+ */
+QRect SAColorSwatchGridWidget::colorRect(int index) const
+{
+    return d_ptr->cellRect(index);
+}
+
+/**
+ * @brief 获取点所在的颜色块索引
+ * @param pos
+ * @return 没有返回-1
+ */
+int SAColorSwatchGridWidget::indexAt(const QPoint& pos) const
+{
+    return d_ptr->indexAt(pos);
+}
+
+QSize SAColorSwatchGridWidget::sizeHint() const
+{
+    const QMargins m = contentsMargins();
+    const int col    = d_ptr->actualColumnCount();
+    const int row    = d_ptr->actualRowCount();
+    const QSize cs   = d_ptr->cellSize();
+    int w            = m.left() + m.right();
+    int h            = m.top() + m.bottom();
+    if (col > 0 && row > 0) {
+        w += col * cs.width() + (col - 1) * d_ptr->mHorizontalSpacing;
+        h += row * cs.height() + (row - 1) * d_ptr->mVerticalSpacing;
+    }
+    return QSize(qMax(w, d_ptr->mIconSize.width()), qMax(h, d_ptr->mIconSize.height()));
+}
+
+QSize SAColorSwatchGridWidget::minimumSizeHint() const
+{
+    return sizeHint();
+}
+
+bool SAColorSwatchGridWidget::event(QEvent* e)
+{
+    if (e->type() == QEvent::ToolTip) {
+        QHelpEvent* he    = static_cast< QHelpEvent* >(e);
+        const int index   = d_ptr->indexAt(he->pos());
+        const QString tip = d_ptr->mToolTips.value(index);
+        if (index >= 0 && !tip.isEmpty()) {
+            QToolTip::showText(he->globalPos(), tip, this, d_ptr->cellRect(index));
+        } else {
+            QToolTip::hideText();
+            e->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(e);
+}
+
+void SAColorSwatchGridWidget::paintEvent(QPaintEvent* e)
+{
+    QPainter p(this);
+    const QRect clipRect = e->rect();
+    const bool focused   = hasFocus();
+    QStyleOption opt;
+    opt.initFrom(this);
+    const QStyle::State baseState = opt.state & ~(QStyle::State_MouseOver | QStyle::State_HasFocus);
+    const int cnt                 = d_ptr->mColors.size();
+    for (int i = 0; i < cnt; ++i) {
+        const QRect cell = d_ptr->cellRect(i);
+        if (!clipRect.intersects(cell)) {
+            continue;
+        }
+        const bool hover   = (i == d_ptr->mHoverIndex);
+        const bool pressed = (i == d_ptr->mPressedIndex) && hover;
+        const bool checked = (i == d_ptr->mCheckedIndex);
+        // 按钮底板，和autoRaise的SAColorToolButton效果一致，只有悬停、按下、选中时才绘制
+        if (hover || pressed || checked) {
+            opt.rect  = cell;
+            opt.state = baseState | QStyle::State_AutoRaise;
+            if (hover) {
+                opt.state |= (QStyle::State_MouseOver | QStyle::State_Raised);
+            }
+            if (pressed) {
+                opt.state |= QStyle::State_Sunken;
+            }
+            if (checked) {
+                opt.state |= QStyle::State_On;
+            }
+            style()->drawPrimitive(QStyle::PE_PanelButtonTool, &opt, &p, this);
+        }
+        // 颜色
+        const QRect clrRect = cell.marginsRemoved(d_ptr->mColorMargins);
+        const QColor& clr   = d_ptr->mColors[ i ];
+        if (clr.isValid()) {
+            p.fillRect(clrRect, clr);
+        } else {
+            SAColorToolButton::paintNoneColor(&p, clrRect);
+        }
+        // 键盘焦点
+        if (focused && i == d_ptr->mFocusIndex) {
+            QStyleOptionFocusRect fr;
+            fr.initFrom(this);
+            fr.rect = cell.adjusted(1, 1, -1, -1);
+            style()->drawPrimitive(QStyle::PE_FrameFocusRect, &fr, &p, this);
+        }
+    }
+}
+
+void SAColorSwatchGridWidget::mousePressEvent(QMouseEvent* e)
+{
+    if (e->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(e);
+        return;
+    }
+    const int index = d_ptr->indexAt(e->pos());
+    if (index < 0) {
+        QWidget::mousePressEvent(e);
+        return;
+    }
+    d_ptr->mPressedIndex = index;
+    d_ptr->setHoverIndex(index);
+    d_ptr->updateCell(index);
+    e->accept();
+    emit colorPressed(d_ptr->mColors[ index ]);
+}
+
+void SAColorSwatchGridWidget::mouseMoveEvent(QMouseEvent* e)
+{
+    d_ptr->setHoverIndex(d_ptr->indexAt(e->pos()));
+    QWidget::mouseMoveEvent(e);
+}
+
+void SAColorSwatchGridWidget::mouseReleaseEvent(QMouseEvent* e)
+{
+    if (e->button() != Qt::LeftButton || !d_ptr->isValidIndex(d_ptr->mPressedIndex)) {
+        QWidget::mouseReleaseEvent(e);
+        return;
+    }
+    const int index      = d_ptr->mPressedIndex;
+    const QColor clr     = d_ptr->mColors[ index ];
+    d_ptr->mPressedIndex = -1;
+    d_ptr->updateCell(index);
+    e->accept();
+    emit colorReleased(clr);
+    // 和按钮一样，只有在按下的颜色块上释放才算点击
+    if (d_ptr->indexAt(e->pos()) == index) {
+        d_ptr->activate(index);
+    }
+}
+
+void SAColorSwatchGridWidget::leaveEvent(QEvent* e)
+{
+    d_ptr->setHoverIndex(-1);
+    QWidget::leaveEvent(e);
+}
+
+void SAColorSwatchGridWidget::keyPressEvent(QKeyEvent* e)
+{
+    const int cnt = d_ptr->mColors.size();
+    if (cnt <= 0) {
+        QWidget::keyPressEvent(e);
+        return;
+    }
+    const int col = d_ptr->actualColumnCount();
+    int index     = d_ptr->isValidIndex(d_ptr->mFocusIndex) ? d_ptr->mFocusIndex : 0;
+    switch (e->key()) {
+    case Qt::Key_Left:
+        index = qMax(0, index - 1);
+        break;
+    case Qt::Key_Right:
+        index = qMin(cnt - 1, index + 1);
+        break;
+    case Qt::Key_Up:
+        if (index - col >= 0) {
+            index -= col;
+        }
+        break;
+    case Qt::Key_Down:
+        if (index + col < cnt) {
+            index += col;
+        }
+        break;
+    case Qt::Key_Home:
+        index = 0;
+        break;
+    case Qt::Key_End:
+        index = cnt - 1;
+        break;
+    case Qt::Key_Space:
+    case Qt::Key_Enter:
+    case Qt::Key_Return: {
+        const QColor clr = d_ptr->mColors[ index ];
+        e->accept();
+        emit colorPressed(clr);
+        emit colorReleased(clr);
+        d_ptr->activate(index);
+        return;
+    }
+    default:
+        QWidget::keyPressEvent(e);
+        return;
+    }
+    e->accept();
+    d_ptr->setFocusIndex(index);
+}
+
+void SAColorSwatchGridWidget::focusInEvent(QFocusEvent* e)
+{
+    if (!d_ptr->isValidIndex(d_ptr->mFocusIndex)) {
+        d_ptr->setFocusIndex(d_ptr->isValidIndex(d_ptr->mCheckedIndex) ? d_ptr->mCheckedIndex : 0);
+    }
+    d_ptr->updateCell(d_ptr->mFocusIndex);
+    QWidget::focusInEvent(e);
+}
+
+void SAColorSwatchGridWidget::focusOutEvent(QFocusEvent* e)
+{
+    d_ptr->updateCell(d_ptr->mFocusIndex);
+    QWidget::focusOutEvent(e);
+}
@@ -0,0 +1,86 @@
+﻿#ifndef SACOLORSWATCHGRIDWIDGET_H
+#define SACOLORSWATCHGRIDWIDGET_H
+#include <QWidget>
+#include "SAColorWidgetsGlobal.h"
+/**
+ * @brief 单窗口绘制的颜色grid，是SAColorGridWidget的轻量替代
+ *
+ * SAColorGridWidget每个颜色块都是一个SAColorToolButton，颜色很多时（例如色板）会创建大量窗口，
+ * 此类把所有颜色块绘制在一个窗口中，自行处理点击判断、悬停、选中状态和键盘导航，
+ * 信号与SAColorGridWidget保持一致
+ *
+ * □□□□□□□□□
+ *
+ * □□□□□□□□□
+ */
+class SA_COLOR_WIDGETS_API SAColorSwatchGridWidget : public QWidget
+{
+    Q_OBJECT
+    SA_COLOR_WIDGETS_DECLARE_PRIVATE(SAColorSwatchGridWidget)
+    Q_PROPERTY(int spacing READ spacing WRITE setSpacing)
+public:
+    SAColorSwatchGridWidget(QWidget* par = nullptr);
+    ~SAColorSwatchGridWidget();
+    // 设置列数，行数量会根据列数量来匹配,如果设置-1或者0，说明不限定列数量，这样会只有一行
+    void setColumnCount(int c);
+    int columnCount() const;
+    // 设置当前的颜色列表
+    void setColorList(const QList< QColor >& cls);
+    QList< QColor > getColorList() const;
+    // 间隔
+    int spacing() const;
+    void setSpacing(int v);
+    // 获取颜色的数量
+    int colorCount() const;
+    // 图标的尺寸
+    void setColorIconSize(const QSize& s);
+    QSize colorIconSize() const;
+    // 设置颜色是否是checkable
+    void setColorCheckable(bool on = true);
+    bool isColorCheckable() const;
+    // 获取当前选中的颜色
+    QColor currentCheckedColor() const;
+    // 垂直间距
+    void setVerticalSpacing(int v);
+    int verticalSpacing() const;
+    // 水平间距
+    void setHorizontalSpacing(int v);
+    int horizontalSpacing() const;
+    // 清除当前选中状态，这时没有颜色是选中的
+    void clearCheckedState();
+    // 设置颜色块的tooltip
+    void setColorToolTip(int index, const QString& tip);
+    QString colorToolTip(int index) const;
+    // 获取颜色块的区域
+    QRect colorRect(int index) const;
+    // 获取点所在的颜色块索引，没有返回-1
+    int indexAt(const QPoint& pos) const;
+
+signals:
+    /**
+     * @brief 对于check模式，check的颜色触发的信号
+     * @param c
+     * @param on
+     */
+    void colorClicked(const QColor& c);
+    void colorPressed(const QColor& c);
+    void colorReleased(const QColor& c);
+    void colorToggled(const QColor& c, bool on);
+
+public:
+    virtual QSize sizeHint() const Q_DECL_OVERRIDE;
+    virtual QSize minimumSizeHint() const Q_DECL_OVERRIDE;
+
+protected:
+    virtual bool event(QEvent* e) Q_DECL_OVERRIDE;
+    virtual void paintEvent(QPaintEvent* e) Q_DECL_OVERRIDE;
+    virtual void mousePressEvent(QMouseEvent* e) Q_DECL_OVERRIDE;
+    virtual void mouseMoveEvent(QMouseEvent* e) Q_DECL_OVERRIDE;
+    virtual void mouseReleaseEvent(QMouseEvent* e) Q_DECL_OVERRIDE;
+    virtual void leaveEvent(QEvent* e) Q_DECL_OVERRIDE;
+    virtual void keyPressEvent(QKeyEvent* e) Q_DECL_OVERRIDE;
+    virtual void focusInEvent(QFocusEvent* e) Q_DECL_OVERRIDE;
+    virtual void focusOutEvent(QFocusEvent* e) Q_DECL_OVERRIDE;
+};
+
+#endif  // SACOLORSWATCHGRIDWIDGET_H
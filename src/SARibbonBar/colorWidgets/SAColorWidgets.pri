@@ -3,6 +3,7 @@ HEADERS += \
     $$PWD/SAColorGridWidget.h \
     $$PWD/SAColorMenu.h \
     $$PWD/SAColorPaletteGridWidget.h \
+    $$PWD/SAColorSwatchGridWidget.h \
     $$PWD/SAColorToolButton.h \
     $$PWD/SAColorWidgetsGlobal.h
 
@@ -10,4 +11,5 @@ SOURCES += \
     $$PWD/SAColorGridWidget.cpp \
     $$PWD/SAColorMenu.cpp \
     $$PWD/SAColorPaletteGridWidget.cpp \
+    $$PWD/SAColorSwatchGridWidget.cpp \
     $$PWD/SAColorToolButton.cpp
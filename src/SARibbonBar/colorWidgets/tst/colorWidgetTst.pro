@@ -18,6 +18,7 @@ INCLUDEPATH += $$PWD/../
 SOURCES += \
     ../SAColorGridWidget.cpp \
     ../SAColorPaletteGridWidget.cpp \
+    ../SAColorSwatchGridWidget.cpp \
     ../SAColorToolButton.cpp \
     main.cpp \
     Widget.cpp
@@ -25,6 +26,7 @@ SOURCES += \
 HEADERS += \
     ../SAColorGridWidget.h \
     ../SAColorPaletteGridWidget.h \
+    ../SAColorSwatchGridWidget.h \
     ../SAColorToolButton.h \
     ../SAColorWidgetsGlobal.h \
     Widget.h
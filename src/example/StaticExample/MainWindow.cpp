@@ -32,8 +32,8 @@ MainWindow::MainWindow(QWidget* parent) : SARibbonMainWindow(parent)
         this->setRibbonTheme(th);
     });
     resize(800, 600);
-    // 在构造函数设置主题会不完全生效
-    // QTimer::singleShot(0, this, [ this ]() { this->setRibbonTheme(SARibbonMainWindow::RibbonThemeOffice2016Blue); });
+    // 可以在构造函数中直接设置主题
+    // setRibbonTheme(SARibbonMainWindow::RibbonThemeOffice2016Blue);
 
     // more example see MainWindowExample
 }
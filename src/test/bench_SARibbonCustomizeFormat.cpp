@@ -0,0 +1,92 @@
+﻿#include <QtTest>
+#include <QBuffer>
+#include <QXmlStreamWriter>
+#include "SARibbonCustomizeData.h"
+#include "SARibbonCustomizeWidget.h"
+
+/**
+ * @brief 对比自定义数据的xml格式和二进制格式的加载耗时
+ *
+ * 加载通过@ref sa_customize_datas_from_device 进行，包含格式的自动识别，
+ * 数据模拟一个较大的用户配置：多个category，每个category多个pannel，每个pannel多个action
+ */
+class BenchSARibbonCustomizeFormat : public QObject
+{
+    Q_OBJECT
+private slots:
+    void load_data();
+    void load();
+};
+
+/**
+ * @brief 生成categoryCount个category的自定义数据，每个category有8个pannel，每个pannel有12个action
+ * @param categoryCount
+ * @return
+ */
+static QList< SARibbonCustomizeData > sa_create_customize_datas(int categoryCount)
+{
+    QList< SARibbonCustomizeData > res;
+    for (int c = 0; c < categoryCount; ++c) {
+        const QString cname = QStringLiteral("customizeCategory%1").arg(c);
+        res.append(SARibbonCustomizeData::makeAddCategoryCustomizeData(QStringLiteral("Category %1").arg(c), c, cname));
+        for (int p = 0; p < 8; ++p) {
+            const QString pname = QStringLiteral("customizePannel%1").arg(p);
+            res.append(
+                SARibbonCustomizeData::makeAddPannelCustomizeData(QStringLiteral("Pannel %1").arg(p), p, cname, pname));
+            for (int a = 0; a < 12; ++a) {
+                SARibbonCustomizeData d(SARibbonCustomizeData::AddActionActionType);
+                d.keyValue                 = QStringLiteral("actionKey%1").arg((c * 7 + p * 12 + a) % 200);
+                d.categoryObjNameValue     = cname;
+                d.pannelObjNameValue       = pname;
+                d.actionRowProportionValue = (a % 3) ? SARibbonPannelItem::Small : SARibbonPannelItem::Large;
+                res.append(d);
+            }
+            res.append(SARibbonCustomizeData::makeChangePannelOrderCustomizeData(cname, pname, -1));
+        }
+        res.append(SARibbonCustomizeData::makeRenameCategoryCustomizeData(QStringLiteral("Renamed %1").arg(c), cname));
+    }
+    return res;
+}
+
+void BenchSARibbonCustomizeFormat::load_data()
+{
+    QTest::addColumn< bool >("isBinary");
+    QTest::addColumn< int >("categoryCount");
+    for (int c : { 10, 100 }) {
+        QTest::newRow(qPrintable(QStringLiteral("xml/%1").arg(c))) << false << c;
+        QTest::newRow(qPrintable(QStringLiteral("binary/%1").arg(c))) << true << c;
+    }
+}
+
+void BenchSARibbonCustomizeFormat::load()
+{
+    QFETCH(bool, isBinary);
+    QFETCH(int, categoryCount);
+    const QList< SARibbonCustomizeData > cds = sa_create_customize_datas(categoryCount);
+    QByteArray data;
+    {
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::WriteOnly));
+        if (isBinary) {
+            QVERIFY(sa_customize_datas_to_binary(&buffer, cds));
+        } else {
+            QXmlStreamWriter xml(&buffer);
+            xml.setAutoFormatting(true);
+            xml.writeStartDocument();
+            QVERIFY(sa_customize_datas_to_xml(&xml, cds));
+            xml.writeEndDocument();
+        }
+    }
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QCOMPARE(sa_customize_datas_from_device(&buffer, nullptr).size(), cds.size());
+    QBENCHMARK
+    {
+        buffer.seek(0);
+        const QList< SARibbonCustomizeData > res = sa_customize_datas_from_device(&buffer, nullptr);
+        Q_UNUSED(res);
+    }
+}
+
+QTEST_MAIN(BenchSARibbonCustomizeFormat)
+#include "bench_SARibbonCustomizeFormat.moc"
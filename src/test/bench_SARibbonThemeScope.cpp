@@ -0,0 +1,82 @@
+﻿#include <QtTest>
+#include <QGridLayout>
+#include <QLineEdit>
+#include <QPushButton>
+#include "SARibbonBar.h"
+#include "SARibbonMainWindow.h"
+#include "SARibbonPannel.h"
+
+/**
+ * @brief 对比qss主题的两种作用范围下切换主题的耗时
+ *
+ * @ref SARibbonMainWindow::RibbonThemeScopeWindow 会对整个窗口树重新polish，
+ * @ref SARibbonMainWindow::RibbonThemeScopeRibbonBar 只对ribbon相关的窗口重新polish，
+ * 中心窗口放置大量子窗口，模拟复杂的业务界面
+ */
+class BenchSARibbonThemeScope : public QObject
+{
+    Q_OBJECT
+private slots:
+    void switchTheme_data();
+    void switchTheme();
+};
+
+/**
+ * @brief 创建有count个子窗口的中心窗口
+ * @param count
+ * @return
+ */
+static QWidget* sa_create_heavy_central_widget(int count)
+{
+    QWidget* w         = new QWidget();
+    QGridLayout* lay   = new QGridLayout(w);
+    const int colCount = 20;
+    for (int i = 0; i < count; ++i) {
+        if (i % 2) {
+            lay->addWidget(new QLineEdit(w), i / colCount, i % colCount);
+        } else {
+            lay->addWidget(new QPushButton(QString::number(i), w), i / colCount, i % colCount);
+        }
+    }
+    return w;
+}
+
+void BenchSARibbonThemeScope::switchTheme_data()
+{
+    QTest::addColumn< int >("scope");
+    QTest::addColumn< int >("childCount");
+    for (int c : { 200, 2000 }) {
+        QTest::newRow(qPrintable(QStringLiteral("window/%1").arg(c)))
+            << int(SARibbonMainWindow::RibbonThemeScopeWindow) << c;
+        QTest::newRow(qPrintable(QStringLiteral("ribbonbar/%1").arg(c)))
+            << int(SARibbonMainWindow::RibbonThemeScopeRibbonBar) << c;
+    }
+}
+
+void BenchSARibbonThemeScope::switchTheme()
+{
+    QFETCH(int, scope);
+    QFETCH(int, childCount);
+    SARibbonMainWindow w;
+    w.setRibbonThemeScope(static_cast< SARibbonMainWindow::RibbonThemeScope >(scope));
+    w.setCentralWidget(sa_create_heavy_central_widget(childCount));
+    SARibbonCategory* category = w.ribbonBar()->addCategoryPage(QStringLiteral("Main"));
+    SARibbonPannel* pannel     = category->addPannel(QStringLiteral("Pannel"));
+    for (int i = 0; i < 20; ++i) {
+        pannel->addSmallAction(new QAction(QStringLiteral("action %1").arg(i), &w));
+    }
+    w.resize(1200, 800);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    // 两个主题交替设置，保证每次都会真正重新polish
+    bool isDark = false;
+    QBENCHMARK
+    {
+        isDark = !isDark;
+        w.setRibbonTheme(isDark ? SARibbonMainWindow::RibbonThemeDark : SARibbonMainWindow::RibbonThemeOffice2013);
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(BenchSARibbonThemeScope)
+#include "bench_SARibbonThemeScope.moc"
@@ -0,0 +1,245 @@
+﻿#include <QtTest>
+#include <random>
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonContextCategory.h"
+#include "SARibbonPannel.h"
+
+/**
+ * @brief SARibbonBar和SARibbonCategoryLayout名字索引的测试
+ *
+ * 随机插入、移除、移动、改名、修改objectName以及显示隐藏，每一步之后，
+ * 增量更新的索引查找结果必须和按当前顺序线性查找的结果一致（重名时取第一个）
+ */
+class TstSARibbonBarIndex : public QObject
+{
+    Q_OBJECT
+private slots:
+    void categoryIndexMatchesRebuild_data();
+    void categoryIndexMatchesRebuild();
+    void pannelIndexMatchesRebuild_data();
+    void pannelIndexMatchesRebuild();
+};
+
+/**
+ * @brief 测试用的名字，个数较少，保证经常出现重名
+ */
+static QString sa_random_key(const QString& prefix, std::mt19937& rnd)
+{
+    return prefix + QString::number(rnd() % 4);
+}
+
+/**
+ * @brief 按顺序线性查找第一个名字为key的category
+ */
+static SARibbonCategory* sa_first_category(const QList< SARibbonCategory* >& cs, const QString& key, bool isObjectName)
+{
+    for (SARibbonCategory* c : cs) {
+        if ((isObjectName ? c->objectName() : c->categoryName()) == key) {
+            return (c);
+        }
+    }
+    return (nullptr);
+}
+
+/**
+ * @brief 按顺序线性查找第一个名字为key的pannel
+ */
+static SARibbonPannel* sa_first_pannel(const QList< SARibbonPannel* >& ps, const QString& key, bool isObjectName)
+{
+    for (SARibbonPannel* p : ps) {
+        if ((isObjectName ? p->objectName() : p->pannelName()) == key) {
+            return (p);
+        }
+    }
+    return (nullptr);
+}
+
+/**
+ * @brief 检查ribbonbar的category索引，不一致时返回描述，一致返回空字符串
+ */
+static QString sa_check_category_index(SARibbonBar& bar)
+{
+    const QList< SARibbonCategory* > cs = bar.categoryPages(true);
+    for (int i = 0; i < 4; ++i) {
+        const QString name = QStringLiteral("n%1").arg(i);
+        if (bar.categoryByName(name) != sa_first_category(cs, name, false)) {
+            return QStringLiteral("categoryByName(%1)").arg(name);
+        }
+        const QString objname = QStringLiteral("o%1").arg(i);
+        if (bar.categoryByObjectName(objname) != sa_first_category(cs, objname, true)) {
+            return QStringLiteral("categoryByObjectName(%1)").arg(objname);
+        }
+    }
+    // tab索引和逐个tab查找的结果一致，隐藏的category和未显示的上下文标签返回-1
+    const int tabCount = bar.ribbonTabBar()->count();
+    for (SARibbonCategory* c : cs) {
+        int expected = -1;
+        for (int i = 0; i < tabCount; ++i) {
+            if (bar.categoryByIndex(i) == c) {
+                expected = i;
+                break;
+            }
+        }
+        if (bar.categoryIndex(c) != expected) {
+            return QStringLiteral("categoryIndex(%1)").arg(c->categoryName());
+        }
+    }
+    return QString();
+}
+
+/**
+ * @brief 检查category的pannel索引，不一致时返回描述，一致返回空字符串
+ */
+static QString sa_check_pannel_index(SARibbonCategory* category)
+{
+    const QList< SARibbonPannel* > ps = category->pannelList();
+    for (int i = 0; i < 4; ++i) {
+        const QString name = QStringLiteral("n%1").arg(i);
+        if (category->pannelByName(name) != sa_first_pannel(ps, name, false)) {
+            return QStringLiteral("pannelByName(%1)").arg(name);
+        }
+        const QString objname = QStringLiteral("o%1").arg(i);
+        if (category->pannelByObjectName(objname) != sa_first_pannel(ps, objname, true)) {
+            return QStringLiteral("pannelByObjectName(%1)").arg(objname);
+        }
+    }
+    for (int i = 0; i < ps.size(); ++i) {
+        if (category->pannelIndex(ps[ i ]) != i) {
+            return QStringLiteral("pannelIndex(%1)").arg(i);
+        }
+    }
+    return QString();
+}
+
+void TstSARibbonBarIndex::categoryIndexMatchesRebuild_data()
+{
+    QTest::addColumn< int >("seed");
+    for (int seed = 0; seed < 200; ++seed) {
+        QTest::newRow(qPrintable(QStringLiteral("seed %1").arg(seed))) << seed;
+    }
+}
+
+void TstSARibbonBarIndex::categoryIndexMatchesRebuild()
+{
+    QFETCH(int, seed);
+    std::mt19937 rnd(static_cast< unsigned >(seed));
+    auto pick = [ &rnd ](int n) { return int(rnd() % unsigned(qMax(1, n))); };
+    SARibbonBar bar;
+    QList< SARibbonContextCategory* > contexts;
+    QList< SARibbonCategory* > hided;
+    for (int step = 0; step < 60; ++step) {
+        const QList< SARibbonCategory* > cs = bar.categoryPages(true);
+        const int tabCount                  = bar.ribbonTabBar()->count();
+        SARibbonCategory* c                 = cs.isEmpty() ? nullptr : cs[ pick(cs.size()) ];
+        switch (pick(8)) {
+        case 0:
+            bar.insertCategoryPage(sa_random_key(QStringLiteral("n"), rnd), pick(tabCount + 1))
+                ->setObjectName(sa_random_key(QStringLiteral("o"), rnd));
+            break;
+        case 1:
+            // 隐藏的category移除后仍记录在隐藏列表中，只移除未隐藏的
+            if (c && !hided.contains(c)) {
+                bar.removeCategory(c);
+                delete c;
+            }
+            break;
+        case 2:
+            if (tabCount > 1) {
+                bar.moveCategory(pick(tabCount), pick(tabCount));
+            }
+            break;
+        case 3:
+            if (c) {
+                c->setCategoryName(sa_random_key(QStringLiteral("n"), rnd));
+            }
+            break;
+        case 4:
+            if (c) {
+                c->setObjectName(sa_random_key(QStringLiteral("o"), rnd));
+            }
+            break;
+        case 5:
+            // 只隐藏显示普通的category，上下文标签通过上下文显示隐藏
+            if (!hided.isEmpty() && (pick(2) == 0)) {
+                bar.showCategory(hided.takeAt(pick(hided.size())));
+            } else if (c && !c->isContextCategory() && !hided.contains(c)) {
+                bar.hideCategory(c);
+                hided.append(c);
+            }
+            break;
+        case 6: {
+            SARibbonContextCategory* context = bar.addContextCategory(QStringLiteral("context"));
+            for (int i = 0, n = 1 + pick(2); i < n; ++i) {
+                context->addCategoryPage(sa_random_key(QStringLiteral("n"), rnd))
+                    ->setObjectName(sa_random_key(QStringLiteral("o"), rnd));
+            }
+            contexts.append(context);
+        } break;
+        default:
+            if (!contexts.isEmpty()) {
+                SARibbonContextCategory* context = contexts[ pick(contexts.size()) ];
+                if (pick(2) == 0) {
+                    bar.showContextCategory(context);
+                } else {
+                    bar.hideContextCategory(context);
+                }
+            }
+            break;
+        }
+        const QString err = sa_check_category_index(bar);
+        QVERIFY2(err.isEmpty(), qPrintable(QStringLiteral("step %1: %2").arg(step).arg(err)));
+    }
+}
+
+void TstSARibbonBarIndex::pannelIndexMatchesRebuild_data()
+{
+    QTest::addColumn< int >("seed");
+    for (int seed = 0; seed < 200; ++seed) {
+        QTest::newRow(qPrintable(QStringLiteral("seed %1").arg(seed))) << seed;
+    }
+}
+
+void TstSARibbonBarIndex::pannelIndexMatchesRebuild()
+{
+    QFETCH(int, seed);
+    std::mt19937 rnd(static_cast< unsigned >(seed));
+    auto pick = [ &rnd ](int n) { return int(rnd() % unsigned(qMax(1, n))); };
+    SARibbonBar bar;
+    SARibbonCategory* category = bar.addCategoryPage(QStringLiteral("Main"));
+    for (int step = 0; step < 60; ++step) {
+        const QList< SARibbonPannel* > ps = category->pannelList();
+        SARibbonPannel* p                 = ps.isEmpty() ? nullptr : ps[ pick(ps.size()) ];
+        switch (pick(5)) {
+        case 0:
+            category->insertPannel(sa_random_key(QStringLiteral("n"), rnd), pick(ps.size() + 1))
+                ->setObjectName(sa_random_key(QStringLiteral("o"), rnd));
+            break;
+        case 1:
+            if (p) {
+                category->removePannel(p);
+            }
+            break;
+        case 2:
+            if (ps.size() > 1) {
+                category->movePannel(pick(ps.size()), pick(ps.size()));
+            }
+            break;
+        case 3:
+            if (p) {
+                p->setPannelName(sa_random_key(QStringLiteral("n"), rnd));
+            }
+            break;
+        default:
+            if (p) {
+                p->setObjectName(sa_random_key(QStringLiteral("o"), rnd));
+            }
+            break;
+        }
+        const QString err = sa_check_pannel_index(category);
+        QVERIFY2(err.isEmpty(), qPrintable(QStringLiteral("step %1: %2").arg(step).arg(err)));
+    }
+}
+
+QTEST_MAIN(TstSARibbonBarIndex)
+#include "tst_SARibbonBarIndex.moc"
@@ -0,0 +1,118 @@
+﻿#include <QtTest>
+#include <QAbstractItemModel>
+#include <QAction>
+#include <QCompleter>
+#include "SARibbonActionsManager.h"
+#include "SARibbonBar.h"
+#include "SARibbonCommandSearchWidget.h"
+
+/**
+ * @brief SARibbonCommandSearchWidget的测试
+ *
+ * 查找在工作线程中进行，结果通过事件循环返回，因此用QTRY_系列宏等待结果；
+ * 结果列表通过内部QCompleter的model获取
+ */
+class TstSARibbonCommandSearchWidget : public QObject
+{
+    Q_OBJECT
+private slots:
+    void searchResults();
+    void staleResultsAreDropped();
+    void snapshotFollowsActions();
+};
+
+/**
+ * @brief 测试用的ribbonbar、actionsManager和搜索框，除了几个有意义的命令外还有大量的填充命令
+ */
+struct SACommandSearchTestEnv
+{
+    SARibbonBar bar;
+    SARibbonActionsManager* mgr { nullptr };
+    SARibbonCommandSearchWidget* search { nullptr };
+    QAbstractItemModel* results { nullptr };
+    SACommandSearchTestEnv()
+    {
+        mgr = new SARibbonActionsManager(&bar);
+        add(QStringLiteral("&Open File"), QStringLiteral("open"));
+        add(QStringLiteral("&Save File"), QStringLiteral("save"));
+        add(QStringLiteral("&Close"), QStringLiteral("close"));
+        add(QStringLiteral("&Print Preview"), QStringLiteral("print"));
+        for (int i = 0; i < 5000; ++i) {
+            add(QStringLiteral("Filler command %1").arg(i), QStringLiteral("filler%1").arg(i));
+        }
+        search = new SARibbonCommandSearchWidget(mgr, &bar);
+        search->setMaximumResultCount(20);
+        results = search->findChild< QCompleter* >()->model();
+    }
+    QAction* add(const QString& text, const QString& key)
+    {
+        QAction* a = new QAction(text, &bar);
+        mgr->registeAction(a, SARibbonActionsManager::UserDefineActionTag, key);
+        return a;
+    }
+    QString resultText(int row) const
+    {
+        return results->index(row, 0).data().toString();
+    }
+};
+
+void TstSARibbonCommandSearchWidget::searchResults()
+{
+    SACommandSearchTestEnv env;
+    env.search->setText(QStringLiteral("open"));
+    QTRY_VERIFY(env.results->rowCount() > 0);
+    QCOMPARE(env.resultText(0), QStringLiteral("Open File"));
+    // 多个关键词，每个关键词都要匹配
+    env.search->setText(QStringLiteral("sav fil"));
+    QTRY_COMPARE(env.resultText(0), QStringLiteral("Save File"));
+    // 没有匹配
+    env.search->setText(QStringLiteral("zzzz"));
+    QTRY_COMPARE(env.results->rowCount(), 0);
+}
+
+void TstSARibbonCommandSearchWidget::staleResultsAreDropped()
+{
+    SACommandSearchTestEnv env;
+    // 记录显示过的所有结果
+    QStringList shown;
+    connect(env.results,
+            &QAbstractItemModel::rowsInserted,
+            this,
+            [ &env, &shown ](const QModelIndex&, int first, int last) {
+                for (int r = first; r <= last; ++r) {
+                    shown.append(env.resultText(r));
+                }
+            });
+    // 第一个查询匹配所有填充命令，在事件循环之前被第二个查询取代，它的结果（包括中间结果）都不能显示
+    env.search->setText(QStringLiteral("f"));
+    env.search->setText(QStringLiteral("print"));
+    QTRY_VERIFY(!shown.isEmpty());
+    QTest::qWait(200);
+    for (const QString& s : qAsConst(shown)) {
+        QVERIFY2(s.contains(QStringLiteral("Print")), qPrintable(s));
+    }
+}
+
+void TstSARibbonCommandSearchWidget::snapshotFollowsActions()
+{
+    SACommandSearchTestEnv env;
+    // 向已有标签注册action没有信号，下一次开始查找时同步
+    env.add(QStringLiteral("Open Recent"), QStringLiteral("recent"));
+    env.search->setText(QStringLiteral("open recent"));
+    QTRY_COMPARE(env.resultText(0), QStringLiteral("Open Recent"));
+    // 文本变化只更新对应的条目，并用新快照重新查询
+    QAction* close = env.mgr->action(QStringLiteral("close"));
+    QVERIFY(close);
+    env.search->setText(QStringLiteral("shutdown"));
+    QTRY_COMPARE(env.results->rowCount(), 0);
+    close->setText(QStringLiteral("Shutdown"));
+    QTRY_COMPARE(env.resultText(0), QStringLiteral("Shutdown"));
+    // 移除的action不再出现在结果中
+    env.mgr->unregisteAction(close);
+    env.search->clear();
+    env.search->setText(QStringLiteral("shutdown"));
+    QTRY_COMPARE(env.results->rowCount(), 0);
+}
+
+QTEST_MAIN(TstSARibbonCommandSearchWidget)
+#include "tst_SARibbonCommandSearchWidget.moc"
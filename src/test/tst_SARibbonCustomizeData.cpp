@@ -0,0 +1,374 @@
+﻿#include <QtTest>
+#include <QAction>
+#include <algorithm>
+#include <random>
+#include "SARibbonActionsManager.h"
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonCustomizeData.h"
+#include "SARibbonPannel.h"
+
+/**
+ * @brief SARibbonCustomizeData::simplify的测试
+ *
+ * 随机生成一系列合法的自定义操作（和自定义界面生成的操作一样，只针对当前存在的对象），
+ * 分别应用原始操作和简化后的操作，最终得到的category/pannel/action树必须一致，
+ * 通过SARibbonCustomizeDataApplier批量应用的结果也必须一致
+ */
+class TstSARibbonCustomizeData : public QObject
+{
+    Q_OBJECT
+private slots:
+    void simplifyKeepsResult_data();
+    void simplifyKeepsResult();
+    void simplifyCancelsAddRemove();
+    void simplifyKeepsShowBeforeHide();
+};
+
+/**
+ * @brief 测试用的ribbonbar，每个ribbonbar有自己的actionsManager和action，action的key相同
+ */
+struct SARibbonCustomizeTestBar
+{
+    SARibbonBar bar;
+    SARibbonActionsManager* mgr { nullptr };
+    SARibbonCustomizeTestBar()
+    {
+        mgr = new SARibbonActionsManager(&bar);
+        for (int i = 0; i < 8; ++i) {
+            QAction* a = new QAction(QStringLiteral("action %1").arg(i), &bar);
+            mgr->registeAction(a, SARibbonActionsManager::UserDefineActionTag, QStringLiteral("a%1").arg(i));
+        }
+    }
+    // 应用操作，操作中的actionsManager替换为此ribbonbar的
+    void apply(const QList< SARibbonCustomizeData >& cds)
+    {
+        for (SARibbonCustomizeData d : cds) {
+            if (d.actionManager()) {
+                d.setActionsManager(mgr);
+            }
+            d.apply(&bar);
+        }
+    }
+    // 通过SARibbonCustomizeDataApplier批量应用，返回应用失败的个数
+    int applyBatch(QList< SARibbonCustomizeData > cds)
+    {
+        for (SARibbonCustomizeData& d : cds) {
+            if (d.actionManager()) {
+                d.setActionsManager(mgr);
+            }
+        }
+        SARibbonCustomizeDataApplier applier(&bar);
+        applier.apply(cds);
+        return applier.failedIndexes().size();
+    }
+};
+
+/**
+ * @brief 显示的category，按tab的顺序
+ */
+static QList< SARibbonCategory* > sa_tab_categories(const SARibbonBar* bar)
+{
+    QList< SARibbonCategory* > res;
+    const QList< SARibbonCategory* > cs = bar->categoryPages();
+    for (SARibbonCategory* c : cs) {
+        if (bar->categoryIndex(c) >= 0) {
+            res.append(c);
+        }
+    }
+    std::sort(res.begin(), res.end(), [ bar ](SARibbonCategory* a, SARibbonCategory* b) {
+        return bar->categoryIndex(a) < bar->categoryIndex(b);
+    });
+    return res;
+}
+
+/**
+ * @brief pannel中的action，按布局的顺序
+ */
+static QList< QAction* > sa_pannel_actions(const SARibbonPannel* p)
+{
+    QList< QAction* > res = p->actions();
+    std::sort(res.begin(), res.end(), [ p ](QAction* a, QAction* b) { return p->actionIndex(a) < p->actionIndex(b); });
+    return res;
+}
+
+/**
+ * @brief 把ribbonbar的结构转换为文本，用于比较
+ *
+ * tab的顺序和category的内容分开记录，隐藏的category只记录内容
+ */
+static QStringList sa_ribbon_tree(SARibbonCustomizeTestBar& tb)
+{
+    QStringList tabs;
+    const QList< SARibbonCategory* > tabCategories = sa_tab_categories(&tb.bar);
+    for (SARibbonCategory* c : tabCategories) {
+        tabs.append(c->objectName());
+    }
+    QStringList res;
+    res.append(QStringLiteral("tabs: ") + tabs.join(QLatin1Char(',')));
+    QList< SARibbonCategory* > cs = tb.bar.categoryPages();
+    std::sort(cs.begin(), cs.end(), [](SARibbonCategory* a, SARibbonCategory* b) {
+        return a->objectName() < b->objectName();
+    });
+    for (SARibbonCategory* c : qAsConst(cs)) {
+        res.append(QStringLiteral("category %1 \"%2\"").arg(c->objectName(), c->categoryName()));
+        const QList< SARibbonPannel* > ps = c->pannelList();
+        for (SARibbonPannel* p : ps) {
+            QStringList keys;
+            const QList< QAction* > acts = sa_pannel_actions(p);
+            for (QAction* a : acts) {
+                keys.append(tb.mgr->key(a));
+            }
+            res.append(QStringLiteral("  pannel %1 \"%2\": %3")
+                           .arg(p->objectName(), p->pannelName(), keys.join(QLatin1Char(','))));
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief 初始结构：3个category，每个category有2个pannel，每个pannel有3个action
+ */
+static QList< SARibbonCustomizeData > sa_initial_data(SARibbonActionsManager* mgr)
+{
+    QList< SARibbonCustomizeData > res;
+    for (int c = 0; c < 3; ++c) {
+        const QString cname = QStringLiteral("c%1").arg(c);
+        res.append(SARibbonCustomizeData::makeAddCategoryCustomizeData(QStringLiteral("C%1").arg(c), -1, cname));
+        for (int p = 0; p < 2; ++p) {
+            const QString pname = QStringLiteral("p%1").arg(p);
+            res.append(
+                SARibbonCustomizeData::makeAddPannelCustomizeData(QStringLiteral("P%1").arg(p), p, cname, pname));
+            for (int a = 0; a < 3; ++a) {
+                res.append(SARibbonCustomizeData::makeAddActionCustomizeData(
+                    QStringLiteral("a%1").arg(a), mgr, SARibbonPannelItem::Large, cname, pname));
+            }
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief 基于ribbonbar当前的结构随机生成一个合法的操作并应用，生成失败返回无效的操作
+ *
+ * category的objectName在c0~c4，pannel的objectName在p0~p3中选取，删除后的名字可以再次使用
+ */
+static SARibbonCustomizeData sa_random_data(SARibbonCustomizeTestBar& tb, std::mt19937& rnd)
+{
+    auto pick                               = [ &rnd ](int n) { return int(rnd() % unsigned(qMax(1, n))); };
+    SARibbonBar* bar                        = &tb.bar;
+    const QList< SARibbonCategory* > living = bar->categoryPages();
+    const QList< SARibbonCategory* > tabs   = sa_tab_categories(bar);
+    const int type                          = 1 + pick(12);
+    SARibbonCustomizeData d;
+    if (SARibbonCustomizeData::AddCategoryActionType == type) {
+        QStringList free;
+        for (int i = 0; i < 5; ++i) {
+            if (!bar->categoryByObjectName(QStringLiteral("c%1").arg(i))) {
+                free.append(QStringLiteral("c%1").arg(i));
+            }
+        }
+        if (free.isEmpty()) {
+            return d;
+        }
+        d = SARibbonCustomizeData::makeAddCategoryCustomizeData(
+            QStringLiteral("T%1").arg(pick(100)), pick(tabs.size() + 1), free.at(pick(free.size())));
+        d.apply(bar);
+        return d;
+    }
+    if (living.isEmpty()) {
+        return d;
+    }
+    SARibbonCategory* c = living.at(pick(living.size()));
+    const QString cname = c->objectName();
+    switch (type) {
+    case SARibbonCustomizeData::AddPannelActionType: {
+        QStringList free;
+        for (int i = 0; i < 4; ++i) {
+            if (!c->pannelByObjectName(QStringLiteral("p%1").arg(i))) {
+                free.append(QStringLiteral("p%1").arg(i));
+            }
+        }
+        if (free.isEmpty()) {
+            return d;
+        }
+        d = SARibbonCustomizeData::makeAddPannelCustomizeData(
+            QStringLiteral("T%1").arg(pick(100)), pick(c->pannelCount() + 1), cname, free.at(pick(free.size())));
+    } break;
+    case SARibbonCustomizeData::RemoveCategoryActionType:
+        d = SARibbonCustomizeData::makeRemoveCategoryCustomizeData(cname);
+        break;
+    case SARibbonCustomizeData::ChangeCategoryOrderActionType: {
+        const int from = tabs.indexOf(c);
+        const int to   = pick(tabs.size());
+        if (from < 0 || from == to) {
+            return d;
+        }
+        d = SARibbonCustomizeData::makeChangeCategoryOrderCustomizeData(cname, to - from);
+    } break;
+    case SARibbonCustomizeData::RenameCategoryActionType:
+        d = SARibbonCustomizeData::makeRenameCategoryCustomizeData(QStringLiteral("N%1").arg(pick(100)), cname);
+        break;
+    case SARibbonCustomizeData::VisibleCategoryActionType:
+        d = SARibbonCustomizeData::makeVisibleCategoryCustomizeData(cname, pick(2) == 1);
+        break;
+    default: {
+        const QList< SARibbonPannel* > ps = c->pannelList();
+        if (ps.isEmpty()) {
+            return d;
+        }
+        SARibbonPannel* p   = ps.at(pick(ps.size()));
+        const QString pname = p->objectName();
+        const QList< QAction* > acts = sa_pannel_actions(p);
+        switch (type) {
+        case SARibbonCustomizeData::RemovePannelActionType:
+            d = SARibbonCustomizeData::makeRemovePannelCustomizeData(cname, pname);
+            break;
+        case SARibbonCustomizeData::ChangePannelOrderActionType: {
+            const int from = ps.indexOf(p);
+            const int to   = pick(ps.size());
+            if (from == to) {
+                return d;
+            }
+            d = SARibbonCustomizeData::makeChangePannelOrderCustomizeData(cname, pname, to - from);
+        } break;
+        case SARibbonCustomizeData::RenamePannelActionType:
+            d = SARibbonCustomizeData::makeRenamePannelCustomizeData(
+                QStringLiteral("N%1").arg(pick(100)), cname, pname);
+            break;
+        case SARibbonCustomizeData::AddActionActionType: {
+            QStringList free;
+            for (int i = 0; i < 8; ++i) {
+                if (!acts.contains(tb.mgr->action(QStringLiteral("a%1").arg(i)))) {
+                    free.append(QStringLiteral("a%1").arg(i));
+                }
+            }
+            if (free.isEmpty()) {
+                return d;
+            }
+            d = SARibbonCustomizeData::makeAddActionCustomizeData(
+                free.at(pick(free.size())), tb.mgr, SARibbonPannelItem::Large, cname, pname);
+        } break;
+        case SARibbonCustomizeData::RemoveActionActionType:
+        case SARibbonCustomizeData::ChangeActionOrderActionType: {
+            if (acts.isEmpty()) {
+                return d;
+            }
+            const int from    = pick(acts.size());
+            const QString key = tb.mgr->key(acts.at(from));
+            if (SARibbonCustomizeData::RemoveActionActionType == type) {
+                d = SARibbonCustomizeData::makeRemoveActionCustomizeData(cname, pname, key, tb.mgr);
+                break;
+            }
+            const int to = pick(acts.size());
+            if (from == to) {
+                return d;
+            }
+            d = SARibbonCustomizeData::makeChangeActionOrderCustomizeData(cname, pname, key, tb.mgr, to - from);
+        } break;
+        default:
+            break;
+        }
+    } break;
+    }
+    if (d.isValid()) {
+        d.apply(bar);
+    }
+    return d;
+}
+
+void TstSARibbonCustomizeData::simplifyKeepsResult_data()
+{
+    QTest::addColumn< int >("seed");
+    for (int seed = 0; seed < 300; ++seed) {
+        QTest::newRow(qPrintable(QStringLiteral("seed %1").arg(seed))) << seed;
+    }
+}
+
+void TstSARibbonCustomizeData::simplifyKeepsResult()
+{
+    QFETCH(int, seed);
+    std::mt19937 rnd(static_cast< unsigned >(seed));
+    // 生成操作的同时应用到origin上
+    SARibbonCustomizeTestBar origin;
+    origin.apply(sa_initial_data(origin.mgr));
+    const int count = 2 + int(rnd() % 40);
+    QList< SARibbonCustomizeData > cds;
+    for (int tryCount = 0; cds.size() < count && tryCount < count * 50; ++tryCount) {
+        const SARibbonCustomizeData d = sa_random_data(origin, rnd);
+        if (d.isValid()) {
+            cds.append(d);
+        }
+    }
+    const QList< SARibbonCustomizeData > simplified = SARibbonCustomizeData::simplify(cds);
+    QVERIFY(simplified.size() <= cds.size());
+
+    SARibbonCustomizeTestBar replay;
+    replay.apply(sa_initial_data(replay.mgr));
+    replay.apply(cds);
+    SARibbonCustomizeTestBar simplifiedReplay;
+    simplifiedReplay.apply(sa_initial_data(simplifiedReplay.mgr));
+    simplifiedReplay.apply(simplified);
+    SARibbonCustomizeTestBar batchReplay;
+    batchReplay.apply(sa_initial_data(batchReplay.mgr));
+    QCOMPARE(batchReplay.applyBatch(cds), 0);
+
+    const QStringList expected = sa_ribbon_tree(origin);
+    QCOMPARE(sa_ribbon_tree(replay), expected);
+    QCOMPARE(sa_ribbon_tree(simplifiedReplay), expected);
+    QCOMPARE(sa_ribbon_tree(batchReplay), expected);
+}
+
+/**
+ * @brief 不相邻的添加和删除操作会被抵消，中间对此pannel的操作一并移除
+ */
+void TstSARibbonCustomizeData::simplifyCancelsAddRemove()
+{
+    SARibbonCustomizeTestBar tb;
+    QList< SARibbonCustomizeData > cds;
+    cds.append(SARibbonCustomizeData::makeAddCategoryCustomizeData(QStringLiteral("C0"), -1, QStringLiteral("c0")));
+    cds.append(SARibbonCustomizeData::makeAddPannelCustomizeData(
+        QStringLiteral("P0"), 0, QStringLiteral("c0"), QStringLiteral("p0")));
+    cds.append(SARibbonCustomizeData::makeAddActionCustomizeData(
+        QStringLiteral("a0"), tb.mgr, SARibbonPannelItem::Large, QStringLiteral("c0"), QStringLiteral("p0")));
+    cds.append(SARibbonCustomizeData::makeRenamePannelCustomizeData(
+        QStringLiteral("P1"), QStringLiteral("c0"), QStringLiteral("p0")));
+    cds.append(SARibbonCustomizeData::makeRenameCategoryCustomizeData(QStringLiteral("C1"), QStringLiteral("c0")));
+    cds.append(SARibbonCustomizeData::makeRemovePannelCustomizeData(QStringLiteral("c0"), QStringLiteral("p0")));
+    const QList< SARibbonCustomizeData > simplified = SARibbonCustomizeData::simplify(cds);
+    QCOMPARE(simplified.size(), 2);
+    QCOMPARE(simplified.at(0).actionType(), SARibbonCustomizeData::AddCategoryActionType);
+    QCOMPARE(simplified.at(1).actionType(), SARibbonCustomizeData::RenameCategoryActionType);
+}
+
+/**
+ * @brief 显示后紧接着隐藏时，显示操作不能移除
+ *
+ * 显示时记录的位置超出范围会被修正，之后隐藏记录的是修正后的位置，
+ * 如果移除显示操作，再次显示时会回到修正前的位置，随机测试很难覆盖这种情况
+ */
+void TstSARibbonCustomizeData::simplifyKeepsShowBeforeHide()
+{
+    const QString c1 = QStringLiteral("c1");
+    const QString c2 = QStringLiteral("c2");
+    QList< SARibbonCustomizeData > cds;
+    cds.append(SARibbonCustomizeData::makeVisibleCategoryCustomizeData(c2, false));
+    cds.append(SARibbonCustomizeData::makeRemoveCategoryCustomizeData(c1));
+    cds.append(SARibbonCustomizeData::makeVisibleCategoryCustomizeData(c2, true));
+    cds.append(SARibbonCustomizeData::makeVisibleCategoryCustomizeData(c2, false));
+    cds.append(SARibbonCustomizeData::makeAddCategoryCustomizeData(QStringLiteral("C3"), -1, QStringLiteral("c3")));
+    cds.append(SARibbonCustomizeData::makeVisibleCategoryCustomizeData(c2, true));
+    const QList< SARibbonCustomizeData > simplified = SARibbonCustomizeData::simplify(cds);
+
+    SARibbonCustomizeTestBar replay;
+    replay.apply(sa_initial_data(replay.mgr));
+    replay.apply(cds);
+    SARibbonCustomizeTestBar simplifiedReplay;
+    simplifiedReplay.apply(sa_initial_data(simplifiedReplay.mgr));
+    simplifiedReplay.apply(simplified);
+    QCOMPARE(sa_ribbon_tree(simplifiedReplay), sa_ribbon_tree(replay));
+    QCOMPARE(sa_ribbon_tree(replay).first(), QStringLiteral("tabs: c0,c2,c3"));
+}
+
+QTEST_MAIN(TstSARibbonCustomizeData)
+#include "tst_SARibbonCustomizeData.moc"
@@ -0,0 +1,119 @@
+﻿#include <QtTest>
+#include <QAction>
+#include <QSignalSpy>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+#include <QAbstractItemModelTester>
+#endif
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonCustomizeData.h"
+#include "SARibbonCustomizeWidget.h"
+#include "SARibbonPannel.h"
+
+/**
+ * @brief SARibbonCustomizeTreeModel延迟加载的测试
+ *
+ * pannel和action节点在fetchMore时才加载，加载前rowCount为0，加载时必须发出插入信号，
+ * 通过applyCustomizeData间接加载的节点同样要发出插入信号
+ *
+ * QAbstractItemModelTester在每次reset和插入后会递归fetchMore所有节点，因此单独测试
+ */
+class TstSARibbonCustomizeTreeModel : public QObject
+{
+    Q_OBJECT
+private slots:
+    void fetchMoreLoadsChildren();
+    void applyLoadsChildrenWithSignals();
+    void modelTesterPasses();
+};
+
+/**
+ * @brief 2个category，每个category有2个pannel，每个pannel有3个action
+ */
+static void sa_init_ribbon(SARibbonBar* bar)
+{
+    for (int c = 0; c < 2; ++c) {
+        SARibbonCategory* category = bar->addCategoryPage(QStringLiteral("C%1").arg(c));
+        category->setObjectName(QStringLiteral("c%1").arg(c));
+        for (int p = 0; p < 2; ++p) {
+            SARibbonPannel* pannel = category->addPannel(QStringLiteral("P%1").arg(p));
+            pannel->setObjectName(QStringLiteral("p%1").arg(p));
+            for (int a = 0; a < 3; ++a) {
+                pannel->addLargeAction(new QAction(QStringLiteral("action %1").arg(a), bar));
+            }
+        }
+    }
+}
+
+void TstSARibbonCustomizeTreeModel::fetchMoreLoadsChildren()
+{
+    SARibbonBar bar;
+    sa_init_ribbon(&bar);
+    SARibbonCustomizeTreeModel model;
+    model.setRibbonBar(&bar);
+    model.reload();
+    QCOMPARE(model.rowCount(), 2);
+
+    const QModelIndex category = model.index(0, 0);
+    QVERIFY(model.hasChildren(category));
+    QCOMPARE(model.rowCount(category), 0);
+    QVERIFY(model.canFetchMore(category));
+
+    QSignalSpy spy(&model, &QAbstractItemModel::rowsInserted);
+    model.fetchMore(category);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(model.rowCount(category), 2);
+    QVERIFY(!model.canFetchMore(category));
+
+    const QModelIndex pannel = model.index(1, 0, category);
+    QCOMPARE(model.rowCount(pannel), 0);
+    QVERIFY(model.canFetchMore(pannel));
+    model.fetchMore(pannel);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(model.rowCount(pannel), 3);
+    QCOMPARE(model.indexLevel(model.index(2, 0, pannel)), 2);
+}
+
+void TstSARibbonCustomizeTreeModel::applyLoadsChildrenWithSignals()
+{
+    SARibbonBar bar;
+    sa_init_ribbon(&bar);
+    SARibbonCustomizeTreeModel model;
+    model.setRibbonBar(&bar);
+    model.reload();
+    const QModelIndex category = model.index(1, 0);
+    QCOMPARE(model.rowCount(category), 0);
+
+    // 向未加载的category添加pannel，先加载原有的2个pannel，再插入新的pannel
+    QSignalSpy spy(&model, &QAbstractItemModel::rowsInserted);
+    const QModelIndex added = model.applyCustomizeData(SARibbonCustomizeData::makeAddPannelCustomizeData(
+        QStringLiteral("new"), 1, QStringLiteral("c1"), QStringLiteral("pnew")));
+    QVERIFY(added.isValid());
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(model.rowCount(category), 3);
+    QCOMPARE(added.row(), 1);
+    QCOMPARE(model.indexObjectName(model.index(2, 0, category)), QStringLiteral("p1"));
+}
+
+void TstSARibbonCustomizeTreeModel::modelTesterPasses()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    SARibbonBar bar;
+    sa_init_ribbon(&bar);
+    SARibbonCustomizeTreeModel model;
+    model.setRibbonBar(&bar);
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.reload();
+    model.applyCustomizeData(SARibbonCustomizeData::makeAddPannelCustomizeData(
+        QStringLiteral("new"), 0, QStringLiteral("c0"), QStringLiteral("pnew")));
+    model.applyCustomizeData(
+        SARibbonCustomizeData::makeRemovePannelCustomizeData(QStringLiteral("c1"), QStringLiteral("p0")));
+    model.revertLastCustomizeData();
+    QCOMPARE(model.rowCount(model.index(0, 0)), 3);
+#else
+    QSKIP("QAbstractItemModelTester requires Qt 5.11");
+#endif
+}
+
+QTEST_MAIN(TstSARibbonCustomizeTreeModel)
+#include "tst_SARibbonCustomizeTreeModel.moc"
@@ -0,0 +1,380 @@
+﻿#include <QtTest>
+#include <QAction>
+#include <QFile>
+#include <QHash>
+#include <QLineEdit>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QStyleFactory>
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonMainWindow.h"
+#include "SARibbonPannel.h"
+#include "SARibbonTheme.h"
+
+/**
+ * @brief SARibbonThemeStyle（原生绘制主题）的测试
+ *
+ * 主题style只能设置在ribbon相关的窗口上，不能改变应用程序的style，
+ * 切换回qss主题后，ribbon窗口要恢复为应用程序的style，且不遗留任何style对象；
+ * SARibbonThemeData中的颜色是从theme-*.qss中抄过来的，要和qss保持一致
+ */
+class TstSARibbonThemeStyle : public QObject
+{
+    Q_OBJECT
+private slots:
+    void styleIsScopedToRibbon();
+    void laterChildrenUseThemeStyle();
+    void switchBackToQss();
+    void switchThemeUpdatesData();
+    void userStyleIsKept();
+    void themeDataMatchesQss_data();
+    void themeDataMatchesQss();
+};
+
+/**
+ * @brief qss的规则，选择器->（属性->值）
+ */
+typedef QHash< QString, QHash< QString, QString > > SAQssRules;
+
+/**
+ * @brief 简单解析qss，只处理“选择器{属性:值;}”的形式，多个选择器用逗号分隔，选择器中的空白统一为一个空格
+ * @param qss
+ * @return
+ */
+static SAQssRules sa_parse_qss(QString qss)
+{
+    // qss文件带有BOM
+    qss.remove(QChar(0xfeff));
+    qss.remove(QRegularExpression(QStringLiteral("/\\*.*?\\*/"), QRegularExpression::DotMatchesEverythingOption));
+    SAQssRules rules;
+    int pos = 0;
+    while (true) {
+        const int left = qss.indexOf(QLatin1Char('{'), pos);
+        const int right = qss.indexOf(QLatin1Char('}'), left);
+        if (left < 0 || right < 0) {
+            break;
+        }
+        const QStringList selectors    = qss.mid(pos, left - pos).split(QLatin1Char(','));
+        const QStringList declarations = qss.mid(left + 1, right - left - 1).split(QLatin1Char(';'));
+        for (const QString& s : selectors) {
+            QHash< QString, QString >& props = rules[ s.simplified() ];
+            for (const QString& decl : declarations) {
+                const int colon = decl.indexOf(QLatin1Char(':'));
+                if (colon > 0) {
+                    props[ decl.left(colon).trimmed() ] = decl.mid(colon + 1).trimmed();
+                }
+            }
+        }
+        pos = right + 1;
+    }
+    return rules;
+}
+
+/**
+ * @brief SARibbonThemeData中的颜色和qss中的对应关系
+ */
+struct SAThemeColorSource
+{
+    const char* name;                   ///< SARibbonThemeData中的成员名
+    QColor SARibbonThemeData::*member;  ///< SARibbonThemeData中的成员
+    const char* selector;               ///< qss选择器
+    const char* property;               ///< qss属性
+    const char* fallbackSelector;       ///< selector中没有此属性时再查找的选择器，可为nullptr
+};
+
+/**
+ * @brief 对比的颜色列表
+ *
+ * 只列出在qss中有直接对应属性的颜色，边框、标题文字、tab指示条等在qss中以复合属性或C++代码实现的不做对比
+ */
+static const SAThemeColorSource s_themeColorSources[] = {
+    { "barBackground", &SARibbonThemeData::barBackground, "SARibbonBar", "background-color", nullptr },
+    { "categoryBackground", &SARibbonThemeData::categoryBackground, "SARibbonCategory", "background-color", nullptr },
+    { "pannelBackground", &SARibbonThemeData::pannelBackground, "SARibbonPannel", "background-color", nullptr },
+    { "pannelTitleText", &SARibbonThemeData::pannelTitleText, "SARibbonPannelLabel", "color", nullptr },
+    { "pannelTitleBackground",
+      &SARibbonThemeData::pannelTitleBackground,
+      "SARibbonPannelLabel",
+      "background-color",
+      nullptr },
+    { "separatorColor", &SARibbonThemeData::separatorColor, "SARibbonSeparatorWidget", "color", nullptr },
+    { "applicationButtonText",
+      &SARibbonThemeData::applicationButtonText,
+      "SARibbonApplicationButton",
+      "color",
+      nullptr },
+    { "applicationButtonBackground",
+      &SARibbonThemeData::applicationButtonBackground,
+      "SARibbonApplicationButton",
+      "background-color",
+      nullptr },
+    { "applicationButtonHoverBackground",
+      &SARibbonThemeData::applicationButtonHoverBackground,
+      "SARibbonApplicationButton:hover",
+      "background-color",
+      nullptr },
+    { "applicationButtonPressedBackground",
+      &SARibbonThemeData::applicationButtonPressedBackground,
+      "SARibbonApplicationButton:pressed",
+      "background-color",
+      "SARibbonApplicationButton::pressed" },
+    { "tabText", &SARibbonThemeData::tabText, "SARibbonTabBar::tab", "color", nullptr },
+    { "tabSelectedText", &SARibbonThemeData::tabSelectedText, "SARibbonTabBar::tab:selected", "color", nullptr },
+    { "tabSelectedBackground",
+      &SARibbonThemeData::tabSelectedBackground,
+      "SARibbonTabBar::tab:selected",
+      "background",
+      nullptr },
+    { "tabHoverText", &SARibbonThemeData::tabHoverText, "SARibbonTabBar::tab:hover:!selected", "color", nullptr },
+    { "tabHoverBackground",
+      &SARibbonThemeData::tabHoverBackground,
+      "SARibbonTabBar::tab:hover:!selected",
+      "background",
+      nullptr },
+    { "buttonText", &SARibbonThemeData::buttonText, "SARibbonToolButton", "color", nullptr },
+    { "buttonHoverBackground",
+      &SARibbonThemeData::buttonHoverBackground,
+      "SARibbonToolButton:hover",
+      "background-color",
+      nullptr },
+    { "buttonPressedBackground",
+      &SARibbonThemeData::buttonPressedBackground,
+      "SARibbonToolButton:pressed",
+      "background-color",
+      nullptr },
+    { "buttonCheckedBackground",
+      &SARibbonThemeData::buttonCheckedBackground,
+      "SARibbonToolButton:checked",
+      "background-color",
+      nullptr },
+    { "menuText", &SARibbonThemeData::menuText, "SARibbonMenu", "color", nullptr },
+    { "menuBackground", &SARibbonThemeData::menuBackground, "SARibbonMenu", "background-color", nullptr },
+    { "menuItemHoverBackground",
+      &SARibbonThemeData::menuItemHoverBackground,
+      "SARibbonMenu::item:hover",
+      "background-color",
+      "SARibbonMenu::item:selected" },
+    { "galleryBackground", &SARibbonThemeData::galleryBackground, "SARibbonGallery", "background-color", nullptr },
+    { "gallerySelectedBackground",
+      &SARibbonThemeData::gallerySelectedBackground,
+      "SARibbonGalleryGroup::item:selected",
+      "background-color",
+      nullptr },
+    { "systemButtonHoverBackground",
+      &SARibbonThemeData::systemButtonHoverBackground,
+      "SARibbonSystemToolButton#SAMinimizeWindowButton:hover",
+      "background-color",
+      nullptr },
+    { "systemButtonPressedBackground",
+      &SARibbonThemeData::systemButtonPressedBackground,
+      "SARibbonSystemToolButton#SAMinimizeWindowButton:pressed",
+      "background-color",
+      nullptr },
+    { "systemCloseHoverBackground",
+      &SARibbonThemeData::systemCloseHoverBackground,
+      "SARibbonSystemToolButton#SACloseWindowButton:hover",
+      "background-color",
+      nullptr },
+    { "systemClosePressedBackground",
+      &SARibbonThemeData::systemClosePressedBackground,
+      "SARibbonSystemToolButton#SACloseWindowButton:pressed",
+      "background-color",
+      nullptr },
+};
+
+/**
+ * @brief 获取qss中的属性值，background属性也会查找background-color
+ */
+static QString sa_qss_value(const SAQssRules& rules, const QString& selector, const QString& property)
+{
+    const QHash< QString, QString > props = rules.value(selector);
+    QString v = props.value(property);
+    if (v.isEmpty() && property == QLatin1String("background")) {
+        v = props.value(QStringLiteral("background-color"));
+    }
+    return v;
+}
+
+/**
+ * @brief 获取qss中的像素值，例如“5px”，没有设置返回0
+ */
+static int sa_qss_px(const SAQssRules& rules, const QString& selector, const QString& property)
+{
+    QString v = sa_qss_value(rules, selector, property);
+    v.remove(QStringLiteral("px"));
+    return v.toInt();
+}
+
+/**
+ * @brief 创建使用原生绘制主题的主窗口，中心窗口为一个QLineEdit
+ */
+static void sa_init_theme_style_window(SARibbonMainWindow& w)
+{
+    w.setRibbonThemeEngine(SARibbonMainWindow::RibbonThemeEngineStyle);
+    w.setCentralWidget(new QLineEdit());
+    SARibbonCategory* category = w.ribbonBar()->addCategoryPage(QStringLiteral("Main"));
+    SARibbonPannel* pannel     = category->addPannel(QStringLiteral("Pannel"));
+    pannel->addLargeAction(new QAction(QStringLiteral("action"), &w));
+    w.resize(800, 600);
+    w.show();
+}
+
+void TstSARibbonThemeStyle::styleIsScopedToRibbon()
+{
+    QStyle* appStyle = QApplication::style();
+    SARibbonMainWindow w;
+    sa_init_theme_style_window(w);
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    // 应用程序的style不变
+    QCOMPARE(QApplication::style(), appStyle);
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(w.ribbonBar());
+    QVERIFY(themeStyle);
+    QCOMPARE(w.ribbonBar()->style(), static_cast< QStyle* >(themeStyle));
+    QCOMPARE(w.ribbonBar()->ribbonTabBar()->style(), static_cast< QStyle* >(themeStyle));
+    // 非ribbon窗口不受影响
+    QCOMPARE(w.centralWidget()->style(), appStyle);
+    QCOMPARE(w.style(), appStyle);
+}
+
+void TstSARibbonThemeStyle::laterChildrenUseThemeStyle()
+{
+    SARibbonMainWindow w;
+    sa_init_theme_style_window(w);
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(w.ribbonBar());
+    QVERIFY(themeStyle);
+    // 显示之后再加入的category和pannel
+    SARibbonCategory* category = w.ribbonBar()->addCategoryPage(QStringLiteral("Later"));
+    SARibbonPannel* pannel     = category->addPannel(QStringLiteral("Pannel"));
+    w.ribbonBar()->raiseCategory(category);
+    QCoreApplication::processEvents();
+    QCOMPARE(category->style(), static_cast< QStyle* >(themeStyle));
+    QCOMPARE(pannel->style(), static_cast< QStyle* >(themeStyle));
+}
+
+void TstSARibbonThemeStyle::switchBackToQss()
+{
+    QStyle* appStyle = QApplication::style();
+    SARibbonMainWindow w;
+    sa_init_theme_style_window(w);
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    QPointer< SARibbonThemeStyle > themeStyle = sa_ribbon_theme_style(w.ribbonBar());
+    QVERIFY(themeStyle);
+    w.setRibbonThemeEngine(SARibbonMainWindow::RibbonThemeEngineQss);
+    // 主题style被删除，不遗留任何style对象，应用程序的style不变
+    QVERIFY(themeStyle.isNull());
+    QVERIFY(!sa_ribbon_theme_style(w.ribbonBar()));
+    QCOMPARE(QApplication::style(), appStyle);
+    QVERIFY(!qobject_cast< QProxyStyle* >(QApplication::style()));
+    const QList< QWidget* > widgets = w.ribbonBar()->findChildren< QWidget* >();
+    for (QWidget* c : widgets) {
+        QVERIFY2(!qobject_cast< SARibbonThemeStyle* >(c->style()), qPrintable(c->metaObject()->className()));
+    }
+    QVERIFY(!w.styleSheet().isEmpty());
+    // 再切换回原生绘制
+    w.setRibbonThemeEngine(SARibbonMainWindow::RibbonThemeEngineStyle);
+    QVERIFY(sa_ribbon_theme_style(w.ribbonBar()));
+    QVERIFY(w.styleSheet().isEmpty());
+    QCOMPARE(QApplication::style(), appStyle);
+}
+
+void TstSARibbonThemeStyle::switchThemeUpdatesData()
+{
+    SARibbonMainWindow w;
+    sa_init_theme_style_window(w);
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(w.ribbonBar());
+    QVERIFY(themeStyle);
+    w.setRibbonTheme(SARibbonMainWindow::RibbonThemeDark);
+    // 切换主题复用同一个style，只更新数据
+    QCOMPARE(sa_ribbon_theme_style(w.ribbonBar()), themeStyle);
+    const SARibbonThemeData dark = SARibbonThemeData::themeData(SARibbonMainWindow::RibbonThemeDark);
+    QCOMPARE(themeStyle->themeData().barBackground, dark.barBackground);
+    QCOMPARE(themeStyle->themeData().tabText, dark.tabText);
+    QCOMPARE(themeStyle->themeData().tabMargin, dark.tabMargin);
+}
+
+void TstSARibbonThemeStyle::userStyleIsKept()
+{
+    QWidget root;
+    QWidget* child  = new QWidget(&root);
+    QWidget* styled = new QWidget(&root);
+    QScopedPointer< QStyle > userStyle(QStyleFactory::create(QStringLiteral("Fusion")));
+    QVERIFY(userStyle);
+    styled->setStyle(userStyle.data());
+    sa_set_ribbon_theme_style(&root, SARibbonMainWindow::RibbonThemeOffice2013);
+    SARibbonThemeStyle* themeStyle = sa_ribbon_theme_style(&root);
+    QVERIFY(themeStyle);
+    QCOMPARE(child->style(), static_cast< QStyle* >(themeStyle));
+    // 用户自己设置的style不会被覆盖
+    QCOMPARE(styled->style(), userStyle.data());
+    sa_clear_ribbon_theme_style(&root);
+    QVERIFY(!sa_ribbon_theme_style(&root));
+    QCOMPARE(child->style(), QApplication::style());
+    QCOMPARE(styled->style(), userStyle.data());
+}
+
+void TstSARibbonThemeStyle::themeDataMatchesQss_data()
+{
+    QTest::addColumn< int >("theme");
+    QTest::addColumn< QString >("qssFile");
+    QTest::newRow("win7") << int(SARibbonMainWindow::RibbonThemeWindows7) << QStringLiteral("theme-win7.qss");
+    QTest::newRow("office2013") << int(SARibbonMainWindow::RibbonThemeOffice2013)
+                                << QStringLiteral("theme-office2013.qss");
+    QTest::newRow("office2016blue") << int(SARibbonMainWindow::RibbonThemeOffice2016Blue)
+                                    << QStringLiteral("theme-office2016-blue.qss");
+    QTest::newRow("office2021blue") << int(SARibbonMainWindow::RibbonThemeOffice2021Blue)
+                                    << QStringLiteral("theme-office2021-blue.qss");
+    QTest::newRow("dark") << int(SARibbonMainWindow::RibbonThemeDark) << QStringLiteral("theme-dark.qss");
+    QTest::newRow("dark2") << int(SARibbonMainWindow::RibbonThemeDark2) << QStringLiteral("theme-dark2.qss");
+}
+
+void TstSARibbonThemeStyle::themeDataMatchesQss()
+{
+    QFETCH(int, theme);
+    QFETCH(QString, qssFile);
+    QFile file(QStringLiteral(":/theme/resource/") + qssFile);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    const SAQssRules rules     = sa_parse_qss(QString::fromUtf8(file.readAll()));
+    const SARibbonThemeData td = SARibbonThemeData::themeData(static_cast< SARibbonMainWindow::RibbonTheme >(theme));
+    QStringList mismatches;
+    for (const SAThemeColorSource& src : s_themeColorSources) {
+        QString v = sa_qss_value(rules, QLatin1String(src.selector), QLatin1String(src.property));
+        if (v.isEmpty() && src.fallbackSelector) {
+            v = sa_qss_value(rules, QLatin1String(src.fallbackSelector), QLatin1String(src.property));
+        }
+        if (v.startsWith(QLatin1String("qlineargradient"))) {
+            // 渐变色在SARibbonThemeData中用单色近似（win7主题）
+            continue;
+        }
+        if (theme == SARibbonMainWindow::RibbonThemeOffice2021Blue && v.isEmpty()
+            && QByteArray(src.name).startsWith("applicationButton")) {
+            // office2021的applicationButton在qss中用底部指示条表示状态，原生绘制用背景色近似
+            continue;
+        }
+        // qss中没有设置或为透明，对应SARibbonThemeData中的无效颜色
+        const QColor expected = (v.isEmpty() || v == QLatin1String("transparent")) ? QColor() : QColor(v);
+        const QColor actual   = td.*(src.member);
+        if (expected.isValid() != actual.isValid() || (expected.isValid() && expected.rgba() != actual.rgba())) {
+            mismatches.append(QStringLiteral("%1: qss=%2 data=%3")
+                                  .arg(QLatin1String(src.name),
+                                       v.isEmpty() ? QStringLiteral("(none)") : v,
+                                       actual.isValid() ? actual.name() : QStringLiteral("(invalid)")));
+        }
+    }
+    QVERIFY2(mismatches.isEmpty(), qPrintable(mismatches.join(QStringLiteral("; "))));
+    // tab的margin和最小尺寸
+    const QString tab = QStringLiteral("SARibbonTabBar::tab");
+    QCOMPARE(td.tabMargin,
+             QMargins(sa_qss_px(rules, tab, QStringLiteral("margin-left")),
+                      sa_qss_px(rules, tab, QStringLiteral("margin-top")),
+                      sa_qss_px(rules, tab, QStringLiteral("margin-right")),
+                      sa_qss_px(rules, tab, QStringLiteral("margin-bottom"))));
+    QCOMPARE(td.tabMinimumSize,
+             QSize(sa_qss_px(rules, tab, QStringLiteral("min-width")),
+                   sa_qss_px(rules, tab, QStringLiteral("min-height"))));
+}
+
+QTEST_MAIN(TstSARibbonThemeStyle)
+#include "tst_SARibbonThemeStyle.moc"
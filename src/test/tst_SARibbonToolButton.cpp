@@ -0,0 +1,108 @@
+﻿#include <QtTest>
+#include <QAction>
+#include <QBuffer>
+#include <QPixmap>
+#include "SARibbonBar.h"
+#include "SARibbonCategory.h"
+#include "SARibbonMainWindow.h"
+#include "SARibbonPannel.h"
+#include "SARibbonToolButton.h"
+
+/**
+ * @brief SARibbonToolButton预设sizehint的测试
+ *
+ * 从布局快照恢复的sizehint只在按钮的文字、图标、菜单和字体变化时失效，
+ * action的enable、check等状态变化不应使预设值失效
+ */
+class TstSARibbonToolButton : public QObject
+{
+    Q_OBJECT
+private slots:
+    void presetKeptOnStateChange();
+    void presetClearedOnActionContentChange();
+    void presetClearedOnButtonContentChange();
+};
+
+/**
+ * @brief 只有一个大按钮的ribbon窗口
+ */
+struct SARibbonToolButtonTestWindow
+{
+    SARibbonMainWindow w;
+    QAction* action { nullptr };
+    SARibbonToolButton* button { nullptr };
+    SARibbonToolButtonTestWindow()
+    {
+        SARibbonCategory* category = w.ribbonBar()->addCategoryPage(QStringLiteral("Main"));
+        SARibbonPannel* pannel     = category->addPannel(QStringLiteral("Pannel"));
+        action                     = new QAction(QStringLiteral("Paste"), &w);
+        action->setObjectName(QStringLiteral("paste"));
+        pannel->addLargeAction(action);
+        button = pannel->actionToRibbonToolButton(action);
+        w.resize(800, 400);
+        w.show();
+    }
+    // 保存当前的布局快照并立即恢复，恢复后按钮使用预设的sizehint
+    bool restoreSnapshot()
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        if (!buffer.open(QIODevice::ReadWrite) || !w.ribbonBar()->saveLayoutSnapshot(&buffer)) {
+            return false;
+        }
+        buffer.seek(0);
+        return w.ribbonBar()->restoreLayoutSnapshot(&buffer);
+    }
+};
+
+void TstSARibbonToolButton::presetKeptOnStateChange()
+{
+    SARibbonToolButtonTestWindow tw;
+    QVERIFY(QTest::qWaitForWindowExposed(&tw.w));
+    QVERIFY(tw.button);
+    QVERIFY(tw.restoreSnapshot());
+    QVERIFY(tw.button->isSizeHintPreset());
+    const QSize preset = tw.button->sizeHint();
+
+    tw.action->setEnabled(false);
+    QVERIFY(tw.button->isSizeHintPreset());
+    tw.action->setCheckable(true);
+    tw.action->setChecked(true);
+    tw.action->setToolTip(QStringLiteral("paste from clipboard"));
+    QVERIFY(tw.button->isSizeHintPreset());
+    QCOMPARE(tw.button->sizeHint(), preset);
+}
+
+void TstSARibbonToolButton::presetClearedOnActionContentChange()
+{
+    SARibbonToolButtonTestWindow tw;
+    QVERIFY(QTest::qWaitForWindowExposed(&tw.w));
+    QVERIFY(tw.restoreSnapshot());
+    tw.action->setText(QStringLiteral("Paste Special"));
+    QVERIFY(!tw.button->isSizeHintPreset());
+
+    QVERIFY(tw.restoreSnapshot());
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::red);
+    tw.action->setIcon(QIcon(pixmap));
+    QVERIFY(!tw.button->isSizeHintPreset());
+}
+
+void TstSARibbonToolButton::presetClearedOnButtonContentChange()
+{
+    SARibbonToolButtonTestWindow tw;
+    QVERIFY(QTest::qWaitForWindowExposed(&tw.w));
+    QVERIFY(tw.restoreSnapshot());
+    tw.button->setText(QStringLiteral("Paste Special"));
+    QVERIFY(!tw.button->isSizeHintPreset());
+
+    tw.button->setText(tw.action->text());
+    QVERIFY(tw.restoreSnapshot());
+    QFont f = tw.button->font();
+    f.setPointSize(f.pointSize() + 4);
+    tw.button->setFont(f);
+    QVERIFY(!tw.button->isSizeHintPreset());
+}
+
+QTEST_MAIN(TstSARibbonToolButton)
+#include "tst_SARibbonToolButton.moc"
@@ -22,6 +22,7 @@
 
 #include "../../src/SARibbonBar/colorWidgets/SAColorMenu.cpp"
 #include "../../src/SARibbonBar/colorWidgets/SAColorGridWidget.cpp"
+#include "../../src/SARibbonBar/colorWidgets/SAColorSwatchGridWidget.cpp"
 #include "../../src/SARibbonBar/colorWidgets/SAColorPaletteGridWidget.cpp"
 #include "../../src/SARibbonBar/colorWidgets/SAColorToolButton.cpp"
 //sa ribbon
@@ -61,6 +62,10 @@
 #include "../../src/SARibbonBar/SARibbonCustomizeWidget.cpp"
 #include "../../src/SARibbonBar/SARibbonCustomizeDialog.cpp"
 #include "../../src/SARibbonBar/SARibbonMainWindow.cpp"
+#include "../../src/SARibbonBar/SARibbonTheme.cpp"
+#include "../../src/SARibbonBar/SARibbonCommandSearchWidget.cpp"
+#include "../../src/SARibbonBar/SARibbonCommandUpdater.cpp"
+#include "../../src/SARibbonBar/SARibbonDescription.cpp"
 
 #ifdef _MSC_VER
 #pragma warning (pop)
@@ -4,6 +4,7 @@
 //color widget
 #include "../../src/SARibbonBar/colorWidgets/SAColorMenu.h"
 #include "../../src/SARibbonBar/colorWidgets/SAColorGridWidget.h"
+#include "../../src/SARibbonBar/colorWidgets/SAColorSwatchGridWidget.h"
 #include "../../src/SARibbonBar/colorWidgets/SAColorPaletteGridWidget.h"
 #include "../../src/SARibbonBar/colorWidgets/SAColorToolButton.h"
 //sa ribbon
@@ -43,4 +44,8 @@
 #include "../../src/SARibbonBar/SARibbonCustomizeWidget.h"
 #include "../../src/SARibbonBar/SARibbonCustomizeDialog.h"
 #include "../../src/SARibbonBar/SARibbonMainWindow.h"
+#include "../../src/SARibbonBar/SARibbonTheme.h"
+#include "../../src/SARibbonBar/SARibbonCommandSearchWidget.h"
+#include "../../src/SARibbonBar/SARibbonCommandUpdater.h"
+#include "../../src/SARibbonBar/SARibbonDescription.h"
 